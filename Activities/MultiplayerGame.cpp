@@ -216,6 +216,14 @@ namespace RTE {
 		m_pServerNameTextBox->SetText(g_SettingsMan.GetNetworkServerAddress());
 		m_pPlayerNameTextBox->SetText(g_SettingsMan.GetPlayerNetworkName());
 
+		// Connect straight away when launched directly into a multiplayer game, only the first time so leaving and coming back lets the player pick a server.
+		if (g_ActivityMan.IsSetToLaunchIntoMultiplayerGame())
+		{
+			m_pServerNameTextBox->SetText(std::string(g_ActivityMan.GetServerToConnectTo()));
+			g_ActivityMan.SetServerToConnectTo({});
+			ConnectToServer();
+		}
+
 		/*
 		m_pNATServiceServerNameTextBox->SetText(g_SettingsMan.GetNATServiceAddress());
 		m_pNATServerNameTextBox->SetText(g_SettingsMan.GetNATServerName());
@@ -225,6 +233,62 @@ namespace RTE {
 		return error;
 	}
 
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Method:          ConnectToServer
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Description:     Connects to the server named in the server name text box as the player
+	//                  named in the player name text box, remembering both in the settings.
+
+	void MultiplayerGame::ConnectToServer()
+	{
+		std::string serverName;
+		int port;
+
+		string::size_type portPos = string::npos;
+
+		portPos = m_pServerNameTextBox->GetText().find(":");
+		if (portPos != string::npos)
+		{
+			serverName = m_pServerNameTextBox->GetText().substr(0, portPos);
+			std::string portStr = m_pServerNameTextBox->GetText().substr(portPos + 1, m_pServerNameTextBox->GetText().length() - 2);
+
+			port = atoi(portStr.c_str());
+			if (port == 0)
+				port = 8000;
+		}
+		else 
+		{
+			serverName = m_pServerNameTextBox->GetText();
+			port = 8000;
+		}
+
+		std::string playerName = m_pPlayerNameTextBox->GetText();
+		if (playerName == "")
+			playerName = "Unnamed Player";
+
+		g_NetworkClient.Connect(serverName, port, playerName);
+		bool saveSettings = false;
+		
+		if (g_SettingsMan.GetPlayerNetworkName() != m_pPlayerNameTextBox->GetText())
+		{
+			g_SettingsMan.SetPlayerNetworkName(m_pPlayerNameTextBox->GetText());
+			saveSettings = true;
+		}
+
+		if (g_SettingsMan.GetNetworkServerAddress() != m_pServerNameTextBox->GetText())
+		{
+			g_SettingsMan.SetNetworkServerAddress(m_pServerNameTextBox->GetText());
+			saveSettings = true;
+		}
+
+		if (saveSettings)
+			g_SettingsMan.UpdateSettingsFile();
+
+		m_pGUIController->EnableMouse(false);
+		m_Mode = CONNECTION;
+		m_ConnectionWaitTimer.Reset();
+	}
+
 	//////////////////////////////////////////////////////////////////////////////////////////
 	// Method:          Pause
 	//////////////////////////////////////////////////////////////////////////////////////////
@@ -305,52 +369,7 @@ namespace RTE {
 
 					if (anEvent.GetControl() == m_pConnectButton)
 					{
-						std::string serverName;
-						int port;
-
-						string::size_type portPos = string::npos;
-
-						portPos = m_pServerNameTextBox->GetText().find(":");
-						if (portPos != string::npos)
-						{
-							serverName = m_pServerNameTextBox->GetText().substr(0, portPos);
-							std::string portStr = m_pServerNameTextBox->GetText().substr(portPos + 1, m_pServerNameTextBox->GetText().length() - 2);
-
-							port = atoi(portStr.c_str());
-							if (port == 0)
-								port = 8000;
-						}
-						else 
-						{
-							serverName = m_pServerNameTextBox->GetText();
-							port = 8000;
-						}
-
-						std::string playerName = m_pPlayerNameTextBox->GetText();
-						if (playerName == "")
-							playerName = "Unnamed Player";
-
-						g_NetworkClient.Connect(serverName, port, playerName);
-						bool saveSettings = false;
-						
-						if (g_SettingsMan.GetPlayerNetworkName() != m_pPlayerNameTextBox->GetText())
-						{
-							g_SettingsMan.SetPlayerNetworkName(m_pPlayerNameTextBox->GetText());
-							saveSettings = true;
-						}
-
-						if (g_SettingsMan.GetNetworkServerAddress() != m_pServerNameTextBox->GetText())
-						{
-							g_SettingsMan.SetNetworkServerAddress(m_pServerNameTextBox->GetText());
-							saveSettings = true;
-						}
-
-						if (saveSettings)
-							g_SettingsMan.UpdateSettingsFile();
-
-						m_pGUIController->EnableMouse(false);
-						m_Mode = CONNECTION;
-						m_ConnectionWaitTimer.Reset();
+						ConnectToServer();
 						g_GUISound.ButtonPressSound()->Play();
 					}
 
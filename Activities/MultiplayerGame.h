@@ -190,6 +190,17 @@ namespace RTE
 		void Draw(BITMAP *pTargetBitmap, const Vector &targetPos = Vector()) override;
 
 
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Method:          ConnectToServer
+		//////////////////////////////////////////////////////////////////////////////////////////
+		// Description:     Connects to the server named in the server name text box as the player
+		//                  named in the player name text box, remembering both in the settings.
+		// Arguments:       None.
+		// Return value:    None.
+
+		void ConnectToServer();
+
+
 		//////////////////////////////////////////////////////////////////////////////////////////
 		// Protected member variable and method declarations
 
@@ -1585,9 +1585,8 @@ bool AHuman::IsWithinRange(Vector &point) const
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  Look
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Casts an unseen-revealing ray in the direction of where this is facing.
-// Arguments:       The degree angle to deviate from the current view point in the ray
-//                  casting. A random ray will be chosen out of this +-range.
+// Description:     Reveals everything unseen in view of this' eyes, in the direction
+//                  of where this is aiming.
 
 bool AHuman::Look(float FOVSpread, float range)
 {
@@ -1616,14 +1615,11 @@ bool AHuman::Look(float FOVSpread, float range)
     Matrix aimMatrix(m_HFlipped ? -m_AimAngle : m_AimAngle);
     aimMatrix.SetXFlipped(m_HFlipped);
     lookVector *= aimMatrix;
-    // Add the spread
-	lookVector.DegRotate(FOVSpread * RandomNormalNum());
 
     // TODO: generate an alarm event if we spot an enemy actor?
 
-	Vector ignored;
-    // Cast the seeing ray, adjusting the skip to match the resolution of the unseen map
-    return g_SceneMan.CastSeeRay(m_Team, aimPos, lookVector, ignored, 25, (int)g_SceneMan.GetUnseenResolution(m_Team).GetSmallest() / 2);
+    // Reveal everything in view within the spread to either side of the aim
+    return m_FieldOfView.Look(m_Team, aimPos, aimDistance, lookVector, FOVSpread, 25);
 }
 
 
@@ -1803,7 +1799,7 @@ void AHuman::UpdateAI()
     ///////////////////////////////////////////////
     // React to relevant AlarmEvents
 
-	const list<AlarmEvent> &events = g_MovableMan.GetAlarmEvents();
+	const std::list<AlarmEvent> &events = g_MovableMan.GetAlarmEvents();
 	if (!events.empty()) {
 		Vector alarmVec;
 		Vector sensorPos = GetEyePos();
@@ -686,10 +686,10 @@ DefaultPieMenuNameGetter("Default Human Pie Menu");
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  Look
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Casts an unseen-revealing ray in the direction of where this is facing.
-// Arguments:       The degree angle to deviate from the current view point in the ray
-//                  casting. A random ray will be chosen out of this +-range.
-//                  The range, in pixels, beyond the actors sharp aim that the ray will have.
+// Description:     Reveals everything unseen in view of this' eyes, in the direction
+//                  of where this is aiming.
+// Arguments:       The degree angle to either side of the aim that this can see.
+//                  The range, in pixels, beyond the actors sharp aim that this can see.
 // Return value:    Whether any unseen pixels were revealed by this look.
 
 	bool Look(float FOVSpread, float range) override;
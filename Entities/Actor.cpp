@@ -99,6 +99,7 @@ void Actor::Clear() {
     m_SightDistance = 450.0F;
     m_Perceptiveness = 0.5F;
 	m_CanRevealUnseen = true;
+	m_FieldOfView.Reset();
     m_CharHeight = 0;
     m_HolsterOffset.Reset();
     m_ViewPoint.Reset();
@@ -121,6 +122,8 @@ void Actor::Clear() {
     m_MoveVector.Reset();
     m_MovePath.clear();
     m_UpdateMovePath = true;
+    m_MovePathRequestTicket = 0;
+    m_MovePathRequestEnd.Reset();
     m_MoveProximityLimit = 100.0F;
     m_LateralMoveState = LAT_STILL;
     m_MoveOvershootTimer.Reset();
@@ -489,6 +492,8 @@ void Actor::Destroy(bool notInherited)
     for (deque<MovableObject *>::const_iterator itr = m_Inventory.begin(); itr != m_Inventory.end(); ++itr)
         delete (*itr);
 
+    CancelMovePathRequest();
+
     if (!notInherited)
         MOSRotating::Destroy();
     Clear();
@@ -662,46 +667,21 @@ Controller::InputMode Actor::SwapControllerModes(Controller::InputMode newMode,
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  Look
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Casts an unseen-revealing ray in the direction of where this is facing.
+// Description:     Reveals everything unseen in view of this' eyes, in the direction it's
+//                  moving, or all around if it's standing still.
 
 bool Actor::Look(float FOVSpread, float range)
 {
     if (!g_SceneMan.AnythingUnseen(m_Team) || m_CanRevealUnseen == false)
         return false;
 
-    // Use the 'eyes' on the 'head', if applicable
-    Vector aimPos = GetEyePos();
-/*
-    Matrix aimMatrix(m_HFlipped ? -m_AimAngle : m_AimAngle);
-    aimMatrix.SetXFlipped(m_HFlipped);
-    // Get the langth of the look vector
-    Vector aimDistance = m_ViewPoint - aimPos;
-    // Add half the screen width
-    Vector lookVector(fabs(aimDistance.m_X) + range, 0);
-    // Set the rotation to the acutal aiming angle
-    lookVector *= aimMatrix;
-    // Add the spread
-    lookVector.DegRotate(FOVSpread * NormalRand());
-// TEST: Really need so far?
-    lookVector /= 2;
-*/
-    Vector lookVector = m_Vel;
     // If there is no vel, just look in all directions
-    if (lookVector.GetLargest() < 0.01)
-    {
-        lookVector.SetXY(range, 0);
-		lookVector.DegRotate(RandomNum(-180.0F, 180.0F));
-    }
-    else
-    {
-        // Set the distance in the look direction
-        lookVector.SetMagnitude(range);
-        // Add the spread from the directed look
-        lookVector.DegRotate(FOVSpread * RandomNormalNum());
-    }
+    Vector lookDirection = m_Vel;
+    if (lookDirection.GetLargest() < 0.01)
+        lookDirection.Reset();
 
-	Vector ignored;
-    return g_SceneMan.CastSeeRay(m_Team, aimPos, lookVector, ignored, 25, g_SceneMan.GetUnseenResolution(m_Team).GetSmallest() / 2);
+    // Use the 'eyes' on the 'head', if applicable
+    return m_FieldOfView.Look(m_Team, GetEyePos(), range, lookDirection, FOVSpread, 25);
 }
 
 
@@ -1179,46 +1159,56 @@ bool Actor::UpdateMovePath()
 {
     // TODO: Do throttling of calls for this function over time??
 
-
-    // Remove the material representation of all doors of this guy's team so he can navigate through them (they'll open for him)
-    g_MovableMan.OverrideMaterialDoors(true, m_Team);
-    // Update the pathfinding with any changes to doors' material representations
-    g_SceneMan.GetScene()->UpdatePathFinding();
-
-    // If we're following someone/thing, then never advance waypoints until that thing disappears
-    if (g_MovableMan.ValidMO(m_pMOMoveTarget))
-        g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_pMOMoveTarget->GetPos(), m_MovePath, m_DigStrength);
-    else
+    Scene *pScene = g_SceneMan.GetScene();
+    if (g_SettingsMan.AsyncPathfinding())
     {
-        // Do we currently have a path to a static target we would like to still pursue?
-        if (m_MovePath.empty())
+        // Check on the path we've asked for, if any; it's solved in the background so there's nothing more to do until it's delivered
+        bool pathDelivered = false;
+        bool requestLost = false;
+        if (m_MovePathRequestTicket != 0)
         {
-            // Ok no path going, so get a new path to the next waypoint, if there is a next waypoint
-            if (!m_Waypoints.empty())
+            if (pScene->IsPathRequestPending(m_MovePathRequestTicket))
+                return false;
+
+            std::list<Vector> requestedPath;
+            pScene->TakePathRequestResult(m_MovePathRequestTicket, requestedPath);
+            m_MovePathRequestTicket = 0;
+            // Solved paths always have at least the start in them, so an empty one means the request got lost along the way and we just ask again
+            if (!requestedPath.empty())
             {
-                // Make sure the path starts from the ground and not somewhere up in the air if/when dropped out of ship
-                g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_Waypoints.front().first, m_MovePath, m_DigStrength);
-                // If the waypoint was tied to an MO to pursue, then load it into the current MO target
-                if (g_MovableMan.ValidMO(m_Waypoints.front().second))
-                    m_pMOMoveTarget = m_Waypoints.front().second;
-                else
-                    m_pMOMoveTarget = 0;
-                // We loaded the waypoint, no need to keep it
-                m_Waypoints.pop_front();
+                m_MovePath = std::move(requestedPath);
+                pathDelivered = true;
             }
-            // Just try to get to the last Move Target
             else
-                g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_MoveTarget, m_MovePath, m_DigStrength);
+                requestLost = true;
+        }
+        if (!pathDelivered)
+        {
+            // A lost request already used up the waypoint it was heading for, so ask for the same end again instead of loading the next one
+            // Followed MOs are the exception, since they never use up waypoints and have likely moved since
+            if (!requestLost || g_MovableMan.ValidMO(m_pMOMoveTarget))
+                m_MovePathRequestEnd = LoadNextMovePathEnd();
+            // Make sure the path starts from the ground and not somewhere up in the air if/when dropped out of ship
+            // The doors of this guy's team are taken out of the material representation when the request is dispatched, so no need to do it here
+            m_MovePathRequestTicket = pScene->RequestPath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), m_MovePathRequestEnd, m_DigStrength, m_Team);
+            return false;
         }
-        // We had a path before trying to update, so use its last point as the final destination
-        else
-            g_SceneMan.GetScene()->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), Vector(m_MovePath.back()), m_MovePath, m_DigStrength);
     }
-
-    // Place back the material representation of all doors of this guy's team so they are as we found them
-    g_MovableMan.OverrideMaterialDoors(false, m_Team);
-    // Update the pathfinding with any changes to doors' material representations
-    g_SceneMan.GetScene()->UpdatePathFinding();
+    else
+    {
+        // Remove the material representation of all doors of this guy's team so he can navigate through them (they'll open for him)
+        g_MovableMan.OverrideMaterialDoors(true, m_Team);
+        // Update the pathfinding with any changes to doors' material representations
+        pScene->UpdatePathFinding();
+
+        // Make sure the path starts from the ground and not somewhere up in the air if/when dropped out of ship
+        pScene->CalculatePath(g_SceneMan.MovePointToGround(m_Pos, m_CharHeight*0.2, 10), LoadNextMovePathEnd(), m_MovePath, m_DigStrength);
+
+        // Place back the material representation of all doors of this guy's team so they are as we found them
+        g_MovableMan.OverrideMaterialDoors(false, m_Team);
+        // Update the pathfinding with any changes to doors' material representations
+        pScene->UpdatePathFinding();
+    }
 
     // Process the new path we now have, if any
     if (!m_MovePath.empty())
@@ -1253,6 +1243,53 @@ bool Actor::UpdateMovePath()
     return true;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelMovePathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Cancels the background request for a new move path, if there is one.
+
+void Actor::CancelMovePathRequest()
+{
+    if (m_MovePathRequestTicket != 0 && g_SceneMan.GetScene())
+        g_SceneMan.GetScene()->CancelPathRequest(m_MovePathRequestTicket);
+    m_MovePathRequestTicket = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LoadNextMovePathEnd
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets where the next move path should lead to, loading the next
+//                  waypoint if there is no path going currently.
+
+Vector Actor::LoadNextMovePathEnd()
+{
+    // If we're following someone/thing, then never advance waypoints until that thing disappears
+    if (g_MovableMan.ValidMO(m_pMOMoveTarget))
+        return m_pMOMoveTarget->GetPos();
+
+    // We had a path before trying to update, so use its last point as the final destination
+    if (!m_MovePath.empty())
+        return m_MovePath.back();
+
+    // Ok no path going, so get a new path to the next waypoint, if there is a next waypoint
+    if (!m_Waypoints.empty())
+    {
+        Vector pathEnd = m_Waypoints.front().first;
+        // If the waypoint was tied to an MO to pursue, then load it into the current MO target
+        if (g_MovableMan.ValidMO(m_Waypoints.front().second))
+            m_pMOMoveTarget = m_Waypoints.front().second;
+        else
+            m_pMOMoveTarget = 0;
+        // We loaded the waypoint, no need to keep it
+        m_Waypoints.pop_front();
+        return pathEnd;
+    }
+
+    // Just try to get to the last Move Target
+    return m_MoveTarget;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool Actor::UpdateAIScripted() {
@@ -1430,8 +1467,8 @@ void Actor::Update()
         // If still stuff in the path, get the next point on it
         if (!m_MovePath.empty())
             m_MoveTarget = m_MovePath.front();
-        // No more path, so check if any more waypoints to make a new path to? This doesn't apply if we're following something
-        else if (m_MovePath.empty() && !m_Waypoints.empty() && !m_pMOMoveTarget)
+        // No more path, so check if any more waypoints to make a new path to, or if the path to the last one is still on its way? This doesn't apply if we're following something
+        else if (m_MovePath.empty() && (!m_Waypoints.empty() || m_MovePathRequestTicket != 0) && !m_pMOMoveTarget)
             UpdateMovePath();
         // Nope, so just conclude that we must have reached the ultimate AI target set and exit the goto mode
         else if (!m_pMOMoveTarget)
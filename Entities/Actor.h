@@ -16,6 +16,7 @@
 
 #include "MOSRotating.h"
 #include "PieMenu.h"
+#include "FieldOfView.h"
 
 namespace RTE
 {
@@ -522,10 +523,11 @@ ClassInfoGetters;
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  Look
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Casts an unseen-revealing ray in the direction of where this is facing.
-// Arguments:       The degree angle to deviate from the current view point in the ray
-//                  casting. A random ray will be chosen out of this +-range.
-//                  The range, in pixels, that the ray will have.
+// Description:     Reveals everything unseen in view of this' eyes, in the direction it's
+//                  moving, or all around if it's standing still.
+// Arguments:       The degree angle to either side of the direction this is moving in
+//                  that it can see.
+//                  The range, in pixels, that this can see.
 // Return value:    Whether any unseen pixels were revealed by this look.
 
     virtual bool Look(float FOVSpread, float range);
@@ -677,7 +679,7 @@ ClassInfoGetters;
 // Arguments:       None.
 // Return value:    None.
 
-	void ClearAIWaypoints() { m_pMOMoveTarget = 0; m_Waypoints.clear(); m_MovePath.clear(); m_MoveTarget = m_Pos; m_MoveVector.Reset(); }
+	void ClearAIWaypoints() { CancelMovePathRequest(); m_pMOMoveTarget = 0; m_Waypoints.clear(); m_MovePath.clear(); m_MoveTarget = m_Pos; m_MoveVector.Reset(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1087,6 +1089,27 @@ ClassInfoGetters;
     virtual bool UpdateMovePath();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsMovePathRequestPending
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether this is waiting on a move path requested to be solved in
+//                  the background. Only happens with asynchronous pathfinding enabled.
+// Arguments:       None.
+// Return value:    Whether a move path request is pending.
+
+	bool IsMovePathRequestPending() const { return m_MovePathRequestTicket != 0; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelMovePathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Cancels the background request for a new move path, if there is one.
+// Arguments:       None.
+// Return value:    None.
+
+	void CancelMovePathRequest();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:  UpdateAIScripted
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1438,6 +1461,8 @@ protected:
     float m_Perceptiveness;
 	// Whether or not this actor can reveal unseen areas by looking
 	bool m_CanRevealUnseen;
+	// What this actor's eyes can see of its team's unseen layer, kept between looks until it needs finding anew
+	FieldOfView m_FieldOfView;
     // About How tall is the Actor, in pixels?
     float m_CharHeight;
     // Speed at which the m_AimAngle will change, in radians/s.
@@ -1524,6 +1549,10 @@ protected:
     std::list<Vector> m_MovePath;
     // Whether it's time to update the path
     bool m_UpdateMovePath;
+    // The ticket of the path requested to be solved in the background to become the new movepath, or 0 if none is pending
+    int m_MovePathRequestTicket;
+    // Where the path requested in the background should lead to, so it can be asked for again if the request gets lost
+    Vector m_MovePathRequestEnd;
     // The minimum range to consider having reached a move target is considered
     float m_MoveProximityLimit;
     // Whether the AI is trying to progress to the right, left, or stand still
@@ -1556,6 +1585,16 @@ private:
 
     std::unique_ptr<PieMenu> m_PieMenu;
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          LoadNextMovePathEnd
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets where the next move path should lead to. If there is no path
+//                  going and nothing being followed, the next waypoint is loaded for it.
+// Arguments:       None.
+// Return value:    The scene position the next move path should end at.
+
+    Vector LoadNextMovePathEnd();
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -107,6 +107,8 @@ int HDFirearm::Create(const HDFirearm &reference) {
 
     HeldDevice::Create(reference);
 
+    // The Magazine, Flash and SoundContainers can't be shared with the reference. The Attachables are MOs in their own right, with their own position, rounds and parent, and each SoundContainer keeps track of the channels it's playing on and where.
+    // What's costly to copy in them, the preset strings and the sound data of their SoundSets, is already shared through CopyOnWrite when they're cloned.
     if (reference.m_pMagazine) { SetMagazine(dynamic_cast<Magazine *>(reference.m_pMagazine->Clone())); }
     if (reference.m_pFlash) { SetFlash(dynamic_cast<Attachable *>(reference.m_pFlash->Clone())); }
 
@@ -16,6 +16,7 @@ namespace RTE {
 		m_MinLethalRange = 1;
 		m_MaxLethalRange = 1;
 		m_LethalSharpness = 1;
+		m_ExternallyReferenced = false;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -168,6 +169,19 @@ namespace RTE {
 		m_Atom->ClearMOIDIgnoreList();
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool MOPixel::IsTravelUnobstructed(const Vector &startPos, const Vector &velocity) const {
+		return m_Atom->IsTravelUnobstructed(startPos, velocity, g_TimerMan.GetDeltaTimeSecs());
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOPixel::TravelUnobstructed() {
+		MovableObject::Travel();
+		m_Atom->TravelUnobstructed(g_TimerMan.GetDeltaTimeSecs());
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	bool MOPixel::CollideAtPoint(HitData &hd) {
@@ -247,9 +261,17 @@ namespace RTE {
 				break;
 		}
 
-		acquire_bitmap(targetBitmap);
-		putpixel(targetBitmap, m_Pos.GetFloorIntX() - targetPos.m_X, m_Pos.GetFloorIntY() - targetPos.m_Y, drawColor);
-		release_bitmap(targetBitmap);
+		// With bitmask MO collision, MOID drawings are registered as footprints instead and only actually drawn when the MOID layer is being viewed.
+		bool drawFootprint = (mode == g_DrawMOID || mode == g_DrawNoMOID) && g_SceneMan.DrawsMOIDFootprints(targetBitmap);
+		int pixelX = static_cast<int>(m_Pos.GetFloorIntX() - targetPos.m_X);
+		int pixelY = static_cast<int>(m_Pos.GetFloorIntY() - targetPos.m_Y);
+		if (drawFootprint) { g_SceneMan.RegisterMOIDFootprint(drawColor, pixelX, pixelY); }
+
+		if (!drawFootprint || g_SceneMan.DrawsMOIDLayer()) {
+			acquire_bitmap(targetBitmap);
+			putpixel(targetBitmap, pixelX, pixelY, drawColor);
+			release_bitmap(targetBitmap);
+		}
 
 		if (mode == g_DrawMOID) {
 			g_SceneMan.RegisterMOIDDrawing(m_Pos - targetPos, 1);
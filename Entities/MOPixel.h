@@ -11,6 +11,7 @@ namespace RTE {
 	/// A movable object with mass that is graphically represented by a single pixel.
 	/// </summary>
 	class MOPixel : public MovableObject {
+		friend class ParticleStore;
 
 	public:
 
@@ -139,6 +140,17 @@ namespace RTE {
 		/// </summary>
 		/// <param name="trailLength">The new max length, in pixels. If 0, no trail is drawn.</param>
 		void SetTrailLength(int trailLength);
+
+		/// <summary>
+		/// Gets whether something outside of MovableMan may hold on to this MOPixel and change it, which keeps it out of ParticleStores.
+		/// </summary>
+		/// <returns>Whether this MOPixel may be held on to from outside of MovableMan.</returns>
+		bool IsExternallyReferenced() const { return m_ExternallyReferenced; }
+
+		/// <summary>
+		/// Sets that something outside of MovableMan may hold on to this MOPixel and change it, which keeps it out of ParticleStores for good.
+		/// </summary>
+		void SetExternallyReferenced() { m_ExternallyReferenced = true; }
 #pragma endregion
 
 #pragma region Virtual Override Methods
@@ -147,6 +159,25 @@ namespace RTE {
 		/// </summary>
 		void Travel() override;
 
+		/// <summary>
+		/// Gets whether this MOPixel's travel this frame can be checked ahead of time with IsTravelUnobstructed(), i.e. nothing but the Scene can affect it.
+		/// </summary>
+		/// <returns>Whether this MOPixel's travel can be predicted.</returns>
+		bool IsTravelPredictable() const { return !m_PinStrength && !m_GetsHitByMOs && !IsTooFast(); }
+
+		/// <summary>
+		/// Checks whether Travel() from the passed in state would not hit anything, without modifying anything. Safe to call from worker threads while the Scene is locked and not being written to.
+		/// </summary>
+		/// <param name="startPos">The position to start the travel from.</param>
+		/// <param name="velocity">The velocity to travel with.</param>
+		/// <returns>Whether the travel would not hit anything.</returns>
+		bool IsTravelUnobstructed(const Vector &startPos, const Vector &velocity) const;
+
+		/// <summary>
+		/// Travels this MOPixel the same way Travel() does when nothing is hit, without checking for collisions. Only valid if IsTravelUnobstructed() is true for the current position and velocity.
+		/// </summary>
+		void TravelUnobstructed();
+
 		/// <summary>
 		/// Calculates the collision response when another MO's Atom collides with this MO's physical representation.
 		/// The effects will be applied directly to this MO, and also represented in the passed in HitData.
@@ -203,6 +234,8 @@ namespace RTE {
 		float m_MaxLethalRange; //!< Upper bound multiplier for setting LethalRange at random. By default, 1.0 equals one screen.
 		float m_LethalSharpness; //!< When Sharpness has decreased below this threshold the MO becomes m_HitsMOs = false. Default is Sharpness * 0.5.
 
+		bool m_ExternallyReferenced; //!< Whether something outside of MovableMan may hold on to this MOPixel and change it, so changes made to it while it's stored would be missed.
+
 	private:
 
 		/// <summary>
@@ -182,9 +182,17 @@ namespace RTE {
 			}
 		}
 
+		// With bitmask MO collision, MOID drawings are registered as footprints instead and only actually drawn when the MOID layer is being viewed.
+		bool drawFootprints = (mode == g_DrawMOID || mode == g_DrawNoMOID) && g_SceneMan.DrawsMOIDFootprints(targetBitmap);
+		bool drawPixels = !drawFootprints || g_SceneMan.DrawsMOIDLayer();
+
 		for (int i = 0; i < drawPasses; ++i) {
 			int spriteX = drawPositions.at(i).GetFloorIntX();
 			int spriteY = drawPositions.at(i).GetFloorIntY();
+			if (drawFootprints) { g_SceneMan.RegisterMOIDFootprint(m_aSprite[m_Frame], mode == g_DrawMOID ? m_MOID : g_NoMOID, spriteX, spriteY); }
+			if (!drawPixels) {
+				continue;
+			}
 			switch (mode) {
 				case g_DrawMaterial:
 					draw_character_ex(targetBitmap, m_aSprite[m_Frame], drawPositions.at(i).GetFloorIntX(), drawPositions.at(i).GetFloorIntY(), m_SettleMaterialDisabled ? GetMaterial()->GetIndex() : GetMaterial()->GetSettleMaterial(), -1);
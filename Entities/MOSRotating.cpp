@@ -1295,21 +1295,11 @@ void MOSRotating::EraseFromTerrain()
 {
     Vector pivot = -m_SpriteOffset;
 
+    // The terrain flips the sprite itself, and caches the flipped silhouette along with the rest
     if (m_HFlipped)
-    {
-        // Create intermediate flipping bitmap if there isn't one yet
-        // Don't size the intermediate bitmaps to teh m_Scale, because the scaling happens after they are done
-        if (!m_pFlipBitmap)
-            m_pFlipBitmap = create_bitmap_ex(8, m_aSprite[m_Frame]->w, m_aSprite[m_Frame]->h);
-        clear_to_color(m_pFlipBitmap, g_MaskColor);
-
-        // Draw eitehr the source color bitmap or the intermediate material bitmap onto the intermediate flipping bitmap
-        draw_sprite_h_flip(m_pFlipBitmap, m_aSprite[m_Frame], 0, 0);
-
-        pivot.m_X = m_pFlipBitmap->w + m_SpriteOffset.m_X;
-    }
+        pivot.m_X = m_aSprite[m_Frame]->w + m_SpriteOffset.m_X;
 
-    deque<MOPixel *> pixels = g_SceneMan.GetTerrain()->EraseSilhouette(m_HFlipped ? m_pFlipBitmap : m_aSprite[m_Frame], m_Pos, pivot, m_Rotation, m_Scale, false);
+    g_SceneMan.GetTerrain()->EraseSilhouette(m_aSprite[m_Frame], m_HFlipped, m_Pos, pivot, m_Rotation, m_Scale, false);
 }
 
 
@@ -1328,51 +1318,29 @@ bool MOSRotating::DeepCheck(bool makeMOPs, int skipMOP, int maxMOPs)
         m_ForceDeepCheck = false;
         m_DeepHardness = true;
 
-// TODO: This stuff is just way too slow, EraseSilhouette is a hog
         // Make particles fly at least somewhat
         float velMag = MAX(10.0f, m_Vel.GetMagnitude());
         float splashDir = m_Vel.m_X >= 0 ? 1 : -1;
         float splashRatio = g_MovableMan.GetSplashRatio();
-        float tally = 0.0;
         int depth = m_pDeepGroup->GetDepth() >> 1;
         Vector pivot = -m_SpriteOffset;
 
+        // The terrain flips the sprite itself, and caches the flipped silhouette along with the rest
         if (m_HFlipped)
-        {
-            // Create intermediate flipping bitmap if there isn't one yet
-            // Don't size the intermediate bitmaps to teh m_Scale, because the scaling happens after they are done
-            if (!m_pFlipBitmap)
-                m_pFlipBitmap = create_bitmap_ex(8, m_aSprite[m_Frame]->w, m_aSprite[m_Frame]->h);
-            clear_to_color(m_pFlipBitmap, g_MaskColor);
-
-            // Draw eitehr the source color bitmap or the intermediate material bitmap onto the intermediate flipping bitmap
-            draw_sprite_h_flip(m_pFlipBitmap, m_aSprite[m_Frame], 0, 0);
-
-            pivot.m_X = m_pFlipBitmap->w + m_SpriteOffset.m_X;
-        }
+            pivot.m_X = m_aSprite[m_Frame]->w + m_SpriteOffset.m_X;
 
         {
             // Particle generation
-            // Erase the silhouette and get all the pixels that were created as a result
-            deque<MOPixel *> pixels = g_SceneMan.GetTerrain()->EraseSilhouette(m_HFlipped ? m_pFlipBitmap : m_aSprite[m_Frame], m_Pos, pivot, m_Rotation, m_Scale, makeMOPs, skipMOP, maxMOPs);
+            // Erase the silhouette and get the pixels that splash out as a result. Only the splash ratio of them are made at all, so they all get added
+            FrameDeque<MOPixel *> pixels = g_SceneMan.GetTerrain()->EraseSilhouette(m_aSprite[m_Frame], m_HFlipped, m_Pos, pivot, m_Rotation, m_Scale, makeMOPs, skipMOP, maxMOPs, splashRatio);
 
-            for (deque<MOPixel *>::iterator itr = pixels.begin(); itr != pixels.end(); ++itr)
+            for (FrameDeque<MOPixel *>::iterator itr = pixels.begin(); itr != pixels.end(); ++itr)
             {
-                tally += splashRatio;
-                if (tally >= 1.0)
-                {
-                    tally -= 1.0;
-                    (*itr)->SetPos((*itr)->GetPos() - m_Vel.GetNormalized() * depth);
-					(*itr)->SetVel(Vector(velMag * RandomNum(0.0F, splashDir), -RandomNum(0.0F, velMag)));
-                    m_DeepHardness += (*itr)->GetMaterial()->GetIntegrity() * (*itr)->GetMaterial()->GetPixelDensity();
-                    g_MovableMan.AddParticle(*itr);
-                    *itr = 0;
-                }
-                else
-                {
-                    delete (*itr);
-                    *itr = 0;
-                }
+                (*itr)->SetPos((*itr)->GetPos() - m_Vel.GetNormalized() * depth);
+                (*itr)->SetVel(Vector(velMag * RandomNum(0.0F, splashDir), -RandomNum(0.0F, velMag)));
+                m_DeepHardness += (*itr)->GetMaterial()->GetIntegrity() * (*itr)->GetMaterial()->GetPixelDensity();
+                g_MovableMan.AddParticle(*itr);
+                *itr = 0;
             }
         }
 // EXPERIMENTAL
@@ -1784,13 +1752,17 @@ void MOSRotating::Draw(BITMAP *pTargetBitmap,
 		keyColor = g_MOIDMaskColor;
 	}
 
+	// With bitmask MO collision, MOID drawings are registered as footprints instead and only actually drawn when the MOID layer is being viewed
+	bool drawFootprints = (mode == g_DrawMOID || mode == g_DrawNoMOID) && g_SceneMan.DrawsMOIDFootprints(pTargetBitmap);
+	bool drawPixels = !drawFootprints || g_SceneMan.DrawsMOIDLayer();
+
     Vector spritePos(m_Pos.GetRounded() - targetPos);
 
     if (m_Recoiled)
         spritePos += m_RecoilOffset;
 
     // If we're drawing a material silhouette, then create an intermediate material bitmap as well
-    if (mode != g_DrawColor && mode != g_DrawTrans)
+    if (mode != g_DrawColor && mode != g_DrawTrans && drawPixels)
     {
         clear_to_color(pTempBitmap, keyColor);
 
@@ -1856,9 +1828,26 @@ void MOSRotating::Draw(BITMAP *pTargetBitmap,
         }
     }
 
+    if (drawFootprints)
+    {
+        bool flipped = m_HFlipped && pFlipBitmap;
+        for (int i = 0; i < passes; ++i)
+        {
+            g_SceneMan.RegisterMOIDFootprint(m_aSprite[m_Frame],
+                                             mode == g_DrawMOID ? m_MOID : g_NoMOID,
+                                             aDrawPos[i].GetFloorIntX(),
+                                             aDrawPos[i].GetFloorIntY(),
+                                             static_cast<int>(flipped ? pFlipBitmap->w + m_SpriteOffset.m_X : -(m_SpriteOffset.m_X)),
+                                             static_cast<int>(-(m_SpriteOffset.m_Y)),
+                                             m_Rotation.GetAllegroAngle(),
+                                             m_Scale,
+                                             flipped);
+        }
+    }
+
     //////////////////
     // FLIPPED
-    if (m_HFlipped && pFlipBitmap)
+    if (drawPixels && m_HFlipped && pFlipBitmap)
     {
         // Don't size the intermediate bitmaps to the m_Scale, because the scaling happens after they are done
         clear_to_color(pFlipBitmap, keyColor);
@@ -1914,7 +1903,7 @@ void MOSRotating::Draw(BITMAP *pTargetBitmap,
     }
     /////////////////
     // NON-FLIPPED
-    else
+    else if (drawPixels)
     {
 //        spritePos += m_SpriteOffset;
 //        spritePos += (m_SpriteCenter * m_Rotation - m_SpriteCenter);
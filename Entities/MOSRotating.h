@@ -469,6 +469,18 @@ ClassInfoGetters;
     /// <param name="destroy">Whether to remove or delete the Attachables. Setting this to true deletes them, setting it to false removes them.</param>
 	void RemoveOrDestroyAllAttachables(bool destroy);
 
+	/// <summary>
+	/// Gets the Attachables of this MOSRotating, not including wounds.
+	/// </summary>
+	/// <returns>The list of Attachables of this MOSRotating.</returns>
+	const std::list<Attachable *> & GetAttachableList() const { return m_Attachables; }
+
+	/// <summary>
+	/// Gets the wounds of this MOSRotating.
+	/// </summary>
+	/// <returns>The list of wound emitters of this MOSRotating.</returns>
+	const std::list<AEmitter *> & GetWoundList() const { return m_Wounds; }
+
 	/// <summary>
 	/// Gets the Attachable nearest to the passed in offset.
 	/// </summary>
@@ -570,8 +570,15 @@ void MOSprite::Draw(BITMAP *pTargetBitmap,
         }
     }
 
+    // With bitmask MO collision, MOID drawings are registered as footprints instead and only actually drawn when the MOID layer is being viewed
+    bool drawFootprints = (mode == g_DrawMOID || mode == g_DrawNoMOID) && g_SceneMan.DrawsMOIDFootprints(pTargetBitmap);
+    bool drawPixels = !drawFootprints || g_SceneMan.DrawsMOIDLayer();
+
     for (int i = 0; i < passes; ++i)
     {
+        if (drawFootprints)
+            g_SceneMan.RegisterMOIDFootprint(m_aSprite[m_Frame], mode == g_DrawMOID ? m_MOID : g_NoMOID, aDrawPos[i].GetFloorIntX(), aDrawPos[i].GetFloorIntY());
+
         if (mode == g_DrawMaterial) {
             RTEAbort("Ordered to draw an MOSprite in its material, which is not possible!");
         }
@@ -581,11 +588,17 @@ void MOSprite::Draw(BITMAP *pTargetBitmap,
         {
             int spriteX = aDrawPos[i].GetFloorIntX();
             int spriteY = aDrawPos[i].GetFloorIntY();
-            draw_character_ex(pTargetBitmap, m_aSprite[m_Frame], spriteX, spriteY, m_MOID, -1);
-            g_SceneMan.RegisterMOIDDrawing(spriteX, spriteY, spriteX + m_aSprite[m_Frame]->w, spriteY + m_aSprite[m_Frame]->h);
+            if (drawPixels)
+            {
+                draw_character_ex(pTargetBitmap, m_aSprite[m_Frame], spriteX, spriteY, m_MOID, -1);
+                g_SceneMan.RegisterMOIDDrawing(spriteX, spriteY, spriteX + m_aSprite[m_Frame]->w, spriteY + m_aSprite[m_Frame]->h);
+            }
 		}
         else if (mode == g_DrawNoMOID)
-            draw_character_ex(pTargetBitmap, m_aSprite[m_Frame], aDrawPos[i].GetFloorIntX(), aDrawPos[i].GetFloorIntY(), g_NoMOID, -1);
+        {
+            if (drawPixels)
+                draw_character_ex(pTargetBitmap, m_aSprite[m_Frame], aDrawPos[i].GetFloorIntX(), aDrawPos[i].GetFloorIntY(), g_NoMOID, -1);
+        }
         else if (mode == g_DrawTrans)
             draw_trans_sprite(pTargetBitmap, m_aSprite[m_Frame], aDrawPos[i].GetFloorIntX(), aDrawPos[i].GetFloorIntY());
         else if (mode == g_DrawAlpha)
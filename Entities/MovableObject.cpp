@@ -17,6 +17,7 @@
 #include "ConsoleMan.h"
 #include "SettingsMan.h"
 #include "LuaMan.h"
+#include "PerformanceMan.h"
 #include "Atom.h"
 #include "Actor.h"
 #include "SLTerrain.h"
@@ -79,6 +80,8 @@ void MovableObject::Clear()
     m_FunctionsAndScripts.clear();
     m_ScriptPresetName.clear();
     m_ScriptObjectName.clear();
+    m_ScriptObjectReference = LuaMan::c_NoReference;
+    m_FunctionTableReferences.reset();
     m_ScreenEffectFile.Reset();
     m_pScreenEffect = 0;
 	m_EffectRotAngle = 0;
@@ -219,6 +222,7 @@ int MovableObject::Create(const MovableObject &reference)
     m_HUDVisible = reference.m_HUDVisible;
 
     m_ScriptPresetName = reference.m_ScriptPresetName;
+    m_FunctionTableReferences = reference.m_FunctionTableReferences;
     for (auto &[scriptPath, scriptEnabled] : reference.m_AllLoadedScripts) {
         LoadScript(scriptPath, scriptEnabled);
     }
@@ -480,6 +484,7 @@ void MovableObject::Destroy(bool notInherited) {
         RunScriptedFunctionInAppropriateScripts("Destroy");
         g_LuaMan.RunScriptString(m_ScriptObjectName + " = nil;");
     }
+    ReleaseScriptReferences();
 	g_MovableMan.UnregisterObject(this);
     if (!notInherited) { SceneObject::Destroy(); }
     Clear();
@@ -492,10 +497,18 @@ int MovableObject::InitializeObjectScripts() {
 
     g_LuaMan.SetTempEntity(this);
 
+    g_LuaMan.ReleaseReference(m_ScriptObjectReference);
+    m_ScriptObjectReference = LuaMan::c_NoReference;
+
     if (g_LuaMan.RunScriptString(m_ScriptObjectName + " = To" + GetClassName() + "(LuaMan.TempEntity);") < 0) {
         m_ScriptObjectName = "ERROR";
         return -2;
     }
+    m_ScriptObjectReference = g_LuaMan.CreateReference(m_ScriptObjectName);
+    if (m_ScriptObjectReference == LuaMan::c_NoReference) {
+        m_ScriptObjectName = "ERROR";
+        return -2;
+    }
 
 	if (!m_FunctionsAndScripts.at("Create").empty() && RunScriptedFunctionInAppropriateScripts("Create", true, true) < 0) {
 		m_ScriptObjectName = "ERROR";
@@ -536,6 +549,7 @@ int MovableObject::LoadScript(const std::string &scriptPath, bool loadAsEnabledS
     // Generate a ScriptPresetName, setup a table for the preset's functions, and clear the instance object name so it gets created in the first run of UpdateScripts
     if (m_ScriptPresetName.empty()) {
         m_ScriptPresetName = GetClassName() + "s." + g_LuaMan.GetNewPresetID();
+        m_FunctionTableReferences = std::make_shared<PresetFunctionTableReferences>();
 
         if (g_LuaMan.RunScriptString(m_ScriptPresetName + " = {};") < 0) {
             return -4;
@@ -578,8 +592,10 @@ int MovableObject::ReloadScripts() {
         std::map<std::string, bool> loadedScriptsCopy = object->m_AllLoadedScripts;
         object->m_AllLoadedScripts.clear();
         object->m_FunctionsAndScripts.clear();
+        object->ReleaseScriptReferences();
         if (isPresetObject) {
             object->m_ScriptPresetName.clear();
+            object->m_FunctionTableReferences.reset();
         } else {
             object->m_ScriptObjectName.clear();
         }
@@ -599,7 +615,10 @@ int MovableObject::ReloadScripts() {
     int status = 0;
     if (movableObjectPreset == this) { status = clearScriptConfigurationAndLoadPreexistingScripts(movableObjectPreset, true); }
     if (status == 0 && movableObjectPreset != this) {
-        if (movableObjectPreset) { m_ScriptPresetName = movableObjectPreset->m_ScriptPresetName; }
+        if (movableObjectPreset) {
+            m_ScriptPresetName = movableObjectPreset->m_ScriptPresetName;
+            m_FunctionTableReferences = movableObjectPreset->m_FunctionTableReferences;
+        }
         status = clearScriptConfigurationAndLoadPreexistingScripts(this, false);
     }
 
@@ -694,10 +713,12 @@ int MovableObject::RunScriptedFunction(const std::string &scriptPath, const std:
         return -1;
     }
 
-    std::string presetAndFunctionName = m_ScriptPresetName + "." + functionName;
-    std::string fullFunctionName = presetAndFunctionName + "[\"" + scriptPath + "\"]";
+    bool measureScriptTime = g_PerformanceMan.IsShowingPerformanceStats();
+    long long startTime = measureScriptTime ? g_TimerMan.GetAbsoluteTime() : 0;
+
+    int status = g_LuaMan.RunReferencedFunction(GetFunctionTableReference(functionName), scriptPath, m_ScriptObjectReference, functionEntityArguments, functionLiteralArguments);
 
-    int status = g_LuaMan.RunScriptedFunction(fullFunctionName, m_ScriptObjectName, {presetAndFunctionName, m_ScriptObjectName, fullFunctionName}, functionEntityArguments, functionLiteralArguments);
+    if (measureScriptTime) { g_PerformanceMan.AddScriptPresetTime(GetModuleAndPresetName(), static_cast<uint64_t>(g_TimerMan.GetAbsoluteTime() - startTime)); }
     if (status < 0 && m_AllLoadedScripts.size() > 1) {
         g_ConsoleMan.PrintString("ERROR: An error occured while trying to run the " + functionName + " function for script at path " + scriptPath);
         return -2;
@@ -731,6 +752,37 @@ int MovableObject::RunScriptedFunctionInAppropriateScripts(const std::string &fu
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+MovableObject::PresetFunctionTableReferences::~PresetFunctionTableReferences() {
+    for (const auto &[functionName, functionTableReference] : References) {
+        g_LuaMan.ReleaseReference(functionTableReference);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int MovableObject::GetFunctionTableReference(const std::string &functionName) const {
+    // Anything that got its ScriptPresetName without going through LoadScript or copying it from its preset still needs somewhere to keep its references.
+    if (!m_FunctionTableReferences) { m_FunctionTableReferences = std::make_shared<PresetFunctionTableReferences>(); }
+
+    std::unordered_map<std::string, int>::const_iterator functionTableReferenceEntry = m_FunctionTableReferences->References.find(functionName);
+    if (functionTableReferenceEntry != m_FunctionTableReferences->References.end()) {
+        return functionTableReferenceEntry->second;
+    }
+    // Missing tables aren't cached, since adding a script can create them later on. Only functions the preset actually has get run though, so this is rare.
+    int functionTableReference = g_LuaMan.CreateReference(m_ScriptPresetName + "." + functionName);
+    if (functionTableReference != LuaMan::c_NoReference) { m_FunctionTableReferences->References.try_emplace(functionName, functionTableReference); }
+    return functionTableReference;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void MovableObject::ReleaseScriptReferences() {
+    g_LuaMan.ReleaseReference(m_ScriptObjectReference);
+    m_ScriptObjectReference = LuaMan::c_NoReference;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /*
 //////////////////////////////////////////////////////////////////////////////////////////
 // Constructor:     MovableObject
@@ -852,27 +904,46 @@ void MovableObject::ApplyForces()
         return;
     }
 
+    m_Vel = GetVelocityAfterForces();
+
+    // Clear out the forces list
+    m_Forces.clear();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetVelocityAfterForces
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Calculates the velocity this MovableObject will have once the global
+//                  and accumulated forces are applied by MovableObject::ApplyForces,
+//                  without actually applying them.
+
+Vector MovableObject::GetVelocityAfterForces() const
+{
+    Vector velocity = m_Vel;
+    if (m_PinStrength > 0)
+        return velocity;
+
     float deltaTime = g_TimerMan.GetDeltaTimeSecs();
 
 //// TODO: remove this!$@#$%#@%#@%#@^#@^#@^@#^@#")
 //    if (m_PresetName != "Test Player")
     // Apply global acceleration (gravity), scaled by the scalar we have that can even be negative.
-    m_Vel += g_SceneMan.GetGlobalAcc() * m_GlobalAccScalar * deltaTime;
+    velocity += g_SceneMan.GetGlobalAcc() * m_GlobalAccScalar * deltaTime;
 
     // Calculate air resistance effects, only when something flies faster than a threshold
-    if (m_AirResistance > 0 && m_Vel.GetLargest() >= m_AirThreshold)
-        m_Vel *= 1.0 - (m_AirResistance * deltaTime);
+    if (m_AirResistance > 0 && velocity.GetLargest() >= m_AirThreshold)
+        velocity *= 1.0 - (m_AirResistance * deltaTime);
 
     // Apply the translational effects of all the forces accumulated during the Update()
-    for (deque<pair<Vector, Vector> >::iterator fItr = m_Forces.begin(); fItr != m_Forces.end(); ++fItr)
+    for (deque<pair<Vector, Vector> >::const_iterator fItr = m_Forces.begin(); fItr != m_Forces.end(); ++fItr)
     {
         // Continuous force application to transformational velocity.
         // (F = m * a -> a = F / m).
-        m_Vel += ((*fItr).first / (GetMass() != 0 ? GetMass() : 0.0001F) * deltaTime);
+        velocity += ((*fItr).first / (GetMass() != 0 ? GetMass() : 0.0001F) * deltaTime);
     }
 
-    // Clear out the forces list
-    m_Forces.clear();
+    return velocity;
 }
 
 
@@ -1017,15 +1088,86 @@ int MovableObject::UpdateScripts() {
 	m_SimUpdatesSinceLastScriptedUpdate = 0;
 
 
-    int status = !g_LuaMan.ExpressionIsTrue(m_ScriptPresetName, false) ? ReloadScripts() : 0;
+    // Holding references to any of the preset's function tables means the preset table exists, so the check, which has to compile the expression, can be skipped.
+    int status = ((!m_FunctionTableReferences || m_FunctionTableReferences->References.empty()) && !g_LuaMan.ExpressionIsTrue(m_ScriptPresetName, false)) ? ReloadScripts() : 0;
     status = (status >= 0 && !ObjectScriptsInitialized()) ? InitializeObjectScripts() : status;
-    status = (status >= 0) ? RunScriptedFunctionInAppropriateScripts("Update", false, true) : status;
+    if (status >= 0 && g_MovableMan.IsBatchedScriptUpdatesEnabled() && GetRootParent() == this && HasEverBeenAddedToMovableMan() && !m_FunctionsAndScripts.at("UpdateAll").empty()) {
+        // Scripts with an UpdateAll function get it run for all their instances at once by MovableMan later this frame, so only the others get their Update run here.
+        g_MovableMan.AddToBatchedScriptUpdates(this);
+        const std::vector<std::string> &batchedScriptPaths = m_FunctionsAndScripts.at("UpdateAll");
+        for (const std::string &scriptPath : m_FunctionsAndScripts.at("Update")) {
+            if (m_AllLoadedScripts.at(scriptPath) == true && std::find(batchedScriptPaths.begin(), batchedScriptPaths.end(), scriptPath) == batchedScriptPaths.end()) {
+                status = RunScriptedFunction(scriptPath, "Update");
+                if (status < 0) {
+                    break;
+                }
+            }
+        }
+    } else {
+        status = (status >= 0) ? RunScriptedFunctionInAppropriateScripts("Update", false, true) : status;
+    }
 
     return status;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void MovableObject::RunBatchedScriptUpdates(const std::vector<unsigned long int> &movableObjectIDs) {
+    /// <summary>
+    /// All the instances of a preset that have one of its scripts enabled, to be updated in one call to the script's UpdateAll function.
+    /// </summary>
+    struct ScriptUpdateBatch {
+        std::string ScriptPath;
+        std::vector<unsigned long int> InstanceIDs;
+    };
+    std::vector<ScriptUpdateBatch> scriptUpdateBatches;
+    std::unordered_map<std::string, size_t> scriptUpdateBatchIndices;
+
+    // Batches are kept in the order their first instance was added, so the scripts run in the same order every time.
+    for (unsigned long int movableObjectID : movableObjectIDs) {
+        // Anything could have been deleted by the scripts and gibbings since it was added, which unregisters it.
+        const MovableObject *movableObject = g_MovableMan.FindObjectByUniqueID(movableObjectID);
+        if (!movableObject || movableObject->IsSetToDelete() || !movableObject->ObjectScriptsInitialized()) {
+            continue;
+        }
+        for (const std::string &scriptPath : movableObject->m_FunctionsAndScripts.at("UpdateAll")) {
+            if (movableObject->m_AllLoadedScripts.at(scriptPath) == true) {
+                auto [batchIndexEntry, newBatch] = scriptUpdateBatchIndices.try_emplace(movableObject->m_ScriptPresetName + "|" + scriptPath, scriptUpdateBatches.size());
+                if (newBatch) { scriptUpdateBatches.push_back({ scriptPath, {} }); }
+                scriptUpdateBatches[batchIndexEntry->second].InstanceIDs.push_back(movableObjectID);
+            }
+        }
+    }
+
+    std::vector<int> instanceReferences;
+    for (const ScriptUpdateBatch &scriptUpdateBatch : scriptUpdateBatches) {
+        // The instances and their references are only gathered right before each call, in case an earlier batch's script deleted any of them or reloaded their scripts.
+        instanceReferences.clear();
+        const MovableObject *firstInstance = nullptr;
+        for (unsigned long int instanceID : scriptUpdateBatch.InstanceIDs) {
+            const MovableObject *instance = g_MovableMan.FindObjectByUniqueID(instanceID);
+            if (instance && !instance->IsSetToDelete()) {
+                instanceReferences.push_back(instance->m_ScriptObjectReference);
+                if (!firstInstance) { firstInstance = instance; }
+            }
+        }
+        if (!firstInstance) {
+            continue;
+        }
+
+        bool measureScriptTime = g_PerformanceMan.IsShowingPerformanceStats();
+        long long startTime = measureScriptTime ? g_TimerMan.GetAbsoluteTime() : 0;
+
+        if (g_LuaMan.RunReferencedFunctionOnObjects(firstInstance->GetFunctionTableReference("UpdateAll"), scriptUpdateBatch.ScriptPath, instanceReferences) < 0) {
+            g_ConsoleMan.PrintString("ERROR: An error occured while trying to run the UpdateAll function for script at path " + scriptUpdateBatch.ScriptPath);
+        }
+
+        if (measureScriptTime) { g_PerformanceMan.AddScriptPresetTime(firstInstance->GetModuleAndPresetName(), static_cast<uint64_t>(g_TimerMan.GetAbsoluteTime() - startTime)); }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 int MovableObject::WhilePieMenuOpenListener(const PieMenu *pieMenu) {
 	return RunScriptedFunctionInAppropriateScripts("WhilePieMenuOpen", false, false, { pieMenu });
 }
@@ -1095,6 +1237,7 @@ bool MovableObject::DrawToTerrain(SLTerrain *terrain) {
 	if (!terrain) {
 		return false;
 	}
+	g_SceneMan.RegisterObstacleDrawing();
 	if (dynamic_cast<MOSprite *>(this)) {
 		auto wrappedMaskedBlit = [](BITMAP *sourceBitmap, BITMAP *destinationBitmap, const Vector &bitmapPos, bool swapSourceWithDestination) {
 			std::array<BITMAP *, 2> bitmaps = { sourceBitmap, destinationBitmap };
@@ -1144,11 +1287,11 @@ bool MovableObject::DrawToTerrain(SLTerrain *terrain) {
 		wrappedMaskedBlit(terrain->GetMaterialBitmap(), tempBitmap, tempBitmapPos, true);
 
 		terrain->AddUpdatedMaterialArea(Box(tempBitmapPos, static_cast<float>(tempBitmap->w), static_cast<float>(tempBitmap->h)));
-		g_SceneMan.RegisterTerrainChange(tempBitmapPos.GetFloorIntX(), tempBitmapPos.GetFloorIntY(), tempBitmap->w, tempBitmap->h, ColorKeys::g_MaskColor, false);
+		g_SceneMan.RegisterTerrainChange(tempBitmapPos.GetFloorIntX(), tempBitmapPos.GetFloorIntY(), tempBitmap->w, tempBitmap->h, false);
 	} else {
 		Draw(terrain->GetFGColorBitmap(), Vector(), DrawMode::g_DrawColor, true);
 		Draw(terrain->GetMaterialBitmap(), Vector(), DrawMode::g_DrawMaterial, true);
-		g_SceneMan.RegisterTerrainChange(m_Pos.GetFloorIntX(), m_Pos.GetFloorIntY(), 1, 1, DrawMode::g_DrawColor, false);
+		g_SceneMan.RegisterTerrainChange(m_Pos.GetFloorIntX(), m_Pos.GetFloorIntY(), 1, 1, false);
 	}
 	return true;
 }
@@ -63,7 +63,7 @@ friend struct EntityLuaBindings;
 
 public:
 
-	ScriptFunctionNames("Create", "Destroy", "Update", "OnScriptDisable", "OnScriptEnable", "OnCollideWithTerrain", "OnCollideWithMO", "WhilePieMenuOpen");
+	ScriptFunctionNames("Create", "Destroy", "Update", "UpdateAll", "OnScriptDisable", "OnScriptEnable", "OnCollideWithTerrain", "OnCollideWithMO", "WhilePieMenuOpen");
 	SerializableOverrideMethods;
 	ClassInfoGetters;
 
@@ -1380,6 +1380,18 @@ enum MOType
     virtual void ApplyForces();
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetVelocityAfterForces
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Calculates the velocity this MovableObject will have once the global
+//                  and accumulated forces are applied by MovableObject::ApplyForces,
+//                  without actually applying them.
+// Arguments:       None.
+// Return value:    The velocity after the forces are applied. Pinned MOs keep theirs.
+
+    Vector GetVelocityAfterForces() const;
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  ApplyImpulses
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1563,6 +1575,13 @@ enum MOType
 
 	int UpdateScripts();
 
+	/// <summary>
+	/// Runs the UpdateAll functions of the scripts of the given MOs, calling each preset script's function once with a table of all the given instances that have that script enabled.
+	/// Used for batched script updates, which have the MOs put off their UpdateAll scripts in UpdateScripts instead of running their Update functions.
+	/// </summary>
+	/// <param name="movableObjectIDs">The unique IDs of the MOs whose UpdateAll functions to run, in update order. MOs that have been deleted or set to be deleted by the time their batch runs are skipped.</param>
+	static void RunBatchedScriptUpdates(const std::vector<unsigned long int> &movableObjectIDs);
+
 	/// <summary>
 	/// Event listener to be run while this MovableObject's PieMenu is opened.
 	/// </summary>
@@ -1831,12 +1850,36 @@ enum MOType
 // Protected member variable and method declarations
 
 protected:
+    /// <summary>
+    /// Lua registry references to a preset's tables of script paths to functions. Shared by the preset and all the copies made of it, and released when the last of them lets go.
+    /// </summary>
+    struct PresetFunctionTableReferences {
+        std::unordered_map<std::string, int> References; //!< A map of function names to Lua registry references to the preset's table of script paths to that function. Filled in as functions are first run.
+
+        /// <summary>
+        /// Destructor method used to release the Lua registry references.
+        /// </summary>
+        ~PresetFunctionTableReferences();
+    };
+
     /// <summary>
     /// Does necessary work to setup a script object name for this object, allowing it to be accessed in Lua, then runs all of the MO's scripts' Create functions in Lua.
     /// </summary>
     /// <returns>0 on success, -2 if it fails to setup the script object in Lua, and -3 if it fails to run any Create function.</returns>
     int InitializeObjectScripts();
 
+    /// <summary>
+    /// Gets the Lua registry reference to this' preset's table of script paths to the given function, looking it up in Lua the first time the preset or any of its copies runs the function.
+    /// </summary>
+    /// <param name="functionName">The name of the function to get the table reference for.</param>
+    /// <returns>The reference to the function table, or LuaMan::c_NoReference if the preset has no such table.</returns>
+    int GetFunctionTableReference(const std::string &functionName) const;
+
+    /// <summary>
+    /// Releases the Lua registry reference to this' object instance representation, so it gets looked up again the next time it's needed. The preset's function table references are left to the preset.
+    /// </summary>
+    void ReleaseScriptReferences();
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Virtual method:  UpdateChildMOIDs
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1967,6 +2010,8 @@ protected:
     std::string m_ScriptPresetName;
     // The ID name unique to this' object instance representation in the Lua state.
     std::string m_ScriptObjectName;
+    int m_ScriptObjectReference; //!< The Lua registry reference to this' object instance representation, so it can be passed into scripted functions without looking it up.
+    mutable std::shared_ptr<PresetFunctionTableReferences> m_FunctionTableReferences; //!< The references to this' preset's function tables, shared with the preset and all its other copies. Made anew whenever the preset gets a new ScriptPresetName.
 
     // Special post processing flash effect file and Bitmap. Shuold be loaded from a 32bpp bitmap
     ContentFile m_ScreenEffectFile;
@@ -8,6 +8,8 @@
 #include "Atom.h"
 #include "DataModule.h"
 #include "PresetMan.h"
+#include "ThreadMan.h"
+#include "TimerMan.h"
 
 namespace RTE {
 
@@ -23,7 +25,9 @@ namespace RTE {
 		m_TerrainFrostings.clear();
 		m_TerrainDebris.clear();
 		m_TerrainObjects.clear();
-		m_UpdatedMaterialAreas.clear();
+		m_SilhouetteMasks.clear();
+		m_MaterialRevision = 0;
+		ResetChunkGrid();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -130,18 +134,27 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	// TODO: Break this down and refactor.
-	void SLTerrain::TexturizeTerrain() {
+	void SLTerrain::TexturizeTerrain(bool multithreaded) {
 		BITMAP *defaultBGLayerTexture = m_DefaultBGTextureFile.GetAsBitmap();
 
 		const std::array<Material *, c_PaletteEntriesNumber> &materialPalette = g_SceneMan.GetMaterialPalette();
 		const std::array<unsigned char, c_PaletteEntriesNumber> &materialMappings = g_PresetMan.GetDataModule(m_BitmapFile.GetDataModuleID())->GetAllMaterialMappings();
 
+		// Look up everything the pixels need per material index once up front, so the rows can be processed in any order on any thread without touching the palette.
+		std::array<unsigned char, c_PaletteEntriesNumber> mappedMaterials;
 		std::array<BITMAP *, c_PaletteEntriesNumber> materialFGTextures;
-		materialFGTextures.fill(nullptr);
 		std::array<BITMAP *, c_PaletteEntriesNumber> materialBGTextures;
-		materialBGTextures.fill(nullptr);
-		std::array<int, c_PaletteEntriesNumber> materialColors;
-		materialColors.fill(0);
+		std::array<unsigned char, c_PaletteEntriesNumber> materialColors;
+		for (int matIndex = 0; matIndex < c_PaletteEntriesNumber; ++matIndex) {
+			// Map any materials defined in this data module but initially collided with other material ID's and thus were displaced to other ID's.
+			mappedMaterials[matIndex] = (materialMappings[matIndex] != 0) ? materialMappings[matIndex] : static_cast<unsigned char>(matIndex);
+
+			// Validate the material, or fallback to default material. If there's no texture for the material, then its solid color is used instead.
+			const Material *material = materialPalette[matIndex] ? materialPalette[matIndex] : materialPalette[MaterialColorKeys::g_MaterialOutOfBounds];
+			materialFGTextures[matIndex] = material ? material->GetFGTexture() : nullptr;
+			materialBGTextures[matIndex] = (material && material->GetBGTexture()) ? material->GetBGTexture() : defaultBGLayerTexture;
+			materialColors[matIndex] = material ? static_cast<unsigned char>(material->GetColor().GetIndex()) : 0;
+		}
 
 		// Reference. Do not remove.
 		//acquire_bitmap(m_MainBitmap);
@@ -149,68 +162,42 @@ namespace RTE {
 		//acquire_bitmap(m_BGColorLayer->GetBitmap());
 		//acquire_bitmap(defaultBGLayerTexture);
 
-		// Go through each pixel on the main bitmap, which contains all the material pixels loaded from the bitmap.
-		// Place texture pixels on the FG layer corresponding to the materials on the main material bitmap.
-		for (int xPos = 0; xPos < m_MainBitmap->w; ++xPos) {
-			for (int yPos = 0; yPos < m_MainBitmap->h; ++yPos) {
-				int matIndex = _getpixel(m_MainBitmap, xPos, yPos);
-
-				// Map any materials defined in this data module but initially collided with other material ID's and thus were displaced to other ID's.
-				if (materialMappings.at(matIndex) != 0) {
-					// Assign the mapping and put it onto the material bitmap too.
-					matIndex = materialMappings.at(matIndex);
-					_putpixel(m_MainBitmap, xPos, yPos, matIndex);
-				}
-
-				// Validate the material, or fallback to default material.
-				const Material *material = (matIndex >= 0 && matIndex < c_PaletteEntriesNumber && materialPalette.at(matIndex)) ? materialPalette.at(matIndex) : materialPalette.at(MaterialColorKeys::g_MaterialOutOfBounds);
-
-				// If haven't read a pixel of this material before, then get its texture so we can quickly access it.
-				if (!materialFGTextures.at(matIndex) && material->GetFGTexture()) {
-					materialFGTextures.at(matIndex) = material->GetFGTexture();
-					//acquire_bitmap(materialFGTextures.at(matIndex));
-				}
-				if (!materialBGTextures.at(matIndex) && material->GetBGTexture()) {
-					materialBGTextures.at(matIndex) = material->GetBGTexture();
-					//acquire_bitmap(materialBGTextures.at(matIndex));
-				}
-
-				int fgPixelColor = 0;
-				// If actually no texture for the material, then use the material's solid color instead.
-				if (!materialFGTextures.at(matIndex)) {
-					if (materialColors.at(matIndex) == 0) { materialColors.at(matIndex) = material->GetColor().GetIndex(); }
-					fgPixelColor = materialColors.at(matIndex);
-				} else {
-					fgPixelColor = _getpixel(materialFGTextures.at(matIndex), xPos % materialFGTextures.at(matIndex)->w, yPos % materialFGTextures.at(matIndex)->h);
+		// Go through each row of the main bitmap, which contains all the material pixels loaded from the bitmap, and place texture pixels on the color layers corresponding to the materials on it.
+		// All the bitmaps are 8bpp memory bitmaps, so the rows are read and written directly instead of through _getpixel and _putpixel.
+		BITMAP *fgColorBitmap = m_FGColorLayer->GetBitmap();
+		BITMAP *bgColorBitmap = m_BGColorLayer->GetBitmap();
+		int width = m_MainBitmap->w;
+		auto texturizeRows = [&](int firstRow, int lastRow) {
+			for (int yPos = firstRow; yPos < lastRow; ++yPos) {
+				unsigned char *materialRow = m_MainBitmap->line[yPos];
+				unsigned char *fgColorRow = fgColorBitmap->line[yPos];
+				unsigned char *bgColorRow = bgColorBitmap->line[yPos];
+
+				// Put the mapped materials onto the material bitmap first, as a plain table lookup per pixel.
+				for (int xPos = 0; xPos < width; ++xPos) {
+					materialRow[xPos] = mappedMaterials[materialRow[xPos]];
 				}
-				_putpixel(m_FGColorLayer->GetBitmap(), xPos, yPos, fgPixelColor);
+				for (int xPos = 0; xPos < width; ++xPos) {
+					unsigned char matIndex = materialRow[xPos];
+					const BITMAP *fgTexture = materialFGTextures[matIndex];
+					fgColorRow[xPos] = fgTexture ? fgTexture->line[yPos % fgTexture->h][xPos % fgTexture->w] : materialColors[matIndex];
 
-				int bgPixelColor = 0;
-				if (matIndex == 0) {
-					bgPixelColor = ColorKeys::g_MaskColor;
-				} else {
-					if (!materialBGTextures.at(matIndex)) {
-						bgPixelColor = _getpixel(defaultBGLayerTexture, xPos % defaultBGLayerTexture->w, yPos % defaultBGLayerTexture->h);
-					} else {
-						bgPixelColor = _getpixel(materialBGTextures.at(matIndex), xPos % materialBGTextures.at(matIndex)->w, yPos % materialBGTextures.at(matIndex)->h);
-					}
+					const BITMAP *bgTexture = materialBGTextures[matIndex];
+					bgColorRow[xPos] = (matIndex == MaterialColorKeys::g_MaterialAir) ? static_cast<unsigned char>(ColorKeys::g_MaskColor) : bgTexture->line[yPos % bgTexture->h][xPos % bgTexture->w];
 				}
-				_putpixel(m_BGColorLayer->GetBitmap(), xPos, yPos, bgPixelColor);
 			}
+		};
+		if (multithreaded) {
+			g_ThreadMan.ParallelFor(m_MainBitmap->h, c_TexturizeRowsPerBatch, texturizeRows);
+		} else {
+			texturizeRows(0, m_MainBitmap->h);
 		}
+
 		// Reference. Do not remove.
 		//release_bitmap(m_MainBitmap);
 		//release_bitmap(m_FGColorLayer->GetBitmap());
 		//release_bitmap(m_BGColorLayer->GetBitmap());
 		//release_bitmap(defaultBGLayerTexture);
-		/*
-		for (BITMAP *fgTextureBitmap : materialFGTextures) {
-			release_bitmap(fgTextureBitmap);
-		}
-		for (BITMAP *bgTextureBitmap : materialBGTextures) {
-			release_bitmap(bgTextureBitmap);
-		}
-		*/
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -218,6 +205,9 @@ namespace RTE {
 	int SLTerrain::LoadData() {
 		SceneLayer::LoadData();
 
+		// The chunk grid gets made anew for the loaded data the first time it's needed.
+		ResetChunkGrid();
+
 		RTEAssert(m_FGColorLayer.get(), "Terrain's foreground layer not instantiated before trying to load its data!");
 		RTEAssert(m_BGColorLayer.get(), "Terrain's background layer not instantiated before trying to load its data!");
 
@@ -231,7 +221,7 @@ namespace RTE {
 			m_BGColorLayer->Destroy();
 			m_BGColorLayer->Create(create_bitmap_ex(8, m_MainBitmap->w, m_MainBitmap->h), true, m_Offset, m_WrapX, m_WrapY, m_ScrollInfo);
 
-			TexturizeTerrain();
+			TexturizeTerrain(true);
 
 			for (const TerrainFrosting *terrainFrosting : m_TerrainFrostings) {
 				terrainFrosting->FrostTerrain(this);
@@ -265,6 +255,7 @@ namespace RTE {
 		RTEAssert(SceneLayer::ClearData() == 0, "Failed to clear material bitmap data of an SLTerrain!");
 		RTEAssert(m_FGColorLayer && m_FGColorLayer->ClearData() == 0, "Failed to clear the foreground color bitmap data of an SLTerrain!");
 		RTEAssert(m_BGColorLayer && m_BGColorLayer->ClearData() == 0, "Failed to clear the background color bitmap data of an SLTerrain!");
+		ResetChunkGrid();
 		return 0;
 	}
 
@@ -288,35 +279,213 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	void SLTerrain::CleanAir() {
-		// Reference. Do not remove.
-		//acquire_bitmap(m_MainBitmap);
-		//acquire_bitmap(m_FGColorLayer->GetBitmap());
+	void SLTerrain::MarkChunksDirty(int left, int top, int width, int height, LayerType changedLayer) {
+		if (!m_MainBitmap || width <= 0 || height <= 0) {
+			return;
+		}
+		MakeChunkGrid();
 
-		int width = m_MainBitmap->w;
-		int height = m_MainBitmap->h;
+		unsigned char changes = 0;
+		switch (changedLayer) {
+			case LayerType::ForegroundLayer:
+				changes = AirUncleaned | MaterialChanged | ForegroundColorChanged;
+				break;
+			case LayerType::BackgroundLayer:
+				changes = BackgroundColorChanged;
+				break;
+			default:
+				changes = AirUncleaned | MaterialChanged;
+				break;
+		}
+		if (changes & MaterialChanged) { ++m_MaterialRevision; }
+
+		// Wrap the area onto the scene, or clip it where the scene doesn't wrap. This can split it in two along each axis.
+		auto wrapSpan = [](int start, int length, int size, bool wraps, std::array<std::pair<int, int>, 2> &spans) {
+			if (!wraps) {
+				int end = std::min(start + length, size) - 1;
+				start = std::max(start, 0);
+				if (start > end) {
+					return 0;
+				}
+				spans[0] = { start, end };
+				return 1;
+			}
+			if (length >= size) {
+				spans[0] = { 0, size - 1 };
+				return 1;
+			}
+			start = ((start % size) + size) % size;
+			if (start + length <= size) {
+				spans[0] = { start, start + length - 1 };
+				return 1;
+			}
+			spans[0] = { start, size - 1 };
+			spans[1] = { 0, start + length - size - 1 };
+			return 2;
+		};
+		std::array<std::pair<int, int>, 2> columnSpans;
+		std::array<std::pair<int, int>, 2> rowSpans;
+		int columnSpanCount = wrapSpan(left, width, m_MainBitmap->w, m_WrapX, columnSpans);
+		int rowSpanCount = wrapSpan(top, height, m_MainBitmap->h, m_WrapY, rowSpans);
+
+		for (int rowSpan = 0; rowSpan < rowSpanCount; ++rowSpan) {
+			for (int columnSpan = 0; columnSpan < columnSpanCount; ++columnSpan) {
+				MarkWrappedChunksDirty(columnSpans[columnSpan].first, rowSpans[rowSpan].first, columnSpans[columnSpan].second, rowSpans[rowSpan].second, changes);
+			}
+		}
+	}
 
-		for (int y = 0; y < height; ++y) {
-			for (int x = 0; x < width; ++x) {
-				int matPixel = _getpixel(m_MainBitmap, x, y);
-				if (matPixel == MaterialColorKeys::g_MaterialCavity) {
-					_putpixel(m_MainBitmap, x, y, MaterialColorKeys::g_MaterialAir);
-					matPixel = MaterialColorKeys::g_MaterialAir;
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool SLTerrain::MaterialChangedSince(int left, int top, int width, int height, unsigned long revision) const {
+		if (revision == m_MaterialRevision || !m_MainBitmap || width <= 0 || height <= 0) {
+			return false;
+		}
+		// Without a chunk grid there's nothing to go by, since it gets made anew whenever the data is.
+		if (m_Chunks.empty()) {
+			return true;
+		}
+		// Chunks are gone through by index, wrapped onto the grid or clipped to it. Areas wider than the scene just cover all of it once.
+		auto chunkSpan = [](int start, int length, int chunkCount, bool wraps, int &firstChunk, int &lastChunk) {
+			firstChunk = static_cast<int>(std::floor(static_cast<float>(start) / static_cast<float>(c_ChunkSize)));
+			lastChunk = static_cast<int>(std::floor(static_cast<float>(start + length - 1) / static_cast<float>(c_ChunkSize)));
+			if (wraps) {
+				lastChunk = std::min(lastChunk, firstChunk + chunkCount - 1);
+			} else {
+				firstChunk = std::max(firstChunk, 0);
+				lastChunk = std::min(lastChunk, chunkCount - 1);
+			}
+			return firstChunk <= lastChunk;
+		};
+		int firstColumn;
+		int lastColumn;
+		int firstRow;
+		int lastRow;
+		if (!chunkSpan(left, width, m_ChunkColumns, m_WrapX, firstColumn, lastColumn) || !chunkSpan(top, height, m_ChunkRows, m_WrapY, firstRow, lastRow)) {
+			return false;
+		}
+		for (int row = firstRow; row <= lastRow; ++row) {
+			int wrappedRow = ((row % m_ChunkRows) + m_ChunkRows) % m_ChunkRows;
+			for (int column = firstColumn; column <= lastColumn; ++column) {
+				int wrappedColumn = ((column % m_ChunkColumns) + m_ChunkColumns) % m_ChunkColumns;
+				if (m_Chunks[wrappedRow * m_ChunkColumns + wrappedColumn].MaterialRevision > revision) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SLTerrain::AddUpdatedMaterialArea(const Box &newArea) {
+		Box area(newArea);
+		area.Unflip();
+		MarkChunksDirty(area.GetCorner().GetFloorIntX(), area.GetCorner().GetFloorIntY(), static_cast<int>(std::ceil(area.GetWidth())), static_cast<int>(std::ceil(area.GetHeight())), LayerType::MaterialLayer);
+		g_SceneMan.RegisterObstacleDrawing();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SLTerrain::TakeUpdatedMaterialAreas(std::deque<Box> &updatedAreas) {
+		// Only the changed bounds are handed out rather than whole chunks, so a few scattered pixels settling don't have pathfinding recalculate everything around them.
+		std::vector<Box> changedAreas;
+		MergeChangedAreas(MaterialChanged, changedAreas);
+		updatedAreas.insert(updatedAreas.end(), changedAreas.begin(), changedAreas.end());
+		for (TerrainChunk &chunk : m_Chunks) {
+			chunk.Changes &= ~MaterialChanged;
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SLTerrain::TakeChangedColorAreas(std::vector<Box> &foregroundAreas, std::vector<Box> &backgroundAreas) {
+		if (!m_HasChangedColorAreas) {
+			return;
+		}
+		MergeChangedAreas(ForegroundColorChanged, foregroundAreas);
+		MergeChangedAreas(BackgroundColorChanged, backgroundAreas);
+		for (TerrainChunk &chunk : m_Chunks) {
+			chunk.Changes &= ~(ForegroundColorChanged | BackgroundColorChanged);
+		}
+		m_HasChangedColorAreas = false;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SLTerrain::MergeChangedAreas(ChunkChanges layerChange, std::vector<Box> &changedAreas) const {
+		struct ChangedArea {
+			int Left;
+			int Top;
+			int Right;
+			int Bottom;
+			long long ChangedArea; //!< The sum of the areas of the chunk change bounds merged into this, as opposed to the area of the bounds of all of them.
+		};
+		auto mergeIfWorthIt = [](ChangedArea &area, const ChangedArea &otherArea) {
+			ChangedArea mergedArea = { std::min(area.Left, otherArea.Left), std::min(area.Top, otherArea.Top), std::max(area.Right, otherArea.Right), std::max(area.Bottom, otherArea.Bottom), area.ChangedArea + otherArea.ChangedArea };
+			if (static_cast<long long>(mergedArea.Right - mergedArea.Left + 1) * static_cast<long long>(mergedArea.Bottom - mergedArea.Top + 1) > mergedArea.ChangedArea * 2) {
+				return false;
+			}
+			area = mergedArea;
+			return true;
+		};
+
+		// Merge neighbouring chunks in each row, then let the merged areas grow down into the next row for as long as there's something there to merge with.
+		std::vector<ChangedArea> growingAreas;
+		std::vector<ChangedArea> rowAreas;
+		std::vector<ChangedArea> nextGrowingAreas;
+		for (int row = 0; row <= m_ChunkRows; ++row) {
+			rowAreas.clear();
+			int previousColumn = -2;
+			for (int column = 0; row < m_ChunkRows && column < m_ChunkColumns; ++column) {
+				const TerrainChunk &chunk = m_Chunks[row * m_ChunkColumns + column];
+				if (chunk.Changes & layerChange) {
+					ChangedArea chunkArea = (layerChange == MaterialChanged) ? ChangedArea{ chunk.ChangedMaterialLeft, chunk.ChangedMaterialTop, chunk.ChangedMaterialRight, chunk.ChangedMaterialBottom, 0 } : ChangedArea{ chunk.ChangedColorLeft, chunk.ChangedColorTop, chunk.ChangedColorRight, chunk.ChangedColorBottom, 0 };
+					chunkArea.ChangedArea = static_cast<long long>(chunkArea.Right - chunkArea.Left + 1) * static_cast<long long>(chunkArea.Bottom - chunkArea.Top + 1);
+					if (previousColumn != column - 1 || !mergeIfWorthIt(rowAreas.back(), chunkArea)) { rowAreas.emplace_back(chunkArea); }
+					previousColumn = column;
+				}
+			}
+			nextGrowingAreas.clear();
+			for (ChangedArea &rowArea : rowAreas) {
+				for (std::vector<ChangedArea>::iterator growingArea = growingAreas.begin(); growingArea != growingAreas.end(); ++growingArea) {
+					if (mergeIfWorthIt(rowArea, *growingArea)) {
+						growingAreas.erase(growingArea);
+						break;
+					}
+				}
+				nextGrowingAreas.emplace_back(rowArea);
+			}
+			// Whatever didn't grow into this row is done.
+			for (const ChangedArea &doneArea : growingAreas) {
+				changedAreas.emplace_back(Vector(static_cast<float>(doneArea.Left), static_cast<float>(doneArea.Top)), static_cast<float>(doneArea.Right - doneArea.Left + 1), static_cast<float>(doneArea.Bottom - doneArea.Top + 1));
+			}
+			growingAreas.swap(nextGrowingAreas);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SLTerrain::CleanAir() {
+		MakeChunkGrid();
+
+		for (int row = 0; row < m_ChunkRows; ++row) {
+			for (int column = 0; column < m_ChunkColumns; ++column) {
+				TerrainChunk &chunk = m_Chunks[row * m_ChunkColumns + column];
+				if (chunk.Changes & AirUncleaned) {
+					int left = column * c_ChunkSize;
+					int top = row * c_ChunkSize;
+					CleanAirInArea(left, top, std::min(left + c_ChunkSize, m_MainBitmap->w) - 1, std::min(top + c_ChunkSize, m_MainBitmap->h) - 1);
+					chunk.Changes &= ~AirUncleaned;
 				}
-				if (matPixel == MaterialColorKeys::g_MaterialAir) { _putpixel(m_FGColorLayer->GetBitmap(), x, y, ColorKeys::g_MaskColor); }
 			}
 		}
-		// Reference. Do not remove.
-		//release_bitmap(m_MainBitmap);
-		//release_bitmap(m_FGColorLayer->GetBitmap());
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void SLTerrain::CleanAirBox(const Box &box, bool wrapsX, bool wrapsY) {
-		// Reference. Do not remove.
-		//acquire_bitmap(m_MainBitmap);
-		//acquire_bitmap(m_FGColorLayer->GetBitmap());
+		MakeChunkGrid();
 
 		int width = m_MainBitmap->w;
 		int height = m_MainBitmap->h;
@@ -334,16 +503,73 @@ namespace RTE {
 					if (wrappedY < 0) { wrappedY += height; }
 					if (wrappedY >= height) { wrappedY -= height; }
 				}
-				if (wrappedX >= 0 && wrappedX < width && wrappedY >= 0 && wrappedY < height) {
-					int matPixel = _getpixel(m_MainBitmap, wrappedX, wrappedY);
-					if (matPixel == MaterialColorKeys::g_MaterialCavity) {
-						_putpixel(m_MainBitmap, wrappedX, wrappedY, MaterialColorKeys::g_MaterialAir);
-						matPixel = MaterialColorKeys::g_MaterialAir;
-					}
-					if (matPixel == MaterialColorKeys::g_MaterialAir) { _putpixel(m_FGColorLayer->GetBitmap(), wrappedX, wrappedY, ColorKeys::g_MaskColor); }
+				// Chunks that haven't changed since they were last cleaned can't have anything to clean. They stay marked for CleanAir() since only part of them may be cleaned here.
+				if (wrappedX >= 0 && wrappedX < width && wrappedY >= 0 && wrappedY < height && (m_Chunks[(wrappedY / c_ChunkSize) * m_ChunkColumns + (wrappedX / c_ChunkSize)].Changes & AirUncleaned)) {
+					CleanAirInArea(wrappedX, wrappedY, wrappedX, wrappedY);
 				}
 			}
 		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SLTerrain::MakeChunkGrid() {
+		if (!m_Chunks.empty() || !m_MainBitmap) {
+			return;
+		}
+		m_ChunkColumns = (m_MainBitmap->w + c_ChunkSize - 1) / c_ChunkSize;
+		m_ChunkRows = (m_MainBitmap->h + c_ChunkSize - 1) / c_ChunkSize;
+		// Nothing is known about the state of the air yet, but pathfinding and network clients start out with the whole terrain anyway.
+		m_Chunks.resize(static_cast<size_t>(m_ChunkColumns * m_ChunkRows), { AirUncleaned, 0, 0, 0, 0, m_MaterialRevision });
+		m_HasChangedColorAreas = false;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SLTerrain::MarkWrappedChunksDirty(int left, int top, int right, int bottom, unsigned char changes) {
+		bool colorChanged = changes & (ForegroundColorChanged | BackgroundColorChanged);
+		bool materialChanged = changes & MaterialChanged;
+		for (int row = top / c_ChunkSize; row <= bottom / c_ChunkSize; ++row) {
+			for (int column = left / c_ChunkSize; column <= right / c_ChunkSize; ++column) {
+				TerrainChunk &chunk = m_Chunks[row * m_ChunkColumns + column];
+				int chunkLeft = std::max(left, column * c_ChunkSize);
+				int chunkTop = std::max(top, row * c_ChunkSize);
+				int chunkRight = std::min(right, (column + 1) * c_ChunkSize - 1);
+				int chunkBottom = std::min(bottom, (row + 1) * c_ChunkSize - 1);
+				// Grows the bounds of the changes already in the chunk to take in this one, or starts them anew if there weren't any.
+				auto addToChangedBounds = [&](bool hadChanges, int &changedLeft, int &changedTop, int &changedRight, int &changedBottom) {
+					changedLeft = hadChanges ? std::min(changedLeft, chunkLeft) : chunkLeft;
+					changedTop = hadChanges ? std::min(changedTop, chunkTop) : chunkTop;
+					changedRight = hadChanges ? std::max(changedRight, chunkRight) : chunkRight;
+					changedBottom = hadChanges ? std::max(changedBottom, chunkBottom) : chunkBottom;
+				};
+				if (colorChanged) { addToChangedBounds(chunk.Changes & (ForegroundColorChanged | BackgroundColorChanged), chunk.ChangedColorLeft, chunk.ChangedColorTop, chunk.ChangedColorRight, chunk.ChangedColorBottom); }
+				if (materialChanged) { addToChangedBounds(chunk.Changes & MaterialChanged, chunk.ChangedMaterialLeft, chunk.ChangedMaterialTop, chunk.ChangedMaterialRight, chunk.ChangedMaterialBottom); }
+				chunk.Changes |= changes;
+				if (changes & MaterialChanged) { chunk.MaterialRevision = m_MaterialRevision; }
+			}
+		}
+		if (colorChanged) { m_HasChangedColorAreas = true; }
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SLTerrain::CleanAirInArea(int left, int top, int right, int bottom) {
+		// Reference. Do not remove.
+		//acquire_bitmap(m_MainBitmap);
+		//acquire_bitmap(m_FGColorLayer->GetBitmap());
+
+		BITMAP *fgColorBitmap = m_FGColorLayer->GetBitmap();
+		for (int y = top; y <= bottom; ++y) {
+			for (int x = left; x <= right; ++x) {
+				int matPixel = _getpixel(m_MainBitmap, x, y);
+				if (matPixel == MaterialColorKeys::g_MaterialCavity) {
+					_putpixel(m_MainBitmap, x, y, MaterialColorKeys::g_MaterialAir);
+					matPixel = MaterialColorKeys::g_MaterialAir;
+				}
+				if (matPixel == MaterialColorKeys::g_MaterialAir) { _putpixel(fgColorBitmap, x, y, ColorKeys::g_MaskColor); }
+			}
+		}
 		// Reference. Do not remove.
 		//release_bitmap(m_MainBitmap);
 		//release_bitmap(m_FGColorLayer->GetBitmap());
@@ -351,66 +577,48 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	// TODO: OPTIMIZE THIS, IT'S A TIME HOG. MAYBE JSUT STAMP THE OUTLINE AND SAMPLE SOME RANDOM PARTICLES?
-	std::deque<MOPixel *> SLTerrain::EraseSilhouette(BITMAP *sprite, const Vector &pos, const Vector &pivot, const Matrix &rotation, float scale, bool makeMOPs, int skipMOP, int maxMOPs) {
+	FrameDeque<MOPixel *> SLTerrain::EraseSilhouette(BITMAP *sprite, bool hFlipped, const Vector &pos, const Vector &pivot, const Matrix &rotation, float scale, bool makeMOPs, int skipMOP, int maxMOPs, float keepRatio) {
 		RTEAssert(sprite, "Null BITMAP passed to SLTerrain::EraseSilhouette");
 
-		int maxWidth = static_cast<int>(static_cast<float>(sprite->w + std::abs(pivot.GetFloorIntX() - (sprite->w / 2))) * scale);
-		int maxHeight = static_cast<int>(static_cast<float>(sprite->h + std::abs(pivot.GetFloorIntY() - (sprite->h / 2))) * scale);
-		int maxDiameter = static_cast<int>(std::sqrt(static_cast<float>(maxWidth * maxWidth + maxHeight * maxHeight)) * 2.0F);
-		int skipCount = skipMOP;
-
-		BITMAP *tempBitmap = g_SceneMan.GetIntermediateBitmapForSettlingIntoTerrain(maxDiameter);
-		clear_bitmap(tempBitmap);
-		pivot_scaled_sprite(tempBitmap, sprite, tempBitmap->w / 2, tempBitmap->h / 2, pivot.GetFloorIntX(), pivot.GetFloorIntY(), ftofix(rotation.GetAllegroAngle()), ftofix(scale));
-
-		std::deque<MOPixel *> dislodgedMOPixels;
+		int angleStep = static_cast<int>(std::round(rotation.GetAllegroAngle())) % c_SilhouetteAngleSteps;
+		if (angleStep < 0) { angleStep += c_SilhouetteAngleSteps; }
+		const SilhouetteMask &silhouette = GetSilhouetteMask(sprite, hFlipped, pivot.GetFloorIntX(), pivot.GetFloorIntY(), angleStep, scale);
 
-		// Test intersection between color pixels of the test bitmap and non-air pixels of the terrain, then generate and collect MOPixels that represent the terrain overlap and clear the same pixels out of the terrain.
-		for (int testY = 0; testY < tempBitmap->h; ++testY) {
-			for (int testX = 0; testX < tempBitmap->w; ++testX) {
-				int terrX = pos.GetFloorIntX() - (tempBitmap->w / 2) + testX;
-				int terrY = pos.GetFloorIntY() - (tempBitmap->h / 2) + testY;
-
-				if (terrX < 0) {
-					if (m_WrapX) {
-						while (terrX < 0) {
-							terrX += m_MainBitmap->w;
-						}
-					} else {
-						continue;
-					}
-				}
-				if (terrY < 0) {
-					if (m_WrapY) {
-						while (terrY < 0) {
-							terrY += m_MainBitmap->h;
-						}
-					} else {
-						continue;
-					}
-				}
-				if (terrX >= m_MainBitmap->w) {
-					if (m_WrapX) {
-						terrX %= m_MainBitmap->w;
-					} else {
-						continue;
-					}
-				}
-				if (terrY >= m_MainBitmap->h) {
-					if (m_WrapY) {
-						terrY %= m_MainBitmap->h;
-					} else {
-						continue;
-					}
+		FrameDeque<MOPixel *> dislodgedMOPixels;
+		int skipCount = skipMOP;
+		int candidateCount = 0;
+		float keepTally = 0;
+
+		int posX = pos.GetFloorIntX();
+		int posY = pos.GetFloorIntY();
+		int terrainWidth = m_MainBitmap->w;
+		int terrainHeight = m_MainBitmap->h;
+		BITMAP *fgColorBitmap = m_FGColorLayer->GetBitmap();
+
+		// The bounds of what got erased from each layer, not wrapped onto the scene.
+		int materialLeft = std::numeric_limits<int>::max();
+		int materialRight = std::numeric_limits<int>::min();
+		int materialTop = std::numeric_limits<int>::max();
+		int materialBottom = std::numeric_limits<int>::min();
+		int colorLeft = materialLeft;
+		int colorRight = materialRight;
+		int colorTop = materialTop;
+		int colorBottom = materialBottom;
+
+		// Erases the pixels of a run that's within the scene, making MOPixels of the first pixel of each skip and keeping only as many as the keep ratio calls for.
+		auto eraseRun = [&](unsigned char *materialRow, unsigned char *colorRow, int terrY, int runStart, int runEnd, int unwrapOffsetX, int unwrappedY) {
+			for (int terrX = runStart; terrX < runEnd; ++terrX) {
+				unsigned char matPixel = materialRow[terrX];
+				unsigned char colorPixel = colorRow[terrX];
+				if (matPixel == MaterialColorKeys::g_MaterialAir && colorPixel == ColorKeys::g_MaskColor) {
+					continue;
 				}
-				int matPixel = getpixel(m_MainBitmap, terrX, terrY);
-				int colorPixel = getpixel(m_FGColorLayer->GetBitmap(), terrX, terrY);
-
-				if (getpixel(tempBitmap, testX, testY) != ColorKeys::g_MaskColor) {
-					// Only add PixelMO if we're not due to skip any.
-					if (makeMOPs && matPixel != MaterialColorKeys::g_MaterialAir && colorPixel != ColorKeys::g_MaskColor && ++skipCount > skipMOP && dislodgedMOPixels.size() < maxMOPs) {
-						skipCount = 0;
+				if (makeMOPs && matPixel != MaterialColorKeys::g_MaterialAir && colorPixel != ColorKeys::g_MaskColor && ++skipCount > skipMOP && candidateCount < maxMOPs) {
+					skipCount = 0;
+					candidateCount++;
+					keepTally += keepRatio;
+					if (keepTally >= 1.0F) {
+						keepTally -= 1.0F;
 						const Material *sceneMat = g_SceneMan.GetMaterialFromID(matPixel);
 						const Material *spawnMat = sceneMat->GetSpawnMaterial() ? g_SceneMan.GetMaterialFromID(sceneMat->GetSpawnMaterial()) : sceneMat;
 
@@ -422,22 +630,142 @@ namespace RTE {
 						terrainPixel->SetToHitMOs(false);
 						dislodgedMOPixels.emplace_back(terrainPixel.release());
 					}
-
-					// Clear the terrain pixels.
-					if (matPixel != MaterialColorKeys::g_MaterialAir) { putpixel(m_MainBitmap, terrX, terrY, MaterialColorKeys::g_MaterialAir); }
-					if (colorPixel != ColorKeys::g_MaskColor) {
-						putpixel(m_FGColorLayer->GetBitmap(), terrX, terrY, ColorKeys::g_MaskColor);
-						g_SceneMan.RegisterTerrainChange(terrX, terrY, 1, 1, ColorKeys::g_MaskColor, false);
+				}
+				int unwrappedX = terrX + unwrapOffsetX;
+				if (matPixel != MaterialColorKeys::g_MaterialAir) {
+					materialRow[terrX] = MaterialColorKeys::g_MaterialAir;
+					materialLeft = std::min(materialLeft, unwrappedX);
+					materialRight = std::max(materialRight, unwrappedX);
+					materialTop = std::min(materialTop, unwrappedY);
+					materialBottom = std::max(materialBottom, unwrappedY);
+				}
+				if (colorPixel != ColorKeys::g_MaskColor) {
+					colorRow[terrX] = ColorKeys::g_MaskColor;
+					colorLeft = std::min(colorLeft, unwrappedX);
+					colorRight = std::max(colorRight, unwrappedX);
+					colorTop = std::min(colorTop, unwrappedY);
+					colorBottom = std::max(colorBottom, unwrappedY);
+				}
+			}
+		};
+
+		for (int row = 0; row < silhouette.Height; ++row) {
+			int unwrappedY = posY + silhouette.Top + row;
+			int terrY = unwrappedY;
+			if (m_WrapY) {
+				terrY = ((terrY % terrainHeight) + terrainHeight) % terrainHeight;
+			} else if (terrY < 0 || terrY >= terrainHeight) {
+				continue;
+			}
+			unsigned char *materialRow = m_MainBitmap->line[terrY];
+			unsigned char *colorRow = fgColorBitmap->line[terrY];
+
+			for (int spanIndex = silhouette.RowSpanStarts[row]; spanIndex < silhouette.RowSpanStarts[row + 1]; ++spanIndex) {
+				int spanStart = posX + silhouette.Spans[spanIndex].first;
+				int spanEnd = posX + silhouette.Spans[spanIndex].second;
+				if (m_WrapX) {
+					// Split the span where it crosses the seam.
+					for (int unwrappedX = spanStart; unwrappedX < spanEnd;) {
+						int terrX = ((unwrappedX % terrainWidth) + terrainWidth) % terrainWidth;
+						int runLength = std::min(spanEnd - unwrappedX, terrainWidth - terrX);
+						eraseRun(materialRow, colorRow, terrY, terrX, terrX + runLength, unwrappedX - terrX, unwrappedY);
+						unwrappedX += runLength;
 					}
+				} else {
+					eraseRun(materialRow, colorRow, terrY, std::max(spanStart, 0), std::min(spanEnd, terrainWidth), 0, unwrappedY);
 				}
 			}
 		}
-		// TODO: improve fit/tightness of box here.
-		m_UpdatedMaterialAreas.emplace_back(Box(pos - pivot, static_cast<float>(maxWidth), static_cast<float>(maxHeight)));
+
+		if (materialLeft <= materialRight) { MarkChunksDirty(materialLeft, materialTop, materialRight - materialLeft + 1, materialBottom - materialTop + 1, LayerType::MaterialLayer); }
+		if (colorLeft <= colorRight) { g_SceneMan.RegisterTerrainChange(colorLeft, colorTop, colorRight - colorLeft + 1, colorBottom - colorTop + 1, false); }
 
 		return dislodgedMOPixels;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	const SLTerrain::SilhouetteMask & SLTerrain::GetSilhouetteMask(BITMAP *sprite, bool hFlipped, int pivotX, int pivotY, int angleStep, float scale) {
+		SilhouetteKey silhouetteKey(sprite, hFlipped, pivotX, pivotY, angleStep, scale);
+		if (auto silhouetteItr = m_SilhouetteMasks.find(silhouetteKey); silhouetteItr != m_SilhouetteMasks.end()) {
+			return silhouetteItr->second;
+		}
+		if (m_SilhouetteMasks.size() >= c_MaxSilhouetteMasks) { m_SilhouetteMasks.clear(); }
+
+		BITMAP *sourceBitmap = sprite;
+		if (hFlipped) {
+			sourceBitmap = create_bitmap_ex(bitmap_color_depth(sprite), sprite->w, sprite->h);
+			clear_to_color(sourceBitmap, bitmap_mask_color(sourceBitmap));
+			draw_sprite_h_flip(sourceBitmap, sprite, 0, 0);
+		}
+		int maxWidth = static_cast<int>(static_cast<float>(sprite->w + std::abs(pivotX - (sprite->w / 2))) * scale);
+		int maxHeight = static_cast<int>(static_cast<float>(sprite->h + std::abs(pivotY - (sprite->h / 2))) * scale);
+		int maxDiameter = static_cast<int>(std::sqrt(static_cast<float>(maxWidth * maxWidth + maxHeight * maxHeight)) * 2.0F);
+
+		BITMAP *tempBitmap = g_SceneMan.GetIntermediateBitmapForSettlingIntoTerrain(maxDiameter);
+		clear_bitmap(tempBitmap);
+		pivot_scaled_sprite(tempBitmap, sourceBitmap, tempBitmap->w / 2, tempBitmap->h / 2, pivotX, pivotY, itofix(angleStep), ftofix(scale));
+		if (sourceBitmap != sprite) { destroy_bitmap(sourceBitmap); }
+
+		SilhouetteMask silhouette;
+		silhouette.Left = std::numeric_limits<int>::max();
+		silhouette.Top = 0;
+		silhouette.Height = 0;
+		int right = std::numeric_limits<int>::min();
+		int firstRow = -1;
+		for (int testY = 0; testY < tempBitmap->h; ++testY) {
+			size_t rowSpanStart = silhouette.Spans.size();
+			for (int testX = 0; testX < tempBitmap->w;) {
+				if (_getpixel(tempBitmap, testX, testY) == ColorKeys::g_MaskColor) {
+					++testX;
+					continue;
+				}
+				int runStart = testX;
+				while (testX < tempBitmap->w && _getpixel(tempBitmap, testX, testY) != ColorKeys::g_MaskColor) {
+					++testX;
+				}
+				silhouette.Spans.emplace_back(runStart - (tempBitmap->w / 2), testX - (tempBitmap->w / 2));
+				silhouette.Left = std::min(silhouette.Left, runStart - (tempBitmap->w / 2));
+				right = std::max(right, testX - (tempBitmap->w / 2));
+			}
+			if (silhouette.Spans.size() > rowSpanStart || firstRow >= 0) {
+				if (firstRow < 0) { firstRow = testY; }
+				silhouette.RowSpanStarts.emplace_back(static_cast<int>(rowSpanStart));
+				if (silhouette.Spans.size() > rowSpanStart) { silhouette.Height = testY - firstRow + 1; }
+			}
+		}
+		// Trim off the empty rows after the last one with any spans.
+		silhouette.RowSpanStarts.resize(silhouette.Height);
+		silhouette.RowSpanStarts.emplace_back(static_cast<int>(silhouette.Spans.size()));
+		silhouette.Top = (firstRow >= 0) ? firstRow - (tempBitmap->h / 2) : 0;
+		silhouette.Width = (silhouette.Spans.empty()) ? 0 : right - silhouette.Left;
+		if (silhouette.Spans.empty()) { silhouette.Left = 0; }
+
+		return m_SilhouetteMasks.emplace(silhouetteKey, std::move(silhouette)).first->second;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SLTerrain::RunTexturizeBenchmark(int repetitionCount, long long &singleThreadTime, long long &multiThreadTime) {
+		repetitionCount = std::max(repetitionCount, 1);
+		if (!m_MainBitmap || !m_FGColorLayer || !m_FGColorLayer->GetBitmap() || !m_BGColorLayer || !m_BGColorLayer->GetBitmap()) {
+			singleThreadTime = 0;
+			multiThreadTime = 0;
+			return;
+		}
+		long long startTime = g_TimerMan.GetAbsoluteTime();
+		for (int repetition = 0; repetition < repetitionCount; ++repetition) {
+			TexturizeTerrain(false);
+		}
+		singleThreadTime = (g_TimerMan.GetAbsoluteTime() - startTime) / repetitionCount;
+
+		startTime = g_TimerMan.GetAbsoluteTime();
+		for (int repetition = 0; repetition < repetitionCount; ++repetition) {
+			TexturizeTerrain(true);
+		}
+		multiThreadTime = (g_TimerMan.GetAbsoluteTime() - startTime) / repetitionCount;
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void SLTerrain::Update() {
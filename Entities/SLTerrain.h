@@ -3,6 +3,7 @@
 
 #include "SceneLayer.h"
 #include "Matrix.h"
+#include "FrameAllocator.h"
 
 namespace RTE {
 
@@ -112,6 +113,12 @@ namespace RTE {
 		/// <returns>A pointer to the material bitmap.</returns>
 		BITMAP * GetMaterialBitmap() { return m_MainBitmap; }
 
+		/// <summary>
+		/// Gets the material revision of this SLTerrain, which counts up every time the material layer changes or is loaded anew.
+		/// </summary>
+		/// <returns>The current material revision.</returns>
+		unsigned long GetMaterialRevision() const { return m_MaterialRevision; }
+
 		/// <summary>
 		/// Gets a specific pixel from the foreground color bitmap of this. LockBitmaps() must be called before using this method.
 		/// </summary>
@@ -178,29 +185,53 @@ namespace RTE {
 
 #pragma region Concrete Methods
 		/// <summary>
-		/// Gets a deque of unwrapped boxes which show the areas where the material layer has had objects applied to it since last call to ClearUpdatedMaterialAreas().
+		/// Marks the chunks overlapping an area of one of the layers of this SLTerrain as changed, so everything that keeps up with terrain changes only has to look at those chunks.
+		/// </summary>
+		/// <param name="left">The X coordinate of the upper left corner of the changed area. Can be unwrapped and out of bounds of the scene.</param>
+		/// <param name="top">The Y coordinate of the upper left corner of the changed area. Can be unwrapped and out of bounds of the scene.</param>
+		/// <param name="width">The width of the changed area.</param>
+		/// <param name="height">The height of the changed area.</param>
+		/// <param name="changedLayer">The layer that was changed. Foreground color changes are assumed to come with material changes. See LayerType enumeration.</param>
+		void MarkChunksDirty(int left, int top, int width, int height, LayerType changedLayer);
+
+		/// <summary>
+		/// Checks whether the material layer has changed within an area since a material revision.
 		/// </summary>
-		/// <returns>Reference to the deque that has been filled with Boxes which are unwrapped and may be out of bounds of the scene!</returns>
-		const std::deque<Box> & GetUpdatedMaterialAreas() const { return m_UpdatedMaterialAreas; }
+		/// <param name="left">The X coordinate of the upper left corner of the area. Can be unwrapped and out of bounds of the scene.</param>
+		/// <param name="top">The Y coordinate of the upper left corner of the area. Can be unwrapped and out of bounds of the scene.</param>
+		/// <param name="width">The width of the area.</param>
+		/// <param name="height">The height of the area.</param>
+		/// <param name="revision">The material revision to check against, as gotten from GetMaterialRevision().</param>
+		/// <returns>Whether any chunk overlapping the area has changed since the revision. This is whole chunks, so changes just outside the area can count too.</returns>
+		bool MaterialChangedSince(int left, int top, int width, int height, unsigned long revision) const;
 
 		/// <summary>
-		/// Adds a notification that an area of the material terrain has been updated.
+		/// Adds a notification that an area of the material terrain has been updated. Also registers the change as an obstacle drawing with SceneMan.
 		/// </summary>
 		/// <param name="newArea">The Box defining the newly updated material area that can be unwrapped and may be out of bounds of the scene.</param>
-		void AddUpdatedMaterialArea(const Box &newArea) { m_UpdatedMaterialAreas.emplace_back(newArea); }
+		void AddUpdatedMaterialArea(const Box &newArea);
 
 		/// <summary>
-		/// Clears the list of updated areas in the material layer (main bitmap).
+		/// Gets the areas of the material layer that have changed since the last call to this, and forgets about them. The bounds of the changes within each chunk are merged into larger boxes wherever that doesn't take in much unchanged area.
 		/// </summary>
-		void ClearUpdatedMaterialAreas() { m_UpdatedMaterialAreas.clear(); }
+		/// <param name="updatedAreas">The deque to add the Boxes of the changed areas to. These are always within the bounds of the scene.</param>
+		void TakeUpdatedMaterialAreas(std::deque<Box> &updatedAreas);
 
 		/// <summary>
-		/// Removes any color pixel in the color layer of this SLTerrain wherever there is an air material pixel in the material layer.
+		/// Gets the areas of the color layers that have changed since the last call to this, and forgets about them. The bounds of the changes within each chunk are merged into larger boxes wherever that doesn't take in much unchanged area.
+		/// </summary>
+		/// <param name="foregroundAreas">The vector to add the Boxes of the changed foreground color areas to. These are always within the bounds of the scene.</param>
+		/// <param name="backgroundAreas">The vector to add the Boxes of the changed background color areas to. These are always within the bounds of the scene.</param>
+		void TakeChangedColorAreas(std::vector<Box> &foregroundAreas, std::vector<Box> &backgroundAreas);
+
+		/// <summary>
+		/// Removes any color pixel in the color layer of this SLTerrain wherever there is an air material pixel in the material layer, in all the chunks that have changed since the last time.
+		/// Chunks are all considered changed when the terrain data is loaded.
 		/// </summary>
 		void CleanAir();
 
 		/// <summary>
-		/// Removes any color pixel in the color layer of this SLTerrain wherever there is an air material pixel in the material layer inside the specified box.
+		/// Removes any color pixel in the color layer of this SLTerrain wherever there is an air material pixel in the material layer inside the specified box. Chunks that haven't changed since the last CleanAir() are skipped.
 		/// </summary>
 		/// <param name="box">Box to clean.</param>
 		/// <param name="wrapsX">Whether the scene is X-wrapped.</param>
@@ -209,17 +240,31 @@ namespace RTE {
 
 		/// <summary>
 		/// Takes a BITMAP and scans through the pixels on this terrain for pixels which overlap with it. Erases them from the terrain and can optionally generate MOPixels based on the erased or 'dislodged' terrain pixels.
+		/// The silhouette is rotated to the nearest Allegro angle unit and cached as row spans, so erasing the same sprite frame at a similar angle again only walks the spans.
 		/// </summary>
-		/// <param name="sprite">A pointer to the source BITMAP whose silhouette will be used as a cookie-cutter on the terrain.</param>
+		/// <param name="sprite">A pointer to the source BITMAP whose silhouette will be used as a cookie-cutter on the terrain. Should be a loaded sprite frame, not a bitmap whose contents change, as silhouettes are cached by it.</param>
+		/// <param name="hFlipped">Whether the sprite is to be flipped horizontally.</param>
 		/// <param name="pos">The position coordinates of the sprite.</param>
-		/// <param name="pivot">The pivot coordinate of the sprite.</param>
+		/// <param name="pivot">The pivot coordinate of the sprite, after any flipping.</param>
 		/// <param name="rotation">The sprite's current rotation in radians.</param>
 		/// <param name="scale">The sprite's current scale coefficient.</param>
 		/// <param name="makeMOPs">Whether to generate any MOPixels from the erased terrain pixels.</param>
 		/// <param name="skipMOP">How many pixels to skip making MOPixels from, between each that gets made. 0 means every pixel turns into an MOPixel.</param>
-		/// <param name="maxMOPs">The max number of MOPixels to make, if they are to be made.</param>
+		/// <param name="maxMOPs">The max number of MOPixels to make, if they are to be made. Counts the ones dropped by the keep ratio too.</param>
+		/// <param name="keepRatio">The ratio of the MOPixels that would be made to actually make. The rest are never made, as if made and deleted right away.</param>
 		/// <returns>A deque filled with the MOPixels of the terrain that are now dislodged. This will be empty if makeMOPs is false. Note that ownership of all the MOPixels in the deque IS transferred!</returns>
-		std::deque<MOPixel *> EraseSilhouette(BITMAP *sprite, const Vector &pos, const Vector &pivot, const Matrix &rotation, float scale, bool makeMOPs = true, int skipMOP = 2, int maxMOPs = 150);
+		FrameDeque<MOPixel *> EraseSilhouette(BITMAP *sprite, bool hFlipped, const Vector &pos, const Vector &pivot, const Matrix &rotation, float scale, bool makeMOPs = true, int skipMOP = 2, int maxMOPs = 150, float keepRatio = 1.0F);
+#pragma endregion
+
+#pragma region Benchmarking
+		/// <summary>
+		/// Texturizes the loaded material layer a number of times on just the calling thread, then the same number of times split across the worker threads, and measures how long each took.
+		/// The color layers are left with bare textures, without any frostings, debris or objects, so this is only meant for throwaway copies of terrains.
+		/// </summary>
+		/// <param name="repetitionCount">The number of times to texturize in each measurement.</param>
+		/// <param name="singleThreadTime">Set to the average time one texturizing took on the calling thread, in microseconds.</param>
+		/// <param name="multiThreadTime">Set to the average time one texturizing took split across the worker threads, in microseconds.</param>
+		void RunTexturizeBenchmark(int repetitionCount, long long &singleThreadTime, long long &multiThreadTime);
 #pragma endregion
 
 #pragma region Virtual Override Methods
@@ -241,6 +286,24 @@ namespace RTE {
 
 		static Entity::ClassInfo m_sClass; //!< ClassInfo for this class.
 
+		static constexpr int c_TexturizeRowsPerBatch = 16; //!< The number of rows handed to a thread at a time when texturizing.
+		static constexpr int c_SilhouetteAngleSteps = 256; //!< The number of angles erased silhouettes are cached at, one per Allegro angle unit.
+		static constexpr size_t c_MaxSilhouetteMasks = 4096; //!< The number of cached silhouettes past which the cache is emptied out, so it doesn't grow forever.
+
+		/// <summary>
+		/// The pixels a rotated and scaled sprite covers, as runs of pixels on each row.
+		/// </summary>
+		struct SilhouetteMask {
+			int Left; //!< The offset of the leftmost column of the silhouette from the sprite's position.
+			int Top; //!< The offset of the topmost row of the silhouette from the sprite's position.
+			int Width; //!< The width of the silhouette.
+			int Height; //!< The height of the silhouette.
+			std::vector<int> RowSpanStarts; //!< The index in Spans of the first span of each row, plus one past the last span at the end.
+			std::vector<std::pair<int, int>> Spans; //!< The runs of pixels of each row, as the offsets from the sprite's position of the first column and of one past the last.
+		};
+
+		using SilhouetteKey = std::tuple<const BITMAP *, bool, int, int, int, float>; //!< Convenient name definition for what a SilhouetteMask is cached by: the sprite, whether it's flipped, the pivot, the angle step and the scale.
+
 		std::unique_ptr<SceneLayer> m_FGColorLayer; //!< The foreground color layer of this SLTerrain.
 		std::unique_ptr<SceneLayer> m_BGColorLayer; //!< The background color layer of this SLTerrain.
 
@@ -252,12 +315,95 @@ namespace RTE {
 		std::vector<TerrainDebris *> m_TerrainDebris; //!< The TerrainDebris that need to be  placed on this SLTerrain.
 		std::vector<TerrainObject *> m_TerrainObjects; //!< The TerrainObjects that need to be placed on this SLTerrain.
 
-		std::deque<Box> m_UpdatedMaterialAreas; //!< List of areas of the material layer (main bitmap) which have been affected by new objects copied to it. These boxes are NOT wrapped, and can be out of bounds!
+		std::map<SilhouetteKey, SilhouetteMask> m_SilhouetteMasks; //!< The silhouettes of sprites that have been erased from this SLTerrain.
+
+		static constexpr int c_ChunkSize = 64; //!< The width and height of the chunks the terrain is split into for keeping track of changes, in pixels.
+
+		/// <summary>
+		/// Flags for what a chunk has changed since it was last looked at, one per thing keeping up with changes.
+		/// </summary>
+		enum ChunkChanges : unsigned char {
+			AirUncleaned = 1 << 0, //!< The chunk may have air material with foreground color left on it, for CleanAir().
+			MaterialChanged = 1 << 1, //!< The material layer changed within the changed material bounds, for TakeUpdatedMaterialAreas().
+			ForegroundColorChanged = 1 << 2, //!< The foreground color layer changed within the changed color bounds, for TakeChangedColorAreas().
+			BackgroundColorChanged = 1 << 3 //!< The background color layer changed within the changed color bounds, for TakeChangedColorAreas().
+		};
+
+		/// <summary>
+		/// A square section of the terrain and what changed in it.
+		/// </summary>
+		struct TerrainChunk {
+			unsigned char Changes; //!< The ChunkChanges of this chunk.
+			int ChangedColorLeft; //!< The leftmost column of the color layer changes in this chunk, in scene coordinates. Only valid if either color changed flag is set.
+			int ChangedColorTop; //!< The topmost row of the color layer changes in this chunk, in scene coordinates. Only valid if either color changed flag is set.
+			int ChangedColorRight; //!< The rightmost column of the color layer changes in this chunk, in scene coordinates. Only valid if either color changed flag is set.
+			int ChangedColorBottom; //!< The bottommost row of the color layer changes in this chunk, in scene coordinates. Only valid if either color changed flag is set.
+			unsigned long MaterialRevision; //!< The material revision of the last change to the material layer in this chunk.
+			int ChangedMaterialLeft; //!< The leftmost column of the material layer changes in this chunk, in scene coordinates. Only valid if the material changed flag is set.
+			int ChangedMaterialTop; //!< The topmost row of the material layer changes in this chunk, in scene coordinates. Only valid if the material changed flag is set.
+			int ChangedMaterialRight; //!< The rightmost column of the material layer changes in this chunk, in scene coordinates. Only valid if the material changed flag is set.
+			int ChangedMaterialBottom; //!< The bottommost row of the material layer changes in this chunk, in scene coordinates. Only valid if the material changed flag is set.
+		};
+
+		int m_ChunkColumns; //!< The number of chunk columns, or 0 if the chunk grid hasn't been made yet.
+		int m_ChunkRows; //!< The number of chunk rows, or 0 if the chunk grid hasn't been made yet.
+		std::vector<TerrainChunk> m_Chunks; //!< The chunks of the terrain, row by row.
+		bool m_HasChangedColorAreas; //!< Whether any chunk has color layer changes, so TakeChangedColorAreas() doesn't have to look through them all for nothing.
+		unsigned long m_MaterialRevision; //!< Counts up every time the material layer changes, or the chunk grid is made anew for loaded data.
+
+		/// <summary>
+		/// Forgets the chunk grid, so it gets made anew for the current terrain data the next time it's needed.
+		/// </summary>
+		void ResetChunkGrid() { m_ChunkColumns = 0; m_ChunkRows = 0; m_Chunks.clear(); m_HasChangedColorAreas = false; ++m_MaterialRevision; }
+
+		/// <summary>
+		/// Gets the silhouette of a rotated and scaled sprite, rotating it and finding its row spans if it isn't cached yet.
+		/// </summary>
+		/// <param name="sprite">The sprite to get the silhouette of.</param>
+		/// <param name="hFlipped">Whether the sprite is flipped horizontally.</param>
+		/// <param name="pivotX">The X coordinate of the pivot of the sprite, after any flipping.</param>
+		/// <param name="pivotY">The Y coordinate of the pivot of the sprite.</param>
+		/// <param name="angleStep">The rotation of the sprite, in Allegro angle units.</param>
+		/// <param name="scale">The scale of the sprite.</param>
+		/// <returns>The silhouette of the sprite.</returns>
+		const SilhouetteMask & GetSilhouetteMask(BITMAP *sprite, bool hFlipped, int pivotX, int pivotY, int angleStep, float scale);
+
+		/// <summary>
+		/// Makes the chunk grid for the current size of the material layer if it hasn't been made yet, with every chunk set to have uncleaned air.
+		/// </summary>
+		void MakeChunkGrid();
+
+		/// <summary>
+		/// Merges the bounds of the changes within the chunks that have a layer changed into as few boxes as can be, without any box taking in more than as much unchanged area as changed area.
+		/// </summary>
+		/// <param name="layerChange">The ChunkChanges flag of the layer to merge the changes of. Either of the color flags or MaterialChanged.</param>
+		/// <param name="changedAreas">The vector to add the Boxes of the merged areas to.</param>
+		void MergeChangedAreas(ChunkChanges layerChange, std::vector<Box> &changedAreas) const;
+
+		/// <summary>
+		/// Marks the chunks overlapping an area that's within the bounds of the scene as changed.
+		/// </summary>
+		/// <param name="left">The X coordinate of the leftmost column of the area.</param>
+		/// <param name="top">The Y coordinate of the topmost row of the area.</param>
+		/// <param name="right">The X coordinate of the rightmost column of the area.</param>
+		/// <param name="bottom">The Y coordinate of the bottommost row of the area.</param>
+		/// <param name="changes">The ChunkChanges flags to set.</param>
+		void MarkWrappedChunksDirty(int left, int top, int right, int bottom, unsigned char changes);
+
+		/// <summary>
+		/// Converts cavity to air and removes foreground color from air within an area that's within the bounds of the scene.
+		/// </summary>
+		/// <param name="left">The X coordinate of the leftmost column of the area.</param>
+		/// <param name="top">The Y coordinate of the topmost row of the area.</param>
+		/// <param name="right">The X coordinate of the rightmost column of the area.</param>
+		/// <param name="bottom">The Y coordinate of the bottommost row of the area.</param>
+		void CleanAirInArea(int left, int top, int right, int bottom);
 
 		/// <summary>
 		/// Applies Material textures to the foreground and background color layers, based on the loaded material layer (main bitmap).
 		/// </summary>
-		void TexturizeTerrain();
+		/// <param name="multithreaded">Whether to split the rows across the worker threads, or do all of them on the calling thread.</param>
+		void TexturizeTerrain(bool multithreaded);
 
 		/// <summary>
 		/// Clears all the member variables of this SLTerrain, effectively resetting the members of this abstraction level only.
@@ -446,6 +446,7 @@ void Scene::Clear()
     m_PathfindingUpdated = false;
     m_FullPathUpdateTimer.Reset();
     m_PartialPathUpdateTimer.Reset();
+    m_GroundedScenePathRequests.clear();
     for (int set = PLACEONLOAD; set < PLACEDSETSCOUNT; ++set)
         m_PlacedObjects[set].clear();
     m_BackLayerList.clear();
@@ -2891,8 +2892,9 @@ void Scene::ResetPathFinding()
 
 void Scene::UpdatePathFinding()
 {
-    m_pPathFinder->RecalculateAreaCosts(m_pTerrain->GetUpdatedMaterialAreas());
-    m_pTerrain->ClearUpdatedMaterialAreas();
+    std::deque<Box> updatedAreas;
+    m_pTerrain->TakeUpdatedMaterialAreas(updatedAreas);
+    m_pPathFinder->RecalculateAreaCosts(updatedAreas);
     m_PartialPathUpdateTimer.Reset();
     m_PathfindingUpdated = true;
 }
@@ -2953,6 +2955,155 @@ int Scene::CalculateScenePath(const Vector start, const Vector end, bool movePat
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RequestPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues up the least difficult path between two points on the current
+//                  scene to be calculated in the background.
+
+int Scene::RequestPath(const Vector &start, const Vector &end, float digStrength, int team)
+{
+    return m_pPathFinder ? m_pPathFinder->RequestPath(start, end, digStrength, team) : 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsPathRequestPending
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether a path request is still waiting to be solved.
+
+bool Scene::IsPathRequestPending(int ticket) const
+{
+    return m_pPathFinder && m_pPathFinder->IsPathRequestPending(ticket);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TakePathRequestResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Takes the path calculated for a finished path request.
+
+float Scene::TakePathRequestResult(int ticket, std::list<Vector> &pathResult)
+{
+    float totalCostResult = -1;
+    if (m_pPathFinder)
+    {
+        int result = m_pPathFinder->TakePathRequestResult(ticket, pathResult, totalCostResult);
+
+        // Same as CalculatePath, a start and end in the same node is fine
+        return (result == micropather::MicroPather::SOLVED || result == micropather::MicroPather::START_END_SAME) ? totalCostResult : -1;
+    }
+
+    return -1;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelPathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Cancels a path request. Its result will never be available.
+
+void Scene::CancelPathRequest(int ticket)
+{
+    if (m_pPathFinder)
+        m_pPathFinder->CancelPathRequest(ticket);
+    m_GroundedScenePathRequests.erase(ticket);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CalculateScenePathAsync
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues up the least difficult path between two points on the current
+//                  scene to be calculated in the background. For exposing RequestPath
+//                  to Lua.
+
+int Scene::CalculateScenePathAsync(const Vector start, const Vector end, bool movePathToGround, float digStrength, int team)
+{
+    int ticket = RequestPath(start, end, digStrength, team);
+    if (ticket != 0 && movePathToGround)
+        m_GroundedScenePathRequests.insert(ticket);
+
+    return ticket;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TakeScenePathRequestResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Loads the path of a finished CalculateScenePathAsync request into
+//                  ScenePath. For exposing TakePathRequestResult to Lua.
+
+int Scene::TakeScenePathRequestResult(int ticket)
+{
+    if (!m_pPathFinder || m_pPathFinder->IsPathRequestPending(ticket))
+        return -1;
+
+    int pathSize = -1;
+    float notUsed;
+    if (m_pPathFinder->TakePathRequestResult(ticket, m_ScenePath, notUsed) != PathFinder::c_PathRequestNotDone && !m_ScenePath.empty())
+    {
+        pathSize = m_ScenePath.size();
+        if (m_GroundedScenePathRequests.find(ticket) != m_GroundedScenePathRequests.end())
+        {
+            // Smash all airborne waypoints down to just above the ground
+            for (Vector &pathPoint : m_ScenePath)
+                pathPoint = g_SceneMan.MovePointToGround(pathPoint, 20, 15);
+        }
+    }
+    m_GroundedScenePathRequests.erase(ticket);
+
+    return pathSize;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CollectPathRequests
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Waits for all the dispatched path requests to be solved and makes
+//                  their results available.
+
+void Scene::CollectPathRequests()
+{
+    if (m_pPathFinder)
+        m_pPathFinder->CollectPathRequests();
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DispatchPathRequests
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Hands the queued path requests to be solved in the background, team
+//                  by team with that team's doors opened up.
+
+void Scene::DispatchPathRequests()
+{
+    if (!m_pPathFinder)
+        return;
+
+    int maxSolves = g_SettingsMan.GetMaxPathSolvesPerUpdate();
+    int solveCount = 0;
+    for (int team : m_pPathFinder->GetQueuedPathRequestTeams())
+    {
+        if (maxSolves > 0 && solveCount >= maxSolves)
+            break;
+
+        // Same as Actor::UpdateMovePath does for its own path, remove the material representation of the team's doors so they're pathed through, but only for as long as it takes to snapshot the costs
+        if (team != Activity::NoTeam)
+        {
+            g_MovableMan.OverrideMaterialDoors(true, team);
+            UpdatePathFinding();
+        }
+        solveCount += m_pPathFinder->DispatchPathRequests(team, maxSolves > 0 ? maxSolves - solveCount : 0);
+        if (team != Activity::NoTeam)
+        {
+            g_MovableMan.OverrideMaterialDoors(false, team);
+            UpdatePathFinding();
+        }
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Lock
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -3025,8 +3176,18 @@ void Scene::Update()
         m_PathfindingUpdated = true;
     }
 
-    // Do partial update every 10 seconds
-    if (m_PartialPathUpdateTimer.IsPastRealMS(10000))
+    // Recalculate a little bit of the changed terrain every frame if there's a time budget for it, otherwise do partial update every 10 seconds
+    float pathCostUpdateBudget = g_SettingsMan.GetPathCostUpdateBudget();
+    if (pathCostUpdateBudget > 0)
+    {
+        std::deque<Box> updatedAreas;
+        m_pTerrain->TakeUpdatedMaterialAreas(updatedAreas);
+        if (!updatedAreas.empty())
+            m_PathfindingUpdated = true;
+        m_pPathFinder->RecalculateAreaCosts(updatedAreas, pathCostUpdateBudget);
+        m_PartialPathUpdateTimer.Reset();
+    }
+    else if (m_PartialPathUpdateTimer.IsPastRealMS(10000))
         UpdatePathFinding();
 }
 
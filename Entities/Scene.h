@@ -1215,6 +1215,111 @@ const SceneObject * PickPlacedActorInRange(int whichSet, Vector &scenePoint, int
     int CalculateScenePath(const Vector start, const Vector end, bool movePathToGround, float digStrength = 1);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RequestPath
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues up the least difficult path between two points on the current
+//                  scene to be calculated in the background. The result is available
+//                  through TakePathRequestResult once the request is no longer pending,
+//                  which is usually on the next update.
+// Arguments:       Start and end positions on the scene to find the path between.
+//                  The maximum material strength any actor traveling along the path can
+//                  dig through.
+//                  The team whose doors should be considered open, or NoTeam for none.
+// Return value:    The ticket of the request, or 0 if there's no pathfinding on this scene.
+
+    int RequestPath(const Vector &start, const Vector &end, float digStrength = 1, int team = Activity::NoTeam);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsPathRequestPending
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether a path request is still waiting to be solved.
+// Arguments:       The ticket of the request.
+// Return value:    Whether the request is still pending. False if it's done or if there is
+//                  no such request.
+
+    bool IsPathRequestPending(int ticket) const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TakePathRequestResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Takes the path calculated for a finished path request. The request is
+//                  forgotten afterwards.
+// Arguments:       The ticket of the request.
+//                  A list which will be filled out with waypoints between the start and end.
+// Return value:    The total minimum difficulty cost calculated between the two points on
+//                  the scene, or -1 if no path was found or the result isn't available.
+
+    float TakePathRequestResult(int ticket, std::list<Vector> &pathResult);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CancelPathRequest
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Cancels a path request. Its result will never be available.
+// Arguments:       The ticket of the request.
+// Return value:    None.
+
+    void CancelPathRequest(int ticket);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CalculateScenePathAsync
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Queues up the least difficult path between two points on the current
+//                  scene to be calculated in the background. Once the request is no
+//                  longer pending, TakeScenePathRequestResult loads it into ScenePath.
+//                  For exposing RequestPath to Lua.
+// Arguments:       Start and end positions on the scene to find the path between.
+//                  If the path should be moved to the ground or not.
+//                  The maximum material strength any actor traveling along the path can
+//                  dig through.
+//                  The team whose doors should be considered open, or NoTeam for none.
+// Return value:    The ticket of the request, or 0 if there's no pathfinding on this scene.
+
+    int CalculateScenePathAsync(const Vector start, const Vector end, bool movePathToGround, float digStrength = 1, int team = Activity::NoTeam);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TakeScenePathRequestResult
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Loads the path of a finished CalculateScenePathAsync request into
+//                  ScenePath. The request is forgotten afterwards.
+//                  For exposing TakePathRequestResult to Lua.
+// Arguments:       The ticket of the request.
+// Return value:    The number of waypoints from start to goal, or -1 if no path or the
+//                  request is still pending or doesn't exist.
+
+    int TakeScenePathRequestResult(int ticket);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CollectPathRequests
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Waits for all the dispatched path requests to be solved and makes
+//                  their results available. Supposed to be done once every sim update,
+//                  before anything that may take the results.
+// Arguments:       None.
+// Return value:    None.
+
+    void CollectPathRequests();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DispatchPathRequests
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Hands the queued path requests to be solved in the background, team
+//                  by team with that team's doors opened up, within the per update solve
+//                  budget. Supposed to be done once every sim update, after everything
+//                  that may request paths.
+// Arguments:       None.
+// Return value:    None.
+
+    void DispatchPathRequests();
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetScenePathSize
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1347,6 +1452,8 @@ protected:
     // Timers for when to do an update of all or only part of the pathfinding data
     Timer m_FullPathUpdateTimer;
     Timer m_PartialPathUpdateTimer;
+    // Tickets of the path requests made through CalculateScenePathAsync that should be moved to the ground when taken
+    std::unordered_set<int> m_GroundedScenePathRequests;
     // SceneObject:s to be placed in the scene, divided up by different sets - OWNED HERE
     std::list<SceneObject *> m_PlacedObjects[PLACEDSETSCOUNT];
     // List of background layers, first is the closest to the terrain, last is closest to the back
@@ -195,9 +195,9 @@ namespace RTE {
 	FMOD_RESULT SoundContainer::UpdateSoundProperties() {
 		FMOD_RESULT result = FMOD_OK;
 
-		std::vector<SoundSet::SoundData *> flattenedSoundData;
-		m_TopLevelSoundSet.GetFlattenedSoundData(flattenedSoundData, false);
-		for (SoundSet::SoundData *soundData : flattenedSoundData) {
+		std::vector<const SoundSet::SoundData *> flattenedSoundData;
+		static_cast<const SoundSet &>(m_TopLevelSoundSet).GetFlattenedSoundData(flattenedSoundData, false);
+		for (const SoundSet::SoundData *soundData : flattenedSoundData) {
 			FMOD_MODE soundMode = (m_Loops == 0) ? FMOD_LOOP_OFF : FMOD_LOOP_NORMAL;
 			if (m_Immobile) {
 				soundMode |= FMOD_3D_HEADRELATIVE;
@@ -19,7 +19,7 @@ namespace RTE {
 		m_SoundSelectionCycleMode = SoundSelectionCycleMode::RANDOM;
 		m_CurrentSelection = {false, -1};
 
-		m_SoundData.clear();
+		m_SoundData.Reset();
 		m_SubSoundSets.clear();
 	}
 
@@ -28,9 +28,7 @@ namespace RTE {
 	int SoundSet::Create(const SoundSet &reference) {
 		m_SoundSelectionCycleMode = reference.m_SoundSelectionCycleMode;
 		m_CurrentSelection = reference.m_CurrentSelection;
-		for (SoundData referenceSoundData : reference.m_SoundData) {
-			m_SoundData.push_back(referenceSoundData);
-		}
+		m_SoundData = reference.m_SoundData;
 		for (const SoundSet &referenceSoundSet : reference.m_SubSoundSets) {
 			SoundSet soundSet;
 			soundSet.Create(referenceSoundSet);
@@ -128,7 +126,7 @@ namespace RTE {
 		writer.NewProperty("SoundSelectionCycleMode");
 		SaveSoundSelectionCycleMode(writer, m_SoundSelectionCycleMode);
 
-		for (const SoundData &soundData : m_SoundData) {
+		for (const SoundData &soundData : *m_SoundData) {
 			writer.NewProperty("AddSound");
 			writer.ObjectStart("ContentFile");
 
@@ -174,15 +172,18 @@ namespace RTE {
 			return;
 		}
 
-		m_SoundData.push_back({soundFile, soundObject, offset, minimumAudibleDistance, attenuationStartDistance});
+		m_SoundData.GetMutable().push_back({soundFile, soundObject, offset, minimumAudibleDistance, attenuationStartDistance});
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	bool SoundSet::RemoveSound(const std::string &soundFilePath, bool removeFromSubSoundSets) {
-		auto soundsToRemove = std::remove_if(m_SoundData.begin(), m_SoundData.end(), [&soundFilePath](const SoundSet::SoundData &soundData) { return soundData.SoundFile.GetDataPath() == soundFilePath; });
-		bool anySoundsToRemove = soundsToRemove != m_SoundData.end();
-		if (anySoundsToRemove) { m_SoundData.erase(soundsToRemove, m_SoundData.end()); }
+		auto isSoundToRemove = [&soundFilePath](const SoundSet::SoundData &soundData) { return soundData.SoundFile.GetDataPath() == soundFilePath; };
+		bool anySoundsToRemove = std::any_of(m_SoundData->begin(), m_SoundData->end(), isSoundToRemove);
+		if (anySoundsToRemove) {
+			std::vector<SoundData> &soundData = m_SoundData.GetMutable();
+			soundData.erase(std::remove_if(soundData.begin(), soundData.end(), isSoundToRemove), soundData.end());
+		}
 		if (removeFromSubSoundSets) {
 			for (SoundSet subSoundSet : m_SubSoundSets) { anySoundsToRemove |= RemoveSound(soundFilePath, removeFromSubSoundSets); }
 		}
@@ -192,7 +193,7 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	bool SoundSet::HasAnySounds(bool includeSubSoundSets) const {
-		bool hasAnySounds = !m_SoundData.empty();
+		bool hasAnySounds = !m_SoundData->empty();
 		if (!hasAnySounds && includeSubSoundSets) {
 			for (const SoundSet &subSoundSet : m_SubSoundSets) {
 				hasAnySounds = subSoundSet.HasAnySounds();
@@ -208,11 +209,11 @@ namespace RTE {
 
 	void SoundSet::GetFlattenedSoundData(std::vector<SoundData *> &flattenedSoundData, bool onlyGetSelectedSoundData) {
 		if (!onlyGetSelectedSoundData || m_SoundSelectionCycleMode == SoundSelectionCycleMode::ALL) {
-			for (SoundData &soundData : m_SoundData) { flattenedSoundData.push_back(&soundData); }
+			for (SoundData &soundData : m_SoundData.GetMutable()) { flattenedSoundData.push_back(&soundData); }
 			for (SoundSet &subSoundSet : m_SubSoundSets) { subSoundSet.GetFlattenedSoundData(flattenedSoundData, onlyGetSelectedSoundData); }
 		} else {
 			if (m_CurrentSelection.first == false) {
-				flattenedSoundData.push_back(&m_SoundData[m_CurrentSelection.second]);
+				flattenedSoundData.push_back(&m_SoundData.GetMutable()[m_CurrentSelection.second]);
 			} else {
 				m_SubSoundSets[m_CurrentSelection.second].GetFlattenedSoundData(flattenedSoundData, onlyGetSelectedSoundData);
 			}
@@ -223,11 +224,11 @@ namespace RTE {
 
 	void SoundSet::GetFlattenedSoundData(std::vector<const SoundData *> &flattenedSoundData, bool onlyGetSelectedSoundData) const {
 		if (!onlyGetSelectedSoundData || m_SoundSelectionCycleMode == SoundSelectionCycleMode::ALL) {
-			for (const SoundData &soundData : m_SoundData) { flattenedSoundData.push_back(&soundData); }
+			for (const SoundData &soundData : *m_SoundData) { flattenedSoundData.push_back(&soundData); }
 			for (const SoundSet &subSoundSet : m_SubSoundSets) { subSoundSet.GetFlattenedSoundData(flattenedSoundData, onlyGetSelectedSoundData); }
 		} else {
 			if (m_CurrentSelection.first == false) {
-				flattenedSoundData.push_back(&m_SoundData[m_CurrentSelection.second]);
+				flattenedSoundData.push_back(&m_SoundData.Get()[m_CurrentSelection.second]);
 			} else {
 				m_SubSoundSets[m_CurrentSelection.second].GetFlattenedSoundData(flattenedSoundData, onlyGetSelectedSoundData);
 			}
@@ -245,8 +246,8 @@ namespace RTE {
 			}
 			return true;
 		}
-		int selectedVectorSize = m_CurrentSelection.first == false ? m_SoundData.size() : m_SubSoundSets.size();
-		int unselectedVectorSize = m_CurrentSelection.first == true ? m_SoundData.size() : m_SubSoundSets.size();
+		int selectedVectorSize = m_CurrentSelection.first == false ? m_SoundData->size() : m_SubSoundSets.size();
+		int unselectedVectorSize = m_CurrentSelection.first == true ? m_SoundData->size() : m_SubSoundSets.size();
 		if (selectedVectorSize == 0 && unselectedVectorSize > 0) {
 			m_CurrentSelection.first = !m_CurrentSelection.first;
 			std::swap(selectedVectorSize, unselectedVectorSize);
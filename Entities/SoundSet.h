@@ -3,6 +3,7 @@
 
 #include "Vector.h"
 #include "ContentFile.h"
+#include "CopyOnWrite.h"
 #include "LuaMan.h"
 
 namespace RTE {
@@ -44,7 +45,7 @@ namespace RTE {
 		SoundSet() { Clear(); }
 
 		/// <summary>
-		/// Creates a SoundSet to be identical to another, by deep copy.
+		/// Creates a SoundSet to be identical to another, by deep copy. The SoundData is shared with the other SoundSet until either changes it.
 		/// </summary>
 		/// <param name="reference">A reference to the SoundSet to deep copy.</param>
 		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
@@ -139,7 +140,7 @@ namespace RTE {
 		/// Adds a copy of the given SoundData to this SoundSet.
 		/// </summary>
 		/// <param name="soundDataToAdd">The SoundData to copy to this SoundSet.</param>
-		void AddSoundData(const SoundData &soundDataToAdd) { m_SoundData.push_back(soundDataToAdd); }
+		void AddSoundData(const SoundData &soundDataToAdd) { m_SoundData.GetMutable().push_back(soundDataToAdd); }
 
 		/// <summary>
 		/// Adds a copy of the passed in SoundSet as a sub SoundSet of this SoundSet. Ownership IS transferred!
@@ -169,6 +170,7 @@ namespace RTE {
 
 		/// <summary>
 		/// Fills the passed in vector with the flattened SoundData in the SoundSet, optionally only getting currently selected SoundData.
+		/// Any SoundData shared with other SoundSets is copied first so it can be changed, so the const version should be used wherever possible.
 		/// </summary>
 		/// <param name="flattenedSoundData">A reference vector of SoundData references to be filled with this SoundSet's flattened SoundData.</param>
 		/// <param name="onlyGetSelectedSoundData">Whether to only get SoundData that is currently selected, or to get all SoundData in this SoundSet.</param>
@@ -212,7 +214,7 @@ namespace RTE {
 		SoundSelectionCycleMode m_SoundSelectionCycleMode; //!< The SoundSelectionCycleMode for this SoundSet.
 		std::pair<bool, int> m_CurrentSelection; //!< Whether the current selection is in the SoundData (false) or SoundSet (true) vector, and its index in the appropriate vector.
 
-		std::vector<SoundData> m_SoundData; //!< The SoundData available for selection in this SoundSet.
+		CopyOnWrite<std::vector<SoundData>> m_SoundData; //!< The SoundData available for selection in this SoundSet. Shared with the SoundSets this was copied from or to, until either changes it.
 		std::vector<SoundSet> m_SubSoundSets; //!< The sub SoundSets available for selection in this SoundSet.
 
 		/// <summary>
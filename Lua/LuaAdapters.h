@@ -62,10 +62,24 @@ namespace RTE {
 		if (movableMan.ValidMO(particle)) {
 			g_ConsoleMan.PrintString("ERROR: Tried to add a Particle that already exists in the simulation!" + particle->GetPresetName());
 		} else {
+			// The script keeps its reference to the particle after adding it.
+			movableMan.KeepOutOfParticleStore(particle);
 			movableMan.AddParticle(particle);
 		}
 	}
 
+	/// <summary>
+	/// Finds a MovableObject by its unique ID, taking it out of the ParticleStore if it's stored there since the script may hold on to and change it.
+	/// </summary>
+	/// <param name="movableMan">A reference to MovableMan, provided by Lua.</param>
+	/// <param name="uniqueID">The unique ID to look for.</param>
+	/// <returns>The MovableObject with the unique ID, or nullptr if there isn't one.</returns>
+	static MovableObject * FindObjectByUniqueID(MovableMan &movableMan, long uniqueID) {
+		MovableObject *movableObject = movableMan.FindObjectByUniqueID(uniqueID);
+		if (movableObject) { movableMan.KeepOutOfParticleStore(movableObject); }
+		return movableObject;
+	}
+
 	/// <summary>
 	/// Gets the number of ticks per second. Lua can't handle int64 (or long long apparently) so we'll expose this specialized function.
 	/// </summary>
@@ -115,6 +129,100 @@ namespace RTE {
 	static bool ReloadEntityPreset2(PresetMan &presetMan, const std::string &presetName, const std::string &className) {
 		return ReloadEntityPreset1(presetMan, presetName, className, "");
 	}
+
+	/// <summary>
+	/// Gets all the Actors and Items whose bounding radii overlap a circle in the scene.
+	/// </summary>
+	/// <param name="center">The center of the circle in the scene.</param>
+	/// <param name="radius">The radius of the circle.</param>
+	/// <param name="ignoreTeam">A team whose MOs should be left out.</param>
+	/// <returns>A list of the found MOs, valid until the start of the next MovableMan update.</returns>
+	static const std::vector<MovableObject *> & GetMOsInRadius1(MovableMan &movableMan, const Vector &center, float radius, int ignoreTeam) {
+		return movableMan.GetMOsInRadius(center, radius, ignoreTeam);
+	}
+
+	/// <summary>
+	/// Gets all the Actors and Items whose bounding radii overlap a circle in the scene.
+	/// </summary>
+	/// <param name="center">The center of the circle in the scene.</param>
+	/// <param name="radius">The radius of the circle.</param>
+	/// <returns>A list of the found MOs, valid until the start of the next MovableMan update.</returns>
+	static const std::vector<MovableObject *> & GetMOsInRadius2(MovableMan &movableMan, const Vector &center, float radius) {
+		return movableMan.GetMOsInRadius(center, radius);
+	}
+
+	/// <summary>
+	/// Gets all the Actors and Items whose bounding radii overlap a box in the scene.
+	/// </summary>
+	/// <param name="box">The box in the scene.</param>
+	/// <param name="ignoreTeam">A team whose MOs should be left out.</param>
+	/// <returns>A list of the found MOs, valid until the start of the next MovableMan update.</returns>
+	static const std::vector<MovableObject *> & GetMOsInBox1(MovableMan &movableMan, const Box &box, int ignoreTeam) {
+		return movableMan.GetMOsInBox(box, ignoreTeam);
+	}
+
+	/// <summary>
+	/// Gets all the Actors and Items whose bounding radii overlap a box in the scene.
+	/// </summary>
+	/// <param name="box">The box in the scene.</param>
+	/// <returns>A list of the found MOs, valid until the start of the next MovableMan update.</returns>
+	static const std::vector<MovableObject *> & GetMOsInBox2(MovableMan &movableMan, const Box &box) {
+		return movableMan.GetMOsInBox(box);
+	}
+
+	/// <summary>
+	/// Casts a batch of rays, described by a sequence of tables with the same fields as SceneMan::RayQuery, and gets a sequence of tables with their results in the same order.
+	/// Each ray table needs at least Start and Ray. Each result table has Hit, HitPos, Value and MOID.
+	/// </summary>
+	/// <param name="rayTable">The sequence of ray tables to cast.</param>
+	/// <returns>The sequence of result tables.</returns>
+	static luabind::object CastRays(SceneMan &sceneMan, const luabind::object &rayTable) {
+		lua_State *luaState = rayTable.interpreter();
+		luabind::object resultTable = luabind::newtable(luaState);
+		if (luabind::type(rayTable) != LUA_TTABLE) {
+			g_ConsoleMan.PrintString("ERROR: SceneMan:CastRays needs a table of rays to cast!");
+			return resultTable;
+		}
+
+		std::vector<SceneMan::RayQuery> rayQueries;
+		for (int rayIndex = 1; luabind::type(rayTable[rayIndex]) == LUA_TTABLE; ++rayIndex) {
+			luabind::object rayEntry = rayTable[rayIndex];
+			SceneMan::RayQuery &rayQuery = rayQueries.emplace_back();
+			auto readField = [&rayEntry](const char *fieldName, auto &field) {
+				if (auto value = luabind::object_cast_nothrow<std::decay_t<decltype(field)>>(rayEntry[fieldName])) { field = *value; }
+			};
+			int rayType = rayQuery.Type;
+			readField("Type", rayType);
+			rayQuery.Type = static_cast<SceneMan::RayQuery::RayType>(rayType);
+			readField("Start", rayQuery.Start);
+			readField("Ray", rayQuery.Ray);
+			int material = rayQuery.Material;
+			readField("Material", material);
+			rayQuery.Material = static_cast<unsigned char>(material);
+			int ignoreMaterial = rayQuery.IgnoreMaterial;
+			readField("IgnoreMaterial", ignoreMaterial);
+			rayQuery.IgnoreMaterial = static_cast<unsigned char>(ignoreMaterial);
+			readField("Strength", rayQuery.Strength);
+			readField("Skip", rayQuery.Skip);
+			readField("Wrap", rayQuery.Wrap);
+			readField("CheckMOs", rayQuery.CheckMOs);
+			readField("IgnoreMOID", rayQuery.IgnoreMOID);
+			readField("IgnoreTeam", rayQuery.IgnoreTeam);
+			readField("IgnoreAllTerrain", rayQuery.IgnoreAllTerrain);
+		}
+		sceneMan.CastRays(rayQueries);
+
+		for (int rayIndex = 0; rayIndex < static_cast<int>(rayQueries.size()); ++rayIndex) {
+			const SceneMan::RayQuery &rayQuery = rayQueries[rayIndex];
+			luabind::object result = luabind::newtable(luaState);
+			result["Hit"] = rayQuery.Hit;
+			result["HitPos"] = rayQuery.HitPos;
+			result["Value"] = rayQuery.Value;
+			result["MOID"] = rayQuery.HitMOID;
+			resultTable[rayIndex + 1] = result;
+		}
+		return resultTable;
+	}
 #pragma endregion
 
 #pragma region Misc Lua Adapters
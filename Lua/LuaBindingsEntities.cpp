@@ -234,6 +234,7 @@ namespace RTE {
 		.property("InventorySize", &Actor::GetInventorySize)
 		.property("MaxInventoryMass", &Actor::GetMaxInventoryMass)
 		.property("MovePathSize", &Actor::GetMovePathSize)
+		.property("MovePathRequestPending", &Actor::IsMovePathRequestPending)
 		.property("AimDistance", &Actor::GetAimDistance, &Actor::SetAimDistance)
 		.property("SightDistance", &Actor::GetSightDistance, &Actor::SetSightDistance)
 		.property("PieMenu", &Actor::GetPieMenu, &ActorSetPieMenu)
@@ -1165,6 +1166,10 @@ namespace RTE {
 		.def("UpdatePathFinding", &Scene::UpdatePathFinding)
 		.def("PathFindingUpdated", &Scene::PathFindingUpdated)
 		.def("CalculatePath", &Scene::CalculateScenePath)
+		.def("CalculatePathAsync", &Scene::CalculateScenePathAsync)
+		.def("IsPathRequestPending", &Scene::IsPathRequestPending)
+		.def("TakePathRequestResult", &Scene::TakeScenePathRequestResult)
+		.def("CancelPathRequest", &Scene::CancelPathRequest)
 
 		.enum_("PlacedObjectSets")[
 			luabind::value("PLACEONLOAD", Scene::PlacedObjectSets::PLACEONLOAD),
@@ -103,6 +103,7 @@ namespace RTE {
 		return luabind::class_<MovableMan>("MovableManager")
 
 		.property("MaxDroppedItems", &MovableMan::GetMaxDroppedItems, &MovableMan::SetMaxDroppedItems)
+		.property("ParticleStoreEnabled", &MovableMan::IsParticleStoreEnabled, &MovableMan::EnableParticleStore)
 
 		.def_readwrite("Actors", &MovableMan::m_Actors, luabind::return_stl_iterator)
 		.def_readwrite("Items", &MovableMan::m_Items, luabind::return_stl_iterator)
@@ -114,10 +115,12 @@ namespace RTE {
 		.def_readwrite("AddedAlarmEvents", &MovableMan::m_AddedAlarmEvents, luabind::return_stl_iterator)
 
 		.def("GetMOFromID", &MovableMan::GetMOFromID)
-		.def("FindObjectByUniqueID", &MovableMan::FindObjectByUniqueID)
+		.def("FindObjectByUniqueID", &FindObjectByUniqueID)
 		.def("GetMOIDCount", &MovableMan::GetMOIDCount)
 		.def("GetTeamMOIDCount", &MovableMan::GetTeamMOIDCount)
 		.def("PurgeAllMOs", &MovableMan::PurgeAllMOs)
+		.def("RunParticleStoreBenchmark", &MovableMan::RunParticleStoreBenchmark)
+		.def("RunParticleKernelBenchmark", &MovableMan::RunParticleKernelBenchmark)
 		.def("GetNextActorInGroup", &MovableMan::GetNextActorInGroup)
 		.def("GetPrevActorInGroup", &MovableMan::GetPrevActorInGroup)
 		.def("GetNextTeamActor", &MovableMan::GetNextTeamActor)
@@ -131,6 +134,10 @@ namespace RTE {
 		.def("GetClosestOtherBrainActor", &MovableMan::GetClosestOtherBrainActor)
 		.def("GetFirstOtherBrainActor", &MovableMan::GetFirstOtherBrainActor)
 		.def("GetUnassignedBrain", &MovableMan::GetUnassignedBrain)
+		.def("GetMOsInRadius", &GetMOsInRadius1, luabind::return_stl_iterator)
+		.def("GetMOsInRadius", &GetMOsInRadius2, luabind::return_stl_iterator)
+		.def("GetMOsInBox", &GetMOsInBox1, luabind::return_stl_iterator)
+		.def("GetMOsInBox", &GetMOsInBox2, luabind::return_stl_iterator)
 		.def("GetParticleCount", &MovableMan::GetParticleCount)
 		.def("GetSplashRatio", &MovableMan::GetSplashRatio)
 		.def("SortTeamRoster", &MovableMan::SortTeamRoster)
@@ -190,7 +197,8 @@ namespace RTE {
 		.def("ReadReflectedPreset", &PresetMan::ReadReflectedPreset)
 		.def("ReloadEntityPreset", ReloadEntityPreset1)
 		.def("ReloadEntityPreset", ReloadEntityPreset2)
-		.def("ReloadAllScripts", &PresetMan::ReloadAllScripts);
+		.def("ReloadAllScripts", &PresetMan::ReloadAllScripts)
+		.def("RunCloneBenchmark", &PresetMan::RunCloneBenchmark);
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -296,6 +304,7 @@ namespace RTE {
 		.def("CastMORay", &SceneMan::CastMORay)
 		.def("CastFindMORay", &SceneMan::CastFindMORay)
 		.def("CastObstacleRay", &SceneMan::CastObstacleRay)
+		.def("CastRays", &CastRays)
 		.def("GetLastRayHitPos", &SceneMan::GetLastRayHitPos)
 		.def("FindAltitude", &SceneMan::FindAltitude)
 		.def("MovePointToGround", &SceneMan::MovePointToGround)
@@ -309,7 +318,19 @@ namespace RTE {
 		.def("ObscuredPoint", (bool (SceneMan::*)(Vector &, int))&SceneMan::ObscuredPoint)//, out_value(_2))
 		.def("ObscuredPoint", (bool (SceneMan::*)(int, int, int))&SceneMan::ObscuredPoint)
 		.def("AddSceneObject", &SceneMan::AddSceneObject, luabind::adopt(_2))
-		.def("CheckAndRemoveOrphans", (int (SceneMan::*)(int, int, int, int, bool))&SceneMan::RemoveOrphans);
+		.def("RunTerrainLoadBenchmark", &SceneMan::RunTerrainLoadBenchmark)
+		.def("RunOrphanSearchBenchmark", &SceneMan::RunOrphanSearchBenchmark)
+		.def("CheckAndRemoveOrphans", (int (SceneMan::*)(int, int, int, int, bool))&SceneMan::RemoveOrphans)
+
+		.enum_("RayType")[
+			luabind::value("MATERIAL_RAY", SceneMan::RayQuery::MaterialRay),
+			luabind::value("NOT_MATERIAL_RAY", SceneMan::RayQuery::NotMaterialRay),
+			luabind::value("STRENGTH_RAY", SceneMan::RayQuery::StrengthRay),
+			luabind::value("WEAKNESS_RAY", SceneMan::RayQuery::WeaknessRay),
+			luabind::value("STRENGTH_SUM_RAY", SceneMan::RayQuery::StrengthSumRay),
+			luabind::value("MAX_STRENGTH_RAY", SceneMan::RayQuery::MaxStrengthRay),
+			luabind::value("MO_RAY", SceneMan::RayQuery::MORay)
+		];
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
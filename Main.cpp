@@ -34,9 +34,12 @@
 #include "PresetMan.h"
 #include "UInputMan.h"
 #include "PerformanceMan.h"
+#include "ThreadMan.h"
 #include "MetaMan.h"
 #include "NetworkServer.h"
 
+#include <csignal>
+
 extern "C" { FILE __iob_func[3] = { *stdin,*stdout,*stderr }; }
 
 using namespace RTE;
@@ -56,6 +59,7 @@ namespace RTE {
 		g_NetworkClient.Initialize();
 		g_TimerMan.Initialize();
 		g_PerformanceMan.Initialize();
+		g_ThreadMan.Initialize();
 		g_FrameMan.Initialize();
 		g_PostProcessMan.Initialize();
 
@@ -66,13 +70,14 @@ namespace RTE {
 		g_SceneMan.Initialize();
 		g_MovableMan.Initialize();
 		g_MetaMan.Initialize();
-		g_MenuMan.Initialize();
+		// There are no menus in headless mode, clients pick what to play in the server lobby.
+		if (!System::IsHeadless()) { g_MenuMan.Initialize(); }
 
 		// Overwrite Settings.ini after all the managers are created to fully populate the file. Up until this moment Settings.ini is populated only with minimal required properties to run.
 		// If Settings.ini already exists and is fully populated, this will deal with overwriting it to apply any overrides performed by the managers at boot (e.g resolution validation).
 		if (g_SettingsMan.SettingsNeedOverwrite()) { g_SettingsMan.UpdateSettingsFile(); }
 
-		g_FrameMan.PrintForcedGfxDriverMessage();
+		if (!System::IsHeadless()) { g_FrameMan.PrintForcedGfxDriverMessage(); }
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -85,6 +90,7 @@ namespace RTE {
 		g_NetworkServer.Destroy();
 		g_MetaMan.Destroy();
 		g_MovableMan.Destroy();
+		g_ThreadMan.Destroy();
 		g_SceneMan.Destroy();
 		g_ActivityMan.Destroy();
 		g_GUISound.Destroy();
@@ -125,6 +131,8 @@ namespace RTE {
 
 			if (currentArg == "-cout") { System::EnableLoggingToCLI(); }
 
+			if (currentArg == "-benchmarkjobs") { g_ThreadMan.RunJobOverheadBenchmark(); }
+
 			if (!lastArg && !singleModuleSet && currentArg == "-module") {
 				std::string moduleToLoad = argValue[++i];
 				if (moduleToLoad.find(System::GetModulePackageExtension()) == moduleToLoad.length() - System::GetModulePackageExtension().length()) {
@@ -133,10 +141,13 @@ namespace RTE {
 				}
 			}
 			if (!launchModeSet) {
-				if (currentArg == "-server") {
+				if (currentArg == "-server" || currentArg == "-dedicated") {
 					g_NetworkServer.EnableServerMode();
 					g_NetworkServer.SetServerPort(!lastArg ? argValue[++i] : "8000");
 					launchModeSet = true;
+				} else if (!lastArg && currentArg == "-connect") {
+					g_ActivityMan.SetServerToConnectTo(argValue[++i]);
+					launchModeSet = true;
 				} else if (!lastArg && currentArg == "-editor") {
 					g_ActivityMan.SetEditorToLaunch(argValue[++i]);
 					launchModeSet = true;
@@ -147,6 +158,17 @@ namespace RTE {
 		if (launchModeSet) { g_SettingsMan.SetSkipIntro(true); }
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Terminates a headless server that failed to start an activity, since there are no menus to fall back to and nothing for clients to join.
+	/// </summary>
+	void AbortHeadlessWithoutActivity() {
+		g_ConsoleMan.PrintString("ERROR: Failed to start an activity in headless mode. Terminating!");
+		DestroyManagers();
+		std::exit(EXIT_FAILURE);
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	/// <summary>
@@ -192,7 +214,10 @@ namespace RTE {
 		g_PerformanceMan.ResetFrameTimer();
 		g_TimerMan.PauseSim(false);
 
-		if (g_ActivityMan.ActivitySetToRestart() && !g_ActivityMan.RestartActivity()) { g_MenuMan.GetTitleScreen()->SetTitleTransitionState(TitleScreen::TitleTransition::ScrollingFadeIn); }
+		if (g_ActivityMan.ActivitySetToRestart() && !g_ActivityMan.RestartActivity()) {
+			if (System::IsHeadless()) { AbortHeadlessWithoutActivity(); }
+			g_MenuMan.GetTitleScreen()->SetTitleTransitionState(TitleScreen::TitleTransition::ScrollingFadeIn);
+		}
 
 		while (!System::IsSetToQuit()) {
 			g_TimerMan.Update();
@@ -203,6 +228,7 @@ namespace RTE {
 			while (g_TimerMan.TimeForSimUpdate()) {
 				serverUpdated = false;
 				g_PerformanceMan.NewPerformanceSample();
+				g_ThreadMan.SwapFrameArenas();
 
 				g_TimerMan.UpdateSim();
 
@@ -221,6 +247,7 @@ namespace RTE {
 				g_ActivityMan.Update();
 				g_PerformanceMan.StopPerformanceMeasurement(PerformanceMan::ActivityUpdate);
 				g_MovableMan.Update();
+				g_SceneMan.Update();
 				g_AudioMan.Update();
 
 				g_ActivityMan.LateUpdateGlobalScripts();
@@ -232,7 +259,10 @@ namespace RTE {
 				g_ConsoleMan.Update();
 				g_PerformanceMan.StopPerformanceMeasurement(PerformanceMan::SimTotal);
 
-				if (!g_ActivityMan.IsInActivity()) {
+				if (!g_ActivityMan.IsInActivity() && System::IsHeadless()) {
+					// There are no menus to fall back to in headless mode, so go back to the lobby for clients to pick what to play next.
+					if (!g_ActivityMan.ActivitySetToRestart()) { g_ActivityMan.SetStartMultiplayerServerOverview(); }
+				} else if (!g_ActivityMan.IsInActivity()) {
 					g_TimerMan.PauseSim(true);
 					if (g_MetaMan.GameInProgress()) {
 						g_MenuMan.GetTitleScreen()->SetTitleTransitionState(TitleScreen::TitleTransition::MetaGameFadeIn);
@@ -248,6 +278,7 @@ namespace RTE {
 					if (!g_ActivityMan.ActivitySetToRestart()) { RunMenuLoop(); }
 				}
 				if (g_ActivityMan.ActivitySetToRestart() && !g_ActivityMan.RestartActivity()) {
+					if (System::IsHeadless()) { AbortHeadlessWithoutActivity(); }
 					break;
 				}
 				if (g_ActivityMan.ActivitySetToResume()) {
@@ -262,16 +293,18 @@ namespace RTE {
 
 				if (!serverUpdated) { g_NetworkServer.Update(); }
 
-				if (g_NetworkServer.GetServerSimSleepWhenIdle()) {
+				// A headless server has nothing else to do until the next sim update is due, so it always sleeps rather than spinning.
+				if (g_NetworkServer.GetServerSimSleepWhenIdle() || System::IsHeadless()) {
 					long long ticksToSleep = g_TimerMan.GetTimeToSleep();
 					if (ticksToSleep > 0) {
 						double secsToSleep = static_cast<double>(ticksToSleep) / static_cast<double>(g_TimerMan.GetTicksPerSecond());
-						long long milisToSleep = static_cast<long long>(secsToSleep) * 1000;
-						std::this_thread::sleep_for(std::chrono::milliseconds(milisToSleep));
+						long long microsToSleep = static_cast<long long>(secsToSleep * 1000000.0);
+						std::this_thread::sleep_for(std::chrono::microseconds(microsToSleep));
 					}
 				}
 			}
-			g_FrameMan.Draw();
+			// Frames are only ever drawn for clients in headless mode, so don't draw any until one of them is due another.
+			if (!System::IsHeadless() || g_NetworkServer.NetworkFrameNeeded()) { g_FrameMan.Draw(); }
 			g_FrameMan.FlipFrameBuffers();
 		}
 	}
@@ -283,10 +316,25 @@ namespace RTE {
 /// Implementation of the main function.
 /// </summary>
 int main(int argc, char **argv) {
+	// A dedicated server runs headless, which changes how Allegro and the managers are initialized, so it has to be known before any other argument is handled.
+	for (int i = 1; i < argc; ++i) {
+		if (std::string_view(argv[i]) == "-dedicated") {
+			System::EnableHeadlessMode();
+			System::EnableLoggingToCLI();
+		}
+	}
+
 	set_config_file("Base.rte/AllegroConfig.txt");
-	allegro_init();
+	if (System::IsHeadless()) {
+		// Without a display there's no system driver to talk to, only memory bitmaps. Quit cleanly when the process is asked to stop, since there's no window to close.
+		install_allegro(SYSTEM_NONE, &errno, atexit);
+		std::signal(SIGINT, [](int) { System::SetQuit(); });
+		std::signal(SIGTERM, [](int) { System::SetQuit(); });
+	} else {
+		allegro_init();
+		set_close_button_callback(System::WindowCloseButtonHandler);
+	}
 	loadpng_init();
-	set_close_button_callback(System::WindowCloseButtonHandler);
 
 	System::Initialize();
 	SeedRNG();
@@ -309,7 +357,10 @@ int main(int argc, char **argv) {
 		if (std::filesystem::exists(System::GetWorkingDirectory() + "LogLoadingWarning.txt")) { std::remove("LogLoadingWarning.txt"); }
 	}
 
-	if (!g_ActivityMan.Initialize()) { RunMenuLoop(); }
+	if (!g_ActivityMan.Initialize()) {
+		if (System::IsHeadless()) { AbortHeadlessWithoutActivity(); }
+		RunMenuLoop();
+	}
 	RunGameLoop();
 
 	DestroyManagers();
@@ -38,6 +38,7 @@ namespace RTE {
 		m_LastMusicPos = 0.0F;
 		m_LaunchIntoActivity = false;
 		m_LaunchIntoEditor = false;
+		m_ServerToConnectTo = {};
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -45,6 +46,8 @@ namespace RTE {
 	bool ActivityMan::Initialize() {
 		if (g_NetworkServer.IsServerModeEnabled()) {
 			return SetStartMultiplayerServerOverview();
+		} else if (IsSetToLaunchIntoMultiplayerGame()) {
+			return SetStartMultiplayerActivity();
 		} else if (IsSetToLaunchIntoEditor()) {
 			// Evaluate LaunchIntoEditor before LaunchIntoActivity so it takes priority when both are set, otherwise it is ignored and editor is never launched.
 			return SetStartEditorActivitySetToLaunchInto();
@@ -138,6 +138,24 @@ namespace RTE {
 		/// </summary>
 		/// <param name="editorName"></param>
 		void SetEditorToLaunch(const std::string_view &editorName) { if (!editorName.empty()) { m_EditorToLaunch = editorName; m_LaunchIntoEditor = true; } }
+
+		/// <summary>
+		/// Gets whether the intro and main menu should be skipped on game start and launch directly into a multiplayer game connected to the set server instead.
+		/// </summary>
+		/// <returns>Whether the game is set to launch directly into a multiplayer game or not.</returns>
+		bool IsSetToLaunchIntoMultiplayerGame() const { return !m_ServerToConnectTo.empty(); }
+
+		/// <summary>
+		/// Gets the address of the server to connect to when launching directly into a multiplayer game.
+		/// </summary>
+		/// <returns>The address of the server to connect to, as "address[:port]". Empty if not launching directly into a multiplayer game.</returns>
+		std::string_view GetServerToConnectTo() const { return m_ServerToConnectTo; }
+
+		/// <summary>
+		/// Sets the address of the server to launch directly into a multiplayer game connected to.
+		/// </summary>
+		/// <param name="serverAddress">The address of the server to connect to, as "address[:port]". Empty to not launch directly into a multiplayer game.</param>
+		void SetServerToConnectTo(const std::string_view &serverAddress) { m_ServerToConnectTo = serverAddress; }
 #pragma endregion
 
 #pragma region Activity Start Handling
@@ -252,6 +270,7 @@ namespace RTE {
 		bool m_LaunchIntoActivity; //!< Whether to skip the intro and main menu and launch directly into the set default Activity instead.
 		bool m_LaunchIntoEditor; //!< Whether to skip the intro and main menu and launch directly into the set editor Activity instead.
 		std::string_view m_EditorToLaunch; //!< The name of the editor Activity to launch directly into.
+		std::string_view m_ServerToConnectTo; //!< The address of the server to launch directly into a multiplayer game connected to.
 
 	private:
 
@@ -6,6 +6,7 @@
 #include "ConsoleMan.h"
 #include "SettingsMan.h"
 #include "UInputMan.h"
+#include "NetworkServer.h"
 
 #include "SLTerrain.h"
 #include "SLBackground.h"
@@ -66,8 +67,14 @@ namespace RTE {
 		m_PrimaryScreenResY = GetSystemMetrics(SM_CYSCREEN);
 #elif __unix__
 		m_NumScreens = 1;
-		m_MaxResX = m_PrimaryScreenResX = DisplayWidth(_xwin.display, _xwin.screen);
-		m_MaxResY = m_PrimaryScreenResY = DisplayHeight(_xwin.display, _xwin.screen);
+		// Headless mode never opens an X display, so there's nothing to query. The bounds are set from the configured resolution in Initialize instead.
+		if (System::IsHeadless()) {
+			m_MaxResX = m_PrimaryScreenResX = c_DefaultResX;
+			m_MaxResY = m_PrimaryScreenResY = c_DefaultResY;
+		} else {
+			m_MaxResX = m_PrimaryScreenResX = DisplayWidth(_xwin.display, _xwin.screen);
+			m_MaxResY = m_PrimaryScreenResY = DisplayHeight(_xwin.display, _xwin.screen);
+		}
 #endif
 		m_ResX = c_DefaultResX;
 		m_ResY = c_DefaultResY;
@@ -278,26 +285,36 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	int FrameMan::Initialize() {
-		ValidateResolution(m_ResX, m_ResY, m_ResMultiplier);
-		SetInitialGraphicsDriver();
-		set_color_depth(m_BPP);
-
-		if (set_gfx_mode(m_GfxDriver, m_ResX * m_ResMultiplier, m_ResY * m_ResMultiplier, 0, 0) != 0) {
-			// If a bad resolution somehow slipped past the validation, revert to defaults.
-			ShowMessageBox("Unable to set specified graphics mode because: " + std::string(allegro_error) + "!\n\nTrying to revert to defaults...");
-			if (set_gfx_mode(GFX_AUTODETECT_WINDOWED, c_DefaultResX, c_DefaultResY, 0, 0) != 0) {
-				RTEAbort("Unable to set any graphics mode because " + std::string(allegro_error) + "!");
-				return 1;
-			}
-			m_ResX = c_DefaultResX;
-			m_ResY = c_DefaultResY;
+		if (System::IsHeadless()) {
+			// There's no window in headless mode. Everything is drawn to memory bitmaps that only ever get sent to clients, at the resolution clients are expected to run at.
+			set_color_depth(m_BPP);
 			m_ResMultiplier = 1;
-		}
+			m_DisableFrameBufferFlip = true;
+			m_NumScreens = 1;
+			m_MaxResX = m_PrimaryScreenResX = m_ResX;
+			m_MaxResY = m_PrimaryScreenResY = m_ResY;
+		} else {
+			ValidateResolution(m_ResX, m_ResY, m_ResMultiplier);
+			SetInitialGraphicsDriver();
+			set_color_depth(m_BPP);
+
+			if (set_gfx_mode(m_GfxDriver, m_ResX * m_ResMultiplier, m_ResY * m_ResMultiplier, 0, 0) != 0) {
+				// If a bad resolution somehow slipped past the validation, revert to defaults.
+				ShowMessageBox("Unable to set specified graphics mode because: " + std::string(allegro_error) + "!\n\nTrying to revert to defaults...");
+				if (set_gfx_mode(GFX_AUTODETECT_WINDOWED, c_DefaultResX, c_DefaultResY, 0, 0) != 0) {
+					RTEAbort("Unable to set any graphics mode because " + std::string(allegro_error) + "!");
+					return 1;
+				}
+				m_ResX = c_DefaultResX;
+				m_ResY = c_DefaultResY;
+				m_ResMultiplier = 1;
+			}
 
-		// Clear the screen buffer so it doesn't flash pink
-		clear_to_color(screen, 0);
+			// Clear the screen buffer so it doesn't flash pink
+			clear_to_color(screen, 0);
 
-		SetDisplaySwitchMode();
+			SetDisplaySwitchMode();
+		}
 
 		// Sets the allowed color conversions when loading bitmaps from files
 		set_color_conversion(COLORCONV_MOST);
@@ -366,7 +383,8 @@ namespace RTE {
 			m_PlayerScreenHeight = m_PlayerScreen->h;
 		}
 
-		m_ScreenDumpBuffer = create_bitmap_ex(24, screen->w, screen->h);
+		// There's no screen in headless mode, so the dump buffer just matches the back buffer. Screen dumps are skipped there anyway.
+		m_ScreenDumpBuffer = screen ? create_bitmap_ex(24, screen->w, screen->h) : create_bitmap_ex(24, m_ResX, m_ResY);
 
 		return 0;
 	}
@@ -1016,6 +1034,10 @@ namespace RTE {
 		const Activity *pActivity = g_ActivityMan.GetActivity();
 
 		for (int playerScreen = 0; playerScreen < screenCount; ++playerScreen) {
+			// Nobody ever sees the screens of players without a client in headless mode.
+			if (System::IsHeadless() && !g_NetworkServer.IsPlayerConnected(static_cast<short>(playerScreen))) {
+				continue;
+			}
 			screenRelativeEffects.clear();
 			screenRelativeGlowBoxes.clear();
 
@@ -1027,7 +1049,8 @@ namespace RTE {
 			}
 			// Need to clear the backbuffers because Scene background layers can be too small to fill the whole backbuffer or drawn masked resulting in artifacts from the previous frame.
 			clear_to_color(drawScreenGUI, ColorKeys::g_MaskColor);
-			clear_to_color(drawScreen, m_BlackColor);
+			// The world layer of clients that are sent the entity states only has the fog of war in it, which they draw over everything else.
+			clear_to_color(drawScreen, (IsInMultiplayerMode() && g_NetworkServer.ReplicatesEntityState()) ? ColorKeys::g_MaskColor : m_BlackColor);
 
 			AllegroBitmap playerGUIBitmap(drawScreenGUI);
 
@@ -1123,10 +1146,13 @@ namespace RTE {
 
 		if (IsInMultiplayerMode()) { PrepareFrameForNetwork(); }
 
-		if (g_ActivityMan.IsInActivity()) { g_PostProcessMan.PostProcess(); }
+		// Post-processing and the console only ever end up on the local display, which there isn't any of in headless mode.
+		if (!System::IsHeadless()) {
+			if (g_ActivityMan.IsInActivity()) { g_PostProcessMan.PostProcess(); }
 
-		// Draw the console on top of everything
-		g_ConsoleMan.Draw(m_BackBuffer32);
+			// Draw the console on top of everything
+			g_ConsoleMan.Draw(m_BackBuffer32);
+		}
 
 #ifdef DEBUG_BUILD
 		// Draw scene seam
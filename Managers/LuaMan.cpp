@@ -8,6 +8,8 @@ namespace RTE {
 
 	const std::unordered_set<std::string> LuaMan::c_FileAccessModes = { "r", "r+", "w", "w+", "a", "a+" };
 
+	static_assert(LuaMan::c_NoReference == LUA_NOREF, "LuaMan::c_NoReference must match LUA_NOREF!");
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void LuaMan::Clear() {
@@ -18,6 +20,7 @@ namespace RTE {
 		m_NextObjectID = 0;
 		m_TempEntity = nullptr;
 		m_TempEntityVector.clear();
+		m_CastFunctionReferences.clear();
 
 		m_OpenedFiles.fill(nullptr);
 	}
@@ -273,6 +276,94 @@ namespace RTE {
 		return result;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int LuaMan::RunReferencedFunction(int functionTableReference, const std::string &functionKey, int selfObjectReference, const std::vector<const Entity *> &functionEntityArguments, const std::vector<std::string_view> &functionLiteralArguments) {
+		// A missing function table, function or self object means there's nothing to run, same as failing the safety checks in RunScriptedFunction.
+		if (functionTableReference == c_NoReference || selfObjectReference == c_NoReference) {
+			return 0;
+		}
+		int argumentCount = 1 + static_cast<int>(functionEntityArguments.size() + functionLiteralArguments.size());
+		if (!lua_checkstack(m_MasterState, argumentCount + 3)) {
+			return -1;
+		}
+		int stackTop = lua_gettop(m_MasterState);
+
+		lua_pushcfunction(m_MasterState, &AddFileAndLineToError);
+		int errorHandlerIndex = stackTop + 1;
+
+		if (!PushReferencedFunction(functionTableReference, functionKey)) {
+			lua_settop(m_MasterState, stackTop);
+			return 0;
+		}
+
+		lua_rawgeti(m_MasterState, LUA_REGISTRYINDEX, selfObjectReference);
+		for (const Entity *functionEntityArgument : functionEntityArguments) {
+			if (!PushEntityArgument(functionEntityArgument, errorHandlerIndex)) {
+				lua_settop(m_MasterState, stackTop);
+				return -1;
+			}
+		}
+		for (const std::string_view &functionLiteralArgument : functionLiteralArguments) {
+			if (!PushLiteralArgument(functionLiteralArgument, errorHandlerIndex)) {
+				lua_settop(m_MasterState, stackTop);
+				return -1;
+			}
+		}
+
+		int error = 0;
+		if (lua_pcall(m_MasterState, argumentCount, 0, errorHandlerIndex)) {
+			m_LastError = lua_tostring(m_MasterState, -1);
+			g_ConsoleMan.PrintString("ERROR: " + m_LastError);
+			ClearErrors();
+			error = -1;
+		}
+		// Pop the error handler and any error message off the stack to clean it up
+		lua_settop(m_MasterState, stackTop);
+
+		return error;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int LuaMan::RunReferencedFunctionOnObjects(int functionTableReference, const std::string &functionKey, const std::vector<int> &objectReferences) {
+		if (functionTableReference == c_NoReference || objectReferences.empty()) {
+			return 0;
+		} else if (!lua_checkstack(m_MasterState, 4)) {
+			return -1;
+		}
+		int stackTop = lua_gettop(m_MasterState);
+
+		lua_pushcfunction(m_MasterState, &AddFileAndLineToError);
+		int errorHandlerIndex = stackTop + 1;
+
+		if (!PushReferencedFunction(functionTableReference, functionKey)) {
+			lua_settop(m_MasterState, stackTop);
+			return 0;
+		}
+
+		lua_createtable(m_MasterState, static_cast<int>(objectReferences.size()), 0);
+		int objectIndex = 1;
+		for (int objectReference : objectReferences) {
+			if (objectReference != c_NoReference) {
+				lua_rawgeti(m_MasterState, LUA_REGISTRYINDEX, objectReference);
+				lua_rawseti(m_MasterState, -2, objectIndex++);
+			}
+		}
+
+		int error = 0;
+		if (lua_pcall(m_MasterState, 1, 0, errorHandlerIndex)) {
+			m_LastError = lua_tostring(m_MasterState, -1);
+			g_ConsoleMan.PrintString("ERROR: " + m_LastError);
+			ClearErrors();
+			error = -1;
+		}
+		// Pop the error handler and any error message off the stack to clean it up
+		lua_settop(m_MasterState, stackTop);
+
+		return error;
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	int LuaMan::RunScriptString(const std::string &scriptString, bool consoleErrors) {
@@ -361,6 +452,32 @@ namespace RTE {
 		return result;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int LuaMan::CreateReference(const std::string &expression) {
+		if (expression.empty()) {
+			return c_NoReference;
+		}
+		if (luaL_loadstring(m_MasterState, std::string("return " + expression + ";").c_str()) || lua_pcall(m_MasterState, 0, 1, 0)) {
+			m_LastError = std::string("When creating reference to Lua expression: ") + lua_tostring(m_MasterState, -1);
+			lua_pop(m_MasterState, 1);
+			return c_NoReference;
+		}
+		if (lua_isnil(m_MasterState, -1)) {
+			lua_pop(m_MasterState, 1);
+			return c_NoReference;
+		}
+		// Pops the value off the stack and stores it in the registry.
+		return luaL_ref(m_MasterState, LUA_REGISTRYINDEX);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void LuaMan::ReleaseReference(int reference) {
+		// References can outlive the master state during shutdown, in which case they're already gone with it.
+		if (m_MasterState && reference != c_NoReference) { luaL_unref(m_MasterState, LUA_REGISTRYINDEX, reference); }
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void LuaMan::SavePointerAsGlobal(void *objectToSave, const std::string &globalName) {
@@ -522,6 +639,100 @@ namespace RTE {
 		return false;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool LuaMan::PushReferencedFunction(int functionTableReference, const std::string &functionKey) {
+		lua_rawgeti(m_MasterState, LUA_REGISTRYINDEX, functionTableReference);
+		if (!lua_istable(m_MasterState, -1)) {
+			lua_pop(m_MasterState, 1);
+			return false;
+		}
+		lua_getfield(m_MasterState, -1, functionKey.c_str());
+		lua_remove(m_MasterState, -2);
+		if (!lua_isfunction(m_MasterState, -1)) {
+			lua_pop(m_MasterState, 1);
+			return false;
+		}
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool LuaMan::PushEntityArgument(const Entity *entity, int errorHandlerIndex) {
+		if (!entity) {
+			lua_pushnil(m_MasterState);
+			return true;
+		}
+		std::unordered_map<std::string, int>::iterator castFunctionEntry = m_CastFunctionReferences.find(entity->GetClassName());
+		if (castFunctionEntry == m_CastFunctionReferences.end()) {
+			lua_getglobal(m_MasterState, std::string("To" + entity->GetClassName()).c_str());
+			int castFunctionReference = c_NoReference;
+			if (lua_isfunction(m_MasterState, -1)) {
+				castFunctionReference = luaL_ref(m_MasterState, LUA_REGISTRYINDEX);
+			} else {
+				lua_pop(m_MasterState, 1);
+			}
+			castFunctionEntry = m_CastFunctionReferences.try_emplace(entity->GetClassName(), castFunctionReference).first;
+		}
+
+		// Entities are passed non-const for ease-of-use in Lua, same as through the temporary entity vector.
+		luabind::object entityObject(m_MasterState, const_cast<Entity *>(entity));
+		if (castFunctionEntry->second == c_NoReference) {
+			entityObject.push(m_MasterState);
+			return true;
+		}
+		lua_rawgeti(m_MasterState, LUA_REGISTRYINDEX, castFunctionEntry->second);
+		entityObject.push(m_MasterState);
+		if (lua_pcall(m_MasterState, 1, 1, errorHandlerIndex)) {
+			m_LastError = lua_tostring(m_MasterState, -1);
+			lua_pop(m_MasterState, 1);
+			g_ConsoleMan.PrintString("ERROR: " + m_LastError);
+			ClearErrors();
+			return false;
+		}
+		// Fall back to the unconverted entity if the conversion failed, same as RunScriptedFunction does.
+		if (lua_isnil(m_MasterState, -1)) {
+			lua_pop(m_MasterState, 1);
+			entityObject.push(m_MasterState);
+		}
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool LuaMan::PushLiteralArgument(const std::string_view &literalArgument, int errorHandlerIndex) {
+		if (literalArgument == "true" || literalArgument == "false") {
+			lua_pushboolean(m_MasterState, literalArgument == "true");
+			return true;
+		} else if (literalArgument == "nil") {
+			lua_pushnil(m_MasterState);
+			return true;
+		} else if (literalArgument.size() >= 2 && literalArgument.front() == '"' && literalArgument.find('"', 1) == literalArgument.size() - 1 && literalArgument.find('\\') == std::string_view::npos) {
+			lua_pushlstring(m_MasterState, literalArgument.data() + 1, literalArgument.size() - 2);
+			return true;
+		}
+
+		std::string literalString(literalArgument);
+		if (!literalString.empty() && (std::isdigit(static_cast<unsigned char>(literalString.front())) || literalString.front() == '-' || literalString.front() == '.')) {
+			char *numberEnd = nullptr;
+			double number = std::strtod(literalString.c_str(), &numberEnd);
+			if (numberEnd == literalString.c_str() + literalString.size()) {
+				lua_pushnumber(m_MasterState, number);
+				return true;
+			}
+		}
+
+		// Anything more involved has to be evaluated, which is as slow as it always was but also pretty much never happens.
+		if (luaL_loadstring(m_MasterState, std::string("return " + literalString + ";").c_str()) || lua_pcall(m_MasterState, 0, 1, errorHandlerIndex)) {
+			m_LastError = lua_tostring(m_MasterState, -1);
+			lua_pop(m_MasterState, 1);
+			g_ConsoleMan.PrintString("ERROR: " + m_LastError);
+			ClearErrors();
+			return false;
+		}
+		return true;
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void LuaMan::Update() const {
@@ -93,6 +93,27 @@ namespace RTE {
 		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
 		int RunScriptedFunction(const std::string &functionName, const std::string &selfObjectName, const std::vector<std::string_view> &variablesToSafetyCheck = std::vector<std::string_view>(), const std::vector<const Entity *> &functionEntityArguments = std::vector<const Entity *>(), const std::vector<std::string_view> &functionLiteralArguments = std::vector<std::string_view>());
 
+		/// <summary>
+		/// Runs the function stored under the given key of a referenced table, without compiling anything. The first argument to the function will always be the referenced self object.
+		/// If either argument list has entries, they will be passed into the function in order, with entity arguments first. Entity arguments are converted to their most derived Lua type.
+		/// </summary>
+		/// <param name="functionTableReference">The reference to the table holding the function, as returned by CreateReference. If the table or function doesn't exist nothing is run.</param>
+		/// <param name="functionKey">The key the function is stored under in the table.</param>
+		/// <param name="selfObjectReference">The reference to the self object, as returned by CreateReference.</param>
+		/// <param name="functionEntityArguments">Optional vector of entity pointers that should be passed into the Lua function. Their internal Lua states will not be accessible. Defaults to empty.</param>
+		/// <param name="functionLiteralArguments">Optional vector of strings that should be passed into the Lua function. Booleans, nil, numbers and quoted strings are pushed as their native Lua types, anything else is evaluated as a Lua expression. Defaults to empty.</param>
+		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
+		int RunReferencedFunction(int functionTableReference, const std::string &functionKey, int selfObjectReference, const std::vector<const Entity *> &functionEntityArguments = std::vector<const Entity *>(), const std::vector<std::string_view> &functionLiteralArguments = std::vector<std::string_view>());
+
+		/// <summary>
+		/// Runs the function stored under the given key of a referenced table once for a batch of objects, passing it a single table with all of the referenced objects in order.
+		/// </summary>
+		/// <param name="functionTableReference">The reference to the table holding the function, as returned by CreateReference. If the table or function doesn't exist nothing is run.</param>
+		/// <param name="functionKey">The key the function is stored under in the table.</param>
+		/// <param name="objectReferences">The references to the objects to pass into the function, as returned by CreateReference. c_NoReference entries are skipped.</param>
+		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
+		int RunReferencedFunctionOnObjects(int functionTableReference, const std::string &functionKey, const std::vector<int> &objectReferences);
+
 		/// <summary>
 		/// Takes a string containing a script snippet and runs it on the master state.
 		/// </summary>
@@ -119,6 +140,19 @@ namespace RTE {
 		/// <returns>Whether the expression was true.</returns>
 		bool ExpressionIsTrue(const std::string &expression, bool consoleErrors);
 
+		/// <summary>
+		/// Evaluates a Lua expression and keeps a reference to the resulting value in the registry, so it can be pushed again later without looking it up or compiling anything.
+		/// </summary>
+		/// <param name="expression">The string with the expression to evaluate.</param>
+		/// <returns>The reference to the value, or c_NoReference if the expression failed or evaluated to nil. Must be released with ReleaseReference when no longer needed.</returns>
+		int CreateReference(const std::string &expression);
+
+		/// <summary>
+		/// Releases a reference created with CreateReference, letting the referenced value be garbage collected.
+		/// </summary>
+		/// <param name="reference">The reference to release. c_NoReference is ignored.</param>
+		void ReleaseReference(int reference);
+
 		/// <summary>
 		/// Takes a pointer to an object and saves it in the Lua state as a global of a specified variable name.
 		/// </summary>
@@ -211,6 +245,8 @@ namespace RTE {
 		void Update() const;
 #pragma endregion
 
+		static constexpr int c_NoReference = -2; //!< The value of a reference that doesn't refer to anything. Same as LUA_NOREF.
+
 	private:
 
 		static constexpr int c_MaxOpenFiles = 10; //!< The maximum number of files that can be opened with FileOpen at runtime.
@@ -226,9 +262,34 @@ namespace RTE {
 		long m_NextObjectID; //!< The next unique object ID to hand out to the next scripted Entity instance that wants to run its preset's scripts. This gets incremented each time a new one is requested to give unique ID's to all scripted objects.
 		Entity *m_TempEntity; //!< Temporary holder for an Entity object that we want to pass into the Lua state without fuss. Lets you export objects to lua easily.
 		std::vector<Entity *> m_TempEntityVector; //!< Temporary holder for a vector of Entities that we want to pass into the Lua state without a fuss. Usually used to pass arguments to special Lua functions.
+		std::unordered_map<std::string, int> m_CastFunctionReferences; //!< References to the To<ClassName> functions used to convert entity arguments to their most derived Lua type, by class name.
 
 		std::array<FILE *, c_MaxOpenFiles> m_OpenedFiles; //!< Internal list of opened files used by File functions.
 
+		/// <summary>
+		/// Pushes the function stored under the given key of a referenced table onto the Lua stack.
+		/// </summary>
+		/// <param name="functionTableReference">The reference to the table holding the function.</param>
+		/// <param name="functionKey">The key the function is stored under in the table.</param>
+		/// <returns>Whether the function exists and was pushed. If not, nothing is left on the stack.</returns>
+		bool PushReferencedFunction(int functionTableReference, const std::string &functionKey);
+
+		/// <summary>
+		/// Pushes an entity onto the Lua stack as its most derived Lua type, using the class' To<ClassName> function.
+		/// </summary>
+		/// <param name="entity">The entity to push. Ownership is NOT transferred!</param>
+		/// <param name="errorHandlerIndex">The stack index of the error handler to use if the conversion fails.</param>
+		/// <returns>Whether the entity was pushed successfully. If not, nothing is left on the stack.</returns>
+		bool PushEntityArgument(const Entity *entity, int errorHandlerIndex);
+
+		/// <summary>
+		/// Pushes a literal argument onto the Lua stack as its native Lua type.
+		/// </summary>
+		/// <param name="literalArgument">The literal to push. Booleans, nil, numbers and quoted strings are pushed directly, anything else is evaluated as a Lua expression.</param>
+		/// <param name="errorHandlerIndex">The stack index of the error handler to use if evaluating the literal fails.</param>
+		/// <returns>Whether the literal was pushed successfully. If not, nothing is left on the stack.</returns>
+		bool PushLiteralArgument(const std::string_view &literalArgument, int errorHandlerIndex);
+
 		/// <summary>
 		/// Clears all the member variables of this LuaMan, effectively resetting the members of this abstraction level only.
 		/// </summary>
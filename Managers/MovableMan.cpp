@@ -12,8 +12,11 @@
 // Inclusions of header files
 
 #include "MovableMan.h"
+#include "NetworkServer.h"
 #include "PostProcessMan.h"
 #include "PerformanceMan.h"
+#include "ThreadMan.h"
+#include "ConsoleMan.h"
 #include "PresetMan.h"
 #include "AHuman.h"
 #include "MOPixel.h"
@@ -25,6 +28,7 @@
 #include "HeldDevice.h"
 #include "ADoor.h"
 #include "Atom.h"
+#include "Scene.h"
 
 namespace RTE {
 
@@ -47,6 +51,9 @@ void MovableMan::Clear()
 {
     m_Actors.clear();
     m_Items.clear();
+    m_ActorHash.Reset();
+    m_ItemHash.Reset();
+    m_MOQueryResults.clear();
     m_Particles.clear();
     m_AddedActors.clear();
     m_AddedItems.clear();
@@ -70,6 +77,13 @@ void MovableMan::Clear()
     m_SloMoDuration = 1000;
     m_SettlingEnabled = true;
     m_MOSubtractionEnabled = true;
+    m_ParallelParticleTravelEnabled = false;
+    m_ParallelParticleTravelCheckEnabled = false;
+    m_ParticleTravelPredictions.clear();
+    m_BatchedScriptUpdatesEnabled = false;
+    m_BatchedScriptUpdateObjectIDs.clear();
+    m_ParticleStoreEnabled = false;
+    m_PromotedParticles.clear();
 }
 
 
@@ -132,9 +146,11 @@ int MovableMan::Save(Writer &writer) const
     for (deque<Actor *>::const_iterator itr = m_Actors.begin(); itr != m_Actors.end(); ++itr)
         writer << **itr;
 
-    writer << m_Particles.size();
+    writer << m_Particles.size() + m_ParticleStore.GetCount();
     for (deque<MovableObject *>::const_iterator itr2 = m_Particles.begin(); itr2 != m_Particles.end(); ++itr2)
         writer << **itr2;
+    for (size_t storeIndex = 0; storeIndex < m_ParticleStore.GetCount(); ++storeIndex)
+        writer << *m_ParticleStore.GetUpToDatePixel(storeIndex);
 
     return 0;
 }
@@ -153,6 +169,7 @@ void MovableMan::Destroy()
         delete (*it2);
     for (deque<MovableObject *>::iterator it3 = m_Particles.begin(); it3 != m_Particles.end(); ++it3)
         delete (*it3);
+    m_ParticleStore.Destroy();
 
     Clear();
 }
@@ -185,6 +202,19 @@ void MovableMan::RegisterObject(MovableObject * mo)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddToBatchedScriptUpdates
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds an MO to have its scripts' UpdateAll functions run after all the
+//                  MOs are done updating this frame.
+
+void MovableMan::AddToBatchedScriptUpdates(const MovableObject *movableObject)
+{
+    if (movableObject)
+        m_BatchedScriptUpdateObjectIDs.push_back(movableObject->GetUniqueID());
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          UnregisterObject
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -215,10 +245,15 @@ void MovableMan::PurgeAllMOs()
         delete (*it2);
     for (deque<MovableObject *>::iterator it3 = m_Particles.begin(); it3 != m_Particles.end(); ++it3)
         delete (*it3);
+    m_ParticleStore.Destroy();
+    m_PromotedParticles.clear();
 
     m_Actors.clear();
     m_Items.clear();
     m_Particles.clear();
+    m_ActorHash.Reset();
+    m_ItemHash.Reset();
+    m_MOQueryResults.clear();
     m_AddedActors.clear();
     m_AddedItems.clear();
     m_AddedParticles.clear();
@@ -539,49 +574,20 @@ Actor * MovableMan::GetClosestTeamActor(int team, int player, const Vector &scen
     Activity *pActivity = g_ActivityMan.GetActivity();
 
     float sqrShortestDistance = static_cast<float>(maxRadius * maxRadius);
-    Actor *pClosestActor = 0;
 
     // If we're looking for a noteam actor, then go through the entire actor list instead
     if (team == Activity::NoTeam)
     {
-        for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
-        {
-            if ((*aIt) == pExcludeThis || (*aIt)->GetTeam() != Activity::NoTeam) {
-                continue;
-            }
-
-            // Check if even within search radius
-            float sqrDistance = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint).GetSqrMagnitude();
-            if (sqrDistance < sqrShortestDistance)
-            {
-                sqrShortestDistance = sqrDistance;
-                pClosestActor = *aIt;
-            }
-        }
-    }
-    // A specific team, so use the rosters instead
-    else
-    {
-        for (list<Actor *>::iterator aIt = m_ActorRoster[team].begin(); aIt != m_ActorRoster[team].end(); ++aIt)
-        {
-			if ((*aIt) == pExcludeThis || (player != NoPlayer && ((*aIt)->GetController()->IsPlayerControlled(player) || (pActivity && pActivity->IsOtherPlayerBrain(*aIt, player))))) {
-				continue;
-			}
-
-            Vector distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
-
-            // Check if even within search radius
-            float sqrDistance = distanceVec.GetSqrMagnitude();
-            if (sqrDistance < sqrShortestDistance)
-            {
-                sqrShortestDistance = sqrDistance;
-                pClosestActor = *aIt;
-				getDistance.SetXY(distanceVec.GetX(), distanceVec.GetY());
-            }
-        }
+        Vector unusedDistance;
+        return FindClosestActor(scenePoint, sqrShortestDistance, false, [pExcludeThis](const Actor *pActor) { return pActor != pExcludeThis && pActor->GetTeam() == Activity::NoTeam; }, unusedDistance);
     }
-
-    return pClosestActor;
+    // A specific team, so look at the same actors the roster has, which includes the ones added this frame
+    return FindClosestActor(scenePoint, sqrShortestDistance, true, [team, player, pActivity, pExcludeThis](const Actor *pActor) {
+        if (pActor == pExcludeThis || pActor->GetTeam() != team)
+            return false;
+        Actor *pMutableActor = const_cast<Actor *>(pActor);
+        return player == NoPlayer || !(pMutableActor->GetController()->IsPlayerControlled(player) || (pActivity && pActivity->IsOtherPlayerBrain(pMutableActor, player)));
+    }, getDistance);
 }
 
 
@@ -595,30 +601,10 @@ Actor * MovableMan::GetClosestEnemyActor(int team, const Vector &scenePoint, int
 {
     if (team < Activity::NoTeam || team >= Activity::MaxTeamCount || m_Actors.empty())
         return 0;
-    
-    Activity *pActivity = g_ActivityMan.GetActivity();
-    
+
     float sqrShortestDistance = static_cast<float>(maxRadius * maxRadius);
-    Actor *pClosestActor = 0;
-    
-    for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
-    {
-        if ((*aIt)->GetTeam() == team)
-            continue;
 
-        Vector distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
-        
-        // Check if even within search radius
-        float sqrDistance = distanceVec.GetSqrMagnitude();
-        if (sqrDistance < sqrShortestDistance)
-        {
-            sqrShortestDistance = sqrDistance;
-            pClosestActor = *aIt;
-            getDistance.SetXY(distanceVec.GetX(), distanceVec.GetY());
-        }
-    }
-    
-    return pClosestActor;
+    return FindClosestActor(scenePoint, sqrShortestDistance, false, [team](const Actor *pActor) { return pActor->GetTeam() != team; }, getDistance);
 }
 
 
@@ -633,29 +619,9 @@ Actor * MovableMan::GetClosestActor(const Vector &scenePoint, int maxRadius, Vec
     if (m_Actors.empty())
         return 0;
 
-    Activity *pActivity = g_ActivityMan.GetActivity();
-
     float sqrShortestDistance = static_cast<float>(maxRadius * maxRadius);
-    Actor *pClosestActor = 0;
-
-    for (deque<Actor *>::iterator aIt = m_Actors.begin(); aIt != m_Actors.end(); ++aIt)
-    {
-        if ((*aIt) == pExcludeThis)
-            continue;
 
-        Vector distanceVec = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint);
-
-        // Check if even within search radius
-        float sqrDistance = distanceVec.GetSqrMagnitude();
-        if (sqrDistance < sqrShortestDistance)
-        {
-            sqrShortestDistance = sqrDistance;
-            pClosestActor = *aIt;
-			getDistance.SetXY(distanceVec.GetX(), distanceVec.GetY());
-        }
-    }
-
-    return pClosestActor;
+    return FindClosestActor(scenePoint, sqrShortestDistance, false, [pExcludeThis](const Actor *pActor) { return pActor != pExcludeThis; }, getDistance);
 }
 
 
@@ -673,23 +639,9 @@ Actor * MovableMan::GetClosestBrainActor(int team, const Vector &scenePoint) con
     float sqrShortestDistance = std::numeric_limits<float>::infinity();
     sqrShortestDistance *= sqrShortestDistance;
 
-    Actor *pClosestBrain = 0;
-
-    for (list<Actor *>::const_iterator aIt = m_ActorRoster[team].begin(); aIt != m_ActorRoster[team].end(); ++aIt)
-    {
-        if (!(*aIt)->HasObjectInGroup("Brains"))
-            continue;
-
-        // Check if closer than best so far
-        float sqrDistance = g_SceneMan.ShortestDistance((*aIt)->GetPos(), scenePoint).GetSqrMagnitude();
-        if (sqrDistance < sqrShortestDistance)
-        {
-            sqrShortestDistance = sqrDistance;
-            pClosestBrain = *aIt;
-        }
-    }
-
-    return pClosestBrain;
+    // Look at the same actors the team roster has, which includes the ones added this frame
+    Vector unusedDistance;
+    return FindClosestActor(scenePoint, sqrShortestDistance, true, [team](const Actor *pActor) { return pActor->GetTeam() == team && pActor->HasObjectInGroup("Brains"); }, unusedDistance);
 }
 
 
@@ -757,6 +709,74 @@ Actor * MovableMan::GetUnassignedBrain(int team) const
     return 0;
 }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all the Actors and Items whose bounding radii overlap a circle
+//                  in the scene, in the order they're in the internal lists.
+
+const std::vector<MovableObject *> & MovableMan::GetMOsInRadius(const Vector &center, float radius, int ignoreTeam)
+{
+    m_MOQueryResults.emplace_back();
+    std::vector<MovableObject *> &foundMOs = m_MOQueryResults.back();
+
+    if (AreSpatialHashesUsable())
+    {
+        m_ActorHash.GetObjectsInRadius(center, radius, foundMOs);
+        foundMOs.insert(foundMOs.end(), m_AddedActors.begin(), m_AddedActors.end());
+        m_ItemHash.GetObjectsInRadius(center, radius, foundMOs);
+        foundMOs.insert(foundMOs.end(), m_AddedItems.begin(), m_AddedItems.end());
+    }
+    else
+    {
+        foundMOs.insert(foundMOs.end(), m_Actors.begin(), m_Actors.end());
+        foundMOs.insert(foundMOs.end(), m_AddedActors.begin(), m_AddedActors.end());
+        foundMOs.insert(foundMOs.end(), m_Items.begin(), m_Items.end());
+        foundMOs.insert(foundMOs.end(), m_AddedItems.begin(), m_AddedItems.end());
+    }
+    // The hashes already did the exact check for what they found, but doing it again is cheaper than keeping track of which ones still need it
+    foundMOs.erase(std::remove_if(foundMOs.begin(), foundMOs.end(), [&center, radius, ignoreTeam](const MovableObject *pMO) {
+        return (ignoreTeam != Activity::NoTeam && pMO->GetTeam() == ignoreTeam) || !SpatialHash::OverlapsCircle(pMO, center, radius);
+    }), foundMOs.end());
+
+    return foundMOs;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOsInBox
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all the Actors and Items whose bounding radii overlap a box in
+//                  the scene, in the order they're in the internal lists.
+
+const std::vector<MovableObject *> & MovableMan::GetMOsInBox(const Box &box, int ignoreTeam)
+{
+    m_MOQueryResults.emplace_back();
+    std::vector<MovableObject *> &foundMOs = m_MOQueryResults.back();
+
+    if (AreSpatialHashesUsable())
+    {
+        m_ActorHash.GetObjectsInBox(box, foundMOs);
+        foundMOs.insert(foundMOs.end(), m_AddedActors.begin(), m_AddedActors.end());
+        m_ItemHash.GetObjectsInBox(box, foundMOs);
+        foundMOs.insert(foundMOs.end(), m_AddedItems.begin(), m_AddedItems.end());
+    }
+    else
+    {
+        foundMOs.insert(foundMOs.end(), m_Actors.begin(), m_Actors.end());
+        foundMOs.insert(foundMOs.end(), m_AddedActors.begin(), m_AddedActors.end());
+        foundMOs.insert(foundMOs.end(), m_Items.begin(), m_Items.end());
+        foundMOs.insert(foundMOs.end(), m_AddedItems.begin(), m_AddedItems.end());
+    }
+    // The hashes already did the exact check for what they found, but doing it again is cheaper than keeping track of which ones still need it
+    foundMOs.erase(std::remove_if(foundMOs.begin(), foundMOs.end(), [&box, ignoreTeam](const MovableObject *pMO) {
+        return (ignoreTeam != Activity::NoTeam && pMO->GetTeam() == ignoreTeam) || !SpatialHash::OverlapsBox(pMO, box);
+    }), foundMOs.end());
+
+    return foundMOs;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool MovableMan::AddMO(MovableObject *movableObjectToAdd) {
@@ -877,6 +897,7 @@ bool MovableMan::RemoveActor(MovableObject *pActorToRem)
             }
         }
 		RemoveActorFromTeamRoster(dynamic_cast<Actor *>(pActorToRem));
+        m_ActorHash.Remove(pActorToRem);
     }
     return removed;
 }
@@ -917,6 +938,7 @@ bool MovableMan::RemoveItem(MovableObject *pItemToRem)
                 }
             }
         }
+        m_ItemHash.Remove(pItemToRem);
     }
     return removed;
 }
@@ -1019,6 +1041,9 @@ bool MovableMan::RemoveParticle(MovableObject *pMOToRem)
                 }
             }
         }
+        // Then the ParticleStore, which gives the pixel up as a full object
+        if (!removed)
+            removed = m_ParticleStore.Remove(pMOToRem) != 0;
     }
     return removed;
 }
@@ -1061,7 +1086,7 @@ bool MovableMan::ValidMO(const MovableObject *pMOToCheck)
     {
 
         // See if this MO has been found earlier this frame
-        for (deque<pair <const MovableObject *, bool> >::iterator itr = m_ValiditySearchResults.begin(); !found && itr != m_ValiditySearchResults.end(); ++itr)
+        for (vector<pair <const MovableObject *, bool> >::iterator itr = m_ValiditySearchResults.begin(); !found && itr != m_ValiditySearchResults.end(); ++itr)
         {
             // If the MO is found to have been searched for earlier this frame, then just return the search results
             if (itr->first == pMOToCheck)
@@ -1189,6 +1214,9 @@ bool MovableMan::IsParticle(const MovableObject *pMOToCheck)
                 }
             }
         }
+        // Then the pixels in the ParticleStore
+        if (!found)
+            found = m_ParticleStore.Contains(pMOToCheck);
     }
     return found;
 }
@@ -1347,6 +1375,7 @@ int MovableMan::EjectAllActors(list<SceneObject *> &actorList, int onlyTeam, boo
     }
     // Clear the internal Actor list; we transferred the ownership of them
     m_Actors.clear();
+    m_ActorHash.Reset();
 
     // Add all Actors added this frame
     for (deque<Actor *>::iterator aIt = m_AddedActors.begin(); aIt != m_AddedActors.end(); ++aIt)
@@ -1389,6 +1418,7 @@ int MovableMan::EjectAllItems(list<SceneObject *> &itemList)
     }
     // Clear the internal Actor list; we transferred the ownership of them
     m_Items.clear();
+    m_ItemHash.Reset();
 
     // Add all Items added this frame
     for (deque<MovableObject *>::iterator iIt = m_AddedItems.begin(); iIt != m_AddedItems.end(); ++iIt)
@@ -1475,6 +1505,359 @@ void MovableMan::RedrawOverlappingMOIDs(MovableObject *pOverlapsThis)
     }
 }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EnableParticleStore
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether plain MOPixels are kept in a ParticleStore and updated
+//                  from there, instead of as full objects in the particle list.
+
+void MovableMan::EnableParticleStore(bool enable)
+{
+    m_ParticleStoreEnabled = enable;
+
+    // This may be called while the particle list is being iterated, so the pixels go in with the ones added this frame
+    if (!m_ParticleStoreEnabled)
+        m_ParticleStore.PromoteAll(m_AddedParticles);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          KeepOutOfParticleStore
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes sure a particle that something outside of MovableMan is going
+//                  to hold on to and change is never kept in the ParticleStore, where
+//                  changes made to it would be missed. Takes it out if it's stored.
+
+void MovableMan::KeepOutOfParticleStore(MovableObject *particle)
+{
+    MOPixel *pixel = dynamic_cast<MOPixel *>(particle);
+    if (!pixel || pixel->IsExternallyReferenced())
+        return;
+
+    pixel->SetExternallyReferenced();
+    // This may be called while the particle list is being iterated, so the pixel goes in with the ones added this frame
+    if (m_ParticleStore.Remove(pixel))
+        m_AddedParticles.push_back(pixel);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunParticleStoreBenchmark
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Measures how long updating a number of plain MOPixels flying around
+//                  the current Scene takes as full objects, compared to in a
+//                  ParticleStore, and prints the results to the console.
+
+void MovableMan::RunParticleStoreBenchmark(int pixelCount, int updateCount)
+{
+    if (!g_SceneMan.GetScene())
+    {
+        g_ConsoleMan.PrintString("ERROR: The ParticleStore benchmark needs a loaded Scene to run in!");
+        return;
+    }
+    // The pixels travel through the Scene for real and can settle into its terrain, which mustn't happen to a game someone is playing
+    if (g_ActivityMan.GetActivity() && !g_ActivityMan.GetActivity()->IsOver())
+    {
+        g_ConsoleMan.PrintString("ERROR: The ParticleStore benchmark changes the Scene, so it can only run once the Activity is over!");
+        return;
+    }
+    pixelCount = std::max(pixelCount, 1);
+    updateCount = std::max(updateCount, 1);
+
+    // Every measurement starts from copies of the same pixels, spread out over the air of the Scene. They never expire or settle, so only leaving the Scene gets rid of any
+    std::vector<MOPixel *> templatePixels;
+    templatePixels.reserve(pixelCount);
+    float maxPosX = static_cast<float>(g_SceneMan.GetSceneWidth() - 1);
+    float maxPosY = static_cast<float>(g_SceneMan.GetSceneHeight() - 1);
+    for (int i = 0; i < pixelCount; ++i)
+    {
+        Vector pixelPos(RandomNum(0.0F, maxPosX), RandomNum(0.0F, maxPosY));
+        for (int attempt = 0; attempt < 10 && g_SceneMan.GetTerrMatter(pixelPos.GetFloorIntX(), pixelPos.GetFloorIntY()) != g_MaterialAir; ++attempt)
+            pixelPos.SetXY(RandomNum(0.0F, maxPosX), RandomNum(0.0F, maxPosY));
+
+        MOPixel *pixel = new MOPixel(Color(g_YellowGlowColor), 0.01F, pixelPos, Vector(RandomNum(-10.0F, 10.0F), RandomNum(-10.0F, 5.0F)), new Atom(Vector(), g_MaterialSand, nullptr), 0);
+        pixel->SetToHitMOs(false);
+        pixel->SetToGetHitByMOs(false);
+        pixel->SetRestThreshold(-1);
+        templatePixels.push_back(pixel);
+    }
+    auto copyTemplatePixels = [&templatePixels]()
+    {
+        std::deque<MovableObject *> pixels;
+        for (const MOPixel *templatePixel : templatePixels)
+            pixels.push_back(dynamic_cast<MOPixel *>(templatePixel->Clone()));
+        return pixels;
+    };
+
+    // Same sequence of calls Update() puts the particle list through, minus the MOID drawing none of these pixels need
+    auto updateFullPixels = [](std::deque<MovableObject *> &pixels)
+    {
+        for (MovableObject *pixel : pixels)
+        {
+            if (!pixel->IsUpdated())
+            {
+                pixel->ApplyForces();
+                pixel->PreTravel();
+                pixel->Travel();
+                pixel->PostTravel();
+            }
+            pixel->NewFrame();
+        }
+        for (MovableObject *pixel : pixels)
+        {
+            pixel->Update();
+            pixel->UpdateScripts();
+            pixel->ApplyImpulses();
+            pixel->RestDetection();
+        }
+        std::deque<MovableObject *>::iterator deleteIt = std::partition(pixels.begin(), pixels.end(), std::not_fn(std::mem_fn(&MovableObject::ToDelete)));
+        for (std::deque<MovableObject *>::iterator pixelIt = deleteIt; pixelIt != pixels.end(); ++pixelIt)
+            delete *pixelIt;
+        pixels.erase(deleteIt, pixels.end());
+    };
+
+    auto printResult = [pixelCount, updateCount](const std::string &measurementName, long long elapsedTime, size_t remainingCount, const std::string &extraInfo)
+    {
+        g_ConsoleMan.PrintString("ParticleStore benchmark - " + measurementName + ": " + std::to_string(elapsedTime) + " us total, " + std::to_string(static_cast<double>(elapsedTime) * 1000.0 / (static_cast<double>(pixelCount) * static_cast<double>(updateCount))) +
+            " ns per pixel update, " + std::to_string(remainingCount) + " pixels left" + extraInfo);
+    };
+    g_ConsoleMan.PrintString("ParticleStore benchmark - Updating " + std::to_string(pixelCount) + " pixels " + std::to_string(updateCount) + " times per measurement.");
+
+    bool sceneWasLocked = g_SceneMan.SceneIsLocked();
+    if (!sceneWasLocked)
+        g_SceneMan.LockScene();
+
+    std::deque<MovableObject *> fullPixels = copyTemplatePixels();
+    long long startTime = g_TimerMan.GetAbsoluteTime();
+    for (int update = 0; update < updateCount; ++update)
+        updateFullPixels(fullPixels);
+    printResult("Full objects", g_TimerMan.GetAbsoluteTime() - startTime, fullPixels.size(), "");
+    for (const MovableObject *pixel : fullPixels)
+        delete pixel;
+
+    auto runStoredPixels = [&copyTemplatePixels, &updateFullPixels, &printResult, updateCount](bool parallel, const std::string &measurementName)
+    {
+        ParticleStore pixelStore;
+        for (MovableObject *pixel : copyTemplatePixels())
+            pixelStore.Add(static_cast<MOPixel *>(pixel));
+
+        // Promoted pixels go back in the store after their full update, same as in Update()
+        std::deque<MovableObject *> promotedPixels;
+        size_t promotionCount = 0;
+        long long startTime = g_TimerMan.GetAbsoluteTime();
+        for (int update = 0; update < updateCount; ++update)
+        {
+            size_t previousPromotedCount = promotedPixels.size();
+            pixelStore.Update(promotedPixels, parallel);
+            promotionCount += promotedPixels.size() - previousPromotedCount;
+            updateFullPixels(promotedPixels);
+
+            std::deque<MovableObject *>::iterator storableIt = std::stable_partition(promotedPixels.begin(), promotedPixels.end(), [](const MovableObject *pixel) { return !ParticleStore::CanStore(pixel); });
+            for (std::deque<MovableObject *>::iterator pixelIt = storableIt; pixelIt != promotedPixels.end(); ++pixelIt)
+                pixelStore.Add(static_cast<MOPixel *>(*pixelIt));
+            promotedPixels.erase(storableIt, promotedPixels.end());
+        }
+        printResult(measurementName, g_TimerMan.GetAbsoluteTime() - startTime, pixelStore.GetCount() + promotedPixels.size(), ", " + std::to_string(promotionCount) + " promotions");
+        for (const MovableObject *pixel : promotedPixels)
+            delete pixel;
+    };
+    runStoredPixels(false, "ParticleStore");
+    if (g_ThreadMan.GetWorkerCount() > 0)
+        runStoredPixels(true, "ParticleStore with parallel travel checks");
+
+    if (!sceneWasLocked)
+        g_SceneMan.UnlockScene();
+
+    for (const MOPixel *pixel : templatePixels)
+        delete pixel;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TravelParticles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Travels all the particles that haven't been updated yet this frame.
+
+void MovableMan::TravelParticles()
+{
+    m_ParticleTravelPredictions.clear();
+
+    // Pixel check visualizations are drawn to the debug layer, which can't be done from several threads at once
+    bool parallelTravel = m_ParallelParticleTravelEnabled && g_ThreadMan.GetWorkerCount() > 0 && !g_SceneMan.IsDrawingPixelCheckVisualizations();
+
+    // Stored pixels do their whole update in one go, only the ones about to hit something or settle join the particle list for the rest of the frame
+    if (m_ParticleStore.GetCount() > 0)
+    {
+        size_t firstPromotedIndex = m_Particles.size();
+        m_ParticleStore.Update(m_Particles, parallelTravel);
+        for (size_t i = firstPromotedIndex; i < m_Particles.size(); ++i)
+            m_PromotedParticles.insert(m_Particles[i]);
+    }
+
+    if (parallelTravel)
+    {
+        for (MovableObject *particle : m_Particles)
+        {
+            MOPixel *pixel = particle->IsUpdated() ? nullptr : dynamic_cast<MOPixel *>(particle);
+            if (pixel && pixel->IsTravelPredictable())
+                m_ParticleTravelPredictions.push_back({ pixel, pixel->GetPos(), Vector(), pixel->HitsMOs(), pixel->IgnoreTerrain(), false });
+        }
+
+        // Nothing gets written in here, so all the checks see the Scene exactly as it is before any particle travels
+        g_ThreadMan.ParallelFor(static_cast<int>(m_ParticleTravelPredictions.size()), 256, [this](int batchStart, int batchEnd) {
+            for (int i = batchStart; i < batchEnd; ++i)
+            {
+                ParticleTravelPrediction &prediction = m_ParticleTravelPredictions[i];
+                prediction.Velocity = prediction.Particle->GetVelocityAfterForces();
+                prediction.Unobstructed = prediction.Particle->IsTravelUnobstructed(prediction.StartPos, prediction.Velocity);
+            }
+        });
+    }
+
+    // Anything drawn onto the material or MOID layers from here on may be in the way of a prediction, so the affected particles fall back to the full Travel()
+    unsigned long obstacleDrawingCount = g_SceneMan.GetObstacleDrawingCount();
+    float deltaTime = g_TimerMan.GetDeltaTimeSecs();
+    int mismatchCount = 0;
+
+    std::vector<ParticleTravelPrediction>::const_iterator predictionItr = m_ParticleTravelPredictions.begin();
+    for (MovableObject *particle : m_Particles)
+    {
+        const ParticleTravelPrediction *prediction = nullptr;
+        if (predictionItr != m_ParticleTravelPredictions.end() && predictionItr->Particle == particle)
+        {
+            prediction = &(*predictionItr);
+            ++predictionItr;
+        }
+
+        if (!particle->IsUpdated())
+        {
+            particle->ApplyForces();
+            particle->PreTravel();
+
+            bool predictionHolds = prediction && prediction->Unobstructed && g_SceneMan.GetObstacleDrawingCount() == obstacleDrawingCount && !particle->IsTooFast() &&
+                particle->GetPos() == prediction->StartPos && particle->GetVel() == prediction->Velocity && particle->HitsMOs() == prediction->HitsMOs && particle->IgnoreTerrain() == prediction->IgnoresTerrain;
+
+            if (predictionHolds && !m_ParallelParticleTravelCheckEnabled)
+            {
+                prediction->Particle->TravelUnobstructed();
+            }
+            else
+            {
+                particle->Travel();
+
+                if (predictionHolds)
+                {
+                    Vector predictedPos = prediction->StartPos + prediction->Velocity * deltaTime * c_PPM;
+                    g_SceneMan.WrapPosition(predictedPos);
+                    if (particle->GetPos() != predictedPos || particle->GetVel() != prediction->Velocity)
+                        ++mismatchCount;
+                }
+            }
+            particle->PostTravel();
+        }
+        particle->NewFrame();
+    }
+
+    if (mismatchCount > 0)
+        g_ConsoleMan.PrintString("ERROR: " + std::to_string(mismatchCount) + " parallel particle travel predictions didn't match the serial travel this frame!");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RebuildSpatialHashes
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Refiles all Actors and Items in the spatial hashes at their current
+//                  positions, laying the hashes out over the current Scene first if
+//                  they aren't already.
+
+void MovableMan::RebuildSpatialHashes()
+{
+    if (!g_SceneMan.GetScene())
+        return;
+
+    int sceneWidth = g_SceneMan.GetSceneWidth();
+    int sceneHeight = g_SceneMan.GetSceneHeight();
+    bool wrapsX = g_SceneMan.SceneWrapsX();
+    bool wrapsY = g_SceneMan.SceneWrapsY();
+
+    if (!m_ActorHash.HasLayout(sceneWidth, sceneHeight, wrapsX, wrapsY))
+    {
+        // Cells a bit bigger than most actors, so most queries only need to look at a handful of them
+        const int cellSize = 256;
+        m_ActorHash.Create(sceneWidth, sceneHeight, wrapsX, wrapsY, cellSize);
+        m_ItemHash.Create(sceneWidth, sceneHeight, wrapsX, wrapsY, cellSize);
+    }
+    else
+    {
+        m_ActorHash.Reset();
+        m_ItemHash.Reset();
+    }
+
+    for (Actor *pActor : m_Actors)
+        m_ActorHash.Insert(pActor);
+    for (MovableObject *pItem : m_Items)
+        m_ItemHash.Insert(pItem);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AreSpatialHashesUsable
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether the spatial hashes are laid out over the current Scene
+//                  and can be used for queries.
+
+bool MovableMan::AreSpatialHashesUsable() const
+{
+    return g_SceneMan.GetScene() && m_ActorHash.HasLayout(g_SceneMan.GetSceneWidth(), g_SceneMan.GetSceneHeight(), g_SceneMan.SceneWrapsX(), g_SceneMan.SceneWrapsY());
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FindClosestActor
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds the Actor closest to a scene point out of the ones that pass a
+//                  filter, through the actor hash when it's usable.
+
+Actor * MovableMan::FindClosestActor(const Vector &scenePoint, float sqrMaxDistance, bool includeAddedActors, const std::function<bool(const Actor *)> &filter, Vector &getDistance) const
+{
+    float sqrShortestDistance = sqrMaxDistance;
+    Actor *pClosestActor = 0;
+    Vector closestDistance;
+
+    auto checkActor = [&](Actor *pActor) {
+        Vector distanceVec = g_SceneMan.ShortestDistance(pActor->GetPos(), scenePoint);
+        float sqrDistance = distanceVec.GetSqrMagnitude();
+        if (sqrDistance < sqrShortestDistance && filter(pActor))
+        {
+            sqrShortestDistance = sqrDistance;
+            pClosestActor = pActor;
+            closestDistance = distanceVec;
+        }
+    };
+
+    if (AreSpatialHashesUsable())
+    {
+        pClosestActor = static_cast<Actor *>(m_ActorHash.GetClosestObject(scenePoint, sqrMaxDistance, [&filter](const MovableObject *pMO) { return filter(static_cast<const Actor *>(pMO)); }, closestDistance));
+        if (pClosestActor)
+            sqrShortestDistance = closestDistance.GetSqrMagnitude();
+    }
+    else
+    {
+        for (Actor *pActor : m_Actors)
+            checkActor(pActor);
+    }
+
+    if (includeAddedActors)
+    {
+        for (Actor *pActor : m_AddedActors)
+            checkActor(pActor);
+    }
+
+    if (pClosestActor)
+        getDistance = closestDistance;
+    return pClosestActor;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Update
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1482,6 +1865,9 @@ void MovableMan::RedrawOverlappingMOIDs(MovableObject *pOverlapsThis)
 
 void MovableMan::Update()
 {
+    // Last update's query results have had their chance to be used, even if this update ends up paused
+    m_MOQueryResults.clear();
+
     // Don't update if paused
     if (g_ActivityMan.GetActivity() && g_ActivityMan.ActivityPaused())
         return;
@@ -1506,9 +1892,11 @@ void MovableMan::Update()
 
     // Move all last frame's alarm events into the proper buffer, and clear out the new one to fill up with this frame's
     m_AlarmEvents.clear();
-    for (list<AlarmEvent>::iterator aeItr = m_AddedAlarmEvents.begin(); aeItr != m_AddedAlarmEvents.end(); ++aeItr)
-        m_AlarmEvents.push_back(*aeItr);
-    m_AddedAlarmEvents.clear();
+    m_AlarmEvents.swap(m_AddedAlarmEvents);
+
+    // Pick up the paths requested last update, so they're ready for anyone waiting on them this update
+    if (g_SceneMan.GetScene())
+        g_SceneMan.GetScene()->CollectPathRequests();
 
     // Pre-lock Scene for all the accesses to its bitmaps
     g_SceneMan.LockScene();
@@ -1567,22 +1955,13 @@ void MovableMan::Update()
 
         // Travel particles
 		g_PerformanceMan.StartPerformanceMeasurement(PerformanceMan::ParticlesTravel);
-        {
-            for (parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt)
-            {
-                if (!((*parIt)->IsUpdated()))
-                {
-                    (*parIt)->ApplyForces();
-                    (*parIt)->PreTravel();
-                    (*parIt)->Travel();
-                    (*parIt)->PostTravel();
-                }
-                (*parIt)->NewFrame();
-            }
-        }
+        TravelParticles();
 		g_PerformanceMan.StopPerformanceMeasurement(PerformanceMan::ParticlesTravel);
 
         g_SceneMan.UnlockScene();
+
+        // Everything's where it's going to be for this frame, so file it for the proximity queries made during the updates
+        RebuildSpatialHashes();
     }
 
     ////////////////////////////////////////////////////////////////////////////
@@ -1637,6 +2016,17 @@ void MovableMan::Update()
             }
         }
 		g_PerformanceMan.StopPerformanceMeasurement(PerformanceMan::ParticlesUpdate);
+
+        // Run the batched script updates now that everything else is done updating, one call per preset script for all its instances
+        if (!m_BatchedScriptUpdateObjectIDs.empty())
+        {
+            MovableObject::RunBatchedScriptUpdates(m_BatchedScriptUpdateObjectIDs);
+            m_BatchedScriptUpdateObjectIDs.clear();
+        }
+
+        // Everything that may have requested a path this update is done, so get them solving while the rest of the frame goes on
+        if (g_SceneMan.GetScene())
+            g_SceneMan.GetScene()->DispatchPathRequests();
     }
 
     ///////////////////////////////////////////////////
@@ -1665,7 +2055,10 @@ void MovableMan::Update()
         {
             // Delete instead if it's marked for it
             if (!(*aIt)->IsSetToDelete())
+            {
                 m_Actors.push_back(*aIt);
+                m_ActorHash.Insert(*aIt);
+            }
             else
 			{
 				// Also remove actor from the roster
@@ -1682,7 +2075,10 @@ void MovableMan::Update()
         {
             // Delete instead if it's marked for it
             if (!(*iIt)->IsSetToDelete())
+            {
                 m_Items.push_back(*iIt);
+                m_ItemHash.Insert(*iIt);
+            }
             else
                 delete (*iIt);
         }
@@ -1692,12 +2088,27 @@ void MovableMan::Update()
         for (parIt = m_AddedParticles.begin(); parIt != m_AddedParticles.end(); ++parIt)
         {
             // Delete instead if it's marked for it
-            if (!(*parIt)->IsSetToDelete())
-                m_Particles.push_back(*parIt);
-            else
+            if ((*parIt)->IsSetToDelete())
                 delete (*parIt);
+            else if (m_ParticleStoreEnabled && ParticleStore::CanStore(*parIt))
+                m_ParticleStore.Add(static_cast<MOPixel *>(*parIt));
+            else
+                m_Particles.push_back(*parIt);
         }
         m_AddedParticles.clear();
+
+        // Pixels the ParticleStore promoted this frame go back in once they're done, if nothing happened to them that needs them to stay full objects
+        if (!m_PromotedParticles.empty())
+        {
+            if (m_ParticleStoreEnabled)
+            {
+                parIt = stable_partition(m_Particles.begin(), m_Particles.end(), [this](const MovableObject *particle) { return m_PromotedParticles.find(particle) == m_PromotedParticles.end() || !ParticleStore::CanStore(particle); });
+                for (midIt = parIt; parIt != m_Particles.end(); ++parIt)
+                    m_ParticleStore.Add(static_cast<MOPixel *>(*parIt));
+                m_Particles.erase(midIt, m_Particles.end());
+            }
+            m_PromotedParticles.clear();
+        }
     }
 
     ////////////////////////////////////////////////////////////////////////////
@@ -1722,6 +2133,7 @@ void MovableMan::Update()
 
                 // Add to the particles list
                 m_Particles.push_back(*aIt);
+                m_ActorHash.Remove(*aIt);
                 // Remove from the team roster
 
                 if ((*aIt)->GetTeam() >= 0)
@@ -1748,6 +2160,7 @@ void MovableMan::Update()
 				// Disable TDExplosive's immunity to settling
 				if ((*iIt)->GetRestThreshold()< 0)
 					(*iIt)->SetRestThreshold(500);
+                m_ItemHash.Remove(*iIt);
                 m_Particles.push_back(*(iIt++));
             }
             m_Items.erase(imidIt, m_Items.end());
@@ -1777,6 +2190,7 @@ void MovableMan::Update()
 				RemoveActorFromTeamRoster(*aIt);
 
             // Delete
+            m_ActorHash.Remove(*aIt);
             delete *aIt;
             aIt++;
         }
@@ -1789,7 +2203,10 @@ void MovableMan::Update()
         imidIt = iIt;
 
         while (iIt != m_Items.end())
+        {
+            m_ItemHash.Remove(*iIt);
             delete *(iIt++);
+        }
         m_Items.erase(imidIt, m_Items.end());
 
         // Particles
@@ -1858,9 +2275,9 @@ void MovableMan::Update()
 
 
     ////////////////////////////////////////////////////////////////////
-    // Draw the MO colors ONLY if this is a drawn update!
+    // Draw the MO colors ONLY if this is a drawn update! Clients that are sent the entity states draw the MOs themselves, so nobody would ever see them then.
 
-    if (g_TimerMan.DrawnSimUpdate())
+    if (g_TimerMan.DrawnSimUpdate() && !(g_FrameMan.IsInMultiplayerMode() && g_NetworkServer.ReplicatesEntityState()))
         Draw(g_SceneMan.GetMOColorBitmap());
 
     // Sort team rosters if necessary
@@ -1891,6 +2308,8 @@ void MovableMan::DrawMatter(BITMAP *pTargetBitmap, Vector &targetPos)
 
     for (deque<MovableObject *>::iterator parIt = --m_Particles.end(); parIt != --m_Particles.begin(); --parIt)
         (*parIt)->Draw(pTargetBitmap, targetPos, g_DrawMaterial);
+
+    m_ParticleStore.Draw(pTargetBitmap, targetPos, true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1995,6 +2414,9 @@ void MovableMan::UpdateDrawMOIDs(BITMAP *pTargetBitmap)
 void MovableMan::Draw(BITMAP *pTargetBitmap, const Vector &targetPos)
 {
     // Draw objects to accumulation bitmap, in reverse order so actors appear on top.
+    if (g_TimerMan.DrawnSimUpdate())
+        m_ParticleStore.Draw(pTargetBitmap, targetPos, false);
+
     for (deque<MovableObject *>::iterator parIt = m_Particles.begin(); parIt != m_Particles.end(); ++parIt)
         (*parIt)->Draw(pTargetBitmap, targetPos);
 
@@ -20,6 +20,8 @@
 #include "SceneMan.h"
 #include "LuaMan.h"
 #include "Singleton.h"
+#include "ParticleStore.h"
+#include "SpatialHash.h"
 
 #define g_MovableMan MovableMan::Instance()
 
@@ -32,6 +34,7 @@ class HeldDevice;
 class MOPixel;
 class AHuman;
 class SceneLayer;
+class Box;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -64,6 +67,7 @@ struct AlarmEvent {
 
 class MovableMan : public Singleton<MovableMan>, public Serializable {
 	friend class SettingsMan;
+	friend class NetworkServer;
     friend struct ManagerLuaBindings;
 
 
@@ -370,6 +374,33 @@ public:
     Actor * GetUnassignedBrain(int team = 0) const;
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOsInRadius
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all the Actors and Items whose bounding radii overlap a circle
+//                  in the scene, in the order they're in the internal lists.
+// Arguments:       The center of the circle in the scene.
+//                  The radius of the circle.
+//                  A team whose MOs should be left out. NoTeam means none are.
+// Return value:    A list of the found MOs, valid until the start of the next Update.
+//                  OWNERSHIP IS NOT TRANSFERRED!
+
+    const std::vector<MovableObject *> & GetMOsInRadius(const Vector &center, float radius, int ignoreTeam = Activity::NoTeam);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetMOsInBox
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets all the Actors and Items whose bounding radii overlap a box in
+//                  the scene, in the order they're in the internal lists.
+// Arguments:       The box in the scene.
+//                  A team whose MOs should be left out. NoTeam means none are.
+// Return value:    A list of the found MOs, valid until the start of the next Update.
+//                  OWNERSHIP IS NOT TRANSFERRED!
+
+    const std::vector<MovableObject *> & GetMOsInBox(const Box &box, int ignoreTeam = Activity::NoTeam);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetParticleCount
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -377,7 +408,7 @@ public:
 // Arguments:       None.
 // Return value:    The number of particles.
 
-    long GetParticleCount() const { return m_Particles.size(); }
+    long GetParticleCount() const { return m_Particles.size() + m_ParticleStore.GetCount(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -682,7 +713,7 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Gets the list of AlarmEvent:s from last frame's update.
 // Arguments:       None.
-// Return value:    The const list of AlarmEvent:s.
+// Return value:    The const list of AlarmEvent:s. It's refilled every update.
 
     const std::list<AlarmEvent> & GetAlarmEvents() const { return m_AlarmEvents; }
 
@@ -742,6 +773,129 @@ public:
     bool IsMOSubtractionEnabled() { return m_MOSubtractionEnabled; }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsParallelParticleTravelEnabled
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether the collision checks of particle travel are spread
+//                  over the ThreadMan worker threads.
+// Arguments:       None.
+// Return value:    Whether enabled or not.
+
+    bool IsParallelParticleTravelEnabled() const { return m_ParallelParticleTravelEnabled; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EnableParallelParticleTravel
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether the collision checks of particle travel are spread over
+//                  the ThreadMan worker threads.
+// Arguments:       Whether to enable or not.
+// Return value:    None.
+
+    void EnableParallelParticleTravel(bool enable = true) { m_ParallelParticleTravelEnabled = enable; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsBatchedScriptUpdatesEnabled
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether scripts that define an UpdateAll function get it called
+//                  once per frame with all their instances, instead of having Update
+//                  called on each instance separately.
+// Arguments:       None.
+// Return value:    Whether enabled or not.
+
+    bool IsBatchedScriptUpdatesEnabled() const { return m_BatchedScriptUpdatesEnabled; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EnableBatchedScriptUpdates
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether scripts that define an UpdateAll function get it called
+//                  once per frame with all their instances, instead of having Update
+//                  called on each instance separately.
+// Arguments:       Whether to enable or not.
+// Return value:    None.
+
+    void EnableBatchedScriptUpdates(bool enable = true) { m_BatchedScriptUpdatesEnabled = enable; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AddToBatchedScriptUpdates
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Adds an MO to have its scripts' UpdateAll functions run after all the
+//                  MOs are done updating this frame. Only for MOs directly updated by
+//                  this MovableMan. It's kept track of by its unique ID, so it's simply
+//                  skipped if it gets deleted before the batched updates run.
+// Arguments:       The MO to add. Ownership is NOT transferred!
+// Return value:    None.
+
+    void AddToBatchedScriptUpdates(const MovableObject *movableObject);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsParticleStoreEnabled
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Shows whether plain MOPixels are kept in a ParticleStore and updated
+//                  from there, instead of as full objects in the particle list.
+// Arguments:       None.
+// Return value:    Whether enabled or not.
+
+    bool IsParticleStoreEnabled() const { return m_ParticleStoreEnabled; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          EnableParticleStore
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Sets whether plain MOPixels are kept in a ParticleStore and updated
+//                  from there, instead of as full objects in the particle list.
+//                  Disabling it moves all the stored pixels back to the particle list.
+// Arguments:       Whether to enable or not.
+// Return value:    None.
+
+    void EnableParticleStore(bool enable = true);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          KeepOutOfParticleStore
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Makes sure a particle that something outside of MovableMan is going
+//                  to hold on to and change is never kept in the ParticleStore, where
+//                  changes made to it would be missed. Takes it out if it's stored.
+// Arguments:       The particle to keep out. Ownership is NOT transferred!
+// Return value:    None.
+
+    void KeepOutOfParticleStore(MovableObject *particle);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunParticleStoreBenchmark
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Measures how long updating a number of plain MOPixels flying around
+//                  the current Scene takes as full objects, compared to in a
+//                  ParticleStore, and prints the results to the console. The pixels can
+//                  change the Scene, so this refuses to run until the Activity is over.
+// Arguments:       The number of pixels to update.
+//                  The number of sim updates to run them for.
+// Return value:    None.
+
+    void RunParticleStoreBenchmark(int pixelCount = 50000, int updateCount = 100);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunParticleKernelBenchmark
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Measures how long applying forces, integrating and checking for rest
+//                  takes for a number of plain MOPixels through the ParticleStore's SIMD
+//                  and scalar kernels, compared to through each MOPixel object, and
+//                  prints the results to the console. The MOPixel objects can change the
+//                  Scene, so this refuses to run until the Activity is over.
+// Arguments:       The number of pixels to process.
+//                  The number of times to process all the pixels in each measurement.
+// Return value:    None.
+
+    void RunParticleKernelBenchmark(int pixelCount = 50000, int iterationCount = 1000) { ParticleStore::RunKernelBenchmark(pixelCount, iterationCount); }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          RedrawOverlappingMOIDs
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -900,7 +1054,7 @@ protected:
     // Optimization implementation
     // MO's that have already been asked whether they exist in the manager this frame, and the search result.
     // Gets cleaned out each frame. Does NOT own any instances.
-    std::deque<std::pair<const MovableObject *, bool> > m_ValiditySearchResults;
+    std::vector<std::pair<const MovableObject *, bool> > m_ValiditySearchResults;
 
     // The alarm events on the scene where something alarming happened, for use with AI firings awareness os they react to shots fired etc.
     // This is the last frame's events, is the one for Actors to poll for events, should be cleaned out and refilled each frame.
@@ -929,6 +1083,42 @@ protected:
     // Whtehr MO's vcanng et subtracted form the terrain at all
     bool m_MOSubtractionEnabled;
 
+    // Whether the collision checks of particle travel are spread over the ThreadMan worker threads
+    bool m_ParallelParticleTravelEnabled;
+    // Whether to verify parallel particle travel predictions against the regular serial travel instead of using them. Slow, for debugging only
+    bool m_ParallelParticleTravelCheckEnabled;
+
+    // A particle travel that was checked ahead of time by the ThreadMan worker threads
+    struct ParticleTravelPrediction {
+        MOPixel *Particle; // The predicted particle. Not owned
+        Vector StartPos; // The position the travel was checked from
+        Vector Velocity; // The velocity, with forces applied, that the travel was checked with
+        bool HitsMOs; // Whether the particle hit MOs when the travel was checked
+        bool IgnoresTerrain; // Whether the particle ignored terrain when the travel was checked
+        bool Unobstructed; // Whether the checked travel doesn't hit anything
+    };
+    // The predictions made for this frame's particle travel. Kept around so it doesn't need to be reallocated every frame
+    std::vector<ParticleTravelPrediction> m_ParticleTravelPredictions;
+
+    // Whether scripts that define an UpdateAll function get it called once per frame with all their instances, instead of Update on each instance
+    bool m_BatchedScriptUpdatesEnabled;
+    // The unique IDs of the MOs waiting to have their scripts' UpdateAll functions run this frame, in update order
+    std::vector<unsigned long int> m_BatchedScriptUpdateObjectIDs;
+
+    // Whether plain MOPixels are kept in the ParticleStore instead of the particle list
+    bool m_ParticleStoreEnabled;
+    // The plain MOPixels that nothing but the Scene can affect, updated all at once without going through their objects
+    ParticleStore m_ParticleStore;
+    // The pixels the ParticleStore promoted to the particle list this frame, to be put back in it once they're done. Not owned
+    std::unordered_set<const MovableObject *> m_PromotedParticles;
+
+    // The Actors in the actor list, sorted by position for the proximity queries. Rebuilt after each frame's travel and kept up with the list until the next
+    SpatialHash m_ActorHash;
+    // The Items in the item list, sorted by position for the proximity queries. Kept up the same way as the actor hash
+    SpatialHash m_ItemHash;
+    // The results of this frame's radius and box queries. Kept around until the start of the next Update so Lua can iterate them
+    std::deque<std::vector<MovableObject *>> m_MOQueryResults;
+
 	unsigned int m_SimUpdateFrameNumber;
 
 	// Global map which stores all objects so they could be foud by their unique ID
@@ -942,6 +1132,61 @@ private:
 
 	static const std::string c_ClassName; //!< A string with the friendly-formatted type name of this object.
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TravelParticles
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Travels all the particles that haven't been updated yet this frame.
+//                  If enabled, the collision checks of MOPixels are done ahead of time
+//                  on the ThreadMan worker threads, and only the MOPixels found to hit
+//                  something get the full serial Travel(). All changes to the Scene are
+//                  still made on the calling thread, in the same order as without
+//                  threading. The Scene MUST BE LOCKED before calling this!
+// Arguments:       None.
+// Return value:    None.
+
+    void TravelParticles();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RebuildSpatialHashes
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Refiles all Actors and Items in the spatial hashes at their current
+//                  positions, laying the hashes out over the current Scene first if
+//                  they aren't already.
+// Arguments:       None.
+// Return value:    None.
+
+    void RebuildSpatialHashes();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          AreSpatialHashesUsable
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Tells whether the spatial hashes are laid out over the current Scene
+//                  and can be used for queries.
+// Arguments:       None.
+// Return value:    Whether the spatial hashes can be used.
+
+    bool AreSpatialHashesUsable() const;
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FindClosestActor
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Finds the Actor closest to a scene point out of the ones that pass a
+//                  filter, through the actor hash when it's usable. Ties go to the Actor
+//                  that comes first in the actor list, then the added actor list.
+// Arguments:       The Scene point to search for the closest to.
+//                  The squared distance Actors have to be strictly closer than.
+//                  Whether to also search the Actors added this frame.
+//                  The function that decides whether an Actor may be found.
+//                  A Vector to be filled out with the distance of the returned closest to
+//                  the search point. Will be unaltered if no Actor was found.
+// Return value:    The closest Actor that passed the filter, or 0 if none did.
+
+    Actor * FindClosestActor(const Vector &scenePoint, float sqrMaxDistance, bool includeAddedActors, const std::function<bool(const Actor *)> &filter, Vector &getDistance) const;
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Clear
 //////////////////////////////////////////////////////////////////////////////////////////
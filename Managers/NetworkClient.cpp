@@ -5,6 +5,8 @@
 #include "SettingsMan.h"
 #include "PerformanceMan.h"
 #include "UInputMan.h"
+#include "PresetMan.h"
+#include "MOSprite.h"
 
 #include "RakSleep.h"
 
@@ -17,6 +19,10 @@ namespace RTE {
 
 	void NetworkClient::Clear() {
 		m_LastInputSentTime = 0;
+		m_LastKeyframeRequestTime = 0;
+		m_TerrainChangeSequence = 0;
+		m_FrameBoxRevisions[0].clear();
+		m_FrameBoxRevisions[1].clear();
 		m_ReceivedData = 0;
 		m_CompressedData = 0;
 		m_IsConnected = false;
@@ -33,6 +39,16 @@ namespace RTE {
 		m_IsNATPunched = false;
 		m_ActiveBackgroundLayers = 0;
 		m_SceneWrapsX = false;
+		m_ReplicatesEntityState = false;
+		m_EntityPresets.clear();
+		m_EntitySnapshots.clear();
+		m_LastEntitySnapshot = 0;
+		m_LastEntitySnapshotReceiveTime = 0;
+		m_EntityRenderTime = 0;
+		m_LastEntityDrawTime = 0;
+		m_EntityDrawCount = 0;
+		m_CosmeticParticles.clear();
+		m_EntityFlipBitmap = 0;
 
 		for (int f = 0; f < c_FramesToRemember; f++) {
 			m_TargetPos[f].Reset();
@@ -247,6 +263,8 @@ namespace RTE {
 		msg.InputElementPressed = 0;
 		msg.InputElementReleased = 0;
 
+		msg.LastEntitySnapshot = m_LastEntitySnapshot;
+
 		msg.ResetActivityVote = g_UInputMan.KeyHeld(KEY_BACKSPACE) ? true : false;
 		msg.RestartActivityVote = g_UInputMan.KeyHeld(KEY_BACKSLASH) ? true : false;
 
@@ -355,8 +373,26 @@ namespace RTE {
 		m_CompressedData += frameData->UncompressedSize;
 
 		if (bpx + maxWidth - 1 < bmp->w && bpy + maxHeight - 1 < bmp->h && bpx >= 0 && bpy >= 0) {
+			std::unordered_map<unsigned int, unsigned short> &boxRevisions = m_FrameBoxRevisions[frameData->Layer];
+			unsigned int boxKey = (static_cast<unsigned int>(bpy) << 16) | static_cast<unsigned int>(bpx);
+			std::unordered_map<unsigned int, unsigned short>::iterator boxRevision = boxRevisions.find(boxKey);
+
+			// Deltas only make sense against the revision right before them, and unchanged boxes against their own. Anything else means some of the box went missing on the way.
+			if (frameData->Encoding != FrameBoxKeyframe) {
+				unsigned short expectedRevision = (frameData->Encoding == FrameBoxDelta) ? static_cast<unsigned short>(frameData->Revision - 1) : frameData->Revision;
+				if (boxRevision == boxRevisions.end() || boxRevision->second != expectedRevision) {
+					if (boxRevision != boxRevisions.end()) { boxRevisions.erase(boxRevision); }
+					SendKeyframeRequestMsg();
+					release_bitmap(bmp);
+					return;
+				}
+			}
+			boxRevisions[boxKey] = frameData->Revision;
+
 			// Unpack box
-			if (frameData->DataSize == 0) {
+			if (frameData->Encoding == FrameBoxUnchanged) {
+				// Nothing to do, the box already holds this revision.
+			} else if (frameData->DataSize == 0) {
 				//memset(bmp->line[lineNumber], g_MaskColor, bmp->w);
 				rectfill(bmp, bpx, bpy, bpx + maxWidth - 1, bpy + maxHeight - 1, g_MaskColor);
 			} else {
@@ -371,14 +407,21 @@ namespace RTE {
 				} else {
 					LZ4_decompress_safe((char *)(packet->data + sizeof(MsgFrameBox)), (char *)(m_PixelLineBuffer), size, frameData->UncompressedSize);
 				}
-				// Copy box to bitmap line by line
+				// Copy box to bitmap line by line, or XOR the changes into it if it's a delta
 				const unsigned char *lineAddr = m_PixelLineBuffer;
 				for (int y = 0; y < maxHeight; y++) {
+					if (frameData->Encoding == FrameBoxDelta) {
+						unsigned char *pixel = bmp->line[bpy + y] + bpx;
+						for (int x = 0; x < maxWidth; x++) {
+							pixel[x] ^= lineAddr[x];
+						}
+					} else {
 #ifdef _WIN32
-					memcpy_s(bmp->line[bpy + y] + bpx, maxWidth, lineAddr, maxWidth);
+						memcpy_s(bmp->line[bpy + y] + bpx, maxWidth, lineAddr, maxWidth);
 #else
-					memcpy(bmp->line[bpy + y] + bpx, lineAddr, maxWidth);
+						memcpy(bmp->line[bpy + y] + bpx, lineAddr, maxWidth);
 #endif
+					}
 
 					lineAddr += maxWidth;
 				}
@@ -391,6 +434,20 @@ namespace RTE {
 		release_bitmap(bmp);
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::SendKeyframeRequestMsg() {
+		long long currentTicks = g_TimerMan.GetRealTickCount();
+		if (currentTicks - m_LastKeyframeRequestTime >= 0 && static_cast<double>(currentTicks - m_LastKeyframeRequestTime) / static_cast<double>(g_TimerMan.GetTicksPerSecond()) < c_KeyframeRequestInterval) {
+			return;
+		}
+		m_LastKeyframeRequestTime = currentTicks;
+
+		MsgKeyframeRequest msg;
+		msg.Id = ID_CLT_KEYFRAME_REQUEST;
+		m_Client->Send((const char *)&msg, sizeof(msg), HIGH_PRIORITY, RELIABLE, 0, m_ServerID, false);
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkClient::SendSceneAcceptedMsg() {
@@ -453,6 +510,9 @@ namespace RTE {
 	void NetworkClient::ReceiveSceneSetupMsg(RakNet::Packet *packet) {
 		clear_to_color(g_FrameMan.GetNetworkBackBufferIntermediateGUI8Ready(0), g_MaskColor);
 		clear_to_color(g_FrameMan.GetNetworkBackBufferGUI8Ready(0), g_MaskColor);
+		m_FrameBoxRevisions[0].clear();
+		m_FrameBoxRevisions[1].clear();
+		m_TerrainChangeSequence = 0;
 
 		const MsgSceneSetup *frameData = (MsgSceneSetup *)packet->data;
 
@@ -471,6 +531,14 @@ namespace RTE {
 		m_SceneWidth = frameData->Width;
 		m_SceneHeight = frameData->Height;
 
+		m_ReplicatesEntityState = frameData->ReplicatesEntityState;
+		m_EntityPresets.assign(1, nullptr);
+		m_EntitySnapshots.clear();
+		m_LastEntitySnapshot = 0;
+		m_LastEntityDrawTime = 0;
+		m_EntityDrawCount = 0;
+		m_CosmeticParticles.clear();
+
 		m_ActiveBackgroundLayers = frameData->BackgroundLayerCount;
 
 		for (int i = 0; i < m_ActiveBackgroundLayers; i++) {
@@ -524,38 +592,255 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkClient::ReceiveTerrainChangeMsg(RakNet::Packet *packet) {
-		const MsgTerrainChange *frameData = (MsgTerrainChange *)packet->data;
-		if (frameData->SceneId != m_SceneID) {
+		const MsgTerrainChangeBatch *msg = (MsgTerrainChangeBatch *)packet->data;
+		if (msg->SceneId != m_SceneID || packet->length < sizeof(MsgTerrainChangeBatch) + msg->DataSize) {
 			return;
 		}
+		if (msg->Sequence != m_TerrainChangeSequence) {
+			g_ConsoleMan.PrintString("CLIENT: Terrain change batch " + std::to_string(msg->Sequence) + " received when expecting " + std::to_string(m_TerrainChangeSequence));
+			if (msg->Sequence < m_TerrainChangeSequence) {
+				return;
+			}
+		}
+		m_TerrainChangeSequence = msg->Sequence + 1;
 
-		if (frameData->W == 1 && frameData->H == 1) {
-			BITMAP *bmp = 0;
-			bmp = frameData->Back ? m_SceneBackgroundBitmap : m_SceneForegroundBitmap;
-			putpixel(bmp, frameData->X, frameData->Y, frameData->Color);
-		} else {
-			int size = frameData->UncompressedSize;
+		const unsigned char *runLengthData = packet->data + sizeof(MsgTerrainChangeBatch);
+		if (msg->DataSize != msg->RunLengthSize) {
+			m_TerrainChangeRunLengthBuffer.resize(msg->RunLengthSize);
+			if (LZ4_decompress_safe((const char *)runLengthData, (char *)m_TerrainChangeRunLengthBuffer.data(), msg->DataSize, msg->RunLengthSize) != static_cast<int>(msg->RunLengthSize)) {
+				return;
+			}
+			runLengthData = m_TerrainChangeRunLengthBuffer.data();
+		}
+		m_TerrainChangeRawBuffer.resize(msg->RawSize);
+		if (!RunLengthDecode(runLengthData, msg->RunLengthSize, m_TerrainChangeRawBuffer.data(), msg->RawSize)) {
+			return;
+		}
 
-			if (frameData->DataSize == frameData->UncompressedSize) {
-#ifdef _WIN32
-				memcpy_s(m_PixelLineBuffer, size, packet->data + sizeof(MsgTerrainChange), size);
-#else
-				memcpy(m_PixelLineBuffer, packet->data + sizeof(MsgTerrainChange), size);
-#endif
+		// Check every region fits before changing anything, so a bad batch can't leave the scene half changed.
+		size_t regionsSize = sizeof(TerrainChangeRegion) * static_cast<size_t>(msg->RegionCount);
+		if (regionsSize > msg->RawSize) {
+			return;
+		}
+		const TerrainChangeRegion *regions = (const TerrainChangeRegion *)m_TerrainChangeRawBuffer.data();
+		size_t pixelCount = 0;
+		for (unsigned int i = 0; i < msg->RegionCount; i++) {
+			const BITMAP *bmp = regions[i].Back ? m_SceneBackgroundBitmap : m_SceneForegroundBitmap;
+			if (!bmp || regions[i].X + regions[i].W > bmp->w || regions[i].Y + regions[i].H > bmp->h) {
+				return;
+			}
+			pixelCount += static_cast<size_t>(regions[i].W) * static_cast<size_t>(regions[i].H);
+		}
+		if (regionsSize + pixelCount != msg->RawSize) {
+			return;
+		}
+
+		// Copy bitmap data to scene bitmap
+		const unsigned char *src = m_TerrainChangeRawBuffer.data() + regionsSize;
+		for (unsigned int i = 0; i < msg->RegionCount; i++) {
+			const BITMAP *bmp = regions[i].Back ? m_SceneBackgroundBitmap : m_SceneForegroundBitmap;
+			for (int y = 0; y < regions[i].H; y++) {
+				memcpy(bmp->line[regions[i].Y + y] + regions[i].X, src, regions[i].W);
+				src += regions[i].W;
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool NetworkClient::RunLengthDecode(const unsigned char *encodedData, size_t encodedDataSize, unsigned char *data, size_t dataSize) {
+		size_t readPosition = 0;
+		size_t writePosition = 0;
+		while (readPosition < encodedDataSize) {
+			unsigned char control = encodedData[readPosition++];
+			if (control < 128) {
+				size_t literalLength = static_cast<size_t>(control) + 1;
+				if (readPosition + literalLength > encodedDataSize || writePosition + literalLength > dataSize) {
+					return false;
+				}
+				memcpy(data + writePosition, encodedData + readPosition, literalLength);
+				readPosition += literalLength;
+				writePosition += literalLength;
 			} else {
-				LZ4_decompress_safe((char *)(packet->data + sizeof(MsgTerrainChange)), (char *)m_PixelLineBuffer, frameData->DataSize, size);
+				size_t runLength = static_cast<size_t>(control) - 125;
+				if (readPosition >= encodedDataSize || writePosition + runLength > dataSize) {
+					return false;
+				}
+				memset(data + writePosition, encodedData[readPosition++], runLength);
+				writePosition += runLength;
+			}
+		}
+		return writePosition == dataSize;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::ReceiveEntityPresetsMsg(RakNet::Packet *packet) {
+		const MsgEntityPresets *msg = (MsgEntityPresets *)packet->data;
+		// Every preset takes at least the two null terminators of its names, so a message can't claim more presets than half its size.
+		if (packet->length < sizeof(MsgEntityPresets) || packet->length - sizeof(MsgEntityPresets) < msg->DataSize || msg->FirstIndex == 0 || msg->Count > msg->DataSize / 2 || msg->Count > c_MaxEntityPresets || msg->FirstIndex > c_MaxEntityPresets + 1 - msg->Count) {
+			return;
+		}
+		// Presets are numbered from 1 and sent in order, but the server starts over from 1 when a scene starts, so a batch may overwrite ones from the last scene that arrived after this one started.
+		if (m_EntityPresets.size() < msg->FirstIndex + msg->Count) { m_EntityPresets.resize(msg->FirstIndex + msg->Count, nullptr); }
+
+		const char *names = (const char *)(packet->data + sizeof(MsgEntityPresets));
+		const char *namesEnd = names + msg->DataSize;
+		auto readName = [&names, namesEnd](std::string &name) {
+			const char *nameEnd = std::find(names, namesEnd, '\0');
+			if (nameEnd == namesEnd) {
+				return false;
+			}
+			name.assign(names, nameEnd);
+			names = nameEnd + 1;
+			return true;
+		};
+
+		std::string className;
+		std::string presetName;
+		for (unsigned int i = 0; i < msg->Count; i++) {
+			if (!readName(className) || !readName(presetName)) {
+				break;
+			}
+			m_EntityPresets[msg->FirstIndex + i] = dynamic_cast<const MOSprite *>(g_PresetMan.GetEntityPreset(className, presetName));
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::ReceiveEntitySnapshotMsg(RakNet::Packet *packet) {
+		const MsgEntitySnapshot *msg = (MsgEntitySnapshot *)packet->data;
+		if (!m_ReplicatesEntityState || packet->length < sizeof(MsgEntitySnapshot) || packet->length - sizeof(MsgEntitySnapshot) < msg->DataSize || msg->SceneId != m_SceneID || msg->Sequence <= m_LastEntitySnapshot) {
+			return;
+		}
+		const EntitySnapshot *baseSnapshot = nullptr;
+		if (msg->BaseSequence != 0) {
+			for (const EntitySnapshot &entitySnapshot : m_EntitySnapshots) {
+				if (entitySnapshot.Sequence == msg->BaseSequence) { baseSnapshot = &entitySnapshot; }
+			}
+			// The server only sends deltas against snapshots that were acked, but the scene may have started over since.
+			if (!baseSnapshot) {
+				return;
+			}
+		}
+
+		const unsigned char *data = packet->data + sizeof(MsgEntitySnapshot);
+		if (msg->DataSize != msg->RawSize) {
+			m_EntitySnapshotBuffer.resize(msg->RawSize);
+			if (LZ4_decompress_safe((const char *)data, (char *)m_EntitySnapshotBuffer.data(), msg->DataSize, msg->RawSize) != static_cast<int>(msg->RawSize)) {
+				return;
+			}
+			data = m_EntitySnapshotBuffer.data();
+		}
+		const unsigned char *dataEnd = data + msg->RawSize;
+		if (msg->RemovedCount > msg->RawSize / sizeof(unsigned int) || msg->OrderCount > msg->RawSize / sizeof(unsigned int) - msg->RemovedCount) {
+			return;
+		}
+
+		EntitySnapshot entitySnapshot;
+		entitySnapshot.Sequence = msg->Sequence;
+		entitySnapshot.ServerTime = msg->ServerTime;
+		entitySnapshot.GlobalAcc.SetXY(msg->GlobalAccX, msg->GlobalAccY);
+
+		std::unordered_map<unsigned int, size_t> stateIndices;
+		if (baseSnapshot) {
+			std::unordered_set<unsigned int> removedIDs;
+			for (unsigned int i = 0; i < msg->RemovedCount; i++) {
+				unsigned int removedID;
+				memcpy(&removedID, data, sizeof(removedID));
+				data += sizeof(removedID);
+				removedIDs.insert(removedID);
+			}
+			entitySnapshot.States.reserve(baseSnapshot->States.size() + msg->StateCount);
+			for (const EntityStateNetworkData &baseState : baseSnapshot->States) {
+				if (removedIDs.find(baseState.UniqueID) == removedIDs.end()) {
+					stateIndices.try_emplace(baseState.UniqueID, entitySnapshot.States.size());
+					entitySnapshot.States.emplace_back(baseState);
+				}
+			}
+		} else {
+			data += msg->RemovedCount * sizeof(unsigned int);
+			entitySnapshot.States.reserve(msg->StateCount);
+		}
+		const unsigned char *orderData = data;
+		data += msg->OrderCount * sizeof(unsigned int);
+
+		for (unsigned int i = 0; i < msg->StateCount; i++) {
+			if (dataEnd - data < static_cast<std::ptrdiff_t>(sizeof(unsigned int) + sizeof(unsigned char))) {
+				return;
+			}
+			EntityStateNetworkData newState = {};
+			memcpy(&newState.UniqueID, data, sizeof(newState.UniqueID));
+			data += sizeof(newState.UniqueID);
+			unsigned char fields = *data++;
+
+			std::pair<std::unordered_map<unsigned int, size_t>::iterator, bool> stateIndex = stateIndices.try_emplace(newState.UniqueID, entitySnapshot.States.size());
+			if (stateIndex.second) { entitySnapshot.States.emplace_back(newState); }
+			if (!ReadEntityStateFields(data, dataEnd, fields, entitySnapshot.States[stateIndex.first->second])) {
+				return;
 			}
+		}
+		if (data != dataEnd) {
+			return;
+		}
 
-			// Copy bitmap data to scene bitmap
-			const BITMAP *bmp = 0;
-			bmp = (frameData->Back) ? m_SceneBackgroundBitmap : m_SceneForegroundBitmap;
+		// New entities are put after the ones from the base snapshot, so when that isn't the order they're drawn in on the server the whole order is listed to keep the draw order stable.
+		if (msg->OrderCount != 0) {
+			if (msg->OrderCount != entitySnapshot.States.size()) {
+				return;
+			}
+			std::vector<EntityStateNetworkData> orderedStates;
+			orderedStates.reserve(entitySnapshot.States.size());
+			for (unsigned int i = 0; i < msg->OrderCount; i++) {
+				unsigned int uniqueID;
+				memcpy(&uniqueID, orderData + i * sizeof(uniqueID), sizeof(uniqueID));
+				std::unordered_map<unsigned int, size_t>::const_iterator stateIndex = stateIndices.find(uniqueID);
+				if (stateIndex == stateIndices.end()) {
+					return;
+				}
+				orderedStates.emplace_back(entitySnapshot.States[stateIndex->second]);
+			}
+			entitySnapshot.States.swap(orderedStates);
+		}
 
-			const unsigned char *src = m_PixelLineBuffer;
-			for (int y = 0; y < frameData->H && frameData->Y + y < bmp->h; y++) {
-				memcpy(bmp->line[frameData->Y + y] + frameData->X, src, frameData->W);
-				src += frameData->W;
+		m_EntitySnapshots.emplace_back(std::move(entitySnapshot));
+		while (m_EntitySnapshots.size() > c_EntitySnapshotsToKeep) {
+			m_EntitySnapshots.pop_front();
+		}
+		m_LastEntitySnapshot = msg->Sequence;
+		m_LastEntitySnapshotReceiveTime = g_TimerMan.GetRealTickCount();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool NetworkClient::ReadEntityStateFields(const unsigned char *&data, const unsigned char *dataEnd, unsigned char fields, EntityStateNetworkData &state) {
+		auto readValue = [&data, dataEnd](auto &value) {
+			if (dataEnd - data < static_cast<std::ptrdiff_t>(sizeof(value))) {
+				return false;
 			}
+			memcpy(&value, data, sizeof(value));
+			data += sizeof(value);
+			return true;
+		};
+		if ((fields & EntityFieldPreset) && !readValue(state.PresetIndex)) {
+			return false;
+		}
+		if ((fields & EntityFieldPos) && !(readValue(state.PosX) && readValue(state.PosY))) {
+			return false;
+		}
+		if ((fields & EntityFieldVel) && !(readValue(state.VelX) && readValue(state.VelY))) {
+			return false;
+		}
+		if ((fields & EntityFieldRotation) && !readValue(state.Rotation)) {
+			return false;
+		}
+		if ((fields & EntityFieldFrame) && !readValue(state.Frame)) {
+			return false;
 		}
+		if ((fields & EntityFieldTeam) && !readValue(state.Team)) {
+			return false;
+		}
+		return !(fields & EntityFieldFlags) || readValue(state.Flags);
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -868,6 +1153,165 @@ namespace RTE {
 
 	void NetworkClient::DrawPostEffects(int frame) { g_PostProcessMan.SetNetworkPostEffectsList(0, m_PostEffects[frame]); }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::DrawEntities(BITMAP *targetBitmap, const Vector &targetPos) {
+		if (m_EntitySnapshots.empty()) {
+			return;
+		}
+		long long currentTicks = g_TimerMan.GetRealTickCount();
+		double ticksPerMS = static_cast<double>(g_TimerMan.GetTicksPerSecond()) / 1000.0;
+
+		// Ease the render time towards where it should be rather than snapping to it, so snapshots arriving unevenly don't make entities jitter. Only snap when too far off to catch up smoothly.
+		const EntitySnapshot &newestSnapshot = m_EntitySnapshots.back();
+		double targetRenderTime = static_cast<double>(newestSnapshot.ServerTime) + static_cast<double>(currentTicks - m_LastEntitySnapshotReceiveTime) / ticksPerMS - c_EntityInterpolationDelay;
+		double deltaTime = (m_LastEntityDrawTime != 0) ? static_cast<double>(currentTicks - m_LastEntityDrawTime) / ticksPerMS : 0;
+		m_LastEntityDrawTime = currentTicks;
+		m_EntityRenderTime += deltaTime;
+		if (deltaTime == 0 || std::abs(targetRenderTime - m_EntityRenderTime) > c_MaxEntityExtrapolation) {
+			m_EntityRenderTime = targetRenderTime;
+		} else {
+			m_EntityRenderTime += (targetRenderTime - m_EntityRenderTime) * 0.1;
+		}
+
+		const EntitySnapshot *fromSnapshot = &m_EntitySnapshots.front();
+		const EntitySnapshot *toSnapshot = nullptr;
+		for (const EntitySnapshot &entitySnapshot : m_EntitySnapshots) {
+			if (static_cast<double>(entitySnapshot.ServerTime) > m_EntityRenderTime) {
+				toSnapshot = &entitySnapshot;
+				break;
+			}
+			fromSnapshot = &entitySnapshot;
+		}
+		if (toSnapshot && toSnapshot->ServerTime <= fromSnapshot->ServerTime) { toSnapshot = nullptr; }
+
+		float interpolation = 0;
+		float extrapolation = 0;
+		std::unordered_map<unsigned int, const EntityStateNetworkData *> fromStates;
+		if (toSnapshot) {
+			interpolation = std::clamp(static_cast<float>((m_EntityRenderTime - static_cast<double>(fromSnapshot->ServerTime)) / static_cast<double>(toSnapshot->ServerTime - fromSnapshot->ServerTime)), 0.0F, 1.0F);
+			fromStates.reserve(fromSnapshot->States.size());
+			for (const EntityStateNetworkData &fromState : fromSnapshot->States) {
+				fromStates.try_emplace(fromState.UniqueID, &fromState);
+			}
+		} else {
+			extrapolation = static_cast<float>(std::clamp(m_EntityRenderTime - static_cast<double>(fromSnapshot->ServerTime), 0.0, c_MaxEntityExtrapolation) / 1000.0);
+		}
+		const EntitySnapshot &drawnSnapshot = toSnapshot ? *toSnapshot : *fromSnapshot;
+
+		m_EntityDrawCount++;
+		UpdateCosmeticParticles(deltaTime, drawnSnapshot.GlobalAcc);
+
+		float halfSceneWidth = static_cast<float>(m_SceneWidth) / 2.0F;
+		Vector screenCenter(static_cast<float>(targetBitmap->w) / 2.0F, static_cast<float>(targetBitmap->h) / 2.0F);
+
+		for (const EntityStateNetworkData &state : drawnSnapshot.States) {
+			Vector pos(state.PosX, state.PosY);
+			float rotation = state.Rotation;
+			const EntityStateNetworkData *shownState = &state;
+
+			if (state.Flags & EntityCosmetic) {
+				std::pair<std::unordered_map<unsigned int, CosmeticParticle>::iterator, bool> cosmeticParticle = m_CosmeticParticles.try_emplace(state.UniqueID, CosmeticParticle{ pos, Vector(state.VelX, state.VelY), false, 0 });
+				cosmeticParticle.first->second.LastDrawn = m_EntityDrawCount;
+				pos = cosmeticParticle.first->second.Pos;
+			} else if (toSnapshot) {
+				std::unordered_map<unsigned int, const EntityStateNetworkData *>::const_iterator fromState = fromStates.find(state.UniqueID);
+				if (fromState != fromStates.end()) {
+					const EntityStateNetworkData &from = *fromState->second;
+					Vector travel(state.PosX - from.PosX, state.PosY - from.PosY);
+					if (m_SceneWrapsX && std::abs(travel.m_X) > halfSceneWidth) { travel.m_X -= std::copysign(static_cast<float>(m_SceneWidth), travel.m_X); }
+					float turn = std::remainder(state.Rotation - from.Rotation, c_TwoPI);
+
+					pos.SetXY(from.PosX, from.PosY);
+					pos += travel * interpolation;
+					rotation = from.Rotation + turn * interpolation;
+					if (interpolation < 0.5F) { shownState = &from; }
+				}
+			} else {
+				pos += Vector(state.VelX, state.VelY) * (c_PPM * extrapolation);
+			}
+
+			Vector drawPos = pos - targetPos;
+			if (m_SceneWrapsX) {
+				float offCenter = std::remainder(drawPos.m_X - screenCenter.m_X, static_cast<float>(m_SceneWidth));
+				drawPos.m_X = screenCenter.m_X + offCenter;
+			}
+			DrawEntity(targetBitmap, *shownState, drawPos, rotation);
+		}
+
+		for (std::unordered_map<unsigned int, CosmeticParticle>::iterator cosmeticParticle = m_CosmeticParticles.begin(); cosmeticParticle != m_CosmeticParticles.end();) {
+			cosmeticParticle = (cosmeticParticle->second.LastDrawn != m_EntityDrawCount) ? m_CosmeticParticles.erase(cosmeticParticle) : std::next(cosmeticParticle);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::UpdateCosmeticParticles(double deltaTime, const Vector &globalAcc) {
+		float deltaSeconds = static_cast<float>(deltaTime / 1000.0);
+		if (deltaSeconds <= 0) {
+			return;
+		}
+		for (std::pair<const unsigned int, CosmeticParticle> &cosmeticParticleEntry : m_CosmeticParticles) {
+			CosmeticParticle &cosmeticParticle = cosmeticParticleEntry.second;
+			if (cosmeticParticle.Resting) {
+				continue;
+			}
+			cosmeticParticle.Vel += globalAcc * deltaSeconds;
+			Vector newPos = cosmeticParticle.Pos + cosmeticParticle.Vel * (c_PPM * deltaSeconds);
+			if (m_SceneWrapsX) {
+				if (newPos.m_X < 0) {
+					newPos.m_X += static_cast<float>(m_SceneWidth);
+				} else if (newPos.m_X >= static_cast<float>(m_SceneWidth)) {
+					newPos.m_X -= static_cast<float>(m_SceneWidth);
+				}
+			}
+			// The foreground bitmap is the terrain as far as the client knows it, so a particle that lands on anything that isn't mask color comes to rest where it was.
+			int pixel = getpixel(m_SceneForegroundBitmap, newPos.GetFloorIntX(), newPos.GetFloorIntY());
+			if (pixel != -1 && pixel != g_MaskColor) {
+				cosmeticParticle.Resting = true;
+			} else {
+				cosmeticParticle.Pos = newPos;
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkClient::DrawEntity(BITMAP *targetBitmap, const EntityStateNetworkData &state, const Vector &drawPos, float rotation) {
+		if (state.Flags & EntityPixel) {
+			putpixel(targetBitmap, drawPos.GetFloorIntX(), drawPos.GetFloorIntY(), state.Frame);
+			return;
+		}
+		const MOSprite *preset = (state.PresetIndex < m_EntityPresets.size()) ? m_EntityPresets[state.PresetIndex] : nullptr;
+		BITMAP *spriteFrame = preset ? preset->GetSpriteFrame(state.Frame) : nullptr;
+		if (!spriteFrame) {
+			return;
+		}
+		int spriteX = drawPos.GetFloorIntX();
+		int spriteY = drawPos.GetFloorIntY();
+		// Skip sprites well clear of the target bitmap. Even rotated and scaled, nothing reaches further from its position than its diagonal times its scale.
+		int spriteReach = static_cast<int>(static_cast<float>(spriteFrame->w + spriteFrame->h) * std::max(preset->GetScale(), 1.0F));
+		if (spriteX < -spriteReach || spriteY < -spriteReach || spriteX > targetBitmap->w + spriteReach || spriteY > targetBitmap->h + spriteReach) {
+			return;
+		}
+
+		Vector spriteOffset = preset->GetSpriteOffset();
+		fixed allegroAngle = ftofix(Matrix(rotation).GetAllegroAngle());
+		fixed allegroScale = ftofix(preset->GetScale());
+
+		if (state.Flags & EntityHFlipped) {
+			if (!m_EntityFlipBitmap || m_EntityFlipBitmap->w != spriteFrame->w || m_EntityFlipBitmap->h != spriteFrame->h) {
+				if (m_EntityFlipBitmap) { destroy_bitmap(m_EntityFlipBitmap); }
+				m_EntityFlipBitmap = create_bitmap_ex(8, spriteFrame->w, spriteFrame->h);
+			}
+			clear_to_color(m_EntityFlipBitmap, g_MaskColor);
+			draw_sprite_h_flip(m_EntityFlipBitmap, spriteFrame, 0, 0);
+			pivot_scaled_sprite(targetBitmap, m_EntityFlipBitmap, spriteX, spriteY, m_EntityFlipBitmap->w + spriteOffset.GetFloorIntX(), -spriteOffset.GetFloorIntY(), allegroAngle, allegroScale);
+		} else {
+			pivot_scaled_sprite(targetBitmap, spriteFrame, spriteX, spriteY, -spriteOffset.GetFloorIntX(), -spriteOffset.GetFloorIntY(), allegroAngle, allegroScale);
+		}
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkClient::DrawFrame() {
@@ -904,7 +1348,11 @@ namespace RTE {
 		}
 
 		//draw_sprite(src_bmp, dst_bmp, 0, 0);
-		masked_blit(src_bmp, dst_bmp, 0, 0, 0, 0, src_bmp->w, src_bmp->h);
+		if (m_ReplicatesEntityState) {
+			DrawEntities(dst_bmp, m_TargetPos[m_CurrentFrame]);
+		} else {
+			masked_blit(src_bmp, dst_bmp, 0, 0, 0, 0, src_bmp->w, src_bmp->h);
+		}
 		masked_blit(src_gui_bmp, dst_gui_bmp, 0, 0, 0, 0, src_bmp->w, src_bmp->h);
 		masked_blit(m_SceneForegroundBitmap, dst_bmp, sourceX, sourceY, destX, destY, src_bmp->w, src_bmp->h);
 
@@ -920,6 +1368,8 @@ namespace RTE {
 
 			masked_blit(m_SceneForegroundBitmap, dst_bmp, 0, sourceY, newDestX, destY, width, src_bmp->h);
 		}
+		// The world layer only has the fog of war in it when the entities are drawn here, so it goes over the terrain.
+		if (m_ReplicatesEntityState) { masked_blit(src_bmp, dst_bmp, 0, 0, 0, 0, src_bmp->w, src_bmp->h); }
 
 		DrawPostEffects(m_CurrentFrame);
 
@@ -1116,6 +1566,12 @@ namespace RTE {
 				case ID_SRV_TERRAIN:
 					ReceiveTerrainChangeMsg(packet);
 					break;
+				case ID_SRV_ENTITY_PRESETS:
+					ReceiveEntityPresetsMsg(packet);
+					break;
+				case ID_SRV_ENTITY_SNAPSHOT:
+					ReceiveEntitySnapshotMsg(packet);
+					break;
 				case ID_NAT_SERVER_GUID:
 					ReceiveServerGUIDAnswer(packet);
 					break;
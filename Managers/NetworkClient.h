@@ -22,6 +22,7 @@
 namespace RTE {
 
 	struct PostEffect;
+	class MOSprite;
 
 	/// <summary>
 	/// The centralized singleton manager of the network multiplayer client.
@@ -167,11 +168,55 @@ namespace RTE {
 
 		int m_CurrentFrame; //!<
 
+		static constexpr double c_KeyframeRequestInterval = 0.25; //!< The least time in seconds between asking the server to send every box whole again, so it gets a chance to answer before being asked again.
+		std::unordered_map<unsigned int, unsigned short> m_FrameBoxRevisions[2]; //!< The revision of each box of each layer of the frame as last received, keyed by the box's position. Boxes that aren't in here can't have deltas applied to them.
+		long long m_LastKeyframeRequestTime; //!< The last time the server was asked to send every box whole again, in real time ticks.
+
+		unsigned int m_TerrainChangeSequence; //!< The sequence number of the next terrain change batch expected from the server, counted from the start of the scene.
+		std::vector<unsigned char> m_TerrainChangeRunLengthBuffer; //!< The buffer terrain change batches are decompressed into.
+		std::vector<unsigned char> m_TerrainChangeRawBuffer; //!< The buffer terrain change batches are run-length decoded into.
+
 		Vector m_TargetPos[c_FramesToRemember]; //!<
 		std::list<PostEffect> m_PostEffects[c_FramesToRemember]; //!< List of post-effects received from server.
 
 		std::unordered_map<int, SoundContainer *> m_ServerSounds; //!< Unordered map of SoundContainers received from server. OWNED!!!
 
+		/// <summary>
+		/// The state of every entity in the scene at one point of server time, rebuilt from a MsgEntitySnapshot.
+		/// </summary>
+		struct EntitySnapshot {
+			unsigned int Sequence; //!< The sequence number the server gave this snapshot.
+			unsigned int ServerTime; //!< The server's simulation time when this snapshot was taken, in ms.
+			Vector GlobalAcc; //!< The scene's global acceleration when this snapshot was taken.
+			std::vector<EntityStateNetworkData> States; //!< The state of each entity, in the order they're drawn.
+		};
+
+		/// <summary>
+		/// A cosmetic particle the server only sent the starting state of, and which is simulated here from then on.
+		/// </summary>
+		struct CosmeticParticle {
+			Vector Pos; //!< The position of the particle, in pixels.
+			Vector Vel; //!< The velocity of the particle, in m/s.
+			bool Resting; //!< Whether the particle hit the terrain and stopped.
+			unsigned int LastDrawn; //!< The entity draw this particle was last part of, so ones the server no longer lists can be dropped.
+		};
+
+		static constexpr int c_EntitySnapshotsToKeep = 32; //!< How many received entity snapshots to keep, to interpolate between and to apply deltas against.
+		static constexpr double c_EntityInterpolationDelay = 100.0; //!< How far behind the newest entity snapshot entities are drawn, in ms, so there's usually a newer snapshot to interpolate towards.
+		static constexpr double c_MaxEntityExtrapolation = 250.0; //!< How far past the newest entity snapshot entities are moved along their velocity when no newer snapshot arrives, in ms.
+
+		bool m_ReplicatesEntityState; //!< Whether the server sends the state of entities to draw here instead of drawing them into the frame it sends.
+		std::vector<const MOSprite *> m_EntityPresets; //!< The presets entities are drawn with, by the index the server gave them. Index 0 is never used, and presets that couldn't be found are nullptr.
+		std::deque<EntitySnapshot> m_EntitySnapshots; //!< The newest received entity snapshots, oldest first.
+		std::vector<unsigned char> m_EntitySnapshotBuffer; //!< The buffer entity snapshots are decompressed into.
+		unsigned int m_LastEntitySnapshot; //!< The sequence number of the newest entity snapshot received, to ack to the server in input messages.
+		long long m_LastEntitySnapshotReceiveTime; //!< When the newest entity snapshot was received, in real time ticks.
+		double m_EntityRenderTime; //!< The server time entities were last drawn at, in ms.
+		long long m_LastEntityDrawTime; //!< When entities were last drawn, in real time ticks. 0 if they weren't drawn since the scene started.
+		unsigned int m_EntityDrawCount; //!< How many times entities were drawn since the scene started.
+		std::unordered_map<unsigned int, CosmeticParticle> m_CosmeticParticles; //!< The cosmetic particles being simulated here, by unique ID.
+		BITMAP *m_EntityFlipBitmap; //!< Scratch bitmap horizontally flipped sprites are drawn into before being rotated onto the frame.
+
 		unsigned char m_SceneID; //!< 
 		int m_CurrentSceneLayerReceived; //!<
 
@@ -258,6 +303,11 @@ namespace RTE {
 		/// <param name="packet"></param>
 		void ReceiveFrameBoxMsg(RakNet::Packet *packet);
 
+		/// <summary>
+		/// Asks the server to send every box of the frame whole again, unless it was asked only a moment ago.
+		/// </summary>
+		void SendKeyframeRequestMsg();
+
 		/// <summary>
 		/// 
 		/// </summary>
@@ -286,11 +336,43 @@ namespace RTE {
 		void SendSceneSetupAcceptedMsg();
 
 		/// <summary>
-		/// Receive and handle a packet of terrain change data.
+		/// Receive and handle a batch of terrain changes. The whole batch is checked before any of it is applied, so either all of it is or none of it is.
 		/// </summary>
 		/// <param name="packet">The packet to handle.</param>
 		void ReceiveTerrainChangeMsg(RakNet::Packet *packet);
 
+		/// <summary>
+		/// Decodes run-length encoded data the way MsgTerrainChangeBatch describes.
+		/// </summary>
+		/// <param name="encodedData">The data to decode.</param>
+		/// <param name="encodedDataSize">The size of the data to decode.</param>
+		/// <param name="data">The buffer to decode the data into.</param>
+		/// <param name="dataSize">The size the data should have once decoded.</param>
+		/// <returns>Whether the data decoded to exactly the expected size.</returns>
+		static bool RunLengthDecode(const unsigned char *encodedData, size_t encodedDataSize, unsigned char *data, size_t dataSize);
+
+		/// <summary>
+		/// Receive and handle a batch of entity preset names, resolving each to the preset it names so entities using it can be drawn.
+		/// </summary>
+		/// <param name="packet">The packet to handle.</param>
+		void ReceiveEntityPresetsMsg(RakNet::Packet *packet);
+
+		/// <summary>
+		/// Receive and handle an entity snapshot, rebuilding it whole from the snapshot it's a delta against. Snapshots that are stale, against a base that's no longer kept or malformed are dropped.
+		/// </summary>
+		/// <param name="packet">The packet to handle.</param>
+		void ReceiveEntitySnapshotMsg(RakNet::Packet *packet);
+
+		/// <summary>
+		/// Reads the values of the fields of an entity state that are present in an entity snapshot, as NetworkServer::WriteEntityState writes them.
+		/// </summary>
+		/// <param name="data">The data to read from. Advanced past what was read.</param>
+		/// <param name="dataEnd">The end of the data to read from.</param>
+		/// <param name="fields">The EntityStateFields present in the data.</param>
+		/// <param name="state">The entity state to read the fields into. Fields that aren't present are left as they were.</param>
+		/// <returns>Whether all the fields fit in the data.</returns>
+		static bool ReadEntityStateFields(const unsigned char *&data, const unsigned char *dataEnd, unsigned char fields, EntityStateNetworkData &state);
+
 		/// <summary>
 		/// Receive and handle a packet of post-effect data. 
 		/// </summary>
@@ -323,6 +405,29 @@ namespace RTE {
 		/// <param name="frame"></param>
 		void DrawPostEffects(int frame);
 
+		/// <summary>
+		/// Draws the entities of the scene as they were a moment ago in server time, interpolated between the two entity snapshots around that moment, or moved along their velocity if no newer snapshot arrived yet.
+		/// </summary>
+		/// <param name="targetBitmap">The bitmap to draw on.</param>
+		/// <param name="targetPos">The position of the top left corner of the target bitmap in the scene.</param>
+		void DrawEntities(BITMAP *targetBitmap, const Vector &targetPos);
+
+		/// <summary>
+		/// Moves the cosmetic particles along by the time since they were last moved, stopping the ones that hit the terrain.
+		/// </summary>
+		/// <param name="deltaTime">The time to move the particles by, in ms.</param>
+		/// <param name="globalAcc">The scene's global acceleration.</param>
+		void UpdateCosmeticParticles(double deltaTime, const Vector &globalAcc);
+
+		/// <summary>
+		/// Draws a single entity with its preset's sprite, rotated and flipped the way MOSRotating draws itself.
+		/// </summary>
+		/// <param name="targetBitmap">The bitmap to draw on.</param>
+		/// <param name="state">The state of the entity to draw.</param>
+		/// <param name="drawPos">The position to draw the entity at on the target bitmap.</param>
+		/// <param name="rotation">The rotation to draw the entity at, in radians.</param>
+		void DrawEntity(BITMAP *targetBitmap, const EntityStateNetworkData &state, const Vector &drawPos, float rotation);
+
 		/// <summary>
 		/// 
 		/// </summary>
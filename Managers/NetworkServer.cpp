@@ -8,6 +8,9 @@
 #include "SLTerrain.h"
 #include "SLBackground.h"
 #include "GameActivity.h"
+#include "MovableMan.h"
+#include "AEmitter.h"
+#include "MOPixel.h"
 
 #include "SettingsMan.h"
 #include "ConsoleMan.h"
@@ -45,6 +48,66 @@ namespace RTE {
 
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::EncoderThreadFunction(NetworkServer *server) {
+		FrameBoxEncoder encoder;
+		encoder.HighCompressionState = malloc(LZ4_sizeofStateHC());
+		encoder.FastCompressionState = malloc(LZ4_sizeofState());
+
+		std::unique_lock<std::mutex> encodeLock(server->m_EncodeMutex);
+		while (!server->m_StopEncoders) {
+			if (server->m_FrameEncodeJobs.empty()) {
+				server->m_EncodeCondition.wait(encodeLock);
+				continue;
+			}
+			FrameEncodeJob *encodeJob = server->m_FrameEncodeJobs.front();
+			encodeJob->ActiveEncoders++;
+			encodeLock.unlock();
+
+			server->RunFrameEncodeJob(*encodeJob, encoder);
+
+			encodeLock.lock();
+			// Every box of the job is claimed by now, so nobody else needs to pick it up.
+			std::deque<FrameEncodeJob *>::iterator queuedJob = std::find(server->m_FrameEncodeJobs.begin(), server->m_FrameEncodeJobs.end(), encodeJob);
+			if (queuedJob != server->m_FrameEncodeJobs.end()) { server->m_FrameEncodeJobs.erase(queuedJob); }
+			if (--encodeJob->ActiveEncoders == 0) { server->m_EncodeDoneCondition.notify_all(); }
+		}
+		encodeLock.unlock();
+
+		free(encoder.HighCompressionState);
+		free(encoder.FastCompressionState);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::StartEncoderThreads() {
+		if (!m_EncoderThreads.empty()) {
+			return;
+		}
+		int encoderThreadCount = m_EncoderThreadCount;
+		if (encoderThreadCount <= 0) { encoderThreadCount = std::clamp(static_cast<int>(std::thread::hardware_concurrency()) / 2, 1, 8); }
+
+		m_StopEncoders = false;
+		for (int i = 0; i < encoderThreadCount; i++) {
+			m_EncoderThreads.emplace_back(EncoderThreadFunction, this);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::StopEncoderThreads() {
+		{
+			std::lock_guard<std::mutex> encodeLock(m_EncodeMutex);
+			m_StopEncoders = true;
+		}
+		m_EncodeCondition.notify_all();
+		for (std::thread &encoderThread : m_EncoderThreads) {
+			if (encoderThread.joinable()) { encoderThread.join(); }
+		}
+		m_EncoderThreads.clear();
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkServer::Clear() {
@@ -55,6 +118,30 @@ namespace RTE {
 			m_BackBuffer8[i] = 0;
 			m_BackBufferGUI8[i] = 0;
 
+			m_TerrainChangeSequence[i] = 0;
+
+			m_FrameBoxTasks[i].clear();
+			m_FrameBoxPackets[i].clear();
+			m_FrameBoxEncoders[i].HighCompressionState = 0;
+			m_FrameBoxEncoders[i].FastCompressionState = 0;
+			m_FrameBoxEncoders[i].BoxBuffer.clear();
+			m_EncodeTimePerFrame[i] = 0;
+
+			m_EntitySnapshots[i].reset();
+			m_SentEntitySnapshots[i].clear();
+			m_EntitySnapshotSequence[i] = 0;
+			m_AckedEntitySnapshot[i] = 0;
+			m_EntityStateResetRequested[i] = false;
+			m_EntityPresetsSent[i] = 0;
+			m_EntitySnapshotRawBuffer[i].clear();
+			m_EntitySnapshotMsgBuffer[i].clear();
+
+			m_ReferenceBackBuffer8[i] = 0;
+			m_ReferenceBackBufferGUI8[i] = 0;
+			m_FrameBoxStates[i][0].clear();
+			m_FrameBoxStates[i][1].clear();
+			m_KeyframeRequested[i] = false;
+
 			m_LastFrameSentTime[i] = 0;
 			m_LastStatResetTime[i] = 0;
 
@@ -122,6 +209,8 @@ namespace RTE {
 
 			m_EmptyBlocks[i] = 0;
 			m_FullBlocks[i] = 0;
+			m_DeltaBlocks[i] = 0;
+			m_UnchangedBlocks[i] = 0;
 		}
 
 		m_UseHighCompression = true;
@@ -130,6 +219,11 @@ namespace RTE {
 		m_FastAccelerationFactor = 10;
 		m_UseInterlacing = false;
 		m_EncodingFps = 60;
+		m_UseDeltaCompression = true;
+		m_ReplicateEntityState = false;
+		m_EntityPresetNames.clear();
+		m_EntityPresetIndices.clear();
+		m_CosmeticEntityStates.clear();
 		m_ShowInput = false;
 		m_ShowStats = false;
 		m_TransmitAsBoxes = true;
@@ -137,7 +231,11 @@ namespace RTE {
 		m_BoxHeight = 88;
 		m_UseNATService = false;
 		m_NatServerConnected = false;
+		m_TerrainChangeCompressionState = 0;
 		m_LastPackedReceived.Reset();
+		m_EncoderThreadCount = 0;
+		m_FrameEncodeJobs.clear();
+		m_StopEncoders = false;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -155,7 +253,11 @@ namespace RTE {
 
 			m_LZ4CompressionState[i] = malloc(LZ4_sizeofStateHC());
 			m_LZ4FastCompressionState[i] = malloc(LZ4_sizeofState());
+
+			m_FrameBoxEncoders[i].HighCompressionState = m_LZ4CompressionState[i];
+			m_FrameBoxEncoders[i].FastCompressionState = m_LZ4FastCompressionState[i];
 		}
+		m_TerrainChangeCompressionState = malloc(LZ4_sizeofState());
 
 		return 0;
 	}
@@ -171,6 +273,8 @@ namespace RTE {
 		// We're done with the network
 		RakNet::RakPeerInterface::DestroyInstance(m_Server);
 
+		StopEncoderThreads();
+
 		for (short i = 0; i < c_MaxClients; i++) {
 			DestroyBackBuffer(i);
 
@@ -180,6 +284,9 @@ namespace RTE {
 			if (m_LZ4FastCompressionState[i]) { free(m_LZ4FastCompressionState[i]); }		
 			m_LZ4FastCompressionState[i] = 0;
 		}
+		if (m_TerrainChangeCompressionState) { free(m_TerrainChangeCompressionState); }
+		m_TerrainChangeCompressionState = 0;
+
 		Clear();
 	}
 
@@ -197,6 +304,22 @@ namespace RTE {
 		return playersReady >= playersTotal;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool NetworkServer::NetworkFrameNeeded() {
+		// The send threads send at most m_EncodingFps frames a second, so any frame drawn sooner than that after the last would never be sent.
+		if (!m_NetworkFrameTimer.IsPastRealMS(1000.0 / static_cast<double>(m_EncodingFps))) {
+			return false;
+		}
+		for (short player = 0; player < c_MaxClients; player++) {
+			if (IsPlayerConnected(player) && SendFrameData(player)) {
+				m_NetworkFrameTimer.Reset();
+				return true;
+			}
+		}
+		return false;
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkServer::SetServerPort(const std::string &newPort) {
@@ -214,6 +337,10 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkServer::Start() {
+		// A dedicated server goes back to the lobby between activities with the server still running.
+		if (m_Server->IsActive()) {
+			return;
+		}
 		RakNet::SocketDescriptor socketDescriptors[1];
 		socketDescriptors[0].port = atoi(m_ServerPort.c_str());
 		socketDescriptors[0].socketFamily = AF_INET; // Test out IPV4
@@ -227,6 +354,7 @@ namespace RTE {
 			m_Server->SetMaximumIncomingConnections(4);
 			g_ConsoleMan.PrintString("SERVER: STARTED!");
 		}
+		StartEncoderThreads();
 
 		if (m_UseNATService) {
 			g_ConsoleMan.PrintString("SERVER: Connecting to NAT service");
@@ -284,14 +412,65 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	void NetworkServer::RegisterTerrainChange(SceneMan::TerrainChange terrainChange) {
-		if (m_IsInServerMode) {
-			for (short player = 0; player < c_MaxClients; player++) {
-				if (IsPlayerConnected(player)) {
-					m_Mutex[player].lock();
-					m_PendingTerrainChanges[player].push(terrainChange);
-					m_Mutex[player].unlock();
-				}
+	void NetworkServer::RegisterTerrainChanges(const std::vector<SceneMan::TerrainChange> &terrainChanges) {
+		if (!m_IsInServerMode || terrainChanges.empty()) {
+			return;
+		}
+		bool anyPlayerConnected = false;
+		for (short player = 0; player < c_MaxClients && !anyPlayerConnected; player++) {
+			anyPlayerConnected = IsPlayerConnected(player);
+		}
+		if (!anyPlayerConnected) {
+			return;
+		}
+		SLTerrain *terrain = g_SceneMan.GetScene()->GetTerrain();
+
+		// Lay out all the regions before all their pixels, so the regions don't break up the runs of pixels.
+		size_t rawSize = sizeof(TerrainChangeRegion) * terrainChanges.size();
+		for (const SceneMan::TerrainChange &terrainChange : terrainChanges) {
+			rawSize += static_cast<size_t>(terrainChange.w * terrainChange.h);
+		}
+		m_TerrainChangeRawBuffer.resize(rawSize);
+
+		TerrainChangeRegion *region = (TerrainChangeRegion *)m_TerrainChangeRawBuffer.data();
+		unsigned char *dest = m_TerrainChangeRawBuffer.data() + sizeof(TerrainChangeRegion) * terrainChanges.size();
+		for (const SceneMan::TerrainChange &terrainChange : terrainChanges) {
+			region->X = terrainChange.x;
+			region->Y = terrainChange.y;
+			region->W = terrainChange.w;
+			region->H = terrainChange.h;
+			region->Back = terrainChange.back;
+			region++;
+
+			const BITMAP *bmp = terrainChange.back ? terrain->GetBGColorBitmap() : terrain->GetFGColorBitmap();
+			for (int y = 0; y < terrainChange.h; y++) {
+				memcpy(dest, bmp->line[terrainChange.y + y] + terrainChange.x, terrainChange.w);
+				dest += terrainChange.w;
+			}
+		}
+		RunLengthEncode(m_TerrainChangeRawBuffer.data(), rawSize, m_TerrainChangeRunLengthBuffer);
+
+		std::shared_ptr<TerrainChangeBatch> terrainChangeBatch = std::make_shared<TerrainChangeBatch>();
+		terrainChangeBatch->RegionCount = terrainChanges.size();
+		terrainChangeBatch->RawSize = rawSize;
+		terrainChangeBatch->RunLengthSize = m_TerrainChangeRunLengthBuffer.size();
+
+		int runLengthSize = static_cast<int>(m_TerrainChangeRunLengthBuffer.size());
+		terrainChangeBatch->Data.resize(LZ4_compressBound(runLengthSize));
+		int result = LZ4_compress_fast_extState(m_TerrainChangeCompressionState, (char *)m_TerrainChangeRunLengthBuffer.data(), (char *)terrainChangeBatch->Data.data(), runLengthSize, static_cast<int>(terrainChangeBatch->Data.size()), 1);
+
+		// Compression failed or ineffective, send as is
+		if (result <= 0 || result >= runLengthSize) {
+			terrainChangeBatch->Data = m_TerrainChangeRunLengthBuffer;
+		} else {
+			terrainChangeBatch->Data.resize(result);
+		}
+
+		for (short player = 0; player < c_MaxClients; player++) {
+			if (IsPlayerConnected(player)) {
+				m_Mutex[player].lock();
+				m_PendingTerrainChanges[player].push(terrainChangeBatch);
+				m_Mutex[player].unlock();
 			}
 		}
 	}
@@ -469,6 +648,9 @@ namespace RTE {
 			msg.InputElementReleased = m->InputElementReleased;
 			msg.InputElementHeld = m->InputElementHeld;
 
+			msg.LastEntitySnapshot = m->LastEntitySnapshot;
+			m_AckedEntitySnapshot[player] = m->LastEntitySnapshot;
+
 			bool skip = true;
 
 			if (!m_InputMessages[player].empty()) {
@@ -676,6 +858,7 @@ namespace RTE {
 		msgSceneSetup.Width = static_cast<short>(g_SceneMan.GetSceneWidth());
 		msgSceneSetup.Height = static_cast<short>(g_SceneMan.GetSceneHeight());
 		msgSceneSetup.SceneWrapsX = g_SceneMan.SceneWrapsX();
+		msgSceneSetup.ReplicatesEntityState = m_ReplicateEntityState;
 
 		Scene *scene = g_SceneMan.GetScene();
 
@@ -876,9 +1059,9 @@ namespace RTE {
 		while (!m_PendingTerrainChanges[player].empty()) {
 			m_PendingTerrainChanges[player].pop();
 		}
-		while (!m_CurrentTerrainChanges[player].empty()) {
-			m_CurrentTerrainChanges[player].pop();
-		}
+		m_CurrentTerrainChanges[player].clear();
+		// The client counts the batches from the start of the scene data that's about to be sent.
+		m_TerrainChangeSequence[player] = 0;
 		m_Mutex[player].unlock();
 	}
 
@@ -899,133 +1082,72 @@ namespace RTE {
 	void NetworkServer::ProcessTerrainChanges(short player) {
 		m_Mutex[player].lock();
 		while (!m_PendingTerrainChanges[player].empty()) {
-			m_CurrentTerrainChanges[player].push(m_PendingTerrainChanges[player].front());
+			m_CurrentTerrainChanges[player].push_back(m_PendingTerrainChanges[player].front());
 			m_PendingTerrainChanges[player].pop();
 		}
 		m_Mutex[player].unlock();
 
-		while (!m_CurrentTerrainChanges[player].empty()) {
-			int maxSize = 1280;
-
-			SceneMan::TerrainChange terrainChange = m_CurrentTerrainChanges[player].front();
-			m_CurrentTerrainChanges[player].pop();
-
-			// Fragment region if it does not fit one packet
-			if (terrainChange.w * terrainChange.h > maxSize) {
-				int size = 0;
-				int height = 1;
-				int heightStart = 0;
-
-				for (int y = 0; y < terrainChange.h; y++) {
-					height++;
-					size += terrainChange.w;
-
-					// Store changed block if the size is over the MTU or if it's the last block.
-					if (size + terrainChange.w >= maxSize || y == terrainChange.h - 1) {
-						SceneMan::TerrainChange tcf;
-						tcf.x = terrainChange.x;
-						tcf.y = terrainChange.y + heightStart;
-						tcf.w = terrainChange.w;
-						tcf.h = height;
-						tcf.back = terrainChange.back;
-						tcf.color = terrainChange.color;
-
-						SendTerrainChangeMsg(player, tcf);
-
-						size = 0;
-						heightStart = y;
-						height = 1;
-					}
-				}
-			} else {
-				SendTerrainChangeMsg(player, terrainChange);
-			}
+		// Each batch goes out whole as one message, RakNet splits it up if it's bigger than a packet and puts it back together before the client gets it.
+		for (const std::shared_ptr<const TerrainChangeBatch> &terrainChangeBatch : m_CurrentTerrainChanges[player]) {
+			SendTerrainChangeMsg(player, *terrainChangeBatch);
 		}
+		m_CurrentTerrainChanges[player].clear();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	void NetworkServer::SendTerrainChangeMsg(short player, SceneMan::TerrainChange terrainChange) {
-		if (terrainChange.w == 1 && terrainChange.h == 1) {
-			MsgTerrainChange msg;
-			msg.Id = ID_SRV_TERRAIN;
-			msg.X = terrainChange.x;
-			msg.Y = terrainChange.y;
-			msg.W = terrainChange.w;
-			msg.H = terrainChange.h;
-			msg.DataSize = 0;
-			msg.UncompressedSize = 0;
-			msg.SceneId = m_SceneID;
-			msg.Color = terrainChange.color;
-			msg.Back = terrainChange.back;
-
-			int payloadSize = sizeof(MsgTerrainChange);
-
-			m_Server->Send((const char *)&msg, payloadSize, MEDIUM_PRIORITY, RELIABLE, 0, m_ClientConnections[player].ClientId, false);
-
-			m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
-			m_DataSentTotal[player] += payloadSize;
+	void NetworkServer::SendTerrainChangeMsg(short player, const TerrainChangeBatch &terrainChangeBatch) {
+		std::vector<unsigned char> &msgBuffer = m_TerrainChangeMsgBuffer[player];
+		msgBuffer.resize(sizeof(MsgTerrainChangeBatch) + terrainChangeBatch.Data.size());
 
-			m_TerrainDataSentCurrent[player][STAT_CURRENT] += payloadSize;
-			m_TerrainDataSentTotal[player] += payloadSize;
+		MsgTerrainChangeBatch *msg = (MsgTerrainChangeBatch *)msgBuffer.data();
+		msg->Id = ID_SRV_TERRAIN;
+		msg->SceneId = m_SceneID;
+		msg->Sequence = m_TerrainChangeSequence[player]++;
+		msg->RegionCount = terrainChangeBatch.RegionCount;
+		msg->RawSize = terrainChangeBatch.RawSize;
+		msg->RunLengthSize = terrainChangeBatch.RunLengthSize;
+		msg->DataSize = terrainChangeBatch.Data.size();
+		memcpy(msgBuffer.data() + sizeof(MsgTerrainChangeBatch), terrainChangeBatch.Data.data(), terrainChangeBatch.Data.size());
 
-			m_DataUncompressedCurrent[player][STAT_CURRENT] += payloadSize;
-			m_DataUncompressedTotal[player] += payloadSize;
-		} else {
-			MsgTerrainChange *msg = (MsgTerrainChange *)m_PixelLineBuffer[player];
-			msg->Id = ID_SRV_TERRAIN;
-			msg->X = terrainChange.x;
-			msg->Y = terrainChange.y;
-			msg->W = terrainChange.w;
-			msg->H = terrainChange.h;
-			int size = msg->W * msg->H;
-			msg->DataSize = size;
-			msg->UncompressedSize = size;
-			msg->SceneId = m_SceneID;
-			msg->Color = terrainChange.color;
-			msg->Back = terrainChange.back;
+		int payloadSize = static_cast<int>(msgBuffer.size());
 
-			Scene * scene = g_SceneMan.GetScene();
-			SLTerrain * terrain = scene->GetTerrain();
+		// Ordered on a channel of its own, so the batches are applied in turn without holding up anything else.
+		m_Server->Send((const char *)msg, payloadSize, MEDIUM_PRIORITY, RELIABLE_ORDERED, 1, m_ClientConnections[player].ClientId, false);
 
-			const BITMAP *bmp = 0;
-			bmp = msg->Back ? terrain->GetBGColorBitmap() : terrain->GetFGColorBitmap();
-
-			unsigned char *dest = (unsigned char *)(m_TerrainChangeBuffer[player]);
+		m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
+		m_DataSentTotal[player] += payloadSize;
 
-			// Copy bitmap data
-			for (int y = 0; y < msg->H && msg->Y + y < bmp->h; y++) {
-				memcpy(dest, bmp->line[msg->Y + y] + msg->X, msg->W);
-				dest += msg->W;
-			}
+		m_TerrainDataSentCurrent[player][STAT_CURRENT] += payloadSize;
+		m_TerrainDataSentTotal[player] += payloadSize;
 
-			int result = 0;
+		m_DataUncompressedCurrent[player][STAT_CURRENT] += msg->RawSize;
+		m_DataUncompressedTotal[player] += msg->RawSize;
+	}
 
-			result = LZ4_compress_HC_extStateHC(m_LZ4CompressionState[player], (char *)m_TerrainChangeBuffer[player], (char *)(m_PixelLineBuffer[player] + sizeof(MsgTerrainChange)), size, size, LZ4HC_CLEVEL_OPT_MIN);
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-			// Compression failed or ineffective, send as is
-			if (result == 0 || result == size) {
-#ifdef _WIN32
-				memcpy_s(m_PixelLineBuffer[player] + sizeof(MsgTerrainChange), c_MaxPixelLineBufferSize, m_TerrainChangeBuffer[player], size);
-#else
-				memcpy(m_PixelLineBuffer[player] + sizeof(MsgTerrainChange), m_TerrainChangeBuffer[player], size);
-#endif
+	void NetworkServer::RunLengthEncode(const unsigned char *data, size_t dataSize, std::vector<unsigned char> &encodedData) {
+		encodedData.clear();
+		size_t position = 0;
+		while (position < dataSize) {
+			size_t runLength = 1;
+			while (position + runLength < dataSize && runLength < 130 && data[position + runLength] == data[position]) {
+				runLength++;
+			}
+			if (runLength >= 3) {
+				encodedData.push_back(static_cast<unsigned char>(runLength + 125));
+				encodedData.push_back(data[position]);
+				position += runLength;
 			} else {
-				msg->DataSize = result;
+				// Gather literals up to where the next run worth encoding starts.
+				size_t literalStart = position;
+				while (position < dataSize && position - literalStart < 128 && !(position + 2 < dataSize && data[position] == data[position + 1] && data[position] == data[position + 2])) {
+					position++;
+				}
+				encodedData.push_back(static_cast<unsigned char>(position - literalStart - 1));
+				encodedData.insert(encodedData.end(), data + literalStart, data + position);
 			}
-
-			int payloadSize = sizeof(MsgTerrainChange) + msg->DataSize;
-
-			m_Server->Send((const char *)msg, payloadSize, MEDIUM_PRIORITY, RELIABLE, 0, m_ClientConnections[player].ClientId, false);
-
-			m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
-			m_DataSentTotal[player] += payloadSize;
-
-			m_TerrainDataSentCurrent[player][STAT_CURRENT] += payloadSize;
-			m_TerrainDataSentTotal[player] += payloadSize;
-
-			m_DataUncompressedCurrent[player][STAT_CURRENT] += msg->UncompressedSize;
-			m_DataUncompressedTotal[player] += msg->UncompressedSize;
 		}
 	}
 
@@ -1033,7 +1155,12 @@ namespace RTE {
 
 	void NetworkServer::ReceiveSceneAcceptedMsg(RakNet::Packet *packet) {
 		for (short player = 0; player < c_MaxClients; player++) {
-			if (m_ClientConnections[player].ClientId == packet->systemAddress) { m_SendFrameData[player] = true; }
+			if (m_ClientConnections[player].ClientId == packet->systemAddress) {
+				// The client starts the new scene with nothing in its frame, so there's nothing to send deltas against.
+				m_KeyframeRequested[player] = true;
+				m_EntityStateResetRequested[player] = true;
+				m_SendFrameData[player] = true;
+			}
 		}
 	}
 
@@ -1050,6 +1177,18 @@ namespace RTE {
 	void NetworkServer::CreateBackBuffer(short player, int w, int h) {
 		m_BackBuffer8[player] = create_bitmap_ex(8, w, h);
 		m_BackBufferGUI8[player] = create_bitmap_ex(8, w, h);
+
+		m_ReferenceBackBuffer8[player] = create_bitmap_ex(8, w, h);
+		m_ReferenceBackBufferGUI8[player] = create_bitmap_ex(8, w, h);
+
+		int boxCount = (w / m_BoxWidth + 1) * (h / m_BoxHeight + 1);
+		for (int layer = 0; layer < 2; layer++) {
+			m_FrameBoxStates[player][layer].assign(boxCount, { false, 0, 0 });
+			// Spread the scheduled keyframes of the boxes over the interval, so they don't all get sent whole on the same frame.
+			for (int boxIndex = 0; boxIndex < boxCount; boxIndex++) {
+				m_FrameBoxStates[player][layer][boxIndex].SendsSinceKeyframe = boxIndex % c_FrameBoxKeyframeInterval;
+			}
+		}
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1060,6 +1199,33 @@ namespace RTE {
 
 		if (m_BackBufferGUI8) { destroy_bitmap(m_BackBufferGUI8[player]); }
 		m_BackBufferGUI8[player] = 0;
+
+		if (m_ReferenceBackBuffer8[player]) { destroy_bitmap(m_ReferenceBackBuffer8[player]); }
+		m_ReferenceBackBuffer8[player] = 0;
+
+		if (m_ReferenceBackBufferGUI8[player]) { destroy_bitmap(m_ReferenceBackBufferGUI8[player]); }
+		m_ReferenceBackBufferGUI8[player] = 0;
+
+		m_FrameBoxStates[player][0].clear();
+		m_FrameBoxStates[player][1].clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::ResetFrameBoxStates(short player) {
+		for (int layer = 0; layer < 2; layer++) {
+			for (FrameBoxState &boxState : m_FrameBoxStates[player][layer]) {
+				boxState.HasReference = false;
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::ReceiveKeyframeRequestMsg(RakNet::Packet *packet) {
+		for (short player = 0; player < c_MaxClients; player++) {
+			if (m_ClientConnections[player].ClientId == packet->systemAddress) { m_KeyframeRequested[player] = true; }
+		}
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1198,6 +1364,9 @@ namespace RTE {
 		SendSoundData(player);
 		SendMusicData(player);
 
+		// The clients draw the world themselves from the entity states, so the world layer only has the fog of war in it.
+		if (m_ReplicateEntityState) { SendEntitySnapshotMsg(player); }
+
 		m_FramesSent[player]++;
 
 		// Compression section
@@ -1207,17 +1376,16 @@ namespace RTE {
 		m_SendEven[player] = !m_SendEven[player];
 
 		if (m_TransmitAsBoxes) {
-			MsgFrameBox *frameData = (MsgFrameBox *)m_PixelLineBuffer[player];
-			frameData->FrameNumber = m_FrameNumbers[player];
+			if (m_KeyframeRequested[player].exchange(false)) { ResetFrameBoxStates(player); }
 
-			// Save message ID
-			frameData->Id = ID_SRV_FRAME_BOX;
-			frameData->BoxWidth = m_BoxWidth;
-			frameData->BoxHeight = m_BoxHeight;
+			long long encodeStartTime = g_TimerMan.GetAbsoluteTime();
 
 			int bw = m_BackBuffer8[player]->w / m_BoxWidth;
 			int bh = m_BackBuffer8[player]->h / m_BoxHeight;
 
+			// List every box to send this frame in the order they're sent, so they can be encoded in any order on any thread and still go out in order.
+			std::vector<FrameBoxTask> &boxTasks = m_FrameBoxTasks[player];
+			boxTasks.clear();
 			for (int by = 0; by <= bh; by++) {
 				int step = 1;
 				int startLine = 0;
@@ -1238,113 +1406,61 @@ namespace RTE {
 					if (bpx >= m_BackBuffer8[player]->w || bpy >= m_BackBuffer8[player]->h) {
 						break;
 					}
-
-					frameData->BoxX = bpx;
-					frameData->BoxY = bpy;
-
-					int maxWidth = m_BoxWidth;
-					if (bpx + m_BoxWidth >= m_BackBuffer8[player]->w) {
-						maxWidth = m_BackBuffer8[player]->w - bpx;
-						frameData->BoxWidth = maxWidth;
-					}
-
-					int maxHeight = m_BoxHeight;
-					if (bpy + m_BoxHeight >= m_BackBuffer8[player]->h) {
-						maxHeight = m_BackBuffer8[player]->h - bpy;
-						frameData->BoxHeight = maxHeight;
-					}
-
-					int size = maxWidth * maxHeight;
-					frameData->UncompressedSize = size;
-					frameData->DataSize = size;
-
 					for (int layer = 0; layer < 2; layer++) {
-						bool boxIsEmpty = true;
-						int line = 0;
-
-						const BITMAP *backBuffer = 0;
-						if (layer == 0) {
-							backBuffer = m_BackBuffer8[player];
-						} else if (layer == 1) {
-							backBuffer = m_BackBufferGUI8[player];
-						}
-
-						frameData->Layer = layer;
-
-						unsigned char *dest = (unsigned char *)(m_TerrainChangeBuffer[player]);
-
-						// Copy block to line buffer and also check if block is empty
-						for (line = 0; line < maxHeight; line++) {
-							// Copy bitmap data
-							memcpy(dest, backBuffer->line[bpy + line] + bpx, maxWidth);
-							dest += maxWidth;
-						}
-
-						// Check if block is empty
-						unsigned long *pixelInt = (unsigned long *)m_TerrainChangeBuffer[player];
-						int counter = 0;
-
-						for (counter = 0; counter < size; counter += sizeof(unsigned long)) {
-							if (*pixelInt > 0) {
-								boxIsEmpty = false;
-								break;
-							}
-							pixelInt++;
-						}
-						if (boxIsEmpty && counter > size) {
-							pixelInt--;
-							counter -= sizeof(unsigned long);
-
-							const unsigned char *pixelChr = (unsigned char *)pixelInt;
-							for (; counter < size; counter++) {
-								if (*pixelChr > 0) {
-									boxIsEmpty = false;
-									break;
-								}
-								pixelChr++;
-							}
-						}
-
-						if (!boxIsEmpty) {
-							int result = 0;
-
-							if (m_UseHighCompression) {
-								result = LZ4_compress_HC_extStateHC(m_LZ4CompressionState[player], (char *)m_TerrainChangeBuffer[player], (char *)(m_PixelLineBuffer[player] + sizeof(MsgFrameBox)), size, size, compressionMethod);
-							} else if (m_UseFastCompression) {
-								result = LZ4_compress_fast_extState(m_LZ4FastCompressionState[player], (char *)m_TerrainChangeBuffer[player], (char *)(m_PixelLineBuffer[player] + sizeof(MsgFrameBox)), size, size, accelerationFactor);
-							}
+						boxTasks.push_back({ by * (bw + 1) + bx, bpx, bpy, std::min(m_BoxWidth, m_BackBuffer8[player]->w - bpx), std::min(m_BoxHeight, m_BackBuffer8[player]->h - bpy), layer });
+					}
+				}
+			}
+			size_t packetSize = GetFrameBoxPacketSize();
+			m_FrameBoxPackets[player].resize(boxTasks.size() * packetSize);
+
+			// Let the encoder threads in on the frame and help out until every box is claimed, then wait for the ones they claimed to be done.
+			FrameEncodeJob encodeJob;
+			encodeJob.Player = player;
+			encodeJob.NextTask = 0;
+			encodeJob.ActiveEncoders = 0;
+			bool shareJob = !m_EncoderThreads.empty() && static_cast<int>(boxTasks.size()) > c_FrameBoxTasksPerClaim;
+			if (shareJob) {
+				{
+					std::lock_guard<std::mutex> encodeLock(m_EncodeMutex);
+					m_FrameEncodeJobs.push_back(&encodeJob);
+				}
+				m_EncodeCondition.notify_all();
+			}
+			RunFrameEncodeJob(encodeJob, m_FrameBoxEncoders[player]);
+			if (shareJob) {
+				std::unique_lock<std::mutex> encodeLock(m_EncodeMutex);
+				std::deque<FrameEncodeJob *>::iterator queuedJob = std::find(m_FrameEncodeJobs.begin(), m_FrameEncodeJobs.end(), &encodeJob);
+				if (queuedJob != m_FrameEncodeJobs.end()) { m_FrameEncodeJobs.erase(queuedJob); }
+				m_EncodeDoneCondition.wait(encodeLock, [&encodeJob]() { return encodeJob.ActiveEncoders == 0; });
+			}
+			m_EncodeTimePerFrame[player] = g_TimerMan.GetAbsoluteTime() - encodeStartTime;
 
-							// Compression failed or ineffective, send as is
-							if (result == 0 || result == backBuffer->w) {
-#ifdef _WIN32
-								memcpy_s(m_PixelLineBuffer[player] + sizeof(MsgFrameBox), c_MaxPixelLineBufferSize, m_TerrainChangeBuffer[player], size);
-#else
-								memcpy(m_PixelLineBuffer[player] + sizeof(MsgFrameBox), m_TerrainChangeBuffer[player], size);
-#endif
-							} else {
-								frameData->DataSize = result;
-							}
+			for (size_t taskIndex = 0; taskIndex < boxTasks.size(); taskIndex++) {
+				const MsgFrameBox *frameData = (MsgFrameBox *)(m_FrameBoxPackets[player].data() + taskIndex * packetSize);
 
-							m_FullBlocks[player]++;
-						} else {
-							frameData->DataSize = 0;
-							m_EmptyBlocks[player]++;
-						}
+				if (frameData->Encoding == FrameBoxUnchanged) {
+					m_UnchangedBlocks[player]++;
+				} else if (frameData->Encoding == FrameBoxDelta) {
+					m_DeltaBlocks[player]++;
+				} else if (frameData->DataSize == 0) {
+					m_EmptyBlocks[player]++;
+				} else {
+					m_FullBlocks[player]++;
+				}
 
-						int payloadSize = frameData->DataSize + sizeof(MsgFrameBox);
+				int payloadSize = frameData->DataSize + sizeof(MsgFrameBox);
 
-						m_Server->Send((const char *)frameData, payloadSize, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 0, m_ClientConnections[player].ClientId, false);
+				m_Server->Send((const char *)frameData, payloadSize, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 0, m_ClientConnections[player].ClientId, false);
 
-						m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
-						m_DataSentTotal[player] += payloadSize;
+				m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
+				m_DataSentTotal[player] += payloadSize;
 
-						m_FrameDataSentCurrent[player][STAT_CURRENT] += payloadSize;
-						m_FrameDataSentTotal[player] += payloadSize;
+				m_FrameDataSentCurrent[player][STAT_CURRENT] += payloadSize;
+				m_FrameDataSentTotal[player] += payloadSize;
 
-						m_DataUncompressedCurrent[player][STAT_CURRENT] += frameData->UncompressedSize;
-						m_DataUncompressedTotal[player] += frameData->UncompressedSize;
-					}
-				}
+				m_DataUncompressedCurrent[player][STAT_CURRENT] += frameData->UncompressedSize;
+				m_DataUncompressedTotal[player] += frameData->UncompressedSize;
 			}
 		} else {
 			MsgFrameLine *frameData = (MsgFrameLine *)m_PixelLineBuffer[player];
@@ -1460,6 +1576,461 @@ namespace RTE {
 		return 0;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	size_t NetworkServer::GetFrameBoxPacketSize() const {
+		return sizeof(MsgFrameBox) + static_cast<size_t>(LZ4_COMPRESSBOUND(m_BoxWidth * m_BoxHeight));
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::RunFrameEncodeJob(FrameEncodeJob &encodeJob, FrameBoxEncoder &encoder) {
+		int taskCount = static_cast<int>(m_FrameBoxTasks[encodeJob.Player].size());
+		for (int firstTask = encodeJob.NextTask.fetch_add(c_FrameBoxTasksPerClaim); firstTask < taskCount; firstTask = encodeJob.NextTask.fetch_add(c_FrameBoxTasksPerClaim)) {
+			for (int taskIndex = firstTask; taskIndex < std::min(firstTask + c_FrameBoxTasksPerClaim, taskCount); taskIndex++) {
+				EncodeFrameBox(encodeJob.Player, taskIndex, encoder);
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::EncodeFrameBox(short player, int taskIndex, FrameBoxEncoder &encoder) {
+		const FrameBoxTask &boxTask = m_FrameBoxTasks[player][taskIndex];
+		BITMAP *backBuffer = (boxTask.Layer == 0) ? m_BackBuffer8[player] : m_BackBufferGUI8[player];
+		BITMAP *referenceBuffer = (boxTask.Layer == 0) ? m_ReferenceBackBuffer8[player] : m_ReferenceBackBufferGUI8[player];
+		FrameBoxState &boxState = m_FrameBoxStates[player][boxTask.Layer][boxTask.BoxIndex];
+
+		MsgFrameBox *frameData = (MsgFrameBox *)(m_FrameBoxPackets[player].data() + static_cast<size_t>(taskIndex) * GetFrameBoxPacketSize());
+		frameData->Id = ID_SRV_FRAME_BOX;
+		frameData->FrameNumber = m_FrameNumbers[player];
+		frameData->Layer = boxTask.Layer;
+		frameData->BoxX = boxTask.X;
+		frameData->BoxY = boxTask.Y;
+		frameData->BoxWidth = boxTask.Width;
+		frameData->BoxHeight = boxTask.Height;
+
+		int size = boxTask.Width * boxTask.Height;
+		frameData->UncompressedSize = size;
+		frameData->DataSize = size;
+
+		encoder.BoxBuffer.resize(static_cast<size_t>(m_BoxWidth * m_BoxHeight));
+		unsigned char *boxData = encoder.BoxBuffer.data();
+		bool boxIsEmpty = false;
+
+		bool sendKeyframe = !m_UseDeltaCompression || !boxState.HasReference || ++boxState.SendsSinceKeyframe >= c_FrameBoxKeyframeInterval;
+		if (boxState.SendsSinceKeyframe >= c_FrameBoxKeyframeInterval) { boxState.SendsSinceKeyframe = 0; }
+
+		if (sendKeyframe) {
+			frameData->Encoding = FrameBoxKeyframe;
+			unsigned char *dest = boxData;
+			for (int line = 0; line < boxTask.Height; line++) {
+				memcpy(dest, backBuffer->line[boxTask.Y + line] + boxTask.X, boxTask.Width);
+				dest += boxTask.Width;
+			}
+			boxIsEmpty = std::find_if(boxData, boxData + size, [](unsigned char pixel) { return pixel != 0; }) == boxData + size;
+		} else {
+			bool boxIsUnchanged = true;
+			for (int line = 0; line < boxTask.Height && boxIsUnchanged; line++) {
+				boxIsUnchanged = memcmp(backBuffer->line[boxTask.Y + line] + boxTask.X, referenceBuffer->line[boxTask.Y + line] + boxTask.X, boxTask.Width) == 0;
+			}
+			if (boxIsUnchanged) {
+				frameData->Encoding = FrameBoxUnchanged;
+			} else {
+				// XOR the box against what the client has, which leaves zeroes wherever nothing changed for the compression to squeeze out.
+				frameData->Encoding = FrameBoxDelta;
+				unsigned char *dest = boxData;
+				for (int line = 0; line < boxTask.Height; line++) {
+					const unsigned char *currentPixel = backBuffer->line[boxTask.Y + line] + boxTask.X;
+					const unsigned char *referencePixel = referenceBuffer->line[boxTask.Y + line] + boxTask.X;
+					for (int x = 0; x < boxTask.Width; x++) {
+						dest[x] = currentPixel[x] ^ referencePixel[x];
+					}
+					dest += boxTask.Width;
+				}
+			}
+		}
+
+		if (frameData->Encoding != FrameBoxUnchanged) {
+			boxState.Revision++;
+			if (m_UseDeltaCompression) {
+				boxState.HasReference = true;
+				for (int line = 0; line < boxTask.Height; line++) {
+					memcpy(referenceBuffer->line[boxTask.Y + line] + boxTask.X, backBuffer->line[boxTask.Y + line] + boxTask.X, boxTask.Width);
+				}
+			}
+		}
+		frameData->Revision = boxState.Revision;
+
+		if (frameData->Encoding == FrameBoxUnchanged || boxIsEmpty) {
+			frameData->DataSize = 0;
+			return;
+		}
+
+		unsigned char *compressedData = (unsigned char *)frameData + sizeof(MsgFrameBox);
+		int compressedCapacity = static_cast<int>(GetFrameBoxPacketSize() - sizeof(MsgFrameBox));
+		int result = 0;
+
+		bool useHighCompression = m_UseHighCompression;
+		if (useHighCompression) {
+			float entropy = GetEntropy(boxData, size);
+			useHighCompression = entropy >= c_MinHighCompressionEntropy && entropy <= c_MaxHighCompressionEntropy;
+		}
+		if (useHighCompression) {
+			result = LZ4_compress_HC_extStateHC(encoder.HighCompressionState, (char *)boxData, (char *)compressedData, size, compressedCapacity, m_HighCompressionLevel);
+		} else if (m_UseHighCompression || m_UseFastCompression) {
+			result = LZ4_compress_fast_extState(encoder.FastCompressionState, (char *)boxData, (char *)compressedData, size, compressedCapacity, m_FastAccelerationFactor);
+		}
+
+		// Compression failed or ineffective, send as is
+		if (result <= 0 || result >= size) {
+			memcpy(compressedData, boxData, size);
+		} else {
+			frameData->DataSize = result;
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	float NetworkServer::GetEntropy(const unsigned char *data, int dataSize) {
+		if (dataSize <= 0) {
+			return 0;
+		}
+		std::array<int, 256> symbolCounts = {};
+		for (int i = 0; i < dataSize; i++) {
+			symbolCounts[data[i]]++;
+		}
+		float entropy = 0;
+		for (int symbolCount : symbolCounts) {
+			if (symbolCount > 0) {
+				float probability = static_cast<float>(symbolCount) / static_cast<float>(dataSize);
+				entropy -= probability * std::log2(probability);
+			}
+		}
+		return entropy;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::CreateEntitySnapshot() {
+		std::shared_ptr<EntitySnapshot> entitySnapshot = std::make_shared<EntitySnapshot>();
+		entitySnapshot->SceneId = m_SceneID;
+		entitySnapshot->ServerTime = static_cast<unsigned int>(g_TimerMan.GetSimTickCount() * 1000 / g_TimerMan.GetTicksPerSecond());
+		entitySnapshot->GlobalAcc = g_SceneMan.GetGlobalAcc();
+
+		std::vector<std::string> newPresetNames;
+
+		// Stored pixels are only ever cosmetic, so they're sent as they were when they first appeared and the clients simulate them from there. That way they don't cost anything after they're first sent.
+		std::unordered_map<unsigned int, EntityStateNetworkData> cosmeticEntityStates;
+		const ParticleStore &particleStore = g_MovableMan.m_ParticleStore;
+		for (size_t i = 0; i < particleStore.GetCount(); i++) {
+			const MOPixel *pixel = particleStore.GetUpToDatePixel(i);
+			std::unordered_map<unsigned int, EntityStateNetworkData>::const_iterator cosmeticEntityState = m_CosmeticEntityStates.find(static_cast<unsigned int>(pixel->GetUniqueID()));
+			EntityStateNetworkData state;
+			if (cosmeticEntityState != m_CosmeticEntityStates.end()) {
+				state = cosmeticEntityState->second;
+			} else {
+				state = GetEntityState(pixel, newPresetNames);
+				state.Flags |= EntityCosmetic;
+			}
+			cosmeticEntityStates.try_emplace(state.UniqueID, state);
+			entitySnapshot->States.emplace_back(state);
+		}
+		m_CosmeticEntityStates.swap(cosmeticEntityStates);
+
+		// Same order as MovableMan draws them in.
+		for (const MovableObject *particle : g_MovableMan.m_Particles) {
+			AddEntityStates(particle, *entitySnapshot, newPresetNames);
+		}
+		for (std::deque<MovableObject *>::const_reverse_iterator itemItr = g_MovableMan.m_Items.crbegin(); itemItr != g_MovableMan.m_Items.crend(); ++itemItr) {
+			AddEntityStates(*itemItr, *entitySnapshot, newPresetNames);
+		}
+		for (std::deque<Actor *>::const_reverse_iterator actorItr = g_MovableMan.m_Actors.crbegin(); actorItr != g_MovableMan.m_Actors.crend(); ++actorItr) {
+			AddEntityStates(*actorItr, *entitySnapshot, newPresetNames);
+		}
+
+		// Each team only gets the entities that aren't in its unseen areas, or the fog of war would be given away by the snapshots.
+		const Activity *activity = g_ActivityMan.GetActivity();
+		std::array<std::shared_ptr<const EntitySnapshot>, Activity::MaxTeamCount> teamEntitySnapshots;
+		std::array<std::shared_ptr<const EntitySnapshot>, c_MaxClients> playerEntitySnapshots;
+		for (short player = 0; player < c_MaxClients; player++) {
+			if (!SendFrameData(player)) {
+				continue;
+			}
+			int team = activity->GetTeamOfPlayer(player);
+			if (team < Activity::TeamOne || team >= Activity::MaxTeamCount || !g_SceneMan.GetScene()->GetUnseenLayer(team)) {
+				playerEntitySnapshots[player] = entitySnapshot;
+				continue;
+			}
+			if (!teamEntitySnapshots[team]) {
+				std::shared_ptr<EntitySnapshot> teamEntitySnapshot = std::make_shared<EntitySnapshot>();
+				teamEntitySnapshot->SceneId = entitySnapshot->SceneId;
+				teamEntitySnapshot->ServerTime = entitySnapshot->ServerTime;
+				teamEntitySnapshot->GlobalAcc = entitySnapshot->GlobalAcc;
+				teamEntitySnapshot->States.reserve(entitySnapshot->States.size());
+				for (const EntityStateNetworkData &state : entitySnapshot->States) {
+					if (!g_SceneMan.IsUnseen(static_cast<int>(state.PosX), static_cast<int>(state.PosY), team)) { teamEntitySnapshot->States.emplace_back(state); }
+				}
+				teamEntitySnapshots[team] = teamEntitySnapshot;
+			}
+			playerEntitySnapshots[player] = teamEntitySnapshots[team];
+		}
+
+		std::lock_guard<std::mutex> entitySnapshotLock(m_EntitySnapshotMutex);
+		m_EntityPresetNames.insert(m_EntityPresetNames.end(), newPresetNames.begin(), newPresetNames.end());
+		for (short player = 0; player < c_MaxClients; player++) {
+			m_EntitySnapshots[player] = playerEntitySnapshots[player];
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::AddEntityStates(const MovableObject *movableObject, EntitySnapshot &entitySnapshot, std::vector<std::string> &newPresetNames) {
+		const MOSRotating *mosRotating = dynamic_cast<const MOSRotating *>(movableObject);
+
+		// Same order as MOSRotating draws its wounds and Attachables in. Attachables that their parents draw in some special way are put after their parent.
+		if (mosRotating) {
+			for (const AEmitter *wound : mosRotating->GetWoundList()) {
+				if (!wound->IsDrawnAfterParent()) { AddEntityStates(wound, entitySnapshot, newPresetNames); }
+			}
+			for (const Attachable *attachable : mosRotating->GetAttachableList()) {
+				if (!attachable->IsDrawnAfterParent() && attachable->IsDrawnNormallyByParent()) { AddEntityStates(attachable, entitySnapshot, newPresetNames); }
+			}
+		}
+		if (dynamic_cast<const MOSprite *>(movableObject) || dynamic_cast<const MOPixel *>(movableObject)) { entitySnapshot.States.emplace_back(GetEntityState(movableObject, newPresetNames)); }
+
+		if (mosRotating) {
+			for (const AEmitter *wound : mosRotating->GetWoundList()) {
+				if (wound->IsDrawnAfterParent()) { AddEntityStates(wound, entitySnapshot, newPresetNames); }
+			}
+			for (const Attachable *attachable : mosRotating->GetAttachableList()) {
+				if (attachable->IsDrawnAfterParent() || !attachable->IsDrawnNormallyByParent()) { AddEntityStates(attachable, entitySnapshot, newPresetNames); }
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	EntityStateNetworkData NetworkServer::GetEntityState(const MovableObject *movableObject, std::vector<std::string> &newPresetNames) {
+		EntityStateNetworkData state = {};
+		state.UniqueID = static_cast<unsigned int>(movableObject->GetUniqueID());
+		state.PosX = movableObject->GetPos().GetX();
+		state.PosY = movableObject->GetPos().GetY();
+		state.VelX = movableObject->GetVel().GetX();
+		state.VelY = movableObject->GetVel().GetY();
+		state.Team = static_cast<signed char>(movableObject->GetTeam());
+
+		if (const MOPixel *pixel = dynamic_cast<const MOPixel *>(movableObject)) {
+			state.Frame = static_cast<unsigned short>(pixel->GetColor().GetIndex());
+			state.Flags = EntityPixel;
+		} else if (const MOSprite *sprite = dynamic_cast<const MOSprite *>(movableObject)) {
+			std::string presetName = sprite->GetClassName() + '\0' + sprite->GetModuleAndPresetName() + '\0';
+			std::unordered_map<std::string, unsigned int>::const_iterator presetIndex = m_EntityPresetIndices.find(presetName);
+			if (presetIndex == m_EntityPresetIndices.end() && m_EntityPresetIndices.size() < c_MaxEntityPresets) {
+				presetIndex = m_EntityPresetIndices.try_emplace(presetName, static_cast<unsigned int>(m_EntityPresetIndices.size() + 1)).first;
+				newPresetNames.emplace_back(presetName);
+			}
+
+			state.PresetIndex = (presetIndex != m_EntityPresetIndices.end()) ? presetIndex->second : 0;
+			state.Rotation = sprite->GetRotAngle();
+			state.Frame = static_cast<unsigned short>(sprite->GetFrame());
+			state.Flags = sprite->IsHFlipped() ? EntityHFlipped : 0;
+		}
+		return state;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::SendEntityPresetsMsg(short player) {
+		std::vector<unsigned char> &msgBuffer = m_EntitySnapshotMsgBuffer[player];
+		unsigned int firstIndex = m_EntityPresetsSent[player] + 1;
+		{
+			std::lock_guard<std::mutex> entitySnapshotLock(m_EntitySnapshotMutex);
+			if (m_EntityPresetsSent[player] >= m_EntityPresetNames.size()) {
+				return;
+			}
+			msgBuffer.resize(sizeof(MsgEntityPresets));
+			for (size_t i = m_EntityPresetsSent[player]; i < m_EntityPresetNames.size(); i++) {
+				msgBuffer.insert(msgBuffer.end(), m_EntityPresetNames[i].begin(), m_EntityPresetNames[i].end());
+			}
+			m_EntityPresetsSent[player] = static_cast<unsigned int>(m_EntityPresetNames.size());
+		}
+
+		MsgEntityPresets *msg = (MsgEntityPresets *)msgBuffer.data();
+		msg->Id = ID_SRV_ENTITY_PRESETS;
+		msg->FirstIndex = firstIndex;
+		msg->Count = m_EntityPresetsSent[player] + 1 - firstIndex;
+		msg->DataSize = static_cast<unsigned int>(msgBuffer.size() - sizeof(MsgEntityPresets));
+
+		m_Server->Send((const char *)msgBuffer.data(), static_cast<int>(msgBuffer.size()), HIGH_PRIORITY, RELIABLE_ORDERED, 2, m_ClientConnections[player].ClientId, false);
+
+		m_OtherDataSentCurrent[player][STAT_CURRENT] += msgBuffer.size();
+		m_OtherDataSentTotal[player] += msgBuffer.size();
+		m_DataSentTotal[player] += msgBuffer.size();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::SendEntitySnapshotMsg(short player) {
+		std::deque<std::pair<unsigned int, std::shared_ptr<const EntitySnapshot>>> &sentSnapshots = m_SentEntitySnapshots[player];
+		if (m_EntityStateResetRequested[player].exchange(false)) {
+			sentSnapshots.clear();
+			m_EntityPresetsSent[player] = 0;
+		}
+		SendEntityPresetsMsg(player);
+
+		std::shared_ptr<const EntitySnapshot> entitySnapshot;
+		{
+			std::lock_guard<std::mutex> entitySnapshotLock(m_EntitySnapshotMutex);
+			entitySnapshot = m_EntitySnapshots[player];
+		}
+		if (!entitySnapshot) {
+			return;
+		}
+
+		// The client only acks the newest snapshot it has and drops any older ones that arrive late, so snapshots older than the ack will never be sent against again.
+		unsigned int ackedSequence = m_AckedEntitySnapshot[player];
+		while (!sentSnapshots.empty() && sentSnapshots.front().first < ackedSequence) {
+			sentSnapshots.pop_front();
+		}
+		const EntitySnapshot *baseSnapshot = nullptr;
+		if (!sentSnapshots.empty() && sentSnapshots.front().first == ackedSequence && sentSnapshots.front().second->SceneId == entitySnapshot->SceneId) { baseSnapshot = sentSnapshots.front().second.get(); }
+
+		std::vector<unsigned char> &rawData = m_EntitySnapshotRawBuffer[player];
+		rawData.clear();
+		unsigned int removedCount = 0;
+		unsigned int orderCount = 0;
+		unsigned int stateCount = 0;
+
+		if (baseSnapshot) {
+			std::unordered_map<unsigned int, const EntityStateNetworkData *> baseStates;
+			baseStates.reserve(baseSnapshot->States.size());
+			for (const EntityStateNetworkData &baseState : baseSnapshot->States) {
+				baseStates.try_emplace(baseState.UniqueID, &baseState);
+			}
+
+			// Lay the changed states out after where the removed IDs will go, since which entities were removed is only known once every current one is found in the base.
+			// The client keeps the entities it already had in the base order and puts new ones after them, so the order only has to be sent when the draw order differs from that.
+			std::vector<unsigned char> stateData;
+			std::ptrdiff_t lastBaseStateIndex = -1;
+			bool newStateListed = false;
+			bool orderChanged = false;
+			for (const EntityStateNetworkData &state : entitySnapshot->States) {
+				std::unordered_map<unsigned int, const EntityStateNetworkData *>::iterator baseState = baseStates.find(state.UniqueID);
+				unsigned char changedFields = EntityFieldsAll;
+				if (baseState != baseStates.end()) {
+					std::ptrdiff_t baseStateIndex = baseState->second - baseSnapshot->States.data();
+					if (newStateListed || baseStateIndex < lastBaseStateIndex) { orderChanged = true; }
+					lastBaseStateIndex = baseStateIndex;
+
+					changedFields = GetChangedEntityStateFields(state, *baseState->second);
+					baseStates.erase(baseState);
+				} else {
+					newStateListed = true;
+				}
+				if (changedFields != 0) {
+					WriteEntityState(state, changedFields, stateData);
+					stateCount++;
+				}
+			}
+			for (const std::pair<const unsigned int, const EntityStateNetworkData *> &removedState : baseStates) {
+				const unsigned char *removedID = reinterpret_cast<const unsigned char *>(&removedState.first);
+				rawData.insert(rawData.end(), removedID, removedID + sizeof(unsigned int));
+				removedCount++;
+			}
+			if (orderChanged) {
+				for (const EntityStateNetworkData &state : entitySnapshot->States) {
+					const unsigned char *uniqueID = reinterpret_cast<const unsigned char *>(&state.UniqueID);
+					rawData.insert(rawData.end(), uniqueID, uniqueID + sizeof(unsigned int));
+				}
+				orderCount = static_cast<unsigned int>(entitySnapshot->States.size());
+			}
+			rawData.insert(rawData.end(), stateData.begin(), stateData.end());
+		} else {
+			for (const EntityStateNetworkData &state : entitySnapshot->States) {
+				WriteEntityState(state, EntityFieldsAll, rawData);
+				stateCount++;
+			}
+		}
+
+		std::vector<unsigned char> &msgBuffer = m_EntitySnapshotMsgBuffer[player];
+		msgBuffer.resize(sizeof(MsgEntitySnapshot) + static_cast<size_t>(LZ4_compressBound(static_cast<int>(rawData.size()))));
+		int dataSize = rawData.empty() ? 0 : LZ4_compress_fast_extState(m_LZ4FastCompressionState[player], (const char *)rawData.data(), (char *)(msgBuffer.data() + sizeof(MsgEntitySnapshot)), static_cast<int>(rawData.size()), static_cast<int>(msgBuffer.size() - sizeof(MsgEntitySnapshot)), 1);
+		if (dataSize <= 0 || dataSize >= static_cast<int>(rawData.size())) {
+			dataSize = static_cast<int>(rawData.size());
+			if (dataSize > 0) { memcpy(msgBuffer.data() + sizeof(MsgEntitySnapshot), rawData.data(), rawData.size()); }
+		}
+
+		MsgEntitySnapshot *msg = (MsgEntitySnapshot *)msgBuffer.data();
+		msg->Id = ID_SRV_ENTITY_SNAPSHOT;
+		msg->SceneId = entitySnapshot->SceneId;
+		msg->Sequence = ++m_EntitySnapshotSequence[player];
+		msg->BaseSequence = baseSnapshot ? ackedSequence : 0;
+		msg->ServerTime = entitySnapshot->ServerTime;
+		msg->GlobalAccX = entitySnapshot->GlobalAcc.GetX();
+		msg->GlobalAccY = entitySnapshot->GlobalAcc.GetY();
+		msg->RemovedCount = removedCount;
+		msg->OrderCount = orderCount;
+		msg->StateCount = stateCount;
+		msg->RawSize = static_cast<unsigned int>(rawData.size());
+		msg->DataSize = static_cast<unsigned int>(dataSize);
+
+		int payloadSize = static_cast<int>(sizeof(MsgEntitySnapshot)) + dataSize;
+		m_Server->Send((const char *)msgBuffer.data(), payloadSize, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 3, m_ClientConnections[player].ClientId, false);
+
+		sentSnapshots.emplace_back(msg->Sequence, entitySnapshot);
+		while (sentSnapshots.size() > c_EntitySnapshotHistorySize) {
+			sentSnapshots.pop_front();
+		}
+
+		m_DataSentCurrent[player][STAT_CURRENT] += payloadSize;
+		m_DataSentTotal[player] += payloadSize;
+
+		m_FrameDataSentCurrent[player][STAT_CURRENT] += payloadSize;
+		m_FrameDataSentTotal[player] += payloadSize;
+
+		m_DataUncompressedCurrent[player][STAT_CURRENT] += sizeof(MsgEntitySnapshot) + rawData.size();
+		m_DataUncompressedTotal[player] += sizeof(MsgEntitySnapshot) + rawData.size();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void NetworkServer::WriteEntityState(const EntityStateNetworkData &state, unsigned char fields, std::vector<unsigned char> &data) {
+		auto writeValue = [&data](const auto &value) {
+			const unsigned char *valueBytes = reinterpret_cast<const unsigned char *>(&value);
+			data.insert(data.end(), valueBytes, valueBytes + sizeof(value));
+		};
+		writeValue(state.UniqueID);
+		writeValue(fields);
+		if (fields & EntityFieldPreset) { writeValue(state.PresetIndex); }
+		if (fields & EntityFieldPos) {
+			writeValue(state.PosX);
+			writeValue(state.PosY);
+		}
+		if (fields & EntityFieldVel) {
+			writeValue(state.VelX);
+			writeValue(state.VelY);
+		}
+		if (fields & EntityFieldRotation) { writeValue(state.Rotation); }
+		if (fields & EntityFieldFrame) { writeValue(state.Frame); }
+		if (fields & EntityFieldTeam) { writeValue(state.Team); }
+		if (fields & EntityFieldFlags) { writeValue(state.Flags); }
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	unsigned char NetworkServer::GetChangedEntityStateFields(const EntityStateNetworkData &state, const EntityStateNetworkData &baseState) {
+		unsigned char changedFields = 0;
+		if (state.PresetIndex != baseState.PresetIndex) { changedFields |= EntityFieldPreset; }
+		if (state.PosX != baseState.PosX || state.PosY != baseState.PosY) { changedFields |= EntityFieldPos; }
+		if (state.VelX != baseState.VelX || state.VelY != baseState.VelY) { changedFields |= EntityFieldVel; }
+		if (state.Rotation != baseState.Rotation) { changedFields |= EntityFieldRotation; }
+		if (state.Frame != baseState.Frame) { changedFields |= EntityFieldFrame; }
+		if (state.Team != baseState.Team) { changedFields |= EntityFieldTeam; }
+		if (state.Flags != baseState.Flags) { changedFields |= EntityFieldFlags; }
+		return changedFields;
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void NetworkServer::UpdateStats(short player) {
@@ -1505,7 +2076,7 @@ namespace RTE {
 		guid += GetServerGUID().ToString();
 		g_FrameMan.GetLargeFont()->DrawAligned(&guiBMP, midX, 5, guid, GUIFont::Centre);
 
-		char buf[256];
+		char buf[512];
 
 		if (m_NatServerConnected) {
 			std::snprintf(buf, sizeof(buf), "NAT SERVICE CONNECTED\nName: %s  Pass: %s", g_SettingsMan.GetNATServerName().c_str(), g_SettingsMan.GetNATServerPassword().c_str());
@@ -1545,6 +2116,8 @@ namespace RTE {
 
 		m_FullBlocks[c_MaxClients] = 0;
 		m_EmptyBlocks[c_MaxClients] = 0;
+		m_DeltaBlocks[c_MaxClients] = 0;
+		m_UnchangedBlocks[c_MaxClients] = 0;
 
 
 		for (short i = 0; i < MAX_STAT_RECORDS; i++) {
@@ -1571,6 +2144,8 @@ namespace RTE {
 
 				m_FullBlocks[c_MaxClients] += m_FullBlocks[i];
 				m_EmptyBlocks[c_MaxClients] += m_EmptyBlocks[i];
+				m_DeltaBlocks[c_MaxClients] += m_DeltaBlocks[i];
+				m_UnchangedBlocks[c_MaxClients] += m_UnchangedBlocks[i];
 			}
 
 			// Update compression ratio
@@ -1583,7 +2158,7 @@ namespace RTE {
 
 			// Jesus christ
 			std::snprintf(buf, sizeof(buf),
-					  "%s\nPing %u\nCmp Mbit: %.1f\nUnc Mbit: %.1f\nR: %.2f\nFrame Kbit: %lu\nGlow Kbit: %lu\nSound Kbit: %lu\nScene Kbit: %lu\nFrames sent: %uK\nFrame skipped: %uK\nBlocks full: %uK\nBlocks empty: %uK\nBlk Ratio: %.2f\nFPS: %d\nSend Ms %d\nTotal Data %lu MB",
+					  "%s\nPing %u\nCmp Mbit: %.1f\nUnc Mbit: %.1f\nR: %.2f\nFrame Kbit: %lu\nGlow Kbit: %lu\nSound Kbit: %lu\nScene Kbit: %lu\nFrames sent: %uK\nFrame skipped: %uK\nBlocks full: %uK\nBlocks empty: %uK\nBlocks delta: %uK\nBlocks same: %uK\nBlk Ratio: %.2f\nFPS: %d\nSend Ms %d\nEncode Ms %.2f\nTotal Data %lu MB",
 					  (i == c_MaxClients) ? "- TOTALS - " : playerName.c_str(),
 					  (i < c_MaxClients) ? m_Ping[i] : 0,
 					  static_cast<double>(m_DataSentCurrent[i][STAT_SHOWN]) / 125000,
@@ -1597,9 +2172,12 @@ namespace RTE {
 					  m_FramesSkipped[i] / 1000,
 					  m_FullBlocks[i] / 1000,
 					  m_EmptyBlocks[i] / 1000,
+					  m_DeltaBlocks[i] / 1000,
+					  m_UnchangedBlocks[i] / 1000,
 					  emptyRatio,
 					  (i < c_MaxClients) ? fps : 0,
 					  (i < c_MaxClients) ? m_MsecPerSendCall[i] : 0,
+					  (i < c_MaxClients) ? static_cast<double>(m_EncodeTimePerFrame[i]) / 1000.0 : 0.0,
 					  m_DataSentTotal[i] / (1024 * 1024)
 			);
 
@@ -1706,9 +2284,19 @@ namespace RTE {
 					}
 				}
 			}
+
+			if (m_ReplicateEntityState && g_ActivityMan.IsInActivity()) {
+				for (short player = 0; player < c_MaxClients; player++) {
+					if (SendFrameData(player)) {
+						CreateEntitySnapshot();
+						break;
+					}
+				}
+			}
 		}
 
-		DrawStatisticsData();
+		// The statistics are drawn for the local display, which there isn't any of in headless mode.
+		if (!System::IsHeadless()) { DrawStatisticsData(); }
 
 		// Clear sound events for unconnected players because AudioMan does not know about their state and stores broadcast sounds to their event lists
 		for (short player = 0; player < c_MaxClients; player++) {
@@ -1780,6 +2368,9 @@ namespace RTE {
 				case ID_CLT_SCENE_ACCEPTED:
 					ReceiveSceneAcceptedMsg(packet);
 					break;
+				case ID_CLT_KEYFRAME_REQUEST:
+					ReceiveKeyframeRequestMsg(packet);
+					break;
 				case ID_CONNECTION_REQUEST_ACCEPTED:
 					break;
 				case ID_NAT_SERVER_REGISTER_ACCEPTED:
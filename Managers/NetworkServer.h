@@ -14,6 +14,8 @@
 
 namespace RTE {
 
+	class MovableObject;
+
 	/// <summary>
 	/// The centralized singleton manager of the network multiplayer server.
 	/// </summary>
@@ -86,6 +88,13 @@ namespace RTE {
 		/// <returns></returns>
 		bool ReadyForSimulation();
 
+		/// <summary>
+		/// Gets whether a frame should be drawn for the clients now, which is when a connected client waits for one and the last one was drawn long enough ago for the send threads to have picked it up.
+		/// A frame is counted as drawn when this returns true. Used in headless mode, where nothing else needs frames drawn.
+		/// </summary>
+		/// <returns>Whether a frame should be drawn for the clients now.</returns>
+		bool NetworkFrameNeeded();
+
 		/// <summary>
 		/// Gets the network player's name.
 		/// </summary>
@@ -112,6 +121,12 @@ namespace RTE {
 		/// <param name="newMode">Whether to use interlacing or not.</param>
 		void SetInterlacingMode(bool newMode) { m_UseInterlacing = newMode; }
 
+		/// <summary>
+		/// Gets whether the clients are sent the state of the entities in the scene to draw themselves, instead of having them drawn into the frames.
+		/// </summary>
+		/// <returns>Whether entity state is replicated to the clients or not.</returns>
+		bool ReplicatesEntityState() const { return m_ReplicateEntityState; }
+
 		/// <summary>
 		/// Sets the duration this thread should be put to sleep for in milliseconds.
 		/// </summary>
@@ -165,14 +180,20 @@ namespace RTE {
 		void ResetScene();
 
 		/// <summary>
-		/// 
+		/// Packs the terrain changes of one sim update, with their pixels as they are now, into a batch to be sent to every connected player.
 		/// </summary>
-		/// <param name="terrainChange"></param>
-		void RegisterTerrainChange(SceneMan::TerrainChange terrainChange);
+		/// <param name="terrainChanges">The changed areas of the terrain, which must be within the bounds of the scene.</param>
+		void RegisterTerrainChanges(const std::vector<SceneMan::TerrainChange> &terrainChanges);
 #pragma endregion
 
 	protected:
 
+		static constexpr int c_FrameBoxKeyframeInterval = 120; //!< The number of times a box is sent as a delta or unchanged before it's sent whole again, in case the client lost track of it without noticing.
+		static constexpr int c_FrameBoxTasksPerClaim = 4; //!< The number of boxes an encoder takes from a frame at a time.
+		static constexpr float c_MinHighCompressionEntropy = 1.5F; //!< Boxes with less entropy than this, in bits per pixel, are mostly flat and fast compression gets nearly as much out of them as high compression.
+		static constexpr float c_MaxHighCompressionEntropy = 7.0F; //!< Boxes with more entropy than this, in bits per pixel, are close to noise and high compression would only waste time on them.
+		static constexpr int c_EntitySnapshotHistorySize = 32; //!< The number of entity snapshots sent to each client that are kept to send deltas against, for when the client's acks are a bit behind.
+
 		/// <summary>
 		/// 
 		/// </summary>
@@ -186,6 +207,65 @@ namespace RTE {
 			std::string PlayerName; //!<
 		};
 
+		/// <summary>
+		/// The terrain changes of one sim update, packed the same for every player. Only the sequence number differs between players, so it's added when sending.
+		/// </summary>
+		struct TerrainChangeBatch {
+			unsigned int RegionCount; //!< The number of changed regions.
+			unsigned int RawSize; //!< The size of the regions and their pixels before any encoding.
+			unsigned int RunLengthSize; //!< The size of the regions and their pixels after run-length encoding.
+			std::vector<unsigned char> Data; //!< The run-length encoded regions and their pixels, LZ4 compressed unless that didn't make them any smaller.
+		};
+
+		/// <summary>
+		/// The state of every entity in the scene at one sim update, shared by every player's send thread.
+		/// </summary>
+		struct EntitySnapshot {
+			unsigned char SceneId; //!< The ID of the scene the entities are in.
+			unsigned int ServerTime; //!< The sim time of the snapshot in ms.
+			Vector GlobalAcc; //!< The global acceleration of the scene, for the clients to simulate cosmetic entities with.
+			std::vector<EntityStateNetworkData> States; //!< The state of every entity, in the order they're drawn.
+		};
+
+		/// <summary>
+		/// What the server knows about what a client has in one box of one layer of its frame, for encoding the box against it.
+		/// </summary>
+		struct FrameBoxState {
+			bool HasReference; //!< Whether the client was sent this box since it was last told to start over, so the reference back buffer holds what it has.
+			unsigned short Revision; //!< The revision of the box last sent to the client, which counts up every time the box's pixels change.
+			int SendsSinceKeyframe; //!< The number of times the box was sent since it was last sent whole on schedule.
+		};
+
+		/// <summary>
+		/// One box of one layer of a frame to be encoded into a packet.
+		/// </summary>
+		struct FrameBoxTask {
+			int BoxIndex; //!< The index of the box in the player's FrameBoxStates.
+			int X; //!< The X position of the box in the back buffer.
+			int Y; //!< The Y position of the box in the back buffer.
+			int Width; //!< The width of the box, which is less than the set box width at the right edge of the back buffer.
+			int Height; //!< The height of the box, which is less than the set box height at the bottom edge of the back buffer.
+			int Layer; //!< Which back buffer the box is in, 0 for the world and 1 for the GUI.
+		};
+
+		/// <summary>
+		/// What a thread needs to encode boxes. Each thread has its own, so they never share compression state.
+		/// </summary>
+		struct FrameBoxEncoder {
+			void *HighCompressionState; //!< The LZ4 HC compression state.
+			void *FastCompressionState; //!< The LZ4 fast compression state.
+			std::vector<unsigned char> BoxBuffer; //!< The buffer boxes are gathered or XORed into before compressing.
+		};
+
+		/// <summary>
+		/// The boxes of one player's frame being encoded, handed out to the encoder threads and the player's send thread a few at a time.
+		/// </summary>
+		struct FrameEncodeJob {
+			short Player; //!< The player whose FrameBoxTasks are being encoded.
+			std::atomic<int> NextTask; //!< The index of the next task nobody has claimed yet.
+			int ActiveEncoders; //!< The number of encoder threads working on this job. Guarded by m_EncodeMutex.
+		};
+
 		bool m_IsInServerMode = false; //!<
 
 		bool m_SleepWhenIdle; //!< If true puts thread to sleep if it didn't receive anything for 10 seconds to avoid melting the CPU at 100% even if there are no connections.
@@ -212,6 +292,24 @@ namespace RTE {
 		BITMAP *m_BackBuffer8[c_MaxClients]; //!<
 		BITMAP *m_BackBufferGUI8[c_MaxClients]; //!<
 
+		BITMAP *m_ReferenceBackBuffer8[c_MaxClients]; //!< The back buffer as last sent to each client, box by box, for finding which boxes changed and what changed in them.
+		BITMAP *m_ReferenceBackBufferGUI8[c_MaxClients]; //!< The GUI back buffer as last sent to each client, box by box.
+		std::vector<FrameBoxState> m_FrameBoxStates[c_MaxClients][2]; //!< The state of every box of each layer sent to each client, in rows of boxes.
+		std::atomic<bool> m_KeyframeRequested[c_MaxClients]; //!< Whether each client asked for or needs every box sent whole again, because it lost track of some of them.
+
+		std::vector<FrameBoxTask> m_FrameBoxTasks[c_MaxClients]; //!< The boxes of each player's current frame, in the order they're sent.
+		std::vector<unsigned char> m_FrameBoxPackets[c_MaxClients]; //!< The encoded packets of each player's current frame, one slot of GetFrameBoxPacketSize() bytes for each of the FrameBoxTasks.
+		FrameBoxEncoder m_FrameBoxEncoders[c_MaxClients]; //!< The encoder each player's send thread uses to help with its own frames, using the player's LZ4 states.
+
+		int m_EncoderThreadCount; //!< The number of encoder threads to start. 0 means as many as half the hardware threads, up to 8.
+		std::vector<std::thread> m_EncoderThreads; //!< The encoder threads shared by all the players' send threads.
+		std::deque<FrameEncodeJob *> m_FrameEncodeJobs; //!< The frames waiting for encoder threads to help encode them. Guarded by m_EncodeMutex.
+		std::mutex m_EncodeMutex; //!< Mutex guarding the encode jobs and the encoder threads' stop flag.
+		std::condition_variable m_EncodeCondition; //!< Condition the encoder threads wait on until there's a frame to encode or they should stop.
+		std::condition_variable m_EncodeDoneCondition; //!< Condition the send threads wait on until no encoder thread is working on their frame anymore.
+		bool m_StopEncoders; //!< Whether the encoder threads should stop. Guarded by m_EncodeMutex.
+		long long m_EncodeTimePerFrame[c_MaxClients]; //!< The time in microseconds it took to encode each player's last frame.
+
 		void *m_LZ4CompressionState[c_MaxClients]; //!<
 		void *m_LZ4FastCompressionState[c_MaxClients]; //!<
 
@@ -236,6 +334,22 @@ namespace RTE {
 
 		bool m_UseInterlacing; //!< Use interlacing to heavily reduce bandwidth usage at the cost of visual degradation (unusable at 30 fps, but may be suitable at 60 fps).
 		int m_EncodingFps; //!< Frame transmission rate. Higher value equals more CPU and bandwidth consumption.
+		bool m_UseDeltaCompression; //!< Whether to send boxes as XOR deltas against what the client already has, or as just a header if they didn't change, instead of whole every frame.
+		bool m_ReplicateEntityState; //!< Whether to send the state of the entities in the scene for the clients to draw themselves, instead of drawing them into the frames.
+
+		std::shared_ptr<const EntitySnapshot> m_EntitySnapshots[c_MaxClients]; //!< The latest entity snapshot for each player, without the entities its team can't see. Guarded by m_EntitySnapshotMutex.
+		std::vector<std::string> m_EntityPresetNames; //!< The null-terminated class and module and preset names of every preset entity snapshots refer to, for index 1 and up. Guarded by m_EntitySnapshotMutex.
+		std::mutex m_EntitySnapshotMutex; //!< Mutex guarding the latest entity snapshots and the preset names.
+		std::unordered_map<std::string, unsigned int> m_EntityPresetIndices; //!< The index of every preset in m_EntityPresetNames, by its names. Only used on the main thread.
+		std::unordered_map<unsigned int, EntityStateNetworkData> m_CosmeticEntityStates; //!< The state every cosmetic entity in the latest snapshot had when it first appeared, by unique ID. Only used on the main thread.
+
+		std::deque<std::pair<unsigned int, std::shared_ptr<const EntitySnapshot>>> m_SentEntitySnapshots[c_MaxClients]; //!< The entity snapshots recently sent to each player that are newer than its last ack, by sequence number.
+		unsigned int m_EntitySnapshotSequence[c_MaxClients]; //!< The sequence number of the last entity snapshot sent to each player.
+		std::atomic<unsigned int> m_AckedEntitySnapshot[c_MaxClients]; //!< The sequence number of the newest entity snapshot each player said it has.
+		std::atomic<bool> m_EntityStateResetRequested[c_MaxClients]; //!< Whether each player started a new scene, so it has no entity snapshots or preset names anymore.
+		unsigned int m_EntityPresetsSent[c_MaxClients]; //!< The number of preset names sent to each player.
+		std::vector<unsigned char> m_EntitySnapshotRawBuffer[c_MaxClients]; //!< The buffer each player's entity snapshots are laid out in before compressing.
+		std::vector<unsigned char> m_EntitySnapshotMsgBuffer[c_MaxClients]; //!< The buffer each player's entity snapshot and preset messages are put together in.
 
 		bool m_SendEven[c_MaxClients]; //!<
 
@@ -249,8 +363,14 @@ namespace RTE {
 		std::mutex m_SceneLock[c_MaxClients]; //!<
 
 		unsigned char m_TerrainChangeBuffer[c_MaxClients][c_MaxPixelLineBufferSize]; //!<
-		std::queue<SceneMan::TerrainChange> m_PendingTerrainChanges[c_MaxClients]; //!<
-		std::queue<SceneMan::TerrainChange> m_CurrentTerrainChanges[c_MaxClients]; //!<
+		std::queue<std::shared_ptr<const TerrainChangeBatch>> m_PendingTerrainChanges[c_MaxClients]; //!< The terrain change batches waiting to be sent to each player, in order.
+		std::vector<std::shared_ptr<const TerrainChangeBatch>> m_CurrentTerrainChanges[c_MaxClients]; //!< The terrain change batches being sent to each player, taken from the pending ones.
+		unsigned int m_TerrainChangeSequence[c_MaxClients]; //!< The sequence number of the next terrain change batch sent to each player, counted from the start of the scene.
+		std::vector<unsigned char> m_TerrainChangeMsgBuffer[c_MaxClients]; //!< The buffer each player's terrain change batch messages are put together in.
+
+		void *m_TerrainChangeCompressionState; //!< The LZ4 state for compressing terrain change batches, which is done on the main thread rather than any player's.
+		std::vector<unsigned char> m_TerrainChangeRawBuffer; //!< The buffer the terrain change batches are laid out in before encoding.
+		std::vector<unsigned char> m_TerrainChangeRunLengthBuffer; //!< The buffer the terrain change batches are run-length encoded into before compressing.
 
 		std::mutex m_Mutex[c_MaxClients]; //!<
 
@@ -270,6 +390,7 @@ namespace RTE {
 		Timer m_PingTimer[c_MaxClients]; //!<
 
 		Timer m_LastPackedReceived; //!<
+		Timer m_NetworkFrameTimer; //!< Time since a frame was last drawn for the clients in headless mode.
 
 		/// <summary>
 		/// Transmit frames as blocks instead of lines. Provides better compression at the cost of higher CPU usage.
@@ -281,6 +402,8 @@ namespace RTE {
 
 		int m_EmptyBlocks[MAX_STAT_RECORDS]; //!<
 		int m_FullBlocks[MAX_STAT_RECORDS]; //!<
+		int m_DeltaBlocks[MAX_STAT_RECORDS]; //!< Number of boxes sent as XOR deltas to each client and total.
+		int m_UnchangedBlocks[MAX_STAT_RECORDS]; //!< Number of boxes sent as unchanged to each client and total.
 		int m_SendBufferBytes[MAX_STAT_RECORDS]; //!<
 		int m_SendBufferMessages[MAX_STAT_RECORDS]; //!<
 		int m_DelayedFrames[c_MaxClients]; //!<
@@ -324,6 +447,22 @@ namespace RTE {
 		/// <param name="player"></param>
 		static void BackgroundSendThreadFunction(NetworkServer *server, short player);
 
+		/// <summary>
+		/// Function for the encoder threads, which help encode the boxes of whichever frames are waiting until told to stop.
+		/// </summary>
+		/// <param name="server">The NetworkServer the thread encodes for.</param>
+		static void EncoderThreadFunction(NetworkServer *server);
+
+		/// <summary>
+		/// Starts the encoder threads, if they aren't already running.
+		/// </summary>
+		void StartEncoderThreads();
+
+		/// <summary>
+		/// Stops the encoder threads and waits for them to finish.
+		/// </summary>
+		void StopEncoderThreads();
+
 		/// <summary>
 		/// 
 		/// </summary>
@@ -462,11 +601,19 @@ namespace RTE {
 		void ProcessTerrainChanges(short player);
 
 		/// <summary>
-		/// 
+		/// Sends a terrain change batch to a player as one message, numbered with the player's next terrain change sequence number.
 		/// </summary>
-		/// <param name="player"></param>
-		/// <param name="terrainChange"></param>
-		void SendTerrainChangeMsg(short player, SceneMan::TerrainChange terrainChange);
+		/// <param name="player">The player to send the batch to.</param>
+		/// <param name="terrainChangeBatch">The batch to send.</param>
+		void SendTerrainChangeMsg(short player, const TerrainChangeBatch &terrainChangeBatch);
+
+		/// <summary>
+		/// Run-length encodes data the way MsgTerrainChangeBatch describes, which takes care of the long runs of the same color in terrain changes before LZ4 gets to them.
+		/// </summary>
+		/// <param name="data">The data to encode.</param>
+		/// <param name="dataSize">The size of the data to encode.</param>
+		/// <param name="encodedData">The vector to put the encoded data in, replacing whatever is in it.</param>
+		static void RunLengthEncode(const unsigned char *data, size_t dataSize, std::vector<unsigned char> &encodedData);
 
 		/// <summary>
 		/// 
@@ -496,6 +643,18 @@ namespace RTE {
 		/// <param name="player"></param>
 		void DestroyBackBuffer(short player);
 
+		/// <summary>
+		/// Forgets what the client has in every box, so they're all sent whole the next time they're sent.
+		/// </summary>
+		/// <param name="player">The player to forget the boxes of.</param>
+		void ResetFrameBoxStates(short player);
+
+		/// <summary>
+		/// Handles a client asking for every box to be sent whole again, because it missed some and can't apply deltas to them.
+		/// </summary>
+		/// <param name="packet">The packet to handle.</param>
+		void ReceiveKeyframeRequestMsg(RakNet::Packet *packet);
+
 		/// <summary>
 		/// 
 		/// </summary>
@@ -521,6 +680,87 @@ namespace RTE {
 		/// <param name="player"></param>
 		/// <returns></returns>
 		int SendFrame(short player);
+
+		/// <summary>
+		/// Gets the size of each packet slot in m_FrameBoxPackets, which fits a whole box even if compressing it made it bigger.
+		/// </summary>
+		/// <returns>The size of a packet slot in bytes.</returns>
+		size_t GetFrameBoxPacketSize() const;
+
+		/// <summary>
+		/// Claims and encodes boxes of a frame until none are left unclaimed.
+		/// </summary>
+		/// <param name="encodeJob">The frame to encode boxes of.</param>
+		/// <param name="encoder">The encoder of the calling thread.</param>
+		void RunFrameEncodeJob(FrameEncodeJob &encodeJob, FrameBoxEncoder &encoder);
+
+		/// <summary>
+		/// Encodes one box of one layer of a player's frame into its packet slot as a keyframe, delta or unchanged, updating what the server knows the client has in the box.
+		/// Picks between high and fast compression by the entropy of the box. Only touches the box's own state, reference pixels and packet slot, so boxes can be encoded on any number of threads at once.
+		/// </summary>
+		/// <param name="player">The player whose frame the box is in.</param>
+		/// <param name="taskIndex">The index of the box in the player's FrameBoxTasks.</param>
+		/// <param name="encoder">The encoder of the calling thread.</param>
+		void EncodeFrameBox(short player, int taskIndex, FrameBoxEncoder &encoder);
+
+		/// <summary>
+		/// Gets the entropy of some data, treating each byte as a symbol.
+		/// </summary>
+		/// <param name="data">The data to get the entropy of.</param>
+		/// <param name="dataSize">The size of the data.</param>
+		/// <returns>The entropy in bits per byte, from 0 to 8.</returns>
+		static float GetEntropy(const unsigned char *data, int dataSize);
+#pragma endregion
+
+#pragma region Network Entity State Handling
+		/// <summary>
+		/// Takes a snapshot of the state of every entity in the scene that each player's team can see, for the send threads to send. Only done on the main thread.
+		/// </summary>
+		void CreateEntitySnapshot();
+
+		/// <summary>
+		/// Adds the state of an entity and everything attached to it to a snapshot, in the order they're drawn.
+		/// </summary>
+		/// <param name="movableObject">The entity to add.</param>
+		/// <param name="entitySnapshot">The snapshot to add to.</param>
+		/// <param name="newPresetNames">The names of presets that got an index while taking the snapshot, to add to.</param>
+		void AddEntityStates(const MovableObject *movableObject, EntitySnapshot &entitySnapshot, std::vector<std::string> &newPresetNames);
+
+		/// <summary>
+		/// Gets the state of one entity, as it is now.
+		/// </summary>
+		/// <param name="movableObject">The entity to get the state of.</param>
+		/// <param name="newPresetNames">The names of presets that got an index while taking the snapshot, to add the entity's preset to if it's new.</param>
+		/// <returns>The state of the entity.</returns>
+		EntityStateNetworkData GetEntityState(const MovableObject *movableObject, std::vector<std::string> &newPresetNames);
+
+		/// <summary>
+		/// Sends a player the names of any presets its entity snapshots refer to that it wasn't sent yet.
+		/// </summary>
+		/// <param name="player">The player to send to.</param>
+		void SendEntityPresetsMsg(short player);
+
+		/// <summary>
+		/// Sends a player the latest entity snapshot, as a delta against the newest snapshot it acked if that's still known, or whole if not.
+		/// </summary>
+		/// <param name="player">The player to send to.</param>
+		void SendEntitySnapshotMsg(short player);
+
+		/// <summary>
+		/// Appends some fields of an entity state to entity snapshot data, the way MsgEntitySnapshot describes.
+		/// </summary>
+		/// <param name="state">The state to append.</param>
+		/// <param name="fields">The EntityStateFields to append.</param>
+		/// <param name="data">The data to append to.</param>
+		static void WriteEntityState(const EntityStateNetworkData &state, unsigned char fields, std::vector<unsigned char> &data);
+
+		/// <summary>
+		/// Gets which fields of an entity state differ from another.
+		/// </summary>
+		/// <param name="state">The state to compare.</param>
+		/// <param name="baseState">The state to compare against.</param>
+		/// <returns>The EntityStateFields that differ.</returns>
+		static unsigned char GetChangedEntityStateFields(const EntityStateNetworkData &state, const EntityStateNetworkData &baseState);
 #pragma endregion
 
 #pragma region Network Stats Handling
@@ -2,6 +2,7 @@
 #include "MovableMan.h"
 #include "FrameMan.h"
 #include "AudioMan.h"
+#include "ThreadMan.h"
 #include "Timer.h"
 
 #include "GUI.h"
@@ -18,6 +19,9 @@ namespace RTE {
 		m_FrameTimer = nullptr;
 		m_MSPFs.clear();
 		m_MSPFAverage = 0;
+		m_ScriptPresetTimes.clear();
+		m_ScriptPresetTimeAverages.clear();
+		m_ScriptPresetTimeSampleCount = 0;
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -41,6 +45,7 @@ namespace RTE {
 		m_PerfCounterNames[PerformanceCounters::ParticlesUpdate] = "Prt Update";
 		m_PerfCounterNames[PerformanceCounters::ActorsAIUpdate] = "Act AI";
 		m_PerfCounterNames[PerformanceCounters::ActivityUpdate] = "Activity";
+		m_PerfCounterNames[PerformanceCounters::WorkerThreads] = "Workers";
 
 		return 0;
 	}
@@ -79,6 +84,12 @@ namespace RTE {
 	void PerformanceMan::StopPerformanceMeasurement(PerformanceCounters counter) {
 		m_PerfMeasureStop[counter] = g_TimerMan.GetAbsoluteTime();
 		AddPerformanceSample(counter, m_PerfMeasureStop[counter] - m_PerfMeasureStart[counter]);
+
+		if (counter == PerformanceCounters::SimTotal) {
+			// The workers run alongside the main thread, so their busy time is averaged over all of them. Its percentage of the sim update is then the worker utilization.
+			uint64_t workerBusyTime = g_ThreadMan.TakeWorkerBusyTime();
+			if (g_ThreadMan.GetWorkerCount() > 0) { AddPerformanceSample(PerformanceCounters::WorkerThreads, workerBusyTime / static_cast<uint64_t>(g_ThreadMan.GetWorkerCount())); }
+		}
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -91,6 +102,17 @@ namespace RTE {
 			m_PerfData[counter].at(m_Sample) = 0;
 			m_PerfPercentages[counter].at(m_Sample) = 0;
 		}
+
+		m_ScriptPresetTimeSampleCount++;
+		if (m_ScriptPresetTimeSampleCount >= c_Average) {
+			m_ScriptPresetTimeAverages.clear();
+			for (const auto &[presetName, scriptTime] : m_ScriptPresetTimes) {
+				m_ScriptPresetTimeAverages.emplace_back(presetName, scriptTime / m_ScriptPresetTimeSampleCount);
+			}
+			std::sort(m_ScriptPresetTimeAverages.begin(), m_ScriptPresetTimeAverages.end(), [](const std::pair<std::string, uint64_t> &lhs, const std::pair<std::string, uint64_t> &rhs) { return lhs.second > rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first); });
+			m_ScriptPresetTimes.clear();
+			m_ScriptPresetTimeSampleCount = 0;
+		}
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -173,8 +195,30 @@ namespace RTE {
 			}
 			g_FrameMan.GetLargeFont()->DrawAligned(&bitmapToDrawTo, c_StatsOffsetX, c_StatsHeight + 100, str, GUIFont::Left);
 
+			std::snprintf(str, sizeof(str), "Frame Arena: %zu KB | Peak: %zu KB", g_ThreadMan.GetFrameArenaUsedBytes() / 1024, g_ThreadMan.GetFrameArenaPeakUsedBytes() / 1024);
+			g_FrameMan.GetLargeFont()->DrawAligned(&bitmapToDrawTo, c_StatsOffsetX, c_StatsHeight + 110, str, GUIFont::Left);
+
 			// If in split screen mode don't draw graphs because they don't fit anyway.
-			if (m_AdvancedPerfStats && g_FrameMan.GetScreenCount() == 1) { DrawPeformanceGraphs(bitmapToDrawTo); }
+			if (m_AdvancedPerfStats && g_FrameMan.GetScreenCount() == 1) {
+				DrawPeformanceGraphs(bitmapToDrawTo);
+				DrawScriptPresetTimes(bitmapToDrawTo);
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PerformanceMan::DrawScriptPresetTimes(AllegroBitmap &bitmapToDrawTo) const {
+		if (m_ScriptPresetTimeAverages.empty()) {
+			return;
+		}
+		g_FrameMan.GetLargeFont()->DrawAligned(&bitmapToDrawTo, c_ScriptPresetTimesOffsetX, c_GraphsStartOffsetY, "Lua Time Per Preset (us):", GUIFont::Left);
+
+		char str[128];
+		int linesToDraw = std::min(static_cast<int>(m_ScriptPresetTimeAverages.size()), c_MaxScriptPresetTimesShown);
+		for (int line = 0; line < linesToDraw; ++line) {
+			std::snprintf(str, sizeof(str), "%llu - %s", static_cast<unsigned long long>(m_ScriptPresetTimeAverages[line].second), m_ScriptPresetTimeAverages[line].first.c_str());
+			g_FrameMan.GetLargeFont()->DrawAligned(&bitmapToDrawTo, c_ScriptPresetTimesOffsetX, c_GraphsStartOffsetY + (line + 1) * 10, str, GUIFont::Left);
 		}
 	}
 
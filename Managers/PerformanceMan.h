@@ -29,6 +29,7 @@ namespace RTE {
 			ParticlesTravel,
 			ParticlesUpdate,
 			ActivityUpdate,
+			WorkerThreads,
 			PerfCounterCount
 		};
 
@@ -126,6 +127,19 @@ namespace RTE {
 		/// <param name="counter">Counter to stop and updated measurement for.</param>
 		void StopPerformanceMeasurement(PerformanceCounters counter);
 
+		/// <summary>
+		/// Adds time spent running Lua scripts to the script time counter of a preset. Only counted while the performance stats are shown.
+		/// </summary>
+		/// <param name="presetName">The module and preset name of the preset whose scripts were run.</param>
+		/// <param name="time">The time spent running the scripts, in microseconds.</param>
+		void AddScriptPresetTime(const std::string &presetName, uint64_t time) { m_ScriptPresetTimes[presetName] += time; }
+
+		/// <summary>
+		/// Gets the average time per sim update spent running each preset's Lua scripts, over the last completed batch of averaged samples.
+		/// </summary>
+		/// <returns>Pairs of module and preset names and their average script time in microseconds, most expensive first.</returns>
+		const std::vector<std::pair<std::string, uint64_t>> & GetScriptPresetTimeAverages() const { return m_ScriptPresetTimeAverages; }
+
 		/// <summary>
 		/// Sets the current ping value to display.
 		/// </summary>
@@ -138,6 +152,7 @@ namespace RTE {
 		static constexpr int c_MSPFAverageSampleSize = 10; //!< How many samples to use to calculate average MSPF value.
 		static constexpr int c_MaxSamples = 120; //!< How many performance samples to store, directly affects graph size.
 		static constexpr int c_Average = 10; //!< How many samples to use to calculate average value displayed on screen.
+		static constexpr int c_MaxScriptPresetTimesShown = 10; //!< How many of the most expensive scripted presets to display on screen.
 
 		const int c_StatsOffsetX = 17; //!< Offset of the stat text from the left edge of the screen.
 		const int c_StatsHeight = 14; //!< Height of each stat text line.
@@ -145,6 +160,7 @@ namespace RTE {
 		const int c_GraphsStartOffsetY = 134; //!< Position the first graph block will be drawn from the top edge of the screen.
 		const int c_GraphHeight = 20; //!< Height of the performance graph.
 		const int c_GraphBlockHeight = 34; //!< Height of the whole graph block (text height and graph height combined).
+		const int c_ScriptPresetTimesOffsetX = 220; //!< Offset of the script preset time list from the left edge of the screen.
 
 		bool m_ShowPerfStats; //!< Whether to show performance stats on screen or not.
 		bool m_AdvancedPerfStats; //!< Whether to show performance graphs on screen or not.
@@ -162,6 +178,10 @@ namespace RTE {
 		std::array<uint64_t, PerformanceCounters::PerfCounterCount> m_PerfMeasureStop; //!< Current measurement stop time in microseconds.
 		std::array<std::string, PerformanceCounters::PerfCounterCount> m_PerfCounterNames; //!< Performance counter names displayed on screen.
 
+		std::unordered_map<std::string, uint64_t> m_ScriptPresetTimes; //!< Time in microseconds spent running each preset's Lua scripts during the samples since the averages were last calculated.
+		std::vector<std::pair<std::string, uint64_t>> m_ScriptPresetTimeAverages; //!< Average time in microseconds per sample spent running each preset's Lua scripts, most expensive first.
+		int m_ScriptPresetTimeSampleCount; //!< The number of samples since the script preset time averages were last calculated.
+
 	private:
 
 #pragma region Performance Counter Handling
@@ -185,6 +205,11 @@ namespace RTE {
 		uint64_t GetPerformanceCounterAverage(PerformanceCounters counter) const;
 #pragma endregion
 
+		/// <summary>
+		/// Draws the list of the most expensive scripted presets to the screen.
+		/// </summary>
+		void DrawScriptPresetTimes(AllegroBitmap &bitmapToDrawTo) const;
+
 		/// <summary>
 		/// Draws the performance graphs to the screen. This will be called by Draw() if advanced performance stats are enabled.
 		/// </summary>
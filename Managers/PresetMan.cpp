@@ -26,6 +26,7 @@
 //#include "Atom.h"
 
 #include "ConsoleMan.h"
+#include "TimerMan.h"
 #include "LoadingScreen.h"
 #include "SettingsMan.h"
 
@@ -1131,6 +1132,63 @@ Actor * PresetMan::GetLoadout(std::string loadoutName, int moduleNumber, bool sp
 	return 0;
 }
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunCloneBenchmark
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Measures how long cloning the presets of a class and deleting the
+//                  clones takes, and prints the results to the console, per class.
+
+void PresetMan::RunCloneBenchmark(const std::string &className, int cloneCount)
+{
+	cloneCount = std::max(cloneCount, 1);
+
+	std::list<std::string> classNames;
+	if (className == "All")
+	{
+		const Entity::ClassInfo *movableObjectClass = Entity::ClassInfo::GetClass("MovableObject");
+		for (const std::string &classNameEntry : Entity::ClassInfo::GetClassNames())
+		{
+			const Entity::ClassInfo *classInfo = Entity::ClassInfo::GetClass(classNameEntry);
+			if (classInfo && classInfo->IsConcrete() && classInfo->IsClassOrChildClassOf(movableObjectClass))
+				classNames.push_back(classNameEntry);
+		}
+	}
+	else
+		classNames.push_back(className);
+
+	std::vector<Entity *> clones;
+	clones.reserve(cloneCount);
+	for (const std::string &classNameEntry : classNames)
+	{
+		// The type lists have the presets of all the child classes in them too, so pick out the ones of exactly this class
+		std::list<Entity *> presets;
+		GetAllOfType(presets, classNameEntry);
+		presets.remove_if([&classNameEntry](const Entity *preset) { return preset->GetClassName() != classNameEntry; });
+		if (presets.empty())
+			continue;
+
+		std::list<Entity *>::const_iterator presetItr = presets.begin();
+		long long startTime = g_TimerMan.GetAbsoluteTime();
+		for (int clone = 0; clone < cloneCount; ++clone)
+		{
+			clones.push_back((*presetItr)->Clone());
+			if (++presetItr == presets.end())
+				presetItr = presets.begin();
+		}
+		long long cloneTime = g_TimerMan.GetAbsoluteTime() - startTime;
+
+		startTime = g_TimerMan.GetAbsoluteTime();
+		for (const Entity *clone : clones)
+			delete clone;
+		long long deleteTime = g_TimerMan.GetAbsoluteTime() - startTime;
+		clones.clear();
+
+		g_ConsoleMan.PrintString("Clone benchmark - " + classNameEntry + ": " + std::to_string(cloneCount) + " clones of " + std::to_string(presets.size()) + " presets, " +
+			std::to_string(static_cast<double>(cloneTime) / static_cast<double>(cloneCount)) + " us per clone, " + std::to_string(static_cast<double>(deleteTime) / static_cast<double>(cloneCount)) + " us per delete");
+	}
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void PresetMan::FindAndExtractZippedModules() const {
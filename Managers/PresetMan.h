@@ -532,6 +532,20 @@ public:
 	Actor * GetLoadout(std::string loadoutName, int moduleNumber, bool spawnDropShip);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunCloneBenchmark
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Measures how long cloning the presets of a class and deleting the
+//                  clones takes, and prints the results to the console, per class.
+// Arguments:       The name of the class to clone the presets of. Only presets of exactly
+//                  that class are cloned, not of its child classes. "All" goes through
+//                  every class of MovableObject.
+//                  How many clones to make of each class, going round the presets in turn.
+// Return value:    None.
+
+	void RunCloneBenchmark(const std::string &className = "All", int cloneCount = 1000);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Protected member variable and method declarations
 
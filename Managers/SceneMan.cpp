@@ -31,6 +31,8 @@
 #include "MOPixel.h"
 #include "Atom.h"
 #include "Material.h"
+#include "ThreadMan.h"
+#include "TimerMan.h"
 // Temp
 #include "Controller.h"
 
@@ -81,6 +83,9 @@ void SceneMan::Clear()
     m_pMOColorLayer = 0;
     m_pMOIDLayer = 0;
     m_MOIDDrawings.clear();
+    m_ObstacleDrawingCount = 0;
+    m_MOIDMasks.Destroy();
+    m_MOIDLayerViewed = false;
     m_pDebugLayer = nullptr;
     m_LastRayHitPos.Reset();
 
@@ -106,16 +111,16 @@ void SceneMan::Clear()
     }
 
     m_pUnseenRevealSound = 0;
+    m_UnseenRevision.fill(0);
     m_DrawRayCastVisualizations = false;
     m_DrawPixelCheckVisualizations = false;
     m_LastUpdatedScreen = 0;
     m_SecondStructPass = false;
 //    m_CalcTimer.Reset();
     m_CleanTimer.Reset();
-
-	if (m_pOrphanSearchBitmap)
-		destroy_bitmap(m_pOrphanSearchBitmap);
-	m_pOrphanSearchBitmap = create_bitmap_ex(8, MAXORPHANRADIUS , MAXORPHANRADIUS);
+	m_OrphanSearchVisited.reset();
+	m_OrphanSearchStack.clear();
+	m_OrphanedPixels.clear();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -237,6 +242,8 @@ int SceneMan::LoadScene(Scene *pNewScene, bool placeObjects, bool placeUnits) {
     m_pMOIDLayer = new SceneLayer();
     m_pMOIDLayer->Create(pBitmap, false, Vector(), m_pCurrentScene->WrapsX(), m_pCurrentScene->WrapsY(), Vector(1.0, 1.0));
     pBitmap = 0;
+    m_MOIDMasks.Create(GetSceneWidth(), GetSceneHeight());
+    m_MOIDLayerViewed = false;
 
     // Create the Debug SceneLayer
     if (m_DrawRayCastVisualizations || m_DrawPixelCheckVisualizations) {
@@ -418,9 +425,6 @@ void SceneMan::Destroy()
     delete m_pMOColorLayer;
     delete m_pUnseenRevealSound;
 
-	destroy_bitmap(m_pOrphanSearchBitmap);
-	m_pOrphanSearchBitmap = 0;
-
 	for (const auto &[bitmapSize, bitmapPtr] : m_IntermediateSettlingBitmaps) {
 		destroy_bitmap(bitmapPtr);
 	}
@@ -627,7 +631,7 @@ MOID SceneMan::GetMOIDPixel(int pixelX, int pixelY)
        pixelY >= m_pMOIDLayer->GetBitmap()->h)
         return g_NoMOID;
 
-	MOID moid = getpixel(m_pMOIDLayer->GetBitmap(), pixelX, pixelY);
+	MOID moid = g_SettingsMan.BitmaskMOCollision() ? m_MOIDMasks.GetMOID(pixelX, pixelY) : getpixel(m_pMOIDLayer->GetBitmap(), pixelX, pixelY);
 	if (g_SettingsMan.SimplifiedCollisionDetection()) {
 		if (moid != ColorKeys::g_NoMOID && moid != ColorKeys::g_MOIDMaskColor) {
 			const MOSprite *mo = dynamic_cast<MOSprite *>(g_MovableMan.GetMOFromID(moid));
@@ -920,10 +924,18 @@ void SceneMan::RegisterMOIDDrawing(const Vector &center, float radius)
 
 void SceneMan::ClearAllMOIDDrawings()
 {
-    for (list<IntRect>::iterator itr = m_MOIDDrawings.begin(); itr != m_MOIDDrawings.end(); ++itr)
-        ClearMOIDRect(itr->m_Left, itr->m_Top, itr->m_Right, itr->m_Bottom);
+    if (DrawsMOIDLayer())
+    {
+        for (list<IntRect>::iterator itr = m_MOIDDrawings.begin(); itr != m_MOIDDrawings.end(); ++itr)
+            ClearMOIDRect(itr->m_Left, itr->m_Top, itr->m_Right, itr->m_Bottom);
+    }
+    // Nothing gets drawn onto the layer with bitmask MO collision unless it's viewed, so only what's left from viewing it needs clearing, once
+    else if (m_MOIDLayerViewed)
+        ClearMOIDLayer();
 
+    m_MOIDLayerViewed = g_SettingsMan.BitmaskMOCollision() && DrawsMOIDLayer();
     m_MOIDDrawings.clear();
+    m_MOIDMasks.Reset();
 }
 
 
@@ -1007,214 +1019,278 @@ int SceneMan::RemoveOrphans(int posX, int posY, int radius, int maxArea, bool re
 	if (radius > MAXORPHANRADIUS)
 		radius = MAXORPHANRADIUS;
 
-	clear_to_color(m_pOrphanSearchBitmap, g_MaterialAir);
-	int area = RemoveOrphans(posX, posY, posX, posY, 0, radius, maxArea, false);
-	if (remove && area <= maxArea)
+	SLTerrain *terrain = m_pCurrentScene->GetTerrain();
+	int area = FindOrphanedRegion(terrain->GetMaterialBitmap(), posX, posY, radius, maxArea);
+	if (!remove || area > maxArea || m_OrphanedPixels.empty())
+		return area;
+
+	// Turn the whole region into MOPixels in one go now that it's known to be orphaned. Atoms and MOPixels both come out of their pools
+	int left = posX;
+	int top = posY;
+	int right = posX;
+	int bottom = posY;
+	const float sprayScale = 0.1F;
+	const float maxSpraySpeed = 2.0F * sprayScale;
+	const float minSpraySpeed = maxSpraySpeed / 2.0F;
+	for (const auto &[pixelX, pixelY] : m_OrphanedPixels)
 	{
-		clear_to_color(m_pOrphanSearchBitmap, g_MaterialAir);
-		RemoveOrphans(posX, posY, posX, posY, 0, radius, maxArea, true);
+		left = std::min(left, pixelX);
+		top = std::min(top, pixelY);
+		right = std::max(right, pixelX);
+		bottom = std::max(bottom, pixelY);
+
+		Material const * sceneMat = GetMaterialFromID(terrain->GetMaterialPixel(pixelX, pixelY));
+		Material const * spawnMat = sceneMat->GetSpawnMaterial() ? GetMaterialFromID(sceneMat->GetSpawnMaterial()) : sceneMat;
+		Color spawnColor;
+		if (spawnMat->UsesOwnColor())
+			spawnColor = spawnMat->GetColor();
+		else
+			spawnColor.SetRGBWithIndex(terrain->GetFGColorPixel(pixelX, pixelY));
+
+		// No point generating a key-colored MOPixel
+		if (spawnColor.GetIndex() != g_MaskColor)
+		{
+			// Density is used as the mass for the new MOPixel
+			MOPixel *pixelMO = new MOPixel(spawnColor, spawnMat->GetPixelDensity(), Vector(pixelX, pixelY), Vector(-RandomNum(minSpraySpeed, maxSpraySpeed), -RandomNum(minSpraySpeed, maxSpraySpeed)), new Atom(Vector(), spawnMat->GetIndex(), 0, spawnColor, 2), 0);
+			pixelMO->SetToHitMOs(spawnMat->GetIndex() == c_GoldMaterialID);
+			pixelMO->SetToGetHitByMOs(false);
+			g_MovableMan.AddParticle(pixelMO);
+		}
+		terrain->SetFGColorPixel(pixelX, pixelY, g_MaskColor);
+		terrain->SetMaterialPixel(pixelX, pixelY, g_MaterialAir);
 	}
+	RegisterTerrainChange(left, top, right - left + 1, bottom - top + 1, false);
 
 	return area;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          RemoveOrphans
+// Method:          FindOrphanedRegion
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Returns the area of an orphaned region at specified coordinates. 
+// Description:     Flood fills the material connected to a position, within a square
+//                  search area centered on it, and collects the filled pixels.
 
-int SceneMan::RemoveOrphans(int posX, int posY, 
-							int centerPosX, int centerPosY, 
-							int accumulatedArea, int radius, int maxArea, bool remove)
+int SceneMan::FindOrphanedRegion(BITMAP *materialBitmap, int posX, int posY, int radius, int maxArea)
 {
-	int area = 0;
-	int bmpX = 0;
-	int bmpY = 0;
+	m_OrphanedPixels.clear();
+	m_OrphanSearchStack.clear();
+	m_OrphanSearchVisited.reset();
+	const int notOrphanedArea = MAXORPHANRADIUS * MAXORPHANRADIUS + 1;
 
-	BITMAP * mat = m_pCurrentScene->GetTerrain()->GetMaterialBitmap();
+	radius = std::min(radius, MAXORPHANRADIUS);
+	int windowLeft = posX - radius / 2;
+	int windowTop = posY - radius / 2;
 
-	if (posX < 0 || posY < 0 || posX >= mat->w || posY >= mat->h) return 0;
+	// The region is all the material 8-way connected to the starting position, which is part of it even if it's air. There's no wrapping, the region just stops at the edges of the scene
+	auto isInRegion = [materialBitmap, posX, posY](int x, int y) {
+		return x >= 0 && y >= 0 && x < materialBitmap->w && y < materialBitmap->h && (_getpixel(materialBitmap, x, y) != g_MaterialAir || (x == posX && y == posY));
+	};
+	// Reaching the edge of the search area means the region is connected to something larger, and isn't orphaned
+	auto isOnSearchEdge = [windowLeft, windowTop, radius](int x, int y) {
+		return x <= windowLeft || y <= windowTop || x >= windowLeft + radius - 1 || y >= windowTop + radius - 1;
+	};
+	auto visitedIndex = [windowLeft, windowTop](int x, int y) {
+		return static_cast<size_t>((y - windowTop) * MAXORPHANRADIUS + (x - windowLeft));
+	};
 
-    unsigned char materialID = _getpixel(mat, posX, posY);
-    if (materialID == g_MaterialAir && (posX != centerPosX || posY != centerPosY))
+	if (!isInRegion(posX, posY))
 		return 0;
-	else
+	if (isOnSearchEdge(posX, posY))
+		return notOrphanedArea;
+
+	int area = 0;
+	m_OrphanSearchStack.emplace_back(posX, posY);
+	while (!m_OrphanSearchStack.empty())
 	{
-		bmpX = posX - (centerPosX - radius / 2);
-		bmpY = posY - (centerPosY - radius / 2);
+		auto [seedX, seedY] = m_OrphanSearchStack.back();
+		m_OrphanSearchStack.pop_back();
+		// Runs are always filled whole, so if the seed got filled since it was pushed, so did the rest of its run
+		if (m_OrphanSearchVisited.test(visitedIndex(seedX, seedY)))
+			continue;
+
+		int runLeft = seedX;
+		while (isInRegion(runLeft - 1, seedY))
+		{
+			if (isOnSearchEdge(--runLeft, seedY))
+				return notOrphanedArea;
+		}
+		int runRight = seedX;
+		while (isInRegion(runRight + 1, seedY))
+		{
+			if (isOnSearchEdge(++runRight, seedY))
+				return notOrphanedArea;
+		}
+		for (int x = runLeft; x <= runRight; ++x)
+		{
+			m_OrphanSearchVisited.set(visitedIndex(x, seedY));
+			m_OrphanedPixels.emplace_back(x, seedY);
+		}
+		area += runRight - runLeft + 1;
+		if (area > maxArea)
+			return area;
 
-		// We reached the border of orphan-searching area and 
-		// there are still material pixels there -> the area is not an orphaned teran piece, abort search
-		if (bmpX <= 0 || bmpY <= 0 || bmpX >= radius - 1 || bmpY >= radius - 1)
-			return MAXORPHANRADIUS * MAXORPHANRADIUS + 1;
-		else
-		// Check if pixel was already checked
+		// Push the start of every unfilled run touching this one from above or below, diagonals included
+		for (int rowY = seedY - 1; rowY <= seedY + 1; rowY += 2)
 		{
-			if (_getpixel(m_pOrphanSearchBitmap, bmpX, bmpY) != g_MaterialAir)
-				return 0;
+			bool inRun = false;
+			for (int x = runLeft - 1; x <= runRight + 1; ++x)
+			{
+				if (!isInRegion(x, rowY))
+				{
+					inRun = false;
+					continue;
+				}
+				if (isOnSearchEdge(x, rowY))
+					return notOrphanedArea;
+				if (!inRun && !m_OrphanSearchVisited.test(visitedIndex(x, rowY)))
+					m_OrphanSearchStack.emplace_back(x, rowY);
+				inRun = true;
+			}
 		}
 	}
+	return area;
+}
 
-	_putpixel(m_pOrphanSearchBitmap, bmpX, bmpY, materialID);
-	area++;
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunOrphanSearchBenchmark
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Measures how long searching for orphaned regions takes on a synthetic
+//                  terrain of scattered clumps of material, and prints the results to the
+//                  console.
 
-	// We're clear to remove the pixel
-	if (remove)
-	{
-		Material const * sceneMat = GetMaterialFromID(materialID);
-		Material const * spawnMat;
-        spawnMat = sceneMat->GetSpawnMaterial() ? GetMaterialFromID(sceneMat->GetSpawnMaterial()) : sceneMat;
-		float sprayScale = 0.1;
-        Color spawnColor;
-        if (spawnMat->UsesOwnColor())
-            spawnColor = spawnMat->GetColor();
-        else
-            spawnColor.SetRGBWithIndex(m_pCurrentScene->GetTerrain()->GetFGColorPixel(posX, posY));
+void SceneMan::RunOrphanSearchBenchmark(int searchCount, int radius, int maxArea)
+{
+	searchCount = std::max(searchCount, 1);
+	radius = std::clamp(radius, 3, MAXORPHANRADIUS);
 
-        // No point generating a key-colored MOPixel
-        if (spawnColor.GetIndex() != g_MaskColor)
-        {
-			// TEST COLOR
-			// spawnColor = 5;
-
-            // Get the new pixel from the pre-allocated pool, should be faster than dynamic allocation
-            // Density is used as the mass for the new MOPixel
-			float tempMax = 2.0F * sprayScale;
-			float tempMin = tempMax / 2.0F;
-            MOPixel *pixelMO = new MOPixel(spawnColor,
-                                           spawnMat->GetPixelDensity(),
-                                           Vector(posX, posY),
-                                           Vector(-RandomNum(tempMin, tempMax),
-                                                  -RandomNum(tempMin, tempMax)),
-                                           new Atom(Vector(), spawnMat->GetIndex(), 0, spawnColor, 2),
-                                           0);
-
-            pixelMO->SetToHitMOs(spawnMat->GetIndex() == c_GoldMaterialID);
-            pixelMO->SetToGetHitByMOs(false);
-            g_MovableMan.AddParticle(pixelMO);
-            pixelMO = 0;
-        }
-        m_pCurrentScene->GetTerrain()->SetFGColorPixel(posX, posY, g_MaskColor);
-		RegisterTerrainChange(posX, posY, 1, 1, g_MaskColor, false);
-        m_pCurrentScene->GetTerrain()->SetMaterialPixel(posX, posY, g_MaterialAir);
+	// Solid ground at the bottom, with the air above it sprinkled with material at random like what's left after things have been blown up, so there's a mix of orphans, larger clumps and open air
+	const int terrainSize = 512;
+	BITMAP *materialBitmap = create_bitmap_ex(8, terrainSize, terrainSize);
+	for (int y = 0; y < terrainSize; ++y)
+	{
+		for (int x = 0; x < terrainSize; ++x)
+			_putpixel(materialBitmap, x, y, (y >= terrainSize * 3 / 4 || RandomNum() < 0.4F) ? g_MaterialSand : g_MaterialAir);
 	}
-
-	int xoff[8] = { -1,  0,  1, -1,  1, -1,  0,  1};
-	int yoff[8] = { -1, -1, -1,  0,  0,  1,  1,  1};
-
-	for (int c = 0; c < 8; c++)
+	std::vector<std::pair<int, int>> searchPositions;
+	searchPositions.reserve(searchCount);
+	for (int search = 0; search < searchCount; ++search)
+		searchPositions.emplace_back(RandomNum(0, terrainSize - 1), RandomNum(0, terrainSize - 1));
+
+	int orphanCount = 0;
+	long long orphanedArea = 0;
+	long long startTime = g_TimerMan.GetAbsoluteTime();
+	for (const auto &[searchX, searchY] : searchPositions)
 	{
-		area += RemoveOrphans(posX + xoff[c], posY + yoff[c], centerPosX, centerPosY, area, radius, maxArea, remove);
-		if (accumulatedArea + area > maxArea)
-			break;
+		int area = FindOrphanedRegion(materialBitmap, searchX, searchY, radius, maxArea);
+		if (area > 0 && area <= maxArea)
+		{
+			++orphanCount;
+			orphanedArea += area;
+		}
 	}
+	long long elapsedTime = g_TimerMan.GetAbsoluteTime() - startTime;
+	m_OrphanedPixels.clear();
+	destroy_bitmap(materialBitmap);
 
-	return area;
+	g_ConsoleMan.PrintString("Orphan search benchmark - " + std::to_string(searchCount) + " searches with radius " + std::to_string(radius) + " and max area " + std::to_string(maxArea) + ": " + std::to_string(elapsedTime) + " us total, " +
+		std::to_string(static_cast<double>(elapsedTime) * 1000.0 / static_cast<double>(searchCount)) + " ns per search, " + std::to_string(orphanCount) + " orphans found with " + std::to_string(orphanedArea) + " pixels in total");
 }
 
-void SceneMan::RegisterTerrainChange(int x, int y, int w, int h, unsigned char color, bool back) 
+void SceneMan::RegisterTerrainChange(int x, int y, int w, int h, bool back)
 {
-	if (!g_NetworkServer.IsServerModeEnabled())
-		return;
+	if (m_pCurrentScene && m_pCurrentScene->GetTerrain())
+		m_pCurrentScene->GetTerrain()->MarkChunksDirty(x, y, w, h, back ? SLTerrain::LayerType::BackgroundLayer : SLTerrain::LayerType::ForegroundLayer);
+}
 
-	// Crop if it's out of scene as both the client and server will not tolerate out of bitmap coords while packing/unpacking
-	if (y < 0)
-		y = 0;
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SendTerrainChanges
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Takes the color changes accumulated in the terrain's dirty chunks,
+//                  merged into rectangles, and hands them to the network server as one
+//                  batch for this update.
 
-	if (y + h >= GetSceneHeight())
-		h = GetSceneHeight() - y - 1;
+void SceneMan::SendTerrainChanges()
+{
+	SLTerrain *terrain = m_pCurrentScene->GetTerrain();
+	std::vector<Box> foregroundAreas;
+	std::vector<Box> backgroundAreas;
+	terrain->TakeChangedColorAreas(foregroundAreas, backgroundAreas);
 
-	if (y >= GetSceneHeight() || h <= 0)
+	if (!g_NetworkServer.IsServerModeEnabled())
 		return;
 
-	if (w == 1)
+	// The areas are already wrapped onto the scene and don't cross the seam, so they can go out as they are
+	std::vector<TerrainChange> terrainChanges;
+	terrainChanges.reserve(foregroundAreas.size() + backgroundAreas.size());
+	for (int layer = 0; layer < 2; ++layer)
 	{
-		if (x >= GetSceneWidth())
-		{
-			if (!SceneWrapsX())
-				return;
-			x = x - GetSceneWidth();
-		}
-		if (x < 0)
+		bool back = layer == 1;
+		for (const Box &area : back ? backgroundAreas : foregroundAreas)
 		{
-			if (!SceneWrapsX())
-				return;
-			x = GetSceneWidth() + x;
+			TerrainChange tc;
+			tc.x = area.GetCorner().GetFloorIntX();
+			tc.y = area.GetCorner().GetFloorIntY();
+			tc.w = static_cast<int>(area.GetWidth());
+			tc.h = static_cast<int>(area.GetHeight());
+			tc.back = back;
+			terrainChanges.push_back(tc);
 		}
 	}
-	else
-	{
-		// Divide region if crossing the seam
-		if (x + w >= GetSceneWidth() || x < 0)
-		{
-			// Crossing right part of the scene
-			if (x + w >= GetSceneWidth())
-			{
-				// Left part, on the scene
-				TerrainChange tc1;
-				tc1.x = x;
-				tc1.y = y;
-				tc1.w = GetSceneWidth() - x;
-				tc1.h = h;
-				tc1.back = back;
-				tc1.color = color;
-				g_NetworkServer.RegisterTerrainChange(tc1);
-
-				// Discard out of scene part if scene is not wrapped
-				if (!SceneWrapsX())
-					return;
-
-				// Right part, out of scene
-				TerrainChange tc2;
-				tc2.x = 0;
-				tc2.y = y;
-				tc2.w = w - (GetSceneWidth() - x);
-				tc2.h = h;
-				tc2.back = back;
-				tc2.color = color;
-
-				g_NetworkServer.RegisterTerrainChange(tc2);
-				return;
-			}
+	if (!terrainChanges.empty())
+		g_NetworkServer.RegisterTerrainChanges(terrainChanges);
+}
 
-			if (x < 0)
-			{
-				// Right part, on the scene
-				TerrainChange tc2;
-				tc2.x = 0;
-				tc2.y = y;
-				tc2.w = w + x;
-				tc2.h = h;
-				tc2.back = back;
-				tc2.color = color;
-				g_NetworkServer.RegisterTerrainChange(tc2);
-
-				// Discard out of scene part if scene is not wrapped
-				if (!SceneWrapsX())
-					return;
-
-				// Left part, out of the scene
-				TerrainChange tc1;
-				tc1.x = GetSceneWidth() + x;
-				tc1.y = y;
-				tc1.w = -x;
-				tc1.h = h;
-				tc1.back = back;
-				tc1.color = color;
-				g_NetworkServer.RegisterTerrainChange(tc1);
-				return;
-			}
-		}
-	}
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunTerrainLoadBenchmark
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Loads a copy of the terrain of every Scene preset in a data module,
+//                  measuring how long loading took and how long texturizing it takes on
+//                  one thread compared to on all worker threads, and prints the results
+//                  to the console.
+
+void SceneMan::RunTerrainLoadBenchmark(std::string moduleName, int repetitionCount)
+{
+    int moduleID = g_PresetMan.GetModuleID(moduleName);
+    if (moduleID < 0)
+    {
+        g_ConsoleMan.PrintString("ERROR: The terrain load benchmark couldn't find the data module " + moduleName + "!");
+        return;
+    }
+    std::list<Entity *> scenePresets;
+    g_PresetMan.GetAllOfType(scenePresets, "Scene", moduleID);
+    g_ConsoleMan.PrintString("Terrain load benchmark - Loading the terrains of " + std::to_string(scenePresets.size()) + " Scenes in " + moduleName + " and texturizing each " + std::to_string(std::max(repetitionCount, 1)) + " times per measurement on " + std::to_string(g_ThreadMan.GetWorkerCount()) + " worker threads.");
 
-	TerrainChange tc;
-	tc.x = x;
-	tc.y = y;
-	tc.w = w;
-	tc.h = h;
-	tc.back = back;
-	tc.color = color;
-	g_NetworkServer.RegisterTerrainChange(tc);
+    long long totalSingleThreadTime = 0;
+    long long totalMultiThreadTime = 0;
+    for (Entity *scenePreset : scenePresets)
+    {
+        Scene *scene = dynamic_cast<Scene *>(scenePreset);
+        if (!scene || !scene->GetTerrain())
+            continue;
+
+        // Work on a copy so the preset's terrain stays unloaded
+        SLTerrain *terrain = dynamic_cast<SLTerrain *>(scene->GetTerrain()->Clone());
+        long long startTime = g_TimerMan.GetAbsoluteTime();
+        terrain->LoadData();
+        long long loadTime = g_TimerMan.GetAbsoluteTime() - startTime;
+        if (!terrain->GetBitmap())
+        {
+            delete terrain;
+            continue;
+        }
+
+        long long singleThreadTime = 0;
+        long long multiThreadTime = 0;
+        terrain->RunTexturizeBenchmark(repetitionCount, singleThreadTime, multiThreadTime);
+        totalSingleThreadTime += singleThreadTime;
+        totalMultiThreadTime += multiThreadTime;
+
+        g_ConsoleMan.PrintString("Terrain load benchmark - " + scene->GetPresetName() + " (" + std::to_string(terrain->GetBitmap()->w) + "x" + std::to_string(terrain->GetBitmap()->h) + "): " + std::to_string(loadTime) + " us to load, " +
+            std::to_string(singleThreadTime) + " us to texturize on one thread, " + std::to_string(multiThreadTime) + " us on all threads");
+        delete terrain;
+    }
+    if (totalMultiThreadTime > 0)
+        g_ConsoleMan.PrintString("Terrain load benchmark - Texturizing all terrains took " + std::to_string(totalSingleThreadTime) + " us on one thread, " + std::to_string(totalMultiThreadTime) + " us on all threads, " + std::to_string(static_cast<double>(totalSingleThreadTime) / static_cast<double>(totalMultiThreadTime)) + "x faster");
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1304,7 +1380,7 @@ bool SceneMan::TryPenetrate(int posX,
                 pixelMO = 0;
             }
             m_pCurrentScene->GetTerrain()->SetFGColorPixel(posX, posY, g_MaskColor);
-			RegisterTerrainChange(posX, posY, 1, 1, g_MaskColor, false);
+			RegisterTerrainChange(posX, posY, 1, 1, false);
 
             m_pCurrentScene->GetTerrain()->SetMaterialPixel(posX, posY, g_MaterialAir);
         }
@@ -1312,7 +1388,7 @@ bool SceneMan::TryPenetrate(int posX,
         else if (RandomNum() <= airRatio)
         {
             m_pCurrentScene->GetTerrain()->SetFGColorPixel(posX, posY, g_MaskColor);
-			RegisterTerrainChange(posX, posY, 1, 1, g_MaskColor, false);
+			RegisterTerrainChange(posX, posY, 1, 1, false);
 
 			m_pCurrentScene->GetTerrain()->SetMaterialPixel(posX, posY, g_MaterialAir);
         }
@@ -1377,7 +1453,7 @@ bool SceneMan::TryPenetrate(int posX,
 						}
 
                         // Clear the terrain pixel now when the particle has been generated from it
-						RegisterTerrainChange(posX, testY, 1, 1, g_MaskColor, false);
+						RegisterTerrainChange(posX, testY, 1, 1, false);
                         _putpixel(pFGColor, posX, testY, g_MaskColor);
                         _putpixel(pMaterial, posX, testY, g_MaterialAir);
                     }
@@ -1392,9 +1468,6 @@ bool SceneMan::TryPenetrate(int posX,
 		if (removeOrphansRadius && removeOrphansMaxArea && removeOrphansRate > 0 && RandomNum() < removeOrphansRate)
 		{
 			RemoveOrphans(posX, posY, removeOrphansRadius, removeOrphansMaxArea, true);
-			/*PALETTE palette;
-			get_palette(palette);
-			save_bmp("Orphan.bmp", m_pOrphanSearchBitmap, palette);*/
 		}
 
         return true;
@@ -1575,6 +1648,7 @@ bool SceneMan::RestoreUnseen(const int posX, const int posY, const int team)
             m_pCurrentScene->GetSeenPixels(team).push_back(Vector(scaledX, scaledY));
             // Clear to key color that pixel on the map so it won't be detected as unseen again
             putpixel(pUnseenLayer->GetBitmap(), scaledX, scaledY, g_BlackColor);
+            ++m_UnseenRevision[team];
             // Play the reveal sound, if there's not too many already revealed this frame
             //if (g_SettingsMan.BlipOnRevealUnseen() && m_pUnseenRevealSound && m_pCurrentScene->GetSeenPixels(team).size() < 5)
             //    m_pUnseenRevealSound->Play(g_SceneMan.TargetDistanceScalar(Vector(posX, posY)));
@@ -1637,6 +1711,7 @@ void SceneMan::RestoreUnseenBox(const int posX, const int posY, const int width,
 
         // Fill the box
         rectfill(pUnseenLayer->GetBitmap(), scaledX, scaledY, scaledX + scaledW, scaledY + scaledH, g_BlackColor);
+        ++m_UnseenRevision[team];
     }
 }
 
@@ -2798,6 +2873,212 @@ float SceneMan::CastObstacleRay(const Vector &start, const Vector &ray, Vector &
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastRays
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Casts a batch of rays against the terrain and MOs, split across the
+//                  worker threads unless pixel checks are being visualized.
+
+void SceneMan::CastRays(std::vector<RayQuery> &rayQueries)
+{
+    if (!m_pCurrentScene || rayQueries.empty())
+        return;
+
+    // Look up the materials once for the whole batch instead of for every pixel
+    std::array<float, c_PaletteEntriesNumber> materialIntegrities;
+    for (int materialID = 0; materialID < c_PaletteEntriesNumber; ++materialID)
+        materialIntegrities[materialID] = GetMaterialFromID(static_cast<unsigned char>(materialID))->GetIntegrity();
+
+    auto castBatch = [this, &rayQueries, &materialIntegrities](int batchStart, int batchEnd) {
+        for (int queryIndex = batchStart; queryIndex < batchEnd; ++queryIndex)
+            CastRayQuery(rayQueries[queryIndex], materialIntegrities);
+    };
+    // Pixel checks draw to the debug layer when visualized, which the worker threads can't do at the same time
+    if (m_DrawPixelCheckVisualizations)
+        castBatch(0, static_cast<int>(rayQueries.size()));
+    else
+        g_ThreadMan.ParallelFor(static_cast<int>(rayQueries.size()), 8, castBatch);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TraceRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Steps along a ray one pixel at a time, keeping the position wrapped
+//                  onto the scene as it goes, and calls a function for each checked pixel
+//                  until it returns true.
+
+template <typename PixelFunction>
+bool SceneMan::TraceRay(const Vector &start, const Vector &ray, int skip, bool wrap, PixelFunction &&pixelFunction, Vector &endPos)
+{
+    int error, dom, sub, domSteps, skipped = skip;
+    int intPos[2], delta[2], delta2[2], increment[2];
+
+    intPos[X] = std::floor(start.m_X);
+    intPos[Y] = std::floor(start.m_Y);
+    delta[X] = std::floor(start.m_X + ray.m_X) - intPos[X];
+    delta[Y] = std::floor(start.m_Y + ray.m_Y) - intPos[Y];
+
+    // Wrap the start onto the scene once up front. After that each step can only cross a seam by a single pixel, so there's no need for WrapPosition at every pixel
+    const BITMAP *materialBitmap = m_pCurrentScene->GetTerrain()->GetMaterialBitmap();
+    int sceneSize[2] = { materialBitmap->w, materialBitmap->h };
+    bool wraps[2] = { wrap && SceneWrapsX(), wrap && SceneWrapsY() };
+    for (int axis = X; axis <= Y; ++axis)
+    {
+        if (wraps[axis])
+            intPos[axis] = ((intPos[axis] % sceneSize[axis]) + sceneSize[axis]) % sceneSize[axis];
+    }
+    endPos.SetXY(intPos[X], intPos[Y]);
+
+    if (delta[X] == 0 && delta[Y] == 0)
+        return false;
+
+    /////////////////////////////////////////////////////
+    // Bresenham's line drawing algorithm preparation
+
+    for (int axis = X; axis <= Y; ++axis)
+    {
+        increment[axis] = delta[axis] < 0 ? -1 : 1;
+        delta[axis] = std::abs(delta[axis]);
+        // Scale by 2, for better accuracy of the error at the first pixel
+        delta2[axis] = delta[axis] << 1;
+    }
+
+    // If X is dominant, Y is submissive, and vice versa.
+    dom = delta[X] > delta[Y] ? X : Y;
+    sub = dom == X ? Y : X;
+
+    error = delta2[sub] - delta[dom];
+
+    auto stepAxis = [&intPos, &increment, &sceneSize, &wraps](int axis) {
+        intPos[axis] += increment[axis];
+        if (wraps[axis])
+        {
+            if (intPos[axis] < 0)
+                intPos[axis] += sceneSize[axis];
+            else if (intPos[axis] >= sceneSize[axis])
+                intPos[axis] -= sceneSize[axis];
+        }
+    };
+
+    /////////////////////////////////////////////////////
+    // Bresenham's line drawing algorithm execution
+
+    for (domSteps = 0; domSteps < delta[dom]; ++domSteps)
+    {
+        stepAxis(dom);
+        if (error >= 0)
+        {
+            stepAxis(sub);
+            error -= delta2[dom];
+        }
+        error += delta2[sub];
+
+        // Only check pixel if we're not due to skip any, or if this is the last pixel
+        if (++skipped > skip || domSteps + 1 == delta[dom])
+        {
+            if (pixelFunction(intPos[X], intPos[Y]))
+            {
+                endPos.SetXY(intPos[X], intPos[Y]);
+                return true;
+            }
+            skipped = 0;
+        }
+    }
+    endPos.SetXY(intPos[X], intPos[Y]);
+    return false;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastRayQuery
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Casts a single ray of a CastRays batch and fills in its result.
+
+void SceneMan::CastRayQuery(RayQuery &rayQuery, const std::array<float, c_PaletteEntriesNumber> &materialIntegrities)
+{
+    // Read the material layer straight through its row pointers. Anything outside it counts as air, same as GetTerrMatter
+    const BITMAP *materialBitmap = m_pCurrentScene->GetTerrain()->GetMaterialBitmap();
+    auto terrainMaterial = [materialBitmap](int x, int y) -> unsigned char {
+        return (x >= 0 && y >= 0 && x < materialBitmap->w && y < materialBitmap->h) ? materialBitmap->line[y][x] : static_cast<unsigned char>(g_MaterialAir);
+    };
+
+    rayQuery.Hit = false;
+    rayQuery.Value = -1;
+    rayQuery.HitMOID = g_NoMOID;
+
+    float strengthResult = 0;
+    switch (rayQuery.Type)
+    {
+        case RayQuery::MaterialRay:
+            rayQuery.Hit = TraceRay(rayQuery.Start, rayQuery.Ray, rayQuery.Skip, rayQuery.Wrap, [&rayQuery, &terrainMaterial](int x, int y) {
+                return terrainMaterial(x, y) == rayQuery.Material;
+            }, rayQuery.HitPos);
+            break;
+        case RayQuery::NotMaterialRay:
+            rayQuery.Hit = TraceRay(rayQuery.Start, rayQuery.Ray, rayQuery.Skip, true, [this, &rayQuery, &terrainMaterial](int x, int y) {
+                return terrainMaterial(x, y) != rayQuery.Material || (rayQuery.CheckMOs && GetMOIDPixel(x, y) != g_NoMOID);
+            }, rayQuery.HitPos);
+            break;
+        case RayQuery::StrengthRay:
+            rayQuery.Hit = TraceRay(rayQuery.Start, rayQuery.Ray, rayQuery.Skip, rayQuery.Wrap, [&rayQuery, &terrainMaterial, &materialIntegrities](int x, int y) {
+                unsigned char materialID = terrainMaterial(x, y);
+                return materialID != rayQuery.IgnoreMaterial && materialIntegrities[materialID] >= rayQuery.Strength;
+            }, rayQuery.HitPos);
+            break;
+        case RayQuery::WeaknessRay:
+            rayQuery.Hit = TraceRay(rayQuery.Start, rayQuery.Ray, rayQuery.Skip, rayQuery.Wrap, [&rayQuery, &terrainMaterial, &materialIntegrities](int x, int y) {
+                return materialIntegrities[terrainMaterial(x, y)] <= rayQuery.Strength;
+            }, rayQuery.HitPos);
+            break;
+        case RayQuery::StrengthSumRay:
+            TraceRay(rayQuery.Start, rayQuery.Ray, rayQuery.Skip, true, [&rayQuery, &terrainMaterial, &materialIntegrities, &strengthResult](int x, int y) {
+                unsigned char materialID = terrainMaterial(x, y);
+                if (materialID != g_MaterialAir && materialID != rayQuery.IgnoreMaterial)
+                    strengthResult += materialIntegrities[materialID];
+                return false;
+            }, rayQuery.HitPos);
+            rayQuery.Value = strengthResult;
+            return;
+        case RayQuery::MaxStrengthRay:
+            TraceRay(rayQuery.Start, rayQuery.Ray, rayQuery.Skip, true, [&terrainMaterial, &materialIntegrities, &strengthResult](int x, int y) {
+                unsigned char materialID = terrainMaterial(x, y);
+                if (materialID != g_MaterialDoor)
+                    strengthResult = std::max(strengthResult, materialIntegrities[materialID]);
+                return false;
+            }, rayQuery.HitPos);
+            rayQuery.Value = strengthResult;
+            return;
+        case RayQuery::MORay:
+            rayQuery.Hit = TraceRay(rayQuery.Start, rayQuery.Ray, rayQuery.Skip, true, [this, &rayQuery, &terrainMaterial](int x, int y) {
+                MOID hitMOID = GetMOIDPixel(x, y);
+                if (hitMOID != g_NoMOID && hitMOID != rayQuery.IgnoreMOID && g_MovableMan.GetRootMOID(hitMOID) != rayQuery.IgnoreMOID)
+                {
+                    // Check if we're supposed to ignore the team of what we hit
+                    const MovableObject *hitMO = (rayQuery.IgnoreTeam != Activity::NoTeam) ? g_MovableMan.GetMOFromID(hitMOID) : 0;
+                    hitMO = hitMO ? hitMO->GetRootParent() : 0;
+                    if (!hitMO || !hitMO->IgnoresTeamHits() || hitMO->GetTeam() != rayQuery.IgnoreTeam)
+                    {
+                        rayQuery.HitMOID = hitMOID;
+                        return true;
+                    }
+                }
+                if (!rayQuery.IgnoreAllTerrain)
+                {
+                    unsigned char materialID = terrainMaterial(x, y);
+                    return materialID != g_MaterialAir && materialID != rayQuery.IgnoreMaterial;
+                }
+                return false;
+            }, rayQuery.HitPos);
+            break;
+        default:
+            return;
+    }
+    if (rayQuery.Hit)
+        rayQuery.Value = (rayQuery.HitPos - rayQuery.Start).GetMagnitude();
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          FindAltitude
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -3116,7 +3397,16 @@ float SceneMan::ShortestDistanceY(float val1, float val2, bool checkBounds, int
 
 bool SceneMan::ObscuredPoint(int x, int y, int team)
 {
-    bool obscured = m_pMOIDLayer->GetPixel(x, y) != g_NoMOID || m_pCurrentScene->GetTerrain()->GetPixel(x, y) != g_MaterialAir;
+    bool obscured;
+    if (g_SettingsMan.BitmaskMOCollision())
+    {
+        // Points outside the scene count as obscured, same as they do when reading the MOID layer
+        WrapPosition(x, y);
+        obscured = x < 0 || y < 0 || x >= GetSceneWidth() || y >= GetSceneHeight() || m_MOIDMasks.GetMOID(x, y) != g_NoMOID;
+    }
+    else
+        obscured = m_pMOIDLayer->GetPixel(x, y) != g_NoMOID;
+    obscured = obscured || m_pCurrentScene->GetTerrain()->GetPixel(x, y) != g_MaterialAir;
 
     if (team != Activity::NoTeam)
         obscured = obscured || IsUnseen(x, y, team);
@@ -3266,8 +3556,28 @@ bool SceneMan::AddSceneObject(SceneObject *sceneObject) {
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Update
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Updates the state of this SceneMan. Supposed to be done every frame
-//                  before drawing.
+// Description:     Updates the state of the current Scene that doesn't depend on any
+//                  screen. Supposed to be done once every sim update.
+
+void SceneMan::Update() {
+	if (!m_pCurrentScene) {
+		return;
+	}
+	m_pCurrentScene->Update();
+	SendTerrainChanges();
+
+	if (m_CleanTimer.GetElapsedSimTimeMS() > CLEANAIRINTERVAL) {
+		m_pCurrentScene->GetTerrain()->CleanAir();
+		m_CleanTimer.Reset();
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Update
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Updates the view of this SceneMan for a screen. Supposed to be done
+//                  for each screen every frame before drawing it.
 
 void SceneMan::Update(int screen) {
 	if (!m_pCurrentScene) {
@@ -3275,9 +3585,6 @@ void SceneMan::Update(int screen) {
 	}
 	m_LastUpdatedScreen = screen;
 
-	// Update the scene, only if doing the first screen, since it only needs done once per update.
-	if (screen == 0) { m_pCurrentScene->Update(); }
-
 	SLTerrain *terrain = m_pCurrentScene->GetTerrain();
 
 	if (g_TimerMan.DrawnSimUpdate()) {
@@ -3331,10 +3638,6 @@ void SceneMan::Update(int screen) {
 	// Update the unseen obstruction layer for this team's screen view, if there is one.
 	if (SceneLayer *unseenLayer = (m_ScreenTeam[screen] != Activity::NoTeam) ? m_pCurrentScene->GetUnseenLayer(m_ScreenTeam[screen]) : nullptr) { unseenLayer->SetOffset(m_Offset[screen]); }
 
-	if (m_CleanTimer.GetElapsedSimTimeMS() > CLEANAIRINTERVAL) {
-		terrain->CleanAir();
-		m_CleanTimer.Reset();
-	}
 	m_DeltaOffset[screen] = m_Offset[screen] - oldOffset;
 	m_ScrollTimer[screen].Reset();
 }
@@ -3371,7 +3674,9 @@ void SceneMan::Draw(BITMAP *targetBitmap, BITMAP *targetGUIBitmap, const Vector
 		case LayerDrawMode::g_LayerMOID:
 			m_pMOIDLayer->Draw(targetBitmap, targetBox);
 			break;
-		default:
+		default: {
+			// Clients that are sent the entity states draw the MOs themselves, and draw the world layer over their terrain so it can carry the fog of war.
+			bool replicatesEntityState = g_FrameMan.IsInMultiplayerMode() && g_NetworkServer.ReplicatesEntityState();
 			if (!skipBackgroundLayers) {
 				for (std::list<SLBackground *>::reverse_iterator backgroundLayer = m_pCurrentScene->GetBackLayers().rbegin(); backgroundLayer != m_pCurrentScene->GetBackLayers().rend(); ++backgroundLayer) {
 					(*backgroundLayer)->Draw(targetBitmap, targetBox);
@@ -3381,13 +3686,13 @@ void SceneMan::Draw(BITMAP *targetBitmap, BITMAP *targetGUIBitmap, const Vector
 				terrain->SetLayerToDraw(SLTerrain::LayerType::BackgroundLayer);
 				terrain->Draw(targetBitmap, targetBox);
 			}
-			m_pMOColorLayer->Draw(targetBitmap, targetBox);
+			if (!replicatesEntityState) { m_pMOColorLayer->Draw(targetBitmap, targetBox); }
 
 			if (!skipTerrain) {
 				terrain->SetLayerToDraw(SLTerrain::LayerType::ForegroundLayer);
 				terrain->Draw(targetBitmap, targetBox);
 			}
-			if (!g_FrameMan.IsInMultiplayerMode()) {
+			if (!g_FrameMan.IsInMultiplayerMode() || replicatesEntityState) {
 				int team = m_ScreenTeam[m_LastUpdatedScreen];
 				if (SceneLayer *unseenLayer = (team != Activity::NoTeam) ? m_pCurrentScene->GetUnseenLayer(team) : nullptr) { unseenLayer->Draw(targetBitmap, targetBox); }
 			}
@@ -3399,6 +3704,7 @@ void SceneMan::Draw(BITMAP *targetBitmap, BITMAP *targetGUIBitmap, const Vector
 			if (m_pDebugLayer) { m_pDebugLayer->Draw(targetBitmap, targetBox); }
 
 			break;
+		}
 	}
 }
 
@@ -3425,6 +3731,7 @@ void SceneMan::ClearMOColorLayer()
 void SceneMan::ClearMOIDLayer()
 {
     clear_to_color(m_pMOIDLayer->GetBitmap(), g_NoMOID);
+    m_MOIDMasks.Reset();
 }
 
 
@@ -18,8 +18,10 @@
 #include "Timer.h"
 #include "Box.h"
 #include "Singleton.h"
+#include "MOIDMaskLayer.h"
 
 #include "ActivityMan.h"
+#include "SettingsMan.h"
 
 #define g_SceneMan SceneMan::Instance()
 
@@ -108,7 +110,7 @@ public:
 //                  memory. Create() should be called before using the object.
 // Arguments:       None.
 
-    SceneMan() { m_pOrphanSearchBitmap = 0; Clear(); }
+    SceneMan() { Clear(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -756,7 +758,7 @@ public:
 //                  end of this sim update.
 // Return value:    None.
 
-    void RegisterMOIDDrawing(int left, int top, int right, int bottom) { m_MOIDDrawings.push_back(IntRect(left, top, right, bottom)); }
+    void RegisterMOIDDrawing(int left, int top, int right, int bottom) { m_MOIDDrawings.push_back(IntRect(left, top, right, bottom)); RegisterObstacleDrawing(); }
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -771,6 +773,107 @@ public:
     void RegisterMOIDDrawing(const Vector &center, float radius);
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawsMOIDFootprints
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Indicates whether MOID and NoMOID draws onto a bitmap should register
+//                  footprints with RegisterMOIDFootprint, because MOID pixel checks are
+//                  answered from sprite bitmasks instead of the MOID layer.
+// Arguments:       The bitmap being drawn onto.
+// Return value:    Whether footprints should be registered for draws onto the bitmap.
+
+    bool DrawsMOIDFootprints(const BITMAP *targetBitmap) const { return g_SettingsMan.BitmaskMOCollision() && m_pMOIDLayer && targetBitmap == GetMOIDBitmap(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          DrawsMOIDLayer
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Indicates whether MOID and NoMOID draws should actually be drawn onto
+//                  the MOID layer. With bitmask MO collision that's only needed when the
+//                  layer is being viewed for debugging.
+// Arguments:       None.
+// Return value:    Whether the MOID layer should be drawn.
+
+    bool DrawsMOIDLayer() const { return !g_SettingsMan.BitmaskMOCollision() || m_LayerDrawMode == g_LayerMOID; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RegisterMOIDFootprint
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Registers a sprite drawn unrotated onto the MOID layer, for MOID pixel
+//                  checks to find with bitmask MO collision.
+// Arguments:       The sprite frame drawn.
+//                  The MOID drawn, or g_NoMOID if the sprite erases.
+//                  The coordinates of the upper left corner of the sprite on the layer.
+// Return value:    None.
+
+    void RegisterMOIDFootprint(BITMAP *sprite, MOID moid, int left, int top) { m_MOIDMasks.AddSprite(sprite, moid, left, top); RegisterObstacleDrawing(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RegisterMOIDFootprint
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Registers a sprite drawn rotated and scaled around a pivot onto the
+//                  MOID layer, for MOID pixel checks to find with bitmask MO collision.
+// Arguments:       The sprite frame drawn.
+//                  The MOID drawn, or g_NoMOID if the sprite erases.
+//                  The coordinates the pivot is drawn at on the layer.
+//                  The coordinates of the pivot on the drawn bitmap.
+//                  The Allegro angle and the scale it's drawn with.
+//                  Whether the drawn bitmap is the sprite flipped horizontally.
+// Return value:    None.
+
+    void RegisterMOIDFootprint(BITMAP *sprite, MOID moid, int x, int y, int pivotX, int pivotY, float angle, float scale, bool hFlipped) { m_MOIDMasks.AddPivotedSprite(sprite, moid, x, y, pivotX, pivotY, angle, scale, hFlipped); RegisterObstacleDrawing(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RegisterMOIDFootprint
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Registers a single pixel drawn onto the MOID layer, for MOID pixel
+//                  checks to find with bitmask MO collision.
+// Arguments:       The MOID drawn, or g_NoMOID if the pixel erases.
+//                  The coordinates of the pixel on the layer.
+// Return value:    None.
+
+    void RegisterMOIDFootprint(MOID moid, int x, int y) { m_MOIDMasks.AddPixel(moid, x, y); RegisterObstacleDrawing(); }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RegisterObstacleDrawing
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Registers that something that can be collided with was just drawn
+//                  onto the terrain material or MOID layers. Anything that caches
+//                  collision checks can compare GetObstacleDrawingCount() to see if its
+//                  results may have gone stale.
+// Arguments:       None.
+// Return value:    None.
+
+    void RegisterObstacleDrawing() { ++m_ObstacleDrawingCount; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetObstacleDrawingCount
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets the number of times obstacles have been drawn onto the terrain
+//                  material or MOID layers. Only ever increases.
+// Arguments:       None.
+// Return value:    The number of registered obstacle drawings so far.
+
+    unsigned long GetObstacleDrawingCount() const { return m_ObstacleDrawingCount; }
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          IsDrawingPixelCheckVisualizations
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Indicates whether pixel checks (GetTerrMatter and GetMOIDPixel) are
+//                  drawn to the debug layer, which makes them unsafe to do from
+//                  several threads at once.
+// Arguments:       None.
+// Return value:    Whether pixel check visualizations are drawn.
+
+    bool IsDrawingPixelCheckVisualizations() const { return m_DrawPixelCheckVisualizations; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          ClearAllMOIDDrawings
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -873,36 +976,26 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Description:     Returns the area of an orphaned region at specified coordinates. 
 // Arguments:       Coordinates to check for region, whether the orphaned region should be converted into MOPixels and region removed.
-//					Area of orphaned object calculated during recursve function call to check if we're out of limits
 //					Size of the are to look for orphaned objects
 //					Max area of orphaned object to remove
 //					Whether to actually remove orphaned pixels or not
-//					Whether to clear internal terrain tracking bitmap or not
-// Return value:    The area of orphaned region at posX,posY
+// Return value:    The area of orphaned region at posX,posY, or something larger than
+//                  maxArea if it's too large or not orphaned within the search area.
 
     int RemoveOrphans(int posX, int posY, int radius, int maxArea, bool remove = false);
 
+
 //////////////////////////////////////////////////////////////////////////////////////////
-// Method:          RemoveOrphans
+// Method:          RunOrphanSearchBenchmark
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Returns the area of an orphaned region at specified coordinates. 
-// Arguments:       Coordinates to check for region, whether the orphaned region should be converted into MOPixels and region removed.
-//					Coordinates of initial terrain penetration to check, which serves as a center of orphaned object detection.
-//					Area of orphaned object calculated during recursve function call to check if we're out of limits
-//					Size of the are to look for orphaned objects
-//					Max area of orphaned object to remove
-//					Whether to actually remove orphaned pixels or not
-//					Whether to clear internal terrain tracking bitmap or not
-// Return value:    The area of orphaned region at posX,posY
+// Description:     Measures how long searching for orphaned regions takes on a synthetic
+//                  terrain of scattered clumps of material, and prints the results to the
+//                  console. Doesn't need or touch any Scene.
+// Arguments:       The number of searches to run, and the size of the area and max area
+//                  of orphaned regions to search with.
+// Return value:    None.
 
-    int RemoveOrphans(int posX,
-					  int posY,
-					  int centerPosX,
-					  int centerPosY,
-					  int accumulatedArea,
-					  int radius,
-					  int maxArea,
-					  bool remove = false);
+    void RunOrphanSearchBenchmark(int searchCount = 1000000, int radius = MAXORPHANRADIUS, int maxArea = 25);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          MakeAllUnseen
@@ -958,6 +1051,18 @@ public:
     Vector GetUnseenResolution(const int team) const;
 
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          GetUnseenRevision
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Gets a number that counts up every time anything on the unseen layer
+//                  of a team is hidden again, so whatever keeps track of what's been
+//                  revealed knows to look again.
+// Arguments:       The team we're talking about.
+// Return value:    The current unseen revision of that team.
+
+    unsigned long GetUnseenRevision(const int team) const { return (team >= Activity::TeamOne && team < Activity::MaxTeamCount) ? m_UnseenRevision[team] : 0; }
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          IsUnseen
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1284,6 +1389,50 @@ public:
     float CastObstacleRay(const Vector &start, const Vector &ray, Vector &obstaclePos, Vector &freePos, MOID ignoreMOID = g_NoMOID, int ignoreTeam = Activity::NoTeam, unsigned char ignoreMaterial = 0, int skip = 0);
 
 
+	/// <summary>
+	/// A ray for CastRays to cast, and the result it gets.
+	/// </summary>
+	struct RayQuery
+	{
+		/// <summary>
+		/// The kinds of rays that can be cast, each working like the single ray cast method of the same name.
+		/// </summary>
+		enum RayType { MaterialRay, NotMaterialRay, StrengthRay, WeaknessRay, StrengthSumRay, MaxStrengthRay, MORay };
+
+		RayType Type = MaterialRay; //!< The kind of ray to cast.
+		Vector Start; //!< The starting position.
+		Vector Ray; //!< The vector to trace along.
+		unsigned char Material = g_MaterialAir; //!< The material looked for by MaterialRays, or looked past by NotMaterialRays.
+		unsigned char IgnoreMaterial = g_MaterialAir; //!< The material StrengthRays, StrengthSumRays and MORays don't count.
+		float Strength = 0; //!< The strength threshold of StrengthRays and WeaknessRays.
+		int Skip = 0; //!< For every pixel checked along the ray, how many to skip between them. The last pixel is always checked.
+		bool Wrap = true; //!< Whether the ray wraps around the scene seams. MaterialRays, StrengthRays and WeaknessRays can be made not to, the rest always do.
+		bool CheckMOs = false; //!< Whether NotMaterialRays also stop at any MO.
+		MOID IgnoreMOID = g_NoMOID; //!< The MOID, and all its children, that MORays look past.
+		int IgnoreTeam = Activity::NoTeam; //!< The team whose team hit ignoring MOs MORays look past.
+		bool IgnoreAllTerrain = false; //!< Whether MORays go through terrain.
+
+		bool Hit = false; //!< Set to whether the ray found what it was looking for. MORays also count being stopped by terrain as a hit.
+		Vector HitPos; //!< Set to the wrapped position of the hit, or to the last checked position if there was none.
+		float Value = -1; //!< Set to the distance to the hit, or -1 if there was none. StrengthSumRays and MaxStrengthRays set it to the sum or max of strengths instead.
+		MOID HitMOID = g_NoMOID; //!< Set to the MOID MORays hit, if any.
+	};
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastRays
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Casts a batch of rays against the terrain and MOs, split across the
+//                  worker threads unless pixel checks are being visualized. The terrain
+//                  and MOID layer must not change meanwhile, so this should only be
+//                  called between updates, like from scripts.
+//                  GetLastRayHitPos and the ray cast visualizations are left alone.
+// Arguments:       The rays to cast. Their results are filled in.
+// Return value:    None.
+
+    void CastRays(std::vector<RayQuery> &rayQueries);
+
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          GetLastRayHitPos
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1542,12 +1691,24 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          Update
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Updates the state of this SceneMan. Supposed to be done every frame
-//                  before drawing.
+// Description:     Updates the state of the current Scene that doesn't depend on any
+//                  screen, like pathfinding costs, terrain changes sent to clients and
+//                  air cleaning. Supposed to be done once every sim update.
+// Arguments:       None.
+// Return value:    None.
+
+    void Update();
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          Update
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Updates the view of this SceneMan for a screen. Supposed to be done
+//                  for each screen every frame before drawing it.
 // Arguments:       Which screen to update for.
 // Return value:    None.
 
-    void Update(int screen = 0);
+    void Update(int screen);
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1608,13 +1769,15 @@ public:
 //////////////////////////////////////////////////////////////////////////////////////////
 // Method:          RegisterTerrainChange
 //////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Registers terrain change event for the network server to be then sent to clients.
-// Arguments:       x,y - scene coordinates of change, w,h - size of the changed region, 
-//					color - changed color for one-pixel events, 
-//					back - if true, then background bitmap was changed if false then foreground.
+// Description:     Registers a terrain change by marking the terrain chunks it touches as
+//                  dirty. Air cleaning, pathfinding and the network server only look at
+//                  dirty chunks. The network server gets the changes at the next Update.
+// Arguments:       x,y - scene coordinates of change, w,h - size of the changed region,
+//					back - if true, then background bitmap was changed if false then foreground
+//                  (and material).
 // Return value:    None.
 
-	void RegisterTerrainChange(int x, int y, int w, int h, unsigned char color, bool back);
+	void RegisterTerrainChange(int x, int y, int w, int h, bool back);
 
 
 	/// <summary>
@@ -1624,14 +1787,13 @@ public:
 	/// <returns>Pointer to the temp BITMAP of the appropriate size. Ownership is NOT transferred!</returns>
 	BITMAP * GetIntermediateBitmapForSettlingIntoTerrain(int moDiameter) const;
 
-	//	Struct to register terrain change events
+	//	Struct to send terrain change events to network clients with
 	struct TerrainChange
 	{
 		int x;
 		int y;
 		int w;
 		int h;
-		unsigned char color;
 		bool back;
 	};
 
@@ -1640,6 +1802,20 @@ public:
 	/// </summary>
 	void ClearCurrentScene();
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          RunTerrainLoadBenchmark
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Loads a copy of the terrain of every Scene preset in a data module,
+//                  measuring how long loading took and how long texturizing it takes on
+//                  one thread compared to on all worker threads, and prints the results
+//                  to the console. Doesn't affect the current Scene.
+// Arguments:       The name of the data module to load the Scene terrains of, and the
+//                  number of times to texturize each terrain per measurement.
+// Return value:    None.
+
+    void RunTerrainLoadBenchmark(std::string moduleName = "Scenes.rte", int repetitionCount = 3);
+
 	//////////////////////////////////////////////////////////////////////////////////////////
 	// Protected member variable and method declarations
 
@@ -1664,6 +1840,12 @@ public:
     SceneLayer *m_pMOIDLayer;
     // All the areas drawn within on the MOID layer since last Update
     std::list<IntRect> m_MOIDDrawings;
+    // The number of times anything that can be collided with was drawn onto the terrain material or MOID layers
+    unsigned long m_ObstacleDrawingCount;
+    // The footprints of everything drawn onto the MOID layer since last Update, when bitmask MO collision is enabled in SettingsMan
+    MOIDMaskLayer m_MOIDMasks;
+    // Whether the MOID layer may have something left on it from being viewed with bitmask MO collision, which has to be cleared off once it's no longer viewed
+    bool m_MOIDLayerViewed;
 
     // Debug layer for seeing cast rays etc
     SceneLayer *m_pDebugLayer;
@@ -1706,6 +1888,8 @@ public:
 
     // Sound of an unseen pixel on an unseen layer being revealed.
     SoundContainer *m_pUnseenRevealSound;
+    // Counts up every time anything on the unseen layer of each team is hidden again
+    std::array<unsigned long, Activity::MaxTeamCount> m_UnseenRevision;
 
     bool m_DrawRayCastVisualizations; //!< Whether to visibly draw RayCasts to the Scene debug Bitmap.
     bool m_DrawPixelCheckVisualizations; //!< Whether to visibly draw pixel checks (GetTerrMatter and GetMOIDPixel) to the Scene debug Bitmap.
@@ -1723,8 +1907,12 @@ public:
 
     // The Timer to measure time between cleanings of the color layer of the Terrain.
     Timer m_CleanTimer;
-	// Bitmap to look for orphaned regions
-	BITMAP * m_pOrphanSearchBitmap;
+	// Which pixels of the search window around the position being checked for orphaned terrain have been filled
+	std::bitset<MAXORPHANRADIUS * MAXORPHANRADIUS> m_OrphanSearchVisited;
+	// Row runs of the orphan search waiting to be filled, by their starting pixel
+	std::vector<std::pair<int, int>> m_OrphanSearchStack;
+	// The pixels of the region found by the last orphan search
+	std::vector<std::pair<int, int>> m_OrphanedPixels;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1744,6 +1932,62 @@ private:
 
     void Clear();
 
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          CastRayQuery
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Casts a single ray of a CastRays batch and fills in its result.
+// Arguments:       The ray to cast, and a lookup table of the integrity of every material
+//                  ID.
+// Return value:    None.
+
+    void CastRayQuery(RayQuery &rayQuery, const std::array<float, c_PaletteEntriesNumber> &materialIntegrities);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          TraceRay
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Steps along a ray one pixel at a time, keeping the position wrapped
+//                  onto the scene as it goes, and calls a function for each checked pixel
+//                  until it returns true.
+// Arguments:       The starting position and the vector to trace along, how many pixels
+//                  to skip between checks, whether to wrap around the scene seams, the
+//                  function to call with each checked position, and the position to set
+//                  to where the trace stopped.
+// Return value:    Whether the function returned true for any pixel.
+
+    template <typename PixelFunction>
+    bool TraceRay(const Vector &start, const Vector &ray, int skip, bool wrap, PixelFunction &&pixelFunction, Vector &endPos);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          FindOrphanedRegion
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Flood fills the material connected to a position, within a square
+//                  search area centered on it, and collects the filled pixels. The
+//                  region is orphaned if the fill never reaches the edge of the area.
+// Arguments:       The material bitmap to search, the coordinates to start at, which are
+//                  part of the region even if they're air, the size of the search area,
+//                  which can't be larger than MAXORPHANRADIUS, and the max area of
+//                  orphaned region to look for.
+// Return value:    The area of the orphaned region, in which case its pixels are left in
+//                  m_OrphanedPixels, or something larger than maxArea if it's too large or
+//                  not orphaned.
+
+    int FindOrphanedRegion(BITMAP *materialBitmap, int posX, int posY, int radius, int maxArea);
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Method:          SendTerrainChanges
+//////////////////////////////////////////////////////////////////////////////////////////
+// Description:     Takes the color changes accumulated in the terrain's dirty chunks and
+//                  hands them to the network server, one region per changed chunk.
+//                  Discards them if not hosting.
+// Arguments:       None.
+// Return value:    None.
+
+    void SendTerrainChanges();
+
     
     // Disallow the use of some implicit methods.
 	SceneMan(const SceneMan &reference) = delete;
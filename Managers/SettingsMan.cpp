@@ -5,6 +5,7 @@
 #include "PostProcessMan.h"
 #include "AudioMan.h"
 #include "PerformanceMan.h"
+#include "ThreadMan.h"
 #include "UInputMan.h"
 #include "NetworkClient.h"
 #include "NetworkServer.h"
@@ -42,6 +43,11 @@ namespace RTE {
 
 		m_RecommendedMOIDCount = 240;
 		m_SimplifiedCollisionDetection = false;
+		m_BitmaskMOCollision = false;
+		m_AsyncPathfinding = false;
+		m_MaxPathSolvesPerUpdate = 16;
+		m_HierarchicalPathfinding = false;
+		m_PathCostUpdateBudget = 1.0F;
 		m_SceneBackgroundAutoScaleMode = 1;
 		m_DisableFactionBuyMenuThemes = false;
 
@@ -173,6 +179,16 @@ namespace RTE {
 			reader >> m_RecommendedMOIDCount;
 		} else if (propName == "SimplifiedCollisionDetection") {
 			reader >> m_SimplifiedCollisionDetection;
+		} else if (propName == "BitmaskMOCollision") {
+			reader >> m_BitmaskMOCollision;
+		} else if (propName == "AsyncPathfinding") {
+			reader >> m_AsyncPathfinding;
+		} else if (propName == "MaxPathSolvesPerUpdate") {
+			reader >> m_MaxPathSolvesPerUpdate;
+		} else if (propName == "HierarchicalPathfinding") {
+			reader >> m_HierarchicalPathfinding;
+		} else if (propName == "PathCostUpdateBudget") {
+			reader >> m_PathCostUpdateBudget;
 		} else if (propName == "SceneBackgroundAutoScaleMode") {
 			SetSceneBackgroundAutoScaleMode(std::stoi(reader.ReadPropValue()));
 		} else if (propName == "DisableFactionBuyMenuThemes") {
@@ -181,6 +197,16 @@ namespace RTE {
 			reader >> g_MovableMan.m_SettlingEnabled;
 		} else if (propName == "EnableMOSubtraction") {
 			reader >> g_MovableMan.m_MOSubtractionEnabled;
+		} else if (propName == "EnableParallelParticleTravel") {
+			reader >> g_MovableMan.m_ParallelParticleTravelEnabled;
+		} else if (propName == "CheckParallelParticleTravel") {
+			reader >> g_MovableMan.m_ParallelParticleTravelCheckEnabled;
+		} else if (propName == "EnableBatchedScriptUpdates") {
+			reader >> g_MovableMan.m_BatchedScriptUpdatesEnabled;
+		} else if (propName == "EnableParticleStore") {
+			reader >> g_MovableMan.m_ParticleStoreEnabled;
+		} else if (propName == "WorkerThreadCount") {
+			reader >> g_ThreadMan.m_RequestedWorkerCount;
 		} else if (propName == "DeltaTime") {
 			g_TimerMan.SetDeltaTimeSecs(std::stof(reader.ReadPropValue()));
 		} else if (propName == "RealToSimCap") {
@@ -253,6 +279,12 @@ namespace RTE {
 			reader >> g_NetworkServer.m_FastAccelerationFactor;
 		} else if (propName == "ServerUseInterlacing") {
 			reader >> g_NetworkServer.m_UseInterlacing;
+		} else if (propName == "ServerUseDeltaCompression") {
+			reader >> g_NetworkServer.m_UseDeltaCompression;
+		} else if (propName == "ServerEncoderThreads") {
+			reader >> g_NetworkServer.m_EncoderThreadCount;
+		} else if (propName == "ServerReplicateEntityState") {
+			reader >> g_NetworkServer.m_ReplicateEntityState;
 		} else if (propName == "ServerEncodingFps") {
 			reader >> g_NetworkServer.m_EncodingFps;
 		} else if (propName == "ServerSleepWhenIdle") {
@@ -351,10 +383,20 @@ namespace RTE {
 		writer.NewPropertyWithValue("DisableLuaJIT", g_LuaMan.m_DisableLuaJIT);
 		writer.NewPropertyWithValue("RecommendedMOIDCount", m_RecommendedMOIDCount);
 		writer.NewPropertyWithValue("SimplifiedCollisionDetection", m_SimplifiedCollisionDetection);
+		writer.NewPropertyWithValue("BitmaskMOCollision", m_BitmaskMOCollision);
+		writer.NewPropertyWithValue("AsyncPathfinding", m_AsyncPathfinding);
+		writer.NewPropertyWithValue("MaxPathSolvesPerUpdate", m_MaxPathSolvesPerUpdate);
+		writer.NewPropertyWithValue("HierarchicalPathfinding", m_HierarchicalPathfinding);
+		writer.NewPropertyWithValue("PathCostUpdateBudget", m_PathCostUpdateBudget);
 		writer.NewPropertyWithValue("SceneBackgroundAutoScaleMode", m_SceneBackgroundAutoScaleMode);
 		writer.NewPropertyWithValue("DisableFactionBuyMenuThemes", m_DisableFactionBuyMenuThemes);
 		writer.NewPropertyWithValue("EnableParticleSettling", g_MovableMan.m_SettlingEnabled);
 		writer.NewPropertyWithValue("EnableMOSubtraction", g_MovableMan.m_MOSubtractionEnabled);
+		writer.NewPropertyWithValue("EnableParallelParticleTravel", g_MovableMan.m_ParallelParticleTravelEnabled);
+		writer.NewPropertyWithValue("CheckParallelParticleTravel", g_MovableMan.m_ParallelParticleTravelCheckEnabled);
+		writer.NewPropertyWithValue("EnableBatchedScriptUpdates", g_MovableMan.m_BatchedScriptUpdatesEnabled);
+		writer.NewPropertyWithValue("EnableParticleStore", g_MovableMan.m_ParticleStoreEnabled);
+		writer.NewPropertyWithValue("WorkerThreadCount", g_ThreadMan.m_RequestedWorkerCount);
 		writer.NewPropertyWithValue("DeltaTime", g_TimerMan.GetDeltaTimeSecs());
 		writer.NewPropertyWithValue("RealToSimCap", g_TimerMan.GetRealToSimCap());
 
@@ -416,6 +458,9 @@ namespace RTE {
 		writer.NewPropertyWithValue("ServerHighCompressionLevel", g_NetworkServer.m_HighCompressionLevel);
 		writer.NewPropertyWithValue("ServerFastAccelerationFactor", g_NetworkServer.m_FastAccelerationFactor);
 		writer.NewPropertyWithValue("ServerUseInterlacing", g_NetworkServer.m_UseInterlacing);
+		writer.NewPropertyWithValue("ServerUseDeltaCompression", g_NetworkServer.m_UseDeltaCompression);
+		writer.NewPropertyWithValue("ServerEncoderThreads", g_NetworkServer.m_EncoderThreadCount);
+		writer.NewPropertyWithValue("ServerReplicateEntityState", g_NetworkServer.m_ReplicateEntityState);
 		writer.NewPropertyWithValue("ServerEncodingFps", g_NetworkServer.m_EncodingFps);
 		writer.NewPropertyWithValue("ServerSleepWhenIdle", g_NetworkServer.m_SleepWhenIdle);
 		writer.NewPropertyWithValue("ServerSimSleepWhenIdle", g_NetworkServer.m_SimSleepWhenIdle);
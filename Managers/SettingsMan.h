@@ -69,6 +69,36 @@ namespace RTE {
 		/// <returns>Whether simplified collision detection is enabled or not.</returns>
 		bool SimplifiedCollisionDetection() const { return m_SimplifiedCollisionDetection; }
 
+		/// <summary>
+		/// Gets whether MOID pixel checks are answered from the sprite bitmasks of the MOs drawn this frame instead of the MOID layer.
+		/// </summary>
+		/// <returns>Whether bitmask MO collision is enabled or not.</returns>
+		bool BitmaskMOCollision() const { return m_BitmaskMOCollision; }
+
+		/// <summary>
+		/// Gets whether AI Actors request their paths to be calculated in the background instead of calculating them on the spot.
+		/// </summary>
+		/// <returns>Whether asynchronous pathfinding is enabled or not.</returns>
+		bool AsyncPathfinding() const { return m_AsyncPathfinding; }
+
+		/// <summary>
+		/// Gets the maximum number of distinct background path requests handed out to be solved each sim update.
+		/// </summary>
+		/// <returns>The maximum number of path solves per sim update. 0 or less means no limit.</returns>
+		int GetMaxPathSolvesPerUpdate() const { return m_MaxPathSolvesPerUpdate; }
+
+		/// <summary>
+		/// Gets whether paths between points far apart are solved on the cluster portals of the PathFinder's hierarchy layers first, instead of node by node.
+		/// </summary>
+		/// <returns>Whether hierarchical pathfinding is enabled or not.</returns>
+		bool HierarchicalPathfinding() const { return m_HierarchicalPathfinding; }
+
+		/// <summary>
+		/// Gets the time each frame may spend recalculating the pathfinding costs of terrain that changed, instead of recalculating all of it every 10 seconds.
+		/// </summary>
+		/// <returns>The time budget in milliseconds. 0 or less means the changed terrain is recalculated all at once every 10 seconds.</returns>
+		float GetPathCostUpdateBudget() const { return m_PathCostUpdateBudget; }
+
 		/// <summary>
 		/// Gets the Scene background layer auto-scaling mode.
 		/// </summary>
@@ -481,6 +511,11 @@ namespace RTE {
 
 		int m_RecommendedMOIDCount; //!< Recommended max MOID's before removing actors from scenes.
 		bool m_SimplifiedCollisionDetection; //!< Whether simplified collision detection (reduced MOID layer sampling) is enabled.
+		bool m_BitmaskMOCollision; //!< Whether MOID pixel checks are answered from the sprite bitmasks of the MOs drawn this frame instead of the MOID layer.
+		bool m_AsyncPathfinding; //!< Whether AI Actors request their paths to be calculated in the background instead of calculating them on the spot.
+		int m_MaxPathSolvesPerUpdate; //!< The maximum number of distinct background path requests handed out to be solved each sim update. 0 or less means no limit.
+		bool m_HierarchicalPathfinding; //!< Whether paths between points far apart are solved on the cluster portals of the PathFinder's hierarchy layers first, instead of node by node.
+		float m_PathCostUpdateBudget; //!< The time in milliseconds each frame may spend recalculating the pathfinding costs of changed terrain. 0 or less means all of it is recalculated every 10 seconds instead.
 		int m_SceneBackgroundAutoScaleMode; //!< Scene background layer auto-scaling mode. 0 for off, 1 for fit screen dimensions and 2 for always upscaled to x2.
 		bool m_DisableFactionBuyMenuThemes; //!< Whether faction BuyMenu theme support is disabled.
 
@@ -1,62 +1,310 @@
-//////////////////////////////////////////////////////////////////////////////////////////
-// File:            ThreadMan.cpp
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Source file for the ThreadMan class.
-// Project:         Retro Terrain Engine
-// Author(s):       
-//                  
-//                  
+#include "ThreadMan.h"
+#include "TimerMan.h"
+#include "ConsoleMan.h"
 
+namespace RTE {
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// Inclusions of header files
+	thread_local int ThreadMan::s_CurrentThreadIndex = 0;
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-#include "ThreadMan.h"
+	void ThreadMan::Clear() {
+		m_RequestedWorkerCount = 0;
+		m_Workers.clear();
+		m_ThreadStates.clear();
+		m_MainThreadID = std::thread::id();
+		m_QueuedJobCount = 0;
+		m_StopWorkers = false;
+		m_SleepingWorkerCount = 0;
+		m_CurrentFrameArena = 0;
+		m_FrameArenaGeneration = 0;
+		m_FrameArenaUsedBytes = 0;
+		m_FrameArenaPeakUsedBytes = 0;
+	}
 
-using namespace std;
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-namespace RTE
-{
+	int ThreadMan::Initialize() {
+		int workerCount = m_RequestedWorkerCount;
+		if (workerCount <= 0) { workerCount = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0); }
 
-#define DELTABUFFERSIZE 30
+		m_MainThreadID = std::this_thread::get_id();
+		m_StopWorkers = false;
 
-const string ThreadMan::m_ClassName = "ThreadMan";
+		// All the thread states need to exist before any worker starts looking through them for jobs to steal.
+		for (int threadIndex = 0; threadIndex <= workerCount; ++threadIndex) {
+			m_ThreadStates.emplace_back(std::make_unique<ThreadState>());
+			m_ThreadStates.back()->BusyTime = 0;
+		}
+		for (int threadIndex = 1; threadIndex <= workerCount; ++threadIndex) {
+			m_Workers.emplace_back(&ThreadMan::WorkerThreadFunction, this, threadIndex);
+		}
+		return 0;
+	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          Clear
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Clears all the member variables of this ThreadMan, effectively
-//                  resetting the members of this abstraction level only.
+	void ThreadMan::Destroy() {
+		if (!m_ThreadStates.empty()) {
+			while (RunQueuedJob()) {}
+		}
+		m_StopWorkers = true;
+		{
+			std::lock_guard<std::mutex> sleepLock(m_SleepMutex);
+		}
+		m_WakeCondition.notify_all();
+		for (std::thread &worker : m_Workers) {
+			if (worker.joinable()) { worker.join(); }
+		}
+		int requestedWorkerCount = m_RequestedWorkerCount;
+		// Whatever is still in the current frame arena needs to stay put for anything that outlives this, so keep using it.
+		int currentFrameArena = m_CurrentFrameArena;
+		unsigned int frameArenaGeneration = m_FrameArenaGeneration;
+		Clear();
+		m_RequestedWorkerCount = requestedWorkerCount;
+		m_CurrentFrameArena = currentFrameArena;
+		m_FrameArenaGeneration = frameArenaGeneration;
+	}
 
-void ThreadMan::Clear()
-{
-}
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+	int ThreadMan::GetCurrentThreadIndex() const {
+		return s_CurrentThreadIndex;
+	}
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          Create
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Makes the ThreadMan object ready for use.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int ThreadMan::Create()
-{
+	ScratchArena & ThreadMan::GetScratchArena() {
+		RTEAssert(!m_ThreadStates.empty(), "Trying to get a ScratchArena before ThreadMan is initialized!");
+		RTEAssert(CurrentThreadOwnsIndex(), "Trying to get a ScratchArena from a thread that isn't owned by ThreadMan or the main thread!");
+		return m_ThreadStates[s_CurrentThreadIndex]->Scratch;
+	}
 
-	return 0;
-}
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+	ScratchArena & ThreadMan::GetFrameArena() {
+		RTEAssert(m_MainThreadID == std::thread::id() || std::this_thread::get_id() == m_MainThreadID, "Trying to get the frame arena from a thread other than the main thread!");
+		return m_FrameArenas[m_CurrentFrameArena];
+	}
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          Destroy
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Destroys and resets (through Clear()) the ThreadMan object.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void ThreadMan::Destroy()
-{
+	void ThreadMan::SwapFrameArenas() {
+		// Nothing is ever released from a frame arena before it's reset, so what it has in use is everything the sim update allocated.
+		m_FrameArenaUsedBytes = m_FrameArenas[m_CurrentFrameArena].GetUsedBytes();
+		m_FrameArenaPeakUsedBytes = std::max(m_FrameArenaPeakUsedBytes, m_FrameArenaUsedBytes);
 
+		m_CurrentFrameArena = (m_CurrentFrameArena + 1) % static_cast<int>(m_FrameArenas.size());
+		m_FrameArenas[m_CurrentFrameArena].Reset();
+		m_FrameArenaGeneration++;
+	}
 
-    Clear();
-}
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	uint64_t ThreadMan::TakeWorkerBusyTime() {
+		uint64_t busyTime = 0;
+		for (size_t threadIndex = 1; threadIndex < m_ThreadStates.size(); ++threadIndex) {
+			busyTime += m_ThreadStates[threadIndex]->BusyTime.exchange(0);
+		}
+		return busyTime;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	ThreadMan::JobHandle ThreadMan::AddJob(std::function<void()> jobFunction, const std::vector<JobHandle> &dependencies) {
+		JobHandle job = std::make_shared<Job>();
+		job->Function = std::move(jobFunction);
+		job->Done = false;
+
+		// Hold on to an extra dependency while the real ones are registered, so the job can't get scheduled by a dependency finishing halfway through.
+		job->UnfinishedDependencies = 1;
+		for (const JobHandle &dependency : dependencies) {
+			if (dependency) {
+				std::lock_guard<std::mutex> dependentsLock(dependency->DependentsMutex);
+				if (!dependency->Done) {
+					++job->UnfinishedDependencies;
+					dependency->Dependents.emplace_back(job);
+				}
+			}
+		}
+		if (--job->UnfinishedDependencies == 0) { ScheduleJob(job); }
+		return job;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool ThreadMan::IsJobDone(const JobHandle &job) const {
+		return !job || job->Done;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ThreadMan::WaitForJob(const JobHandle &job) {
+		while (!IsJobDone(job)) {
+			if (!RunQueuedJob()) { std::this_thread::yield(); }
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ThreadMan::ParallelFor(int count, int batchSize, const std::function<void(int, int)> &batchFunction) {
+		if (count <= 0) {
+			return;
+		}
+		batchSize = std::max(batchSize, 1);
+		int batchCount = (count + batchSize - 1) / batchSize;
+
+		// Not worth involving anyone else for a single batch.
+		if (m_Workers.empty() || batchCount == 1) {
+			batchFunction(0, count);
+			return;
+		}
+
+		// Batches are handed out from a shared counter instead of being a job each, so uneven batches balance out without paying the job overhead for every batch.
+		std::atomic<int> nextBatchStart(0);
+		auto runBatches = [&nextBatchStart, &batchFunction, count, batchSize]() {
+			for (int batchStart = nextBatchStart.fetch_add(batchSize); batchStart < count; batchStart = nextBatchStart.fetch_add(batchSize)) {
+				batchFunction(batchStart, std::min(batchStart + batchSize, count));
+			}
+		};
+		int helperCount = std::min(GetWorkerCount(), batchCount - 1);
+		std::vector<JobHandle> helperJobs;
+		helperJobs.reserve(helperCount);
+		for (int helper = 0; helper < helperCount; ++helper) {
+			helperJobs.emplace_back(AddJob(runBatches));
+		}
+		runBatches();
+
+		// The helpers reference this stack frame, so all of them need to be done before leaving, even the ones that never got a batch.
+		for (const JobHandle &helperJob : helperJobs) {
+			WaitForJob(helperJob);
+		}
+	}
 
-} // namespace RTE
\ No newline at end of file
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ThreadMan::RunJobOverheadBenchmark(int jobCount) {
+		jobCount = std::max(jobCount, 1);
+		std::atomic<int> completedCount(0);
+		auto emptyJob = [&completedCount]() { completedCount.fetch_add(1, std::memory_order_relaxed); };
+		auto printResult = [jobCount](const std::string &measurementName, long long elapsedTime) {
+			g_ConsoleMan.PrintString("ThreadMan benchmark - " + measurementName + ": " + std::to_string(elapsedTime) + " us total, " + std::to_string(static_cast<double>(elapsedTime) * 1000.0 / static_cast<double>(jobCount)) + " ns per job");
+		};
+		g_ConsoleMan.PrintString("ThreadMan benchmark - Running " + std::to_string(jobCount) + " empty jobs per measurement on " + std::to_string(GetWorkerCount()) + " worker threads.");
+
+		long long startTime = g_TimerMan.GetAbsoluteTime();
+		std::vector<JobHandle> independentJobs;
+		independentJobs.reserve(jobCount);
+		for (int job = 0; job < jobCount; ++job) {
+			independentJobs.emplace_back(AddJob(emptyJob));
+		}
+		for (const JobHandle &job : independentJobs) {
+			WaitForJob(job);
+		}
+		printResult("Independent jobs", g_TimerMan.GetAbsoluteTime() - startTime);
+		independentJobs.clear();
+
+		startTime = g_TimerMan.GetAbsoluteTime();
+		JobHandle previousJob;
+		for (int job = 0; job < jobCount; ++job) {
+			previousJob = AddJob(emptyJob, { previousJob });
+		}
+		WaitForJob(previousJob);
+		printResult("Dependency chain", g_TimerMan.GetAbsoluteTime() - startTime);
+
+		startTime = g_TimerMan.GetAbsoluteTime();
+		ParallelFor(jobCount, 1, [&completedCount](int batchStart, int batchEnd) { completedCount.fetch_add(batchEnd - batchStart, std::memory_order_relaxed); });
+		printResult("ParallelFor with single index batches", g_TimerMan.GetAbsoluteTime() - startTime);
+
+		if (completedCount != jobCount * 3) { g_ConsoleMan.PrintString("ERROR: ThreadMan benchmark completed " + std::to_string(completedCount) + " jobs instead of " + std::to_string(jobCount * 3) + "!"); }
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ThreadMan::WorkerThreadFunction(int threadIndex) {
+		s_CurrentThreadIndex = threadIndex;
+
+		while (!m_StopWorkers) {
+			if (!RunQueuedJob()) {
+				std::unique_lock<std::mutex> sleepLock(m_SleepMutex);
+				++m_SleepingWorkerCount;
+				m_WakeCondition.wait(sleepLock, [this]() { return m_StopWorkers || m_QueuedJobCount > 0; });
+				--m_SleepingWorkerCount;
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ThreadMan::ScheduleJob(JobHandle job) {
+		// Counted before it's actually queued so the count never dips below the real number of queued jobs.
+		++m_QueuedJobCount;
+		ThreadState &threadState = *m_ThreadStates[s_CurrentThreadIndex];
+		{
+			std::lock_guard<std::mutex> queueLock(threadState.QueueMutex);
+			threadState.Queue.emplace_back(std::move(job));
+		}
+		// A worker going to sleep registers itself before checking for queued jobs, so either it sees this job or we see it and wake it.
+		if (m_SleepingWorkerCount > 0) {
+			{
+				std::lock_guard<std::mutex> sleepLock(m_SleepMutex);
+			}
+			m_WakeCondition.notify_one();
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool ThreadMan::RunQueuedJob() {
+		if (m_QueuedJobCount <= 0) {
+			return false;
+		}
+		JobHandle job;
+		int threadCount = static_cast<int>(m_ThreadStates.size());
+
+		// Take from the back of our own queue, since that's most likely still in cache, and steal from the front of others', since those are the larger chunks of work split off first.
+		ThreadState &ownState = *m_ThreadStates[s_CurrentThreadIndex];
+		{
+			std::lock_guard<std::mutex> queueLock(ownState.QueueMutex);
+			if (!ownState.Queue.empty()) {
+				job = std::move(ownState.Queue.back());
+				ownState.Queue.pop_back();
+			}
+		}
+		for (int offset = 1; !job && offset < threadCount; ++offset) {
+			ThreadState &victimState = *m_ThreadStates[(s_CurrentThreadIndex + offset) % threadCount];
+			std::lock_guard<std::mutex> queueLock(victimState.QueueMutex);
+			if (!victimState.Queue.empty()) {
+				job = std::move(victimState.Queue.front());
+				victimState.Queue.pop_front();
+			}
+		}
+		if (!job) {
+			return false;
+		}
+		--m_QueuedJobCount;
+		RunJob(job);
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ThreadMan::RunJob(const JobHandle &job) {
+		long long startTime = g_TimerMan.GetAbsoluteTime();
+
+		job->Function();
+		// Release anything the function captured right away instead of whenever the last handle goes away.
+		job->Function = nullptr;
+
+		std::vector<JobHandle> dependents;
+		{
+			std::lock_guard<std::mutex> dependentsLock(job->DependentsMutex);
+			job->Done = true;
+			dependents.swap(job->Dependents);
+		}
+		for (JobHandle &dependent : dependents) {
+			if (--dependent->UnfinishedDependencies == 0) { ScheduleJob(std::move(dependent)); }
+		}
+		m_ThreadStates[s_CurrentThreadIndex]->BusyTime += static_cast<uint64_t>(g_TimerMan.GetAbsoluteTime() - startTime);
+	}
+}
@@ -1,141 +1,242 @@
-#ifndef _RTEThreadMan_
-#define _RTEThreadMan_
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// File:            ThreadMan.h
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Header file for the ThreadMan class.
-// Project:         Retro Terrain Engine
-// Author(s):       
-//                  
-//                  
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Inclusions of header files
-
-#include "global_types.h"
-
-
-//#include <boost/thread.hpp>
+#ifndef _RTETHREADMAN_
+#define _RTETHREADMAN_
 
 #include "Singleton.h"
-#define g_ThreadMan ThreadMan::Instance()
-
-namespace RTE
-{
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Class:           ThreadMan
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     The centralized singleton manager of all threads.
-// Parent(s):       Singleton
-// Class history:   03/29/2014  ThreadMan created.
-
-
-class ThreadMan:
-    public Singleton<ThreadMan>
-{
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Public member variable, method and friend function declarations
-
-public:
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Constructor:     ThreadMan
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Constructor method used to instantiate a ThreadMan object in system
-//                  memory. Create() should be called before using the object.
-// Arguments:       None.
-
-    ThreadMan() { Clear(); Create(); }
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Destructor:      ~ThreadMan
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Destructor method used to clean up a ThreadMan object before deletion
-//                  from system memory.
-// Arguments:       None.
-
-    virtual ~ThreadMan() { Destroy(); }
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          Create
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Makes the ThreadMan object ready for use.
-// Arguments:       None.
-// Return value:    An error return value signaling sucess or any particular failure.
-//                  Anything below 0 is an error signal.
+#include "ScratchArena.h"
 
-    virtual int Create();
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Virtual method:  Reset
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Resets the entire ThreadMan, including its inherited members, to
-//                  their default settings or values.
-// Arguments:       None.
-// Return value:    None.
-
-    virtual void Reset() { Clear(); }
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          Destroy
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Destroys and resets (through Clear()) the ThreadMan object.
-// Arguments:       None.
-// Return value:    None.
-
-    void Destroy();
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Virtual method:  GetClassName
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Gets the class name of this Entity.
-// Arguments:       None.
-// Return value:    A string with the friendly-formatted type name of this object.
-
-    virtual const std::string & GetClassName() const { return m_ClassName; }
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Protected member variable and method declarations
-
-protected:
-
-    // Member variables
-    static const std::string m_ClassName;
-
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Private member variable and method declarations
-
-private:
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Method:          Clear
-//////////////////////////////////////////////////////////////////////////////////////////
-// Description:     Clears all the member variables of this ThreadMan, effectively
-//                  resetting the members of this abstraction level only.
-// Arguments:       None.
-// Return value:    None.
-
-    void Clear();
-
-    // Disallow the use of some implicit methods.
-    ThreadMan(const ThreadMan &reference);
-    ThreadMan & operator=(const ThreadMan &rhs);
-
-};
-
-} // namespace RTE
+#define g_ThreadMan ThreadMan::Instance()
 
-#endif // File
+namespace RTE {
+
+	/// <summary>
+	/// The centralized singleton manager of all worker threads. Runs a work-stealing job system that sim systems can hand independent chunks of work to.
+	/// </summary>
+	class ThreadMan : public Singleton<ThreadMan> {
+		friend class SettingsMan;
+
+		struct Job;
+		struct ThreadState;
+
+	public:
+
+		/// <summary>
+		/// Handle to a job added to the ThreadMan. Used to wait for the job and to make other jobs depend on it.
+		/// </summary>
+		using JobHandle = std::shared_ptr<Job>;
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a ThreadMan object in system memory. Initialize() should be called before using the object.
+		/// </summary>
+		ThreadMan() { Clear(); }
+
+		/// <summary>
+		/// Makes the ThreadMan object ready for use, spawning the worker threads. Must be called from the main thread.
+		/// </summary>
+		/// <returns>An error return value signaling success or any particular failure. Anything below 0 is an error signal.</returns>
+		int Initialize();
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Destructor method used to clean up a ThreadMan object before deletion from system memory.
+		/// </summary>
+		~ThreadMan() { Destroy(); }
+
+		/// <summary>
+		/// Finishes all outstanding jobs, stops and joins all the worker threads and resets (through Clear()) the ThreadMan object.
+		/// </summary>
+		void Destroy();
+
+		/// <summary>
+		/// Resets the entire ThreadMan, including its inherited members, to their default settings or values.
+		/// </summary>
+		void Reset() { Clear(); }
+#pragma endregion
+
+#pragma region Getters and Setters
+		/// <summary>
+		/// Gets the number of worker threads owned by this ThreadMan, not counting the main thread.
+		/// </summary>
+		/// <returns>The number of worker threads. 0 means all jobs are run by the threads waiting on them.</returns>
+		int GetWorkerCount() const { return static_cast<int>(m_Workers.size()); }
+
+		/// <summary>
+		/// Gets the index of the calling thread. The main thread and any other thread not owned by this ThreadMan is 0, worker threads are numbered from 1 onward.
+		/// </summary>
+		/// <returns>The index of the calling thread.</returns>
+		int GetCurrentThreadIndex() const;
+
+		/// <summary>
+		/// Gets whether the calling thread has its thread index to itself, which is only the case for the main thread and the worker threads.
+		/// </summary>
+		/// <returns>Whether the calling thread is the main thread or one of the worker threads.</returns>
+		bool CurrentThreadOwnsIndex() const { return s_CurrentThreadIndex != 0 || std::this_thread::get_id() == m_MainThreadID; }
+
+		/// <summary>
+		/// Gets the ScratchArena of the calling thread, for temporary allocations during a job. Only valid for the main thread and the worker threads.
+		/// Anything allocated should be released before the job ends, preferably with a ScratchArena::Scope.
+		/// </summary>
+		/// <returns>The calling thread's ScratchArena.</returns>
+		ScratchArena & GetScratchArena();
+
+		/// <summary>
+		/// Gets the frame arena, for temporaries that only need to last through the current sim update and the next one. Only valid for the main thread.
+		/// Usually used through FrameAllocator rather than directly.
+		/// </summary>
+		/// <returns>The current frame arena.</returns>
+		ScratchArena & GetFrameArena();
+
+		/// <summary>
+		/// Gets the number of bytes allocated from the frame arena during the last finished sim update.
+		/// </summary>
+		/// <returns>The number of bytes the last sim update allocated from the frame arena.</returns>
+		size_t GetFrameArenaUsedBytes() const { return m_FrameArenaUsedBytes; }
+
+		/// <summary>
+		/// Gets the highest number of bytes allocated from the frame arena during any single sim update.
+		/// </summary>
+		/// <returns>The peak number of bytes a sim update allocated from the frame arena.</returns>
+		size_t GetFrameArenaPeakUsedBytes() const { return m_FrameArenaPeakUsedBytes; }
+
+		/// <summary>
+		/// Gets the number of times the frame arenas have been swapped, which goes up by one every sim update.
+		/// </summary>
+		/// <returns>The number of frame arena swaps so far.</returns>
+		unsigned int GetFrameArenaGeneration() const { return m_FrameArenaGeneration; }
+
+		/// <summary>
+		/// Gets the total time the worker threads spent running jobs since the last call to this, and resets it.
+		/// </summary>
+		/// <returns>The summed up busy time of all worker threads, in microseconds.</returns>
+		uint64_t TakeWorkerBusyTime();
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Switches over to the other frame arena, releasing everything allocated from it during the sim update before last. Must be called from the main thread at the start of every sim update.
+		/// </summary>
+		void SwapFrameArenas();
+#pragma endregion
+
+#pragma region Job Handling
+		/// <summary>
+		/// Adds a job that runs the passed in function on any thread once all the passed in jobs are done.
+		/// Jobs must not block on anything other than other jobs, which should be waited for with WaitForJob().
+		/// </summary>
+		/// <param name="jobFunction">The function to run.</param>
+		/// <param name="dependencies">The jobs that must be done before this job may start. Empty handles are ignored.</param>
+		/// <returns>A handle to the new job.</returns>
+		JobHandle AddJob(std::function<void()> jobFunction, const std::vector<JobHandle> &dependencies = {});
+
+		/// <summary>
+		/// Gets whether a job is done.
+		/// </summary>
+		/// <param name="job">The job to check.</param>
+		/// <returns>Whether the job is done. Empty handles count as done.</returns>
+		bool IsJobDone(const JobHandle &job) const;
+
+		/// <summary>
+		/// Blocks until a job is done. The calling thread runs other jobs in the meantime, so this is safe to call from within jobs too.
+		/// </summary>
+		/// <param name="job">The job to wait for. Empty handles return immediately.</param>
+		void WaitForJob(const JobHandle &job);
+
+		/// <summary>
+		/// Splits the index range [0, count) into batches and runs the passed in function over them on the worker threads and the calling thread. Blocks until all batches are done.
+		/// The function must not touch anything that other batches may be writing to. Can be nested inside jobs and other ParallelFor calls.
+		/// </summary>
+		/// <param name="count">The number of indices to process.</param>
+		/// <param name="batchSize">The maximum number of indices handed to a thread at a time.</param>
+		/// <param name="batchFunction">The function to run for each batch. It is passed the first index of the batch and the index one past the last.</param>
+		void ParallelFor(int count, int batchSize, const std::function<void(int, int)> &batchFunction);
+#pragma endregion
+
+#pragma region Benchmarking
+		/// <summary>
+		/// Measures the overhead of the job system by running batches of empty jobs, empty dependency chains and an empty ParallelFor, and prints the results to the console.
+		/// </summary>
+		/// <param name="jobCount">The number of jobs to run in each measurement.</param>
+		void RunJobOverheadBenchmark(int jobCount = 100000);
+#pragma endregion
+
+	protected:
+
+		int m_RequestedWorkerCount; //!< The number of worker threads requested via settings. 0 or less means use one less than the number of hardware threads.
+
+		std::vector<std::thread> m_Workers; //!< The worker threads owned by this.
+		std::vector<std::unique_ptr<ThreadState>> m_ThreadStates; //!< The state of every thread, indexed by thread index. Index 0 is shared by all threads that aren't workers.
+		std::thread::id m_MainThreadID; //!< The ID of the thread this was initialized on.
+
+		std::atomic<int> m_QueuedJobCount; //!< The number of jobs sitting in queues, waiting to be taken.
+		std::atomic<bool> m_StopWorkers; //!< Whether the worker threads should exit.
+		std::atomic<int> m_SleepingWorkerCount; //!< The number of worker threads currently sleeping, so adding jobs doesn't need to bother waking anyone if nobody is.
+		std::mutex m_SleepMutex; //!< Mutex for idle worker threads to sleep on.
+		std::condition_variable m_WakeCondition; //!< Condition idle worker threads wait on until there are jobs to take.
+
+		std::array<ScratchArena, 2> m_FrameArenas; //!< The frame arenas, taking turns at being allocated from so everything allocated during one sim update stays valid through the next one too. Never freed, as frame allocated containers can outlive this.
+		int m_CurrentFrameArena; //!< The index of the frame arena allocations are currently made from.
+		unsigned int m_FrameArenaGeneration; //!< The number of times the frame arenas have been swapped.
+		size_t m_FrameArenaUsedBytes; //!< The number of bytes allocated from the frame arena during the last finished sim update.
+		size_t m_FrameArenaPeakUsedBytes; //!< The highest number of bytes allocated from the frame arena during any single sim update.
+
+	private:
+
+		/// <summary>
+		/// A function to run on any thread, and the bookkeeping for the jobs depending on it.
+		/// </summary>
+		struct Job {
+			std::function<void()> Function; //!< The function this job runs.
+			std::atomic<int> UnfinishedDependencies; //!< The number of jobs that must be done before this can be scheduled, plus one while this is still being added.
+			std::atomic<bool> Done; //!< Whether this job is done.
+			std::mutex DependentsMutex; //!< Mutex guarding Done changing to true against new dependents being added.
+			std::vector<JobHandle> Dependents; //!< The jobs waiting on this job to be done.
+		};
+
+		/// <summary>
+		/// The job queue and scratch memory of a single thread.
+		/// </summary>
+		struct ThreadState {
+			std::mutex QueueMutex; //!< Mutex guarding the queue against thieves.
+			std::deque<JobHandle> Queue; //!< The jobs scheduled on this thread. The owner takes from the back, thieves steal from the front.
+			ScratchArena Scratch; //!< The scratch memory of this thread.
+			std::atomic<uint64_t> BusyTime; //!< The time in microseconds this thread spent running jobs since it was last taken.
+		};
+
+		static thread_local int s_CurrentThreadIndex; //!< The index of the thread this is accessed from.
+
+		/// <summary>
+		/// The function each worker thread runs. Takes and runs jobs until told to stop.
+		/// </summary>
+		/// <param name="threadIndex">The index of the worker thread.</param>
+		void WorkerThreadFunction(int threadIndex);
+
+		/// <summary>
+		/// Puts a job whose dependencies are all done into the calling thread's queue and wakes up a worker to take it.
+		/// </summary>
+		/// <param name="job">The job to schedule.</param>
+		void ScheduleJob(JobHandle job);
+
+		/// <summary>
+		/// Takes a job from the calling thread's queue, or steals one from another thread's if it's empty, and runs it.
+		/// </summary>
+		/// <returns>Whether a job was found and run.</returns>
+		bool RunQueuedJob();
+
+		/// <summary>
+		/// Runs a job, marks it done and schedules any of its dependents that have no unfinished dependencies left.
+		/// </summary>
+		/// <param name="job">The job to run.</param>
+		void RunJob(const JobHandle &job);
+
+		/// <summary>
+		/// Clears all the member variables of this ThreadMan, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+
+		// Disallow the use of some implicit methods.
+		ThreadMan(const ThreadMan &reference) = delete;
+		ThreadMan & operator=(const ThreadMan &rhs) = delete;
+	};
+}
+#endif
@@ -109,9 +109,14 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	int UInputMan::Initialize() {
-		if (install_keyboard() != 0) { RTEAbort("Failed to initialize keyboard!"); }
+		// There are no input devices to install in headless mode, all input comes from clients.
+		if (!System::IsHeadless() && install_keyboard() != 0) { RTEAbort("Failed to initialize keyboard!"); }
 		setlocale(LC_ALL, "C");
 
+		if (System::IsHeadless()) {
+			return 0;
+		}
+
 #ifdef _WIN32
 		// JOY_TYPE_AUTODETECT is failing to select the correct joystick driver, so a dual analog ends up with a non-functional right stick and the triggers being treated as one instead.
 		// This overrides the setting to force it to use the correct driver (without modifying AllegroConfig). Not sure why this is happening but appears to have started after updating Allegro.
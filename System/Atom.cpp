@@ -9,9 +9,7 @@
 namespace RTE {
 
 	const std::string Atom::c_ClassName = "Atom";
-	std::vector<void *> Atom::s_AllocatedPool;
-	int Atom::s_PoolAllocBlockCount = 200;
-	int Atom::s_InstancesInUse = 0;
+	SlabAllocator Atom::s_Pool(sizeof(Atom), 200);
 
 	// This forms a circle around the Atom's offset center, to check for mask color pixels in order to determine the normal at the Atom's position.
 	const int Atom::s_NormalChecks[c_NormalCheckCount][2] = { {0, -3}, {1, -3}, {2, -2}, {3, -1}, {3, 0}, {3, 1}, {2, 2}, {1, 3}, {0, 3}, {-1, 3}, {-2, 2}, {-3, 1}, {-3, 0}, {-3, -1}, {-2, -2}, {-1, -3} };
@@ -131,53 +129,6 @@ namespace RTE {
 		return 0;
 	}
 
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-	void * Atom::GetPoolMemory() {
-		// If the pool is empty, then fill it up again with as many instances as we are set to
-		if (s_AllocatedPool.empty()) { FillPool((s_PoolAllocBlockCount > 0) ? s_PoolAllocBlockCount : 10); }
-
-		// Get the instance in the top of the pool and pop it off
-		void *foundMemory = s_AllocatedPool.back();
-		s_AllocatedPool.pop_back();
-
-		RTEAssert(foundMemory, "Could not find an available instance in the pool, even after increasing its size!");
-
-		// Keep track of the number of instances passed out
-		s_InstancesInUse++;
-
-		return foundMemory;
-	}
-
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-	void Atom::FillPool(int fillAmount) {
-		// Default to the set block allocation size if fillAmount is 0
-		if (fillAmount <= 0) { fillAmount = s_PoolAllocBlockCount; }
-
-		// If concrete class, fill up the pool with pre-allocated memory blocks the size of the type
-		if (fillAmount > 0) {
-			// As many as we're asked to make
-			for (int i = 0; i < fillAmount; ++i) {
-				s_AllocatedPool.push_back(malloc(sizeof(Atom)));
-			}
-		}
-	}
-
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-	int Atom::ReturnPoolMemory(void *returnedMemory) {
-		if (!returnedMemory) {
-			return false;
-		}
-		s_AllocatedPool.push_back(returnedMemory);
-
-		// Keep track of the number of instances passed in
-		s_InstancesInUse--;
-
-		return s_InstancesInUse;
-	}
-
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	bool Atom::CalculateNormal(BITMAP *sprite, Vector spriteCenter) {
@@ -648,10 +599,9 @@ namespace RTE {
 		Vector segTraj;
 		Vector hitAccel;
 
-		std::vector<std::pair<int, int>> trailPoints;
+		FrameVector<std::pair<int, int>> trailPoints;
 
-		// This saves us a few ms because Atom::Travel does a lot of allocations and reallocations if you have a lot of particles.
-		// 6 should be enough for most not so fast travels, everything above simply works as usual.
+		// The trail points come from the frame arena, so this only saves regrowing. 6 should be enough for most not so fast travels, everything above simply works as usual.
 		trailPoints.reserve(6);
 		didWrap = false;
 		int removeOrphansRadius = m_OwnerMO->m_RemoveOrphanTerrainRadius;
@@ -1008,6 +958,116 @@ namespace RTE {
 		return hitCount;
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	template <typename StepFunction>
+	bool Atom::WalkTravelSegment(const Vector &position, const Vector &velocity, float travelTime, bool changedDir, int prevError, StepFunction stepFunction) {
+		// Same setup as the first segment in Travel(), so the pixels walked here are exactly the ones Travel() would check.
+		int intPos[2] = { static_cast<int>(std::floor(position.m_X)), static_cast<int>(std::floor(position.m_Y)) };
+		Vector segTraj = velocity * travelTime * c_PPM;
+
+		int delta[2];
+		delta[X] = static_cast<int>(std::floor(position.m_X + segTraj.m_X)) - intPos[X];
+		delta[Y] = static_cast<int>(std::floor(position.m_Y + segTraj.m_Y)) - intPos[Y];
+		if (std::abs(delta[X]) >= 2500 || std::abs(delta[Y]) >= 2500) {
+			return false;
+		}
+		if (delta[X] == 0 && delta[Y] == 0) {
+			return true;
+		}
+		int increment[2] = { delta[X] < 0 ? -1 : 1, delta[Y] < 0 ? -1 : 1 };
+		delta[X] = std::abs(delta[X]);
+		delta[Y] = std::abs(delta[Y]);
+		int delta2[2] = { delta[X] << 1, delta[Y] << 1 };
+		int dom = (delta[X] > delta[Y]) ? X : Y;
+		int sub = (dom == X) ? Y : X;
+		int error = changedDir ? delta2[sub] - delta[dom] : prevError;
+
+		if (!stepFunction(intPos[X], intPos[Y], true)) {
+			return false;
+		}
+		for (int domSteps = 0; domSteps < delta[dom]; ++domSteps) {
+			intPos[dom] += increment[dom];
+			if (error >= 0) {
+				intPos[sub] += increment[sub];
+				error -= delta2[dom];
+			}
+			error += delta2[sub];
+
+			g_SceneMan.WrapPosition(intPos[X], intPos[Y]);
+			if (!stepFunction(intPos[X], intPos[Y], false)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool Atom::IsTravelUnobstructed(const Vector &startPos, const Vector &velocity, float travelTime) const {
+		if (!m_OwnerMO) {
+			return false;
+		}
+		bool hitsMOs = m_OwnerMO->m_HitsMOs;
+		bool ignoreTerrain = m_OwnerMO->m_IgnoreTerrain;
+
+		return WalkTravelSegment(startPos, velocity, travelTime, [hitsMOs, ignoreTerrain](int posX, int posY, bool isStartPos) {
+			// Atoms starting out embedded in terrain get penetrated out regardless of whether they ignore terrain, see Travel().
+			if (isStartPos) {
+				return g_SceneMan.GetTerrMatter(posX, posY) == g_MaterialAir;
+			}
+			// Ignored MOIDs are treated as hits as well, they're rare enough that falling back to the full Travel() doesn't matter.
+			if (hitsMOs && g_SceneMan.GetMOIDPixel(posX, posY) != g_NoMOID) {
+				return false;
+			}
+			return ignoreTerrain || g_SceneMan.GetTerrMatter(posX, posY) == g_MaterialAir;
+		});
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool Atom::IsTerrainTravelUnobstructed(const Vector &startPos, const Vector &velocity, float travelTime, bool changedDir, int prevError, bool ignoreTerrain) {
+		return WalkTravelSegment(startPos, velocity, travelTime, changedDir, prevError, [ignoreTerrain](int posX, int posY, bool isStartPos) {
+			// Atoms starting out embedded in terrain get penetrated out regardless of whether they ignore terrain, see Travel().
+			return (ignoreTerrain && !isStartPos) || g_SceneMan.GetTerrMatter(posX, posY) == g_MaterialAir;
+		});
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void Atom::TravelUnobstructed(float travelTime) {
+		RTEAssert(m_OwnerMO, "Traveling an Atom without a parent MO!");
+		Vector &position = m_OwnerMO->m_Pos;
+		const Vector &velocity = m_OwnerMO->m_Vel;
+		m_LastHit.Reset();
+
+		// The pixels are only walked for the trail. The MOID Travel() leaves in m_MOIDHit is overwritten on the next step before it's ever read, so it's not worth walking for.
+		if (g_TimerMan.DrawnSimUpdate() && m_TrailLength) {
+			FrameVector<std::pair<int, int>> trailPoints;
+			trailPoints.reserve(6);
+			WalkTravelSegment(position, velocity, travelTime, [&trailPoints](int posX, int posY, bool isStartPos) {
+				trailPoints.push_back({ posX, posY });
+				return true;
+			});
+			// Travel() puts the first trail pixel even when not moving a whole pixel.
+			if (trailPoints.empty()) { trailPoints.push_back({ static_cast<int>(std::floor(position.m_X + m_Offset.m_X)), static_cast<int>(std::floor(position.m_Y + m_Offset.m_Y)) }); }
+
+			BITMAP *trailBitmap = g_SceneMan.GetMOColorBitmap();
+			int length = static_cast<int>(static_cast<float>(m_TrailLength) * RandomNum(1.0F - m_TrailLengthVariation, 1.0F));
+			for (int i = trailPoints.size() - std::min(length, static_cast<int>(trailPoints.size())); i < trailPoints.size(); ++i) {
+				putpixel(trailBitmap, trailPoints[i].first, trailPoints[i].second, m_TrailColor.GetIndex());
+			}
+		}
+
+		// Bake in and extract the offset the same way Travel() does, so the resulting position is bit for bit the same.
+		position += m_Offset;
+		position -= m_Offset;
+		position += velocity * travelTime * c_PPM;
+		m_OwnerMO->m_DidWrap = g_SceneMan.WrapPosition(position);
+
+		ClearMOIDIgnoreList();
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void HitData::Clear() {
@@ -3,6 +3,7 @@
 
 #include "Matrix.h"
 #include "Material.h"
+#include "SlabAllocator.h"
 #include "SceneMan.h"
 
 namespace RTE {
@@ -69,6 +70,7 @@ namespace RTE {
 	/// A point (pixel) that tests for collisions with a BITMAP's drawn pixels, ie not the mask color. Owned and operated by other objects.
 	/// </summary>
 	class Atom : public Serializable {
+		friend class ParticleStore;
 
 	public:
 
@@ -140,23 +142,23 @@ namespace RTE {
 
 #pragma region Memory Management
 		/// <summary>
-		/// Grabs from the pre-allocated pool, an available chunk of memory the exact size of an Atom. OWNERSHIP IS TRANSFERRED!
+		/// Grabs from the pre-allocated pool, an available chunk of memory the exact size of an Atom. Can be called from any thread. OWNERSHIP IS TRANSFERRED!
 		/// </summary>
 		/// <returns>A pointer to the pre-allocated pool memory. OWNERSHIP IS TRANSFERRED!</returns>
-		static void * GetPoolMemory();
+		static void * GetPoolMemory() { return s_Pool.Allocate(); }
 
 		/// <summary>
 		/// Adds a certain number of newly allocated instances to this' pool.
 		/// </summary>
 		/// <param name="fillAmount">The number of instances to fill with. If 0 is specified, the set refill amount will be used.</param>
-		static void FillPool(int fillAmount = 0);
+		static void FillPool(int fillAmount = 0) { s_Pool.Reserve(fillAmount); }
 
 		/// <summary>
-		/// Returns a raw chunk of memory back to the pre-allocated available pool.
+		/// Returns a raw chunk of memory back to the pre-allocated available pool. Can be called from any thread, not just the one that grabbed it.
 		/// </summary>
-		/// <param name="returnedMemory">The raw chunk of memory that is being returned. Needs to be the same size as an Atom. OWNERSHIP IS TRANSFERRED!</param>
+		/// <param name="returnedMemory">The raw chunk of memory that is being returned. Needs to have been grabbed from the Atom pool. OWNERSHIP IS TRANSFERRED!</param>
 		/// <returns>The count of outstanding memory chunks after this was returned.</returns>
-		static int ReturnPoolMemory(void *returnedMemory);
+		static int ReturnPoolMemory(void *returnedMemory) { return s_Pool.Deallocate(returnedMemory); }
 #pragma endregion
 
 #pragma region Getters and Setters
@@ -439,6 +441,36 @@ namespace RTE {
 		/// <param name="scenePreLocked">Whether the Scene has been pre-locked or not.</param>
 		/// <returns>The number of hits against terrain that were made during the travel.</returns>
 		int Travel(float travelTime, bool autoTravel = true, bool scenePreLocked = false);
+
+		/// <summary>
+		/// Checks whether Travel() of the owning MovableObject from the passed in state would pass through nothing but air and unoccupied MOID pixels, without modifying anything.
+		/// Only reads the Scene, so it can be called from multiple threads at once as long as nothing writes to the terrain or MOID layers in the meantime. The Scene MUST BE LOCKED before calling this!
+		/// </summary>
+		/// <param name="startPos">The position of the owning MovableObject to start the travel from.</param>
+		/// <param name="velocity">The velocity of the owning MovableObject during the travel.</param>
+		/// <param name="travelTime">The amount of time in s that this Atom is allowed to travel.</param>
+		/// <returns>Whether the whole travel is unobstructed. False is also returned for trajectories too long to check.</returns>
+		bool IsTravelUnobstructed(const Vector &startPos, const Vector &velocity, float travelTime) const;
+
+		/// <summary>
+		/// Moves the owning MovableObject and draws this Atom's trail exactly like Travel() does when nothing is hit, without checking the Scene for collisions.
+		/// Only valid to call if IsTravelUnobstructed() returned true for the owning MovableObject's current position and velocity.
+		/// </summary>
+		/// <param name="travelTime">The amount of time in s that this Atom is allowed to travel.</param>
+		void TravelUnobstructed(float travelTime);
+
+		/// <summary>
+		/// Checks whether Travel() of an offsetless Atom owned by a MovableObject that doesn't hit MOs would pass through nothing but air, without needing the Atom or its owner.
+		/// Same threading rules as IsTravelUnobstructed(). The Scene MUST BE LOCKED before calling this!
+		/// </summary>
+		/// <param name="startPos">The position to start the travel from.</param>
+		/// <param name="velocity">The velocity during the travel.</param>
+		/// <param name="travelTime">The amount of time in s that the Atom is allowed to travel.</param>
+		/// <param name="changedDir">Whether the Atom's trajectory changed direction during its last travel.</param>
+		/// <param name="prevError">The Atom's stored error at the end of its last travel. Only used if changedDir is false.</param>
+		/// <param name="ignoreTerrain">Whether the owning MovableObject ignores terrain.</param>
+		/// <returns>Whether the whole travel is unobstructed. False is also returned for trajectories too long to check.</returns>
+		static bool IsTerrainTravelUnobstructed(const Vector &startPos, const Vector &velocity, float travelTime, bool changedDir, int prevError, bool ignoreTerrain);
 #pragma endregion
 
 #pragma region Operator Overloads
@@ -467,9 +499,7 @@ namespace RTE {
 
 		static constexpr int c_NormalCheckCount = 16; //!< Array size for offsets to form circle in s_NormalChecks.
 
-		static std::vector<void *> s_AllocatedPool; //!< Pool of pre-allocated Atoms.
-		static int s_PoolAllocBlockCount; //!< The number of instances to fill up the pool of Atoms with each time it runs dry.
-		static int s_InstancesInUse; //!< The number of allocated instances passed out from the pool.
+		static SlabAllocator s_Pool; //!< Pool of pre-allocated Atoms.
 		static const int s_NormalChecks[c_NormalCheckCount][2]; //!< This forms a circle around the Atom's offset center, to check for key color pixels in order to determine the normal at the Atom's position.
 
 		Vector m_Offset; //!< The offset of this Atom for collision calculations.
@@ -530,6 +560,28 @@ namespace RTE {
 
 		static const std::string c_ClassName; //!< A string with the friendly-formatted type name of this.
 
+		/// <summary>
+		/// Walks the pixels Travel() would step through on its first segment from the passed in state, without checking or modifying anything along the way.
+		/// </summary>
+		/// <param name="startPos">The position of the owning MovableObject to start the travel from.</param>
+		/// <param name="velocity">The velocity of the owning MovableObject during the travel.</param>
+		/// <param name="travelTime">The amount of time in s that this Atom is allowed to travel.</param>
+		/// <param name="stepFunction">Function called with the wrapped coordinates of each pixel stepped onto, and whether it is the starting pixel. Walking stops early if it returns false.</param>
+		/// <returns>False if the walk was stopped early or the trajectory is too long to walk, true otherwise.</returns>
+		template <typename StepFunction> bool WalkTravelSegment(const Vector &startPos, const Vector &velocity, float travelTime, StepFunction stepFunction) const { return WalkTravelSegment(startPos + m_Offset, velocity, travelTime, m_ChangedDir, m_PrevError, stepFunction); }
+
+		/// <summary>
+		/// Walks the pixels Travel() would step through on its first segment from the passed in state, for an Atom in the passed in state.
+		/// </summary>
+		/// <param name="position">The position of the Atom itself, offset included, to start the travel from.</param>
+		/// <param name="velocity">The velocity of the owning MovableObject during the travel.</param>
+		/// <param name="travelTime">The amount of time in s that the Atom is allowed to travel.</param>
+		/// <param name="changedDir">Whether the Atom's trajectory changed direction during its last travel.</param>
+		/// <param name="prevError">The Atom's stored error at the end of its last travel. Only used if changedDir is false.</param>
+		/// <param name="stepFunction">Function called with the wrapped coordinates of each pixel stepped onto, and whether it is the starting pixel. Walking stops early if it returns false.</param>
+		/// <returns>False if the walk was stopped early or the trajectory is too long to walk, true otherwise.</returns>
+		template <typename StepFunction> static bool WalkTravelSegment(const Vector &position, const Vector &velocity, float travelTime, bool changedDir, int prevError, StepFunction stepFunction);
+
 		/// <summary>
 		/// Clears all the member variables of this Atom, effectively resetting the members of this abstraction level only.
 		/// </summary>
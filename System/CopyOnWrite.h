@@ -0,0 +1,92 @@
+#ifndef _RTECOPYONWRITE_
+#define _RTECOPYONWRITE_
+
+namespace RTE {
+
+	/// <summary>
+	/// Holds a value that's shared between copies instead of duplicated, until one of them needs to change it.
+	/// Meant for preset data that instances read but almost never change, so cloning an instance off a preset only has to count another reference instead of deep copying.
+	/// Copies can be made and read on any thread, but changing one has to be done on the thread that makes copies of it.
+	/// </summary>
+	template <typename Type>
+	class CopyOnWrite {
+
+	public:
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a CopyOnWrite object holding a default constructed value. Nothing is allocated until the value is first changed.
+		/// </summary>
+		CopyOnWrite() = default;
+
+		/// <summary>
+		/// Constructor method used to instantiate a CopyOnWrite object holding a copy of a value.
+		/// </summary>
+		/// <param name="value">The value to hold.</param>
+		CopyOnWrite(const Type &value) : m_Value(std::make_shared<Type>(value)) {}
+#pragma endregion
+
+#pragma region Getters and Setters
+		/// <summary>
+		/// Gets the held value, which may be shared with other copies.
+		/// </summary>
+		/// <returns>A const reference to the held value.</returns>
+		const Type & Get() const { return m_Value ? *m_Value : GetDefaultValue(); }
+
+		/// <summary>
+		/// Gets the held value for changing it, first duplicating it if it's shared with any other copies.
+		/// </summary>
+		/// <returns>A reference to the held value that only this holds.</returns>
+		Type & GetMutable() {
+			if (!m_Value) {
+				m_Value = std::make_shared<Type>();
+			} else if (m_Value.use_count() > 1) {
+				m_Value = std::make_shared<Type>(*m_Value);
+			}
+			return *m_Value;
+		}
+
+		/// <summary>
+		/// Replaces the held value, leaving any other copies holding the old one.
+		/// </summary>
+		/// <param name="value">The new value to hold.</param>
+		void Set(const Type &value) { m_Value = std::make_shared<Type>(value); }
+
+		/// <summary>
+		/// Goes back to holding a default constructed value, without allocating anything.
+		/// </summary>
+		void Reset() { m_Value.reset(); }
+
+		/// <summary>
+		/// Gets whether the held value is shared with any other copies.
+		/// </summary>
+		/// <returns>Whether changing the held value would duplicate it first.</returns>
+		bool IsShared() const { return m_Value && m_Value.use_count() > 1; }
+#pragma endregion
+
+#pragma region Operator Overloads
+		/// <summary>
+		/// Dereference operator for reading the held value.
+		/// </summary>
+		/// <returns>A const reference to the held value.</returns>
+		const Type & operator*() const { return Get(); }
+
+		/// <summary>
+		/// Member access operator for reading the held value.
+		/// </summary>
+		/// <returns>A const pointer to the held value.</returns>
+		const Type * operator->() const { return &Get(); }
+#pragma endregion
+
+	private:
+
+		std::shared_ptr<Type> m_Value; //!< The held value, shared with all the copies that haven't changed it. Null while it's default constructed.
+
+		/// <summary>
+		/// Gets the default constructed value every CopyOnWrite that hasn't allocated its own holds.
+		/// </summary>
+		/// <returns>A const reference to the default constructed value.</returns>
+		static const Type & GetDefaultValue() { static const Type defaultValue {}; return defaultValue; }
+	};
+}
+#endif
@@ -15,8 +15,8 @@ namespace RTE {
 		m_PresetName = "None";
 		m_IsOriginalPreset = false;
 		m_DefinedInModule = -1;
-		m_PresetDescription.clear();
-		m_Groups.clear();
+		m_PresetDescription.Reset();
+		m_Groups.Reset();
 		m_LastGroupSearch.clear();
 		m_LastGroupResult = false;
 		m_RandomWeight = 100;
@@ -25,7 +25,7 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	int Entity::Create() {
-		m_Groups.push_back("All"); // Special "All" group that includes.. all
+		m_Groups.GetMutable().push_back("All"); // Special "All" group that includes.. all
 		return 0;
 	}
 
@@ -35,11 +35,9 @@ namespace RTE {
 		m_PresetName = reference.m_PresetName;
 		// Note how m_IsOriginalPreset is NOT assigned, automatically indicating that the copy is not an original Preset!
 		m_DefinedInModule = reference.m_DefinedInModule;
+		// The description and groups are only read by the copies, so they're shared with the reference until one of them changes them.
 		m_PresetDescription = reference.m_PresetDescription;
-
-		for (const std::string &group : reference.m_Groups) {
-			m_Groups.push_back(group);
-		}
+		m_Groups = reference.m_Groups;
 		m_RandomWeight = reference.m_RandomWeight;
 		return 0;
 	}
@@ -68,15 +66,16 @@ namespace RTE {
 		} else if (propName == "Description") {
 			std::string descriptionValue = reader.ReadPropValue();
 			if (descriptionValue == "MultiLineText") {
-				m_PresetDescription.clear();
+				std::string &presetDescription = m_PresetDescription.GetMutable();
+				presetDescription.clear();
 				while (reader.NextProperty() && reader.ReadPropName() == "AddLine") {
-					m_PresetDescription += reader.ReadPropValue() + "\n\n";
+					presetDescription += reader.ReadPropValue() + "\n\n";
 				}
-				if (!m_PresetDescription.empty()) {
-					m_PresetDescription.resize(m_PresetDescription.size() - 2);
+				if (!presetDescription.empty()) {
+					presetDescription.resize(presetDescription.size() - 2);
 				}
 			} else {
-				m_PresetDescription = descriptionValue;
+				m_PresetDescription.Set(descriptionValue);
 			}
 		} else if (propName == "RandomWeight") {
 			reader >> m_RandomWeight;
@@ -107,11 +106,11 @@ namespace RTE {
 		} else if (!m_PresetName.empty() && m_PresetName != "None") {
 			writer.NewPropertyWithValue("CopyOf", GetModuleAndPresetName());
 		}
-		if (!m_PresetDescription.empty()) { writer.NewPropertyWithValue("Description", m_PresetDescription); }
+		if (!m_PresetDescription->empty()) { writer.NewPropertyWithValue("Description", m_PresetDescription.Get()); }
 
 		// TODO: Make proper save system that knows not to save redundant data!
 		/*
-		for (list<string>::const_iterator itr = m_Groups.begin(); itr != m_Groups.end(); ++itr) {
+		for (list<string>::const_iterator itr = m_Groups->begin(); itr != m_Groups->end(); ++itr) {
 			writer.NewPropertyWithValue("AddToGroup", *itr);
 		}
 		*/
@@ -184,7 +183,7 @@ namespace RTE {
 		if (whichGroup == "None") {
 			return false;
 		}
-		for (std::list<std::string>::const_iterator itr = m_Groups.begin(); itr != m_Groups.end(); ++itr) {
+		for (std::list<std::string>::const_iterator itr = m_Groups->begin(); itr != m_Groups->end(); ++itr) {
 			if (whichGroup == *itr) {
 				// Save the search result for quicker response next time
 				m_LastGroupSearch = whichGroup;
@@ -225,17 +224,15 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	Entity::ClassInfo::ClassInfo(const std::string &name, ClassInfo *parentInfo, MemoryAllocate allocFunc, MemoryDeallocate deallocFunc, Entity * (*newFunc)(), int allocBlockCount) :
+	Entity::ClassInfo::ClassInfo(const std::string &name, ClassInfo *parentInfo, MemoryAllocate allocFunc, MemoryDeallocate deallocFunc, Entity * (*newFunc)(), size_t instanceSize, int allocBlockCount) :
 		m_Name(name),
 		m_ParentInfo(parentInfo),
 		m_Allocate(allocFunc),
 		m_Deallocate(deallocFunc),
 		m_NewInstance(newFunc),
-		m_NextClass(s_ClassHead) {
+		m_NextClass(s_ClassHead),
+		m_Pool(instanceSize, allocBlockCount) {
 			s_ClassHead = this;
-
-			m_AllocatedPool.clear();
-			m_PoolAllocBlockCount = (allocBlockCount > 0) ? allocBlockCount : 10;
 		}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -273,15 +270,8 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void Entity::ClassInfo::FillPool(int fillAmount) {
-		// Default to the set block allocation size if fillAmount is 0
-		if (fillAmount <= 0) { fillAmount = m_PoolAllocBlockCount; }
-
-		// If concrete class, fill up the pool with pre-allocated memory blocks the size of the type
-		if (m_Allocate && fillAmount > 0) {
-			for (int i = 0; i < fillAmount; ++i) {
-				m_AllocatedPool.push_back(m_Allocate());
-			}
-		}
+		// If concrete class, fill up the pool with a slab of pre-allocated memory blocks the size of the type. The pool defaults to the set block allocation size if fillAmount is 0
+		if (IsConcrete()) { m_Pool.Reserve(fillAmount); }
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -299,20 +289,7 @@ namespace RTE {
 
 	void * Entity::ClassInfo::GetPoolMemory() {
 		RTEAssert(IsConcrete(), "Trying to get pool memory of an abstract Entity class!");
-
-		// If the pool is empty, then fill it up again with as many instances as we are set to
-		if (m_AllocatedPool.empty()) { FillPool((m_PoolAllocBlockCount > 0) ? m_PoolAllocBlockCount : 10); }
-
-		// Get the instance in the top of the pool and pop it off
-		void *foundMemory = m_AllocatedPool.back();
-		m_AllocatedPool.pop_back();
-
-		RTEAssert(foundMemory, "Could not find an available instance in the pool, even after increasing its size!");
-
-		// Keep track of the number of instances passed out
-		m_InstancesInUse++;
-
-		return foundMemory;
+		return m_Pool.Allocate();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -321,19 +298,20 @@ namespace RTE {
 		if (!returnedMemory) {
 			return 0;
 		}
-		m_AllocatedPool.push_back(returnedMemory);
-
-		// Keep track of the number of instances passed in
-		m_InstancesInUse--;
-
-		return m_InstancesInUse;
+		return m_Pool.Deallocate(returnedMemory);
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void Entity::ClassInfo::DumpPoolMemoryInfo(const Writer &fileWriter) {
 		for (const ClassInfo *itr = s_ClassHead; itr != nullptr; itr = itr->m_NextClass) {
-			if (itr->IsConcrete()) { fileWriter.NewLineString(itr->GetName() + ": " + std::to_string(itr->m_InstancesInUse), false); }
+			if (itr->IsConcrete()) {
+				SlabAllocator::Statistics poolStatistics = itr->m_Pool.GetStatistics();
+				std::string poolInfo = itr->GetName() + ": " + std::to_string(poolStatistics.SlotsInUse) + " in use, " + std::to_string(poolStatistics.PeakSlotsInUse) + " peak";
+				poolInfo += " - " + std::to_string(poolStatistics.SlabCount) + " slabs of " + std::to_string(poolStatistics.ReservedSlots) + " instances, " + std::to_string(poolStatistics.EmptySlabs) + " empty, " + std::to_string(poolStatistics.PartialSlabs) + " partially used";
+				poolInfo += " - " + std::to_string(poolStatistics.CachedSlots) + " cached by threads, " + std::to_string(static_cast<int>(std::round(poolStatistics.Fragmentation * 100.0F))) + "% fragmented";
+				fileWriter.NewLineString(poolInfo, false);
+			}
 		}
 	}
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include "Serializable.h"
 #include "RTEError.h"
+#include "CopyOnWrite.h"
+#include "SlabAllocator.h"
 
 namespace RTE {
 
@@ -14,10 +16,10 @@ namespace RTE {
 		Entity::ClassInfo TYPE::m_sClass(#TYPE, &PARENT::m_sClass);
 
 	#define ConcreteClassInfo(TYPE, PARENT, BLOCKCOUNT) \
-		Entity::ClassInfo TYPE::m_sClass(#TYPE, &PARENT::m_sClass, TYPE::Allocate, TYPE::Deallocate, TYPE::NewInstance, BLOCKCOUNT);
+		Entity::ClassInfo TYPE::m_sClass(#TYPE, &PARENT::m_sClass, TYPE::Allocate, TYPE::Deallocate, TYPE::NewInstance, sizeof(TYPE), BLOCKCOUNT);
 
 	#define ConcreteSubClassInfo(TYPE, SUPER, PARENT, BLOCKCOUNT) \
-		Entity::ClassInfo SUPER::TYPE::m_sClass(#TYPE, &PARENT::m_sClass, SUPER::TYPE::Allocate, SUPER::TYPE::Deallocate, SUPER::TYPE::NewInstance, BLOCKCOUNT);
+		Entity::ClassInfo SUPER::TYPE::m_sClass(#TYPE, &PARENT::m_sClass, SUPER::TYPE::Allocate, SUPER::TYPE::Deallocate, SUPER::TYPE::NewInstance, sizeof(SUPER::TYPE), BLOCKCOUNT);
 
 	/// <summary>
 	/// Convenience macro to cut down on duplicate ClassInfo methods in classes that extend Entity.
@@ -90,8 +92,9 @@ namespace RTE {
 			/// <param name="allocFunc">Function pointer to the raw allocation function of the derived's size. If the represented Entity subclass isn't concrete, pass in 0.</param>
 			/// <param name="deallocFunc">Function pointer to the raw deallocation function of memory. If the represented Entity subclass isn't concrete, pass in 0.</param>
 			/// <param name="newFunc">Function pointer to the new instance factory. If the represented Entity subclass isn't concrete, pass in 0.</param>
+			/// <param name="instanceSize">The size in bytes of an instance of the represented Entity subclass. If it isn't concrete, pass in 0.</param>
 			/// <param name="allocBlockCount">The number of new instances to fill the pre-allocated pool with when it runs out.</param>
-			ClassInfo(const std::string &name, ClassInfo *parentInfo = 0, MemoryAllocate allocFunc = 0, MemoryDeallocate deallocFunc = 0, Entity * (*newFunc)() = 0, int allocBlockCount = 10);
+			ClassInfo(const std::string &name, ClassInfo *parentInfo = 0, MemoryAllocate allocFunc = 0, MemoryDeallocate deallocFunc = 0, Entity * (*newFunc)() = 0, size_t instanceSize = 0, int allocBlockCount = 10);
 #pragma endregion
 
 #pragma region Getters
@@ -151,20 +154,20 @@ namespace RTE {
 
 #pragma region Memory Management
 			/// <summary>
-			/// Grabs from the pre-allocated pool, an available chunk of memory the exact size of the Entity this ClassInfo represents. OWNERSHIP IS TRANSFERRED!
+			/// Grabs from the pre-allocated pool, an available chunk of memory the exact size of the Entity this ClassInfo represents. Can be called from any thread. OWNERSHIP IS TRANSFERRED!
 			/// </summary>
 			/// <returns>A pointer to the pre-allocated pool memory. OWNERSHIP IS TRANSFERRED!</returns>
 			void * GetPoolMemory();
 
 			/// <summary>
-			/// Returns a raw chunk of memory back to the pre-allocated available pool.
+			/// Returns a raw chunk of memory back to the pre-allocated available pool. Can be called from any thread, not just the one that grabbed it.
 			/// </summary>
-			/// <param name="returnedMemory">The raw chunk of memory that is being returned. Needs to be the same size as the type this ClassInfo describes. OWNERSHIP IS TRANSFERRED!</param>
+			/// <param name="returnedMemory">The raw chunk of memory that is being returned. Needs to have been grabbed from this ClassInfo's pool. OWNERSHIP IS TRANSFERRED!</param>
 			/// <returns>The count of outstanding memory chunks after this was returned.</returns>
 			int ReturnPoolMemory(void *returnedMemory);
 
 			/// <summary>
-			/// Writes a bunch of useful debug info about the memory pools to a file.
+			/// Writes a bunch of useful debug info about the memory pools to a file. For each concrete class that's the instances in use and the most ever in use at once, and how many slabs its pool reserved and how fragmented they are.
 			/// </summary>
 			/// <param name="fileWriter">The writer to write info to.</param>
 			static void DumpPoolMemoryInfo(const Writer &fileWriter);
@@ -210,9 +213,7 @@ namespace RTE {
 
 			ClassInfo *m_NextClass; //!< Next ClassInfo after this one on aforementioned unordered linked list.
 
-			std::vector<void *> m_AllocatedPool; //!< Pool of pre-allocated objects of the type described by this ClassInfo.
-			int m_PoolAllocBlockCount; //!< The number of instances to fill up the pool of this type with each time it runs dry.
-			int m_InstancesInUse; //!< The number of allocated instances passed out from the pool.
+			SlabAllocator m_Pool; //!< Pool of pre-allocated objects of the type described by this ClassInfo, which reserves as many as its allocation block count at a time each time it runs dry.
 
 
 			// Forbidding copying
@@ -317,13 +318,13 @@ namespace RTE {
 		/// Gets the plain text description of this Entity's data Preset.
 		/// </summary>
 		/// <returns>A string reference with the plain text description name of this Preset.</returns>
-		const std::string & GetDescription() const { return m_PresetDescription; }
+		const std::string & GetDescription() const { return m_PresetDescription.Get(); }
 
 		/// <summary>
 		/// Sets the plain text description of this Entity's data Preset. Shouldn't be more than a couple of sentences.
 		/// </summary>
 		/// <param name="newDesc">A string reference with the preset description.</param>
-		void SetDescription(const std::string &newDesc) { m_PresetDescription = newDesc; }
+		void SetDescription(const std::string &newDesc) { m_PresetDescription.Set(newDesc); }
 
 		/// <summary>
 		/// Gets the name of this Entity's data Preset, preceded by the name of the Data Module it was defined in, separated with a '/'.
@@ -363,7 +364,7 @@ namespace RTE {
 		/// Gets the list of groups this is member of.
 		/// </summary>
 		/// <returns>A pointer to a list of strings which describes the groups this is added to. Ownership is NOT transferred!</returns>
-		const std::list<std::string> * GetGroupList() { return &m_Groups; }
+		const std::list<std::string> * GetGroupList() { return &m_Groups.Get(); }
 
 		/// <summary>
 		/// Shows whether this is part of a specific group or not.
@@ -376,13 +377,13 @@ namespace RTE {
 		/// Adds this Entity to a new grouping.
 		/// </summary>
 		/// <param name="newGroup">A string which describes the group to add this to. Duplicates will be ignored.</param>
-		void AddToGroup(const std::string &newGroup) { m_Groups.push_back(newGroup); m_Groups.sort(); m_Groups.unique(); m_LastGroupSearch.clear(); }
+		void AddToGroup(const std::string &newGroup) { std::list<std::string> &groups = m_Groups.GetMutable(); groups.push_back(newGroup); groups.sort(); groups.unique(); m_LastGroupSearch.clear(); }
 
 		/// <summary>
 		/// Removes this Entity from the specified grouping.
 		/// </summary>
 		/// <param name="groupToRemoveFrom">A string which describes the group to remove this from.</param>
-		void RemoveFromGroup(const std::string &groupToRemoveFrom) { m_Groups.remove(groupToRemoveFrom); m_LastGroupSearch.clear(); }
+		void RemoveFromGroup(const std::string &groupToRemoveFrom) { m_Groups.GetMutable().remove(groupToRemoveFrom); m_LastGroupSearch.clear(); }
 
 		/// <summary>
 		/// Returns random weight used in PresetMan::GetRandomBuyableOfGroupFromTech.
@@ -445,13 +446,13 @@ namespace RTE {
 		static Entity::ClassInfo m_sClass; //!< Type description of this Entity.
 
 		std::string m_PresetName; //!< The name of the Preset data this was cloned from, if any.
-		std::string m_PresetDescription; //!< The description of the preset in user friendly plain text that will show up in menus etc.
+		CopyOnWrite<std::string> m_PresetDescription; //!< The description of the preset in user friendly plain text that will show up in menus etc. Shared with all the copies of the preset that don't change it.
 
 		bool m_IsOriginalPreset; //!< Whether this is to be added to the PresetMan as an original preset instance.
 		int m_DefinedInModule; //!< The DataModule ID that this was successfully added to at some point. -1 if not added to anything yet.
 
 		//TODO Consider replacing this with an unordered_set. See https://github.com/cortex-command-community/Cortex-Command-Community-Project-Source/issues/88
-		std::list<std::string> m_Groups; //!< List of all tags associated with this. The groups are used to categorize and organize Entities.
+		CopyOnWrite<std::list<std::string>> m_Groups; //!< List of all tags associated with this. The groups are used to categorize and organize Entities. Shared with all the copies of the preset that don't change it.
 		std::string m_LastGroupSearch; //!< Last group search string, for more efficient response on multiple tries for the same group name.
 		bool m_LastGroupResult; //!< Last group search result, for more efficient response on multiple tries for the same group name.
 
@@ -0,0 +1,229 @@
+#include "FieldOfView.h"
+#include "SceneMan.h"
+#include "Scene.h"
+#include "SLTerrain.h"
+#include "Material.h"
+
+namespace RTE {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void FieldOfView::Clear() {
+		m_Team = Activity::NoTeam;
+		m_UnseenLayer = nullptr;
+		m_UnseenRevision = 0;
+		m_Terrain = nullptr;
+		m_TerrainRevision = 0;
+		m_EyeCellX = 0;
+		m_EyeCellY = 0;
+		m_RangeCells = 0;
+		m_StrengthLimit = 0;
+		m_CellSize.Reset();
+		m_ColumnCount = 0;
+		m_RowCount = 0;
+		m_WrapsX = false;
+		m_WrapsY = false;
+		m_SamplesPerCell = 0;
+		m_LineStrengths.clear();
+		m_LineStrengthScans.clear();
+		m_LineStrengthScan = 0;
+		m_UnseenCells.clear();
+		m_HasNewCells = false;
+		m_LastLookDirection.Reset();
+		m_LastHalfAngle = 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool FieldOfView::Look(int team, const Vector &eyePos, float range, const Vector &lookDirection, float halfAngle, int strengthLimit) {
+		Scene *scene = g_SceneMan.GetScene();
+		SceneLayer *unseenLayer = scene ? scene->GetUnseenLayer(team) : nullptr;
+		if (!unseenLayer || !unseenLayer->GetBitmap() || !(unseenLayer->GetScaleFactor().GetSmallest() > 0)) {
+			return false;
+		}
+		SLTerrain *terrain = scene->GetTerrain();
+		Vector cellSize = unseenLayer->GetScaleFactor();
+		range = std::max(range, 0.0F);
+
+		Vector wrappedEyePos = eyePos;
+		g_SceneMan.WrapPosition(wrappedEyePos);
+		int eyeCellX = static_cast<int>(std::floor(wrappedEyePos.GetX() / cellSize.GetX()));
+		int eyeCellY = static_cast<int>(std::floor(wrappedEyePos.GetY() / cellSize.GetY()));
+		int rangeCells = static_cast<int>(range / cellSize.GetSmallest());
+		unsigned long unseenRevision = g_SceneMan.GetUnseenRevision(team);
+
+		bool viewChanged = team != m_Team || unseenLayer != m_UnseenLayer || unseenRevision != m_UnseenRevision || terrain != m_Terrain || eyeCellX != m_EyeCellX || eyeCellY != m_EyeCellY || rangeCells != m_RangeCells || strengthLimit != m_StrengthLimit;
+		if (!viewChanged && terrain->GetMaterialRevision() != m_TerrainRevision) {
+			// Only terrain changes within range of the eyes' cell can change what's in view from it.
+			int reach = static_cast<int>(std::ceil((static_cast<float>(rangeCells) + 1.0F) * cellSize.GetLargest()));
+			int eyeCellCenterX = static_cast<int>((static_cast<float>(eyeCellX) + 0.5F) * cellSize.GetX());
+			int eyeCellCenterY = static_cast<int>((static_cast<float>(eyeCellY) + 0.5F) * cellSize.GetY());
+			viewChanged = terrain->MaterialChangedSince(eyeCellCenterX - reach, eyeCellCenterY - reach, reach * 2 + 1, reach * 2 + 1, m_TerrainRevision);
+			if (!viewChanged) { m_TerrainRevision = terrain->GetMaterialRevision(); }
+		}
+		if (viewChanged) {
+			m_Team = team;
+			m_UnseenLayer = unseenLayer;
+			m_UnseenRevision = unseenRevision;
+			m_Terrain = terrain;
+			m_TerrainRevision = terrain->GetMaterialRevision();
+			m_EyeCellX = eyeCellX;
+			m_EyeCellY = eyeCellY;
+			m_RangeCells = rangeCells;
+			m_StrengthLimit = strengthLimit;
+			m_CellSize = cellSize;
+			m_ColumnCount = unseenLayer->GetBitmap()->w;
+			m_RowCount = unseenLayer->GetBitmap()->h;
+			m_WrapsX = g_SceneMan.SceneWrapsX();
+			m_WrapsY = g_SceneMan.SceneWrapsY();
+			FindUnseenCells(range);
+		}
+		if (m_UnseenCells.empty()) {
+			return false;
+		}
+
+		bool allDirections = halfAngle >= 180.0F || lookDirection.IsZero();
+		Vector direction = allDirections ? Vector() : lookDirection.GetNormalized();
+		halfAngle = allDirections ? 180.0F : std::max(halfAngle, 0.0F);
+
+		// Unless the view was found anew or the arc has turned, everything in view within the arc has already been revealed.
+		bool sameArc = halfAngle == m_LastHalfAngle && (allDirections ? m_LastLookDirection.IsZero() : (!m_LastLookDirection.IsZero() && direction.Dot(m_LastLookDirection) > c_LookDirectionTolerance));
+		if (!m_HasNewCells && sameArc) {
+			return false;
+		}
+		m_HasNewCells = false;
+		m_LastLookDirection = direction;
+		m_LastHalfAngle = halfAngle;
+
+		float minDot = std::cos(halfAngle * c_PI / 180.0F);
+		bool revealedAny = false;
+		for (size_t cellIndex = 0; cellIndex < m_UnseenCells.size();) {
+			const UnseenCell &cell = m_UnseenCells[cellIndex];
+			Vector offset(static_cast<float>(cell.OffsetX) * m_CellSize.GetX(), static_cast<float>(cell.OffsetY) * m_CellSize.GetY());
+			if (allDirections || offset.IsZero() || direction.Dot(offset) >= minDot * offset.GetMagnitude()) {
+				int cellCenterX = static_cast<int>((static_cast<float>(cell.X) + 0.5F) * m_CellSize.GetX());
+				int cellCenterY = static_cast<int>((static_cast<float>(cell.Y) + 0.5F) * m_CellSize.GetY());
+				revealedAny = g_SceneMan.RevealUnseen(cellCenterX, cellCenterY, m_Team) || revealedAny;
+				// Once revealed a cell stays that way until something hides it again, which makes the view get found anew anyway.
+				m_UnseenCells[cellIndex] = m_UnseenCells.back();
+				m_UnseenCells.pop_back();
+			} else {
+				++cellIndex;
+			}
+		}
+		return revealedAny;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void FieldOfView::FindUnseenCells(float range) {
+		// The eight octants around the eyes' cell, as the multipliers that turn octant coordinates into cell offsets.
+		static constexpr int octants[8][4] = { { 1, 0, 0, 1 }, { 0, 1, 1, 0 }, { 0, -1, 1, 0 }, { -1, 0, 0, 1 }, { -1, 0, 0, -1 }, { 0, -1, -1, 0 }, { 0, 1, -1, 0 }, { 1, 0, 0, -1 } };
+
+		m_UnseenCells.clear();
+		m_HasNewCells = true;
+
+		int eyeCellX = m_EyeCellX;
+		int eyeCellY = m_EyeCellY;
+		if (WrapCell(eyeCellX, eyeCellY) && _getpixel(m_UnseenLayer->GetBitmap(), eyeCellX, eyeCellY) != g_MaskColor) { m_UnseenCells.push_back({ eyeCellX, eyeCellY, 0, 0 }); }
+
+		if (m_RangeCells > 0) {
+			// Same as the see rays actors used to cast, which sampled the terrain every half a cell plus a pixel.
+			m_SamplesPerCell = m_CellSize.GetSmallest() / std::floor(m_CellSize.GetSmallest() * 0.5F + 1.0F);
+			size_t lineStrengthCount = static_cast<size_t>(m_RangeCells + 1) * static_cast<size_t>(m_RangeCells + 2) / 2;
+			if (m_LineStrengths.size() < lineStrengthCount) {
+				m_LineStrengths.resize(lineStrengthCount);
+				m_LineStrengthScans.resize(lineStrengthCount, 0);
+			}
+			for (const int (&octant)[4] : octants) {
+				m_LineStrengthScan++;
+				m_LineStrengths[0] = 0;
+				m_LineStrengthScans[0] = m_LineStrengthScan;
+				ScanOctant(1, 1.0F, 0.0F, octant, range * range);
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void FieldOfView::ScanOctant(int row, float startSlope, float endSlope, const int (&octant)[4], float rangeSqr) {
+		if (startSlope < endSlope) {
+			return;
+		}
+		BITMAP *unseenBitmap = m_UnseenLayer->GetBitmap();
+		float nextStartSlope = startSlope;
+
+		for (int distance = row; distance <= m_RangeCells; ++distance) {
+			bool blocked = false;
+			int deltaY = -distance;
+			for (int deltaX = -distance; deltaX <= 0; ++deltaX) {
+				// The slopes of the corners of the cell that are furthest apart as seen from the eyes' cell.
+				float leftSlope = (static_cast<float>(deltaX) - 0.5F) / (static_cast<float>(deltaY) + 0.5F);
+				float rightSlope = (static_cast<float>(deltaX) + 0.5F) / (static_cast<float>(deltaY) - 0.5F);
+				if (startSlope < rightSlope) {
+					continue;
+				} else if (endSlope > leftSlope) {
+					break;
+				}
+				int offsetX = deltaX * octant[0] + deltaY * octant[1];
+				int offsetY = deltaX * octant[2] + deltaY * octant[3];
+				int cellX = m_EyeCellX + offsetX;
+				int cellY = m_EyeCellY + offsetY;
+
+				// The strength along the line to this cell is what it was up to the cell the line came through in the row before, which is blocked if that cell wasn't scanned.
+				int previousDeltaX = static_cast<int>(std::lround(static_cast<float>(deltaX * (distance - 1)) / static_cast<float>(distance)));
+				size_t previousIndex = static_cast<size_t>((distance - 1) * distance / 2 + previousDeltaX + distance - 1);
+				float lineStrength = (m_LineStrengthScans[previousIndex] == m_LineStrengthScan) ? m_LineStrengths[previousIndex] : static_cast<float>(m_StrengthLimit);
+
+				// Cells off the unseen layer are off the terrain too, which is all air.
+				if (WrapCell(cellX, cellY)) {
+					float offsetPixelsX = static_cast<float>(offsetX) * m_CellSize.GetX();
+					float offsetPixelsY = static_cast<float>(offsetY) * m_CellSize.GetY();
+					if (offsetPixelsX * offsetPixelsX + offsetPixelsY * offsetPixelsY <= rangeSqr && _getpixel(unseenBitmap, cellX, cellY) != g_MaskColor) { m_UnseenCells.push_back({ cellX, cellY, offsetX, offsetY }); }
+
+					int cellCenterX = static_cast<int>((static_cast<float>(cellX) + 0.5F) * m_CellSize.GetX());
+					int cellCenterY = static_cast<int>((static_cast<float>(cellY) + 0.5F) * m_CellSize.GetY());
+					float lineSlope = static_cast<float>(deltaX) / static_cast<float>(distance);
+					lineStrength += g_SceneMan.GetMaterialFromID(g_SceneMan.GetTerrMatter(cellCenterX, cellCenterY))->GetIntegrity() * m_SamplesPerCell * std::sqrt(1.0F + lineSlope * lineSlope);
+				}
+				size_t index = static_cast<size_t>(distance * (distance + 1) / 2 + deltaX + distance);
+				m_LineStrengths[index] = lineStrength;
+				m_LineStrengthScans[index] = m_LineStrengthScan;
+				bool opaque = lineStrength >= static_cast<float>(m_StrengthLimit);
+
+				if (blocked) {
+					if (opaque) {
+						nextStartSlope = rightSlope;
+						continue;
+					}
+					blocked = false;
+					startSlope = nextStartSlope;
+				} else if (opaque && distance < m_RangeCells) {
+					// The view splits around the blocking cell. Scan the part before it in the rows further out, then carry on with the part after it.
+					blocked = true;
+					ScanOctant(distance + 1, startSlope, leftSlope, octant, rangeSqr);
+					nextStartSlope = rightSlope;
+				}
+			}
+			if (blocked) {
+				break;
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool FieldOfView::WrapCell(int &cellX, int &cellY) const {
+		if (m_WrapsX) {
+			cellX = ((cellX % m_ColumnCount) + m_ColumnCount) % m_ColumnCount;
+		} else if (cellX < 0 || cellX >= m_ColumnCount) {
+			return false;
+		}
+		if (m_WrapsY) {
+			cellY = ((cellY % m_RowCount) + m_RowCount) % m_RowCount;
+		} else if (cellY < 0 || cellY >= m_RowCount) {
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,120 @@
+#ifndef _RTEFIELDOFVIEW_
+#define _RTEFIELDOFVIEW_
+
+#include "Vector.h"
+
+namespace RTE {
+
+	class SceneLayer;
+	class SLTerrain;
+
+	/// <summary>
+	/// What a pair of eyes can see of a team's unseen layer, found by recursive shadowcasting over the cells of the layer, and revealed whole instead of a random ray at a time.
+	/// The cells in view are kept until the eyes move to another cell, the range changes by a cell, the terrain within range changes or anything on the unseen layer gets hidden again, so looking from the same place again costs next to nothing.
+	/// Cells in view that are still unseen are revealed as soon as they're within the looked at arc, and forgotten once revealed.
+	/// </summary>
+	class FieldOfView {
+
+	public:
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a FieldOfView object in system memory.
+		/// </summary>
+		FieldOfView() { Clear(); }
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Forgets everything that's been found to be in view, so it's all found anew on the next look.
+		/// </summary>
+		void Reset() { Clear(); }
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Reveals everything unseen in view of a position on the unseen layer of a team, within an arc around a direction.
+		/// Cells are in view if a line from the center of the eyes' cell can reach them before the material strengths it passes through add up to the strength limit. The cells where they do are in view themselves.
+		/// Each cell a line crosses adds its strength once for every time the old see rays would have sampled the terrain in it, which was every half a cell.
+		/// </summary>
+		/// <param name="team">The team whose unseen layer to reveal.</param>
+		/// <param name="eyePos">The position of the eyes, in Scene coordinates.</param>
+		/// <param name="range">How far the eyes can see, in pixels.</param>
+		/// <param name="lookDirection">The direction the eyes are looking in. A zero vector means all directions.</param>
+		/// <param name="halfAngle">How far to either side of the looking direction the eyes can see, in degrees. 180 or more means all directions.</param>
+		/// <param name="strengthLimit">The material strength that blocks the view.</param>
+		/// <returns>Whether anything was revealed.</returns>
+		bool Look(int team, const Vector &eyePos, float range, const Vector &lookDirection, float halfAngle, int strengthLimit);
+#pragma endregion
+
+	private:
+
+		static constexpr float c_LookDirectionTolerance = 0.9998F; //!< The cosine of the angle, about a degree, the looking direction has to turn by before the cells in view are checked against the arc again.
+
+		/// <summary>
+		/// A cell in view that was still unseen when the view was last found.
+		/// </summary>
+		struct UnseenCell {
+			int X; //!< The X position of the cell on the unseen layer.
+			int Y; //!< The Y position of the cell on the unseen layer.
+			int OffsetX; //!< The X offset of the cell from the eyes' cell, in cells.
+			int OffsetY; //!< The Y offset of the cell from the eyes' cell, in cells.
+		};
+
+		int m_Team; //!< The team whose unseen layer the view was found on.
+		const SceneLayer *m_UnseenLayer; //!< The unseen layer the view was found on.
+		unsigned long m_UnseenRevision; //!< The unseen revision of the team when the view was found.
+		const SLTerrain *m_Terrain; //!< The terrain the view was found through.
+		unsigned long m_TerrainRevision; //!< The material revision of the terrain the view is known to still be good for.
+		int m_EyeCellX; //!< The X position of the eyes' cell on the unseen layer.
+		int m_EyeCellY; //!< The Y position of the eyes' cell on the unseen layer.
+		int m_RangeCells; //!< The range of the view, in whole smallest cell sizes.
+		int m_StrengthLimit; //!< The accumulated material strength that blocked the view.
+
+		Vector m_CellSize; //!< The size of the cells of the unseen layer, in pixels.
+		int m_ColumnCount; //!< The number of cell columns of the unseen layer.
+		int m_RowCount; //!< The number of cell rows of the unseen layer.
+		bool m_WrapsX; //!< Whether the Scene wraps horizontally.
+		bool m_WrapsY; //!< Whether the Scene wraps vertically.
+		float m_SamplesPerCell; //!< How many times the terrain is sampled for each cell a line crosses straight on, for adding up the material strengths along it.
+
+		std::vector<float> m_LineStrengths; //!< The material strength added up along the line from the eyes' cell to each cell of the octant being scanned, by row and then column. Only used while finding the view.
+		std::vector<unsigned int> m_LineStrengthScans; //!< Which octant scan each of the added up strengths is from, so the ones left over from earlier scans can be told apart without clearing them.
+		unsigned int m_LineStrengthScan; //!< The number of the octant scan being done.
+
+		std::vector<UnseenCell> m_UnseenCells; //!< The cells in view that haven't been revealed yet.
+		bool m_HasNewCells; //!< Whether the view was found anew since the cells in view were last checked against the looked at arc.
+		Vector m_LastLookDirection; //!< The normalized looking direction when the cells in view were last checked against the arc, or a zero vector for all directions.
+		float m_LastHalfAngle; //!< The half angle of the arc when the cells in view were last checked against it.
+
+		/// <summary>
+		/// Finds all the unseen cells in view of the eyes' cell anew.
+		/// </summary>
+		/// <param name="range">How far the eyes can see, in pixels.</param>
+		void FindUnseenCells(float range);
+
+		/// <summary>
+		/// Scans one octant around the eyes' cell row by row outwards, between two slopes, recursing for the parts of each row that are split off by blocking cells.
+		/// </summary>
+		/// <param name="row">The row to start scanning at, counted outwards from the eyes' cell.</param>
+		/// <param name="startSlope">The slope of the side of the octant to start each row at.</param>
+		/// <param name="endSlope">The slope of the side of the octant to end each row at.</param>
+		/// <param name="octant">The transform from octant coordinates to cell offsets, as the multipliers for x to x, y to x, x to y, and y to y.</param>
+		/// <param name="rangeSqr">The squared range of the view, in pixels.</param>
+		void ScanOctant(int row, float startSlope, float endSlope, const int (&octant)[4], float rangeSqr);
+
+		/// <summary>
+		/// Wraps a cell position onto the unseen layer.
+		/// </summary>
+		/// <param name="cellX">The X position of the cell. Gets wrapped if the Scene wraps horizontally.</param>
+		/// <param name="cellY">The Y position of the cell. Gets wrapped if the Scene wraps vertically.</param>
+		/// <returns>Whether the cell is on the unseen layer.</returns>
+		bool WrapCell(int &cellX, int &cellY) const;
+
+		/// <summary>
+		/// Clears all the member variables of this FieldOfView, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+	};
+}
+#endif
@@ -0,0 +1,110 @@
+#ifndef _RTEFLOATLANES_
+#define _RTEFLOATLANES_
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RTE_SSE2_FLOAT_LANES
+#endif
+
+namespace RTE {
+
+	/// <summary>
+	/// A single float with the same interface as the SIMD lane types, so kernels written against that interface can run on any of them.
+	/// Serves as the fallback where no SIMD instruction set is available, and for whatever is left over at the end of arrays after the wider lane types are done.
+	/// All operations round exactly like the same scalar operations on plain floats do.
+	/// </summary>
+	struct ScalarFloatLanes {
+		using Mask = bool;
+		static constexpr int c_Count = 1; //!< The number of floats processed at a time.
+		static constexpr const char *c_Name = "Scalar"; //!< The name of the instruction set used.
+
+		float Values; //!< The lane value.
+
+		static ScalarFloatLanes Load(const float *source) { return { *source }; }
+		static ScalarFloatLanes Broadcast(float value) { return { value }; }
+		void Store(float *destination) const { *destination = Values; }
+
+		static ScalarFloatLanes Abs(ScalarFloatLanes lanes) { return { std::abs(lanes.Values) }; }
+		static ScalarFloatLanes Max(ScalarFloatLanes lhs, ScalarFloatLanes rhs) { return { std::max(lhs.Values, rhs.Values) }; }
+		static ScalarFloatLanes Select(Mask mask, ScalarFloatLanes ifTrue, ScalarFloatLanes ifFalse) { return mask ? ifTrue : ifFalse; }
+		static Mask And(Mask lhs, Mask rhs) { return lhs && rhs; }
+		static Mask Or(Mask lhs, Mask rhs) { return lhs || rhs; }
+		static int GetMaskBits(Mask mask) { return mask ? 1 : 0; }
+
+		friend ScalarFloatLanes operator+(ScalarFloatLanes lhs, ScalarFloatLanes rhs) { return { lhs.Values + rhs.Values }; }
+		friend ScalarFloatLanes operator-(ScalarFloatLanes lhs, ScalarFloatLanes rhs) { return { lhs.Values - rhs.Values }; }
+		friend ScalarFloatLanes operator*(ScalarFloatLanes lhs, ScalarFloatLanes rhs) { return { lhs.Values * rhs.Values }; }
+		friend Mask operator>(ScalarFloatLanes lhs, ScalarFloatLanes rhs) { return lhs.Values > rhs.Values; }
+		friend Mask operator>=(ScalarFloatLanes lhs, ScalarFloatLanes rhs) { return lhs.Values >= rhs.Values; }
+	};
+
+#if defined(__AVX__)
+	/// <summary>
+	/// Eight floats processed at a time with AVX instructions. Only available when the build targets AVX, which the avx build option does.
+	/// </summary>
+	struct AVXFloatLanes {
+		using Mask = __m256;
+		static constexpr int c_Count = 8; //!< The number of floats processed at a time.
+		static constexpr const char *c_Name = "AVX"; //!< The name of the instruction set used.
+
+		__m256 Values; //!< The lane values.
+
+		static AVXFloatLanes Load(const float *source) { return { _mm256_loadu_ps(source) }; }
+		static AVXFloatLanes Broadcast(float value) { return { _mm256_set1_ps(value) }; }
+		void Store(float *destination) const { _mm256_storeu_ps(destination, Values); }
+
+		static AVXFloatLanes Abs(AVXFloatLanes lanes) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0F), lanes.Values) }; }
+		static AVXFloatLanes Max(AVXFloatLanes lhs, AVXFloatLanes rhs) { return { _mm256_max_ps(lhs.Values, rhs.Values) }; }
+		static AVXFloatLanes Select(Mask mask, AVXFloatLanes ifTrue, AVXFloatLanes ifFalse) { return { _mm256_blendv_ps(ifFalse.Values, ifTrue.Values, mask) }; }
+		static Mask And(Mask lhs, Mask rhs) { return _mm256_and_ps(lhs, rhs); }
+		static Mask Or(Mask lhs, Mask rhs) { return _mm256_or_ps(lhs, rhs); }
+		static int GetMaskBits(Mask mask) { return _mm256_movemask_ps(mask); }
+
+		friend AVXFloatLanes operator+(AVXFloatLanes lhs, AVXFloatLanes rhs) { return { _mm256_add_ps(lhs.Values, rhs.Values) }; }
+		friend AVXFloatLanes operator-(AVXFloatLanes lhs, AVXFloatLanes rhs) { return { _mm256_sub_ps(lhs.Values, rhs.Values) }; }
+		friend AVXFloatLanes operator*(AVXFloatLanes lhs, AVXFloatLanes rhs) { return { _mm256_mul_ps(lhs.Values, rhs.Values) }; }
+		friend Mask operator>(AVXFloatLanes lhs, AVXFloatLanes rhs) { return _mm256_cmp_ps(lhs.Values, rhs.Values, _CMP_GT_OQ); }
+		friend Mask operator>=(AVXFloatLanes lhs, AVXFloatLanes rhs) { return _mm256_cmp_ps(lhs.Values, rhs.Values, _CMP_GE_OQ); }
+	};
+
+	using SIMDFloatLanes = AVXFloatLanes;
+#elif defined(RTE_SSE2_FLOAT_LANES)
+	/// <summary>
+	/// Four floats processed at a time with SSE2 instructions, which every x86-64 CPU has.
+	/// </summary>
+	struct SSE2FloatLanes {
+		using Mask = __m128;
+		static constexpr int c_Count = 4; //!< The number of floats processed at a time.
+		static constexpr const char *c_Name = "SSE2"; //!< The name of the instruction set used.
+
+		__m128 Values; //!< The lane values.
+
+		static SSE2FloatLanes Load(const float *source) { return { _mm_loadu_ps(source) }; }
+		static SSE2FloatLanes Broadcast(float value) { return { _mm_set1_ps(value) }; }
+		void Store(float *destination) const { _mm_storeu_ps(destination, Values); }
+
+		static SSE2FloatLanes Abs(SSE2FloatLanes lanes) { return { _mm_andnot_ps(_mm_set1_ps(-0.0F), lanes.Values) }; }
+		static SSE2FloatLanes Max(SSE2FloatLanes lhs, SSE2FloatLanes rhs) { return { _mm_max_ps(lhs.Values, rhs.Values) }; }
+		static SSE2FloatLanes Select(Mask mask, SSE2FloatLanes ifTrue, SSE2FloatLanes ifFalse) { return { _mm_or_ps(_mm_and_ps(mask, ifTrue.Values), _mm_andnot_ps(mask, ifFalse.Values)) }; }
+		static Mask And(Mask lhs, Mask rhs) { return _mm_and_ps(lhs, rhs); }
+		static Mask Or(Mask lhs, Mask rhs) { return _mm_or_ps(lhs, rhs); }
+		static int GetMaskBits(Mask mask) { return _mm_movemask_ps(mask); }
+
+		friend SSE2FloatLanes operator+(SSE2FloatLanes lhs, SSE2FloatLanes rhs) { return { _mm_add_ps(lhs.Values, rhs.Values) }; }
+		friend SSE2FloatLanes operator-(SSE2FloatLanes lhs, SSE2FloatLanes rhs) { return { _mm_sub_ps(lhs.Values, rhs.Values) }; }
+		friend SSE2FloatLanes operator*(SSE2FloatLanes lhs, SSE2FloatLanes rhs) { return { _mm_mul_ps(lhs.Values, rhs.Values) }; }
+		friend Mask operator>(SSE2FloatLanes lhs, SSE2FloatLanes rhs) { return _mm_cmpgt_ps(lhs.Values, rhs.Values); }
+		friend Mask operator>=(SSE2FloatLanes lhs, SSE2FloatLanes rhs) { return _mm_cmpge_ps(lhs.Values, rhs.Values); }
+	};
+
+	using SIMDFloatLanes = SSE2FloatLanes;
+#else
+	using SIMDFloatLanes = ScalarFloatLanes;
+#endif
+}
+#endif
@@ -0,0 +1,79 @@
+#ifndef _RTEFRAMEALLOCATOR_
+#define _RTEFRAMEALLOCATOR_
+
+#include "ThreadMan.h"
+
+namespace RTE {
+
+	/// <summary>
+	/// STL allocator that allocates from the ThreadMan's frame arena, so containers of per-frame temporaries cost a pointer bump to fill instead of a trip to the heap.
+	/// Deallocating does nothing, the memory is reclaimed all at once when the frame arena it came from is reset two sim updates later.
+	/// Anything allocated with this must therefore be gone by the end of the sim update after the one it was allocated in. Only usable from the main thread.
+	/// Containers using this are only meant for locals and return values that don't outlive the sim update they're made in. Some standard libraries allocate a container's sentinel node with its allocator on construction,
+	/// so a container kept around as a member would end up pointing into a reset arena even if it's emptied or refilled every update. Allocating through a FrameAllocator made in an earlier sim update asserts to catch that.
+	/// </summary>
+	template <typename Type>
+	class FrameAllocator {
+
+	public:
+
+		using value_type = Type;
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a FrameAllocator object for the current sim update.
+		/// </summary>
+		FrameAllocator() : m_ArenaGeneration(g_ThreadMan.GetFrameArenaGeneration()) {}
+
+		/// <summary>
+		/// Constructor method used to instantiate a FrameAllocator object from one for another type, as containers do for their internal nodes.
+		/// </summary>
+		/// <param name="reference">The FrameAllocator to rebind from.</param>
+		template <typename OtherType> FrameAllocator(const FrameAllocator<OtherType> &reference) : m_ArenaGeneration(reference.m_ArenaGeneration) {}
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Allocates uninitialized memory for a number of objects from the current frame arena.
+		/// </summary>
+		/// <param name="count">The number of objects to allocate memory for.</param>
+		/// <returns>A pointer to the allocated memory.</returns>
+		Type * allocate(size_t count) {
+			RTEAssert(m_ArenaGeneration == g_ThreadMan.GetFrameArenaGeneration(), "Allocating from the frame arena with a container made in an earlier sim update! Frame allocated containers can only be kept as locals.");
+			return static_cast<Type *>(g_ThreadMan.GetFrameArena().Allocate(sizeof(Type) * count, alignof(Type)));
+		}
+
+		/// <summary>
+		/// Does nothing, as frame arena memory is only reclaimed when the whole arena is reset.
+		/// </summary>
+		/// <param name="memory">The memory to deallocate.</param>
+		/// <param name="count">The number of objects the memory was allocated for.</param>
+		void deallocate(Type *memory, size_t count) {}
+#pragma endregion
+
+#pragma region Operator Overloads
+		/// <summary>
+		/// Equality operator for testing if memory allocated by one FrameAllocator can be deallocated by another, which it always can.
+		/// </summary>
+		/// <returns>True.</returns>
+		template <typename OtherType> bool operator==(const FrameAllocator<OtherType> &rhs) const { return true; }
+
+		/// <summary>
+		/// Inequality operator for testing if memory allocated by one FrameAllocator can't be deallocated by another, which it always can.
+		/// </summary>
+		/// <returns>False.</returns>
+		template <typename OtherType> bool operator!=(const FrameAllocator<OtherType> &rhs) const { return false; }
+#pragma endregion
+
+	private:
+
+		template <typename OtherType> friend class FrameAllocator;
+
+		unsigned int m_ArenaGeneration; //!< The frame arena generation this was made in, to catch containers that outlive their sim update.
+	};
+
+	template <typename Type> using FrameVector = std::vector<Type, FrameAllocator<Type>>; //!< Convenient name definition for a vector allocated from the frame arena.
+	template <typename Type> using FrameDeque = std::deque<Type, FrameAllocator<Type>>; //!< Convenient name definition for a deque allocated from the frame arena.
+	template <typename Type> using FrameList = std::list<Type, FrameAllocator<Type>>; //!< Convenient name definition for a list allocated from the frame arena.
+}
+#endif
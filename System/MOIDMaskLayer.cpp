@@ -0,0 +1,233 @@
+#include "MOIDMaskLayer.h"
+
+#include "allegro.h"
+
+namespace RTE {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDMaskLayer::Clear() {
+		m_Width = 0;
+		m_Height = 0;
+		m_ColumnCount = 0;
+		m_RowCount = 0;
+		m_Footprints.clear();
+		m_Cells.clear();
+		m_UsedCells.clear();
+		m_SpriteMasks.clear();
+		m_StaleSpriteMasks.clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDMaskLayer::Create(int width, int height) {
+		m_Footprints.clear();
+		m_UsedCells.clear();
+		m_StaleSpriteMasks.clear();
+		m_Width = std::max(width, 1);
+		m_Height = std::max(height, 1);
+		m_ColumnCount = (m_Width + c_CellSize - 1) / c_CellSize;
+		m_RowCount = (m_Height + c_CellSize - 1) / c_CellSize;
+		m_Cells.clear();
+		m_Cells.resize(static_cast<size_t>(m_ColumnCount * m_RowCount));
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDMaskLayer::Destroy() {
+		Clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDMaskLayer::Reset() {
+		for (int cellIndex : m_UsedCells) {
+			m_Cells[cellIndex].clear();
+		}
+		m_UsedCells.clear();
+		m_Footprints.clear();
+
+		// Nothing refers to any of the masks anymore, so this is where the cache can be trimmed.
+		m_StaleSpriteMasks.clear();
+		if (m_SpriteMasks.size() > c_MaxCachedSpriteMasks) { m_SpriteMasks.clear(); }
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDMaskLayer::AddSprite(BITMAP *sprite, MOID moid, int left, int top) {
+		if (!sprite) {
+			return;
+		}
+		Footprint footprint;
+		footprint.ID = moid;
+		footprint.Left = left;
+		footprint.Top = top;
+		footprint.Right = left + sprite->w - 1;
+		footprint.Bottom = top + sprite->h - 1;
+		footprint.Mask = GetSpriteMask(sprite);
+		footprint.Transformed = false;
+		footprint.HFlipped = false;
+		footprint.OriginX = static_cast<float>(left);
+		footprint.OriginY = static_cast<float>(top);
+		footprint.PivotX = 0;
+		footprint.PivotY = 0;
+		footprint.InverseCos = 1.0F;
+		footprint.InverseSin = 0;
+		AddFootprint(footprint);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDMaskLayer::AddPivotedSprite(BITMAP *sprite, MOID moid, int x, int y, int pivotX, int pivotY, float angle, float scale, bool hFlipped) {
+		if (!sprite || !(scale > 0)) {
+			return;
+		}
+		float radians = angle * c_TwoPI / 256.0F;
+		float cos = std::cos(radians);
+		float sin = std::sin(radians);
+
+		Footprint footprint;
+		footprint.ID = moid;
+		footprint.Mask = GetSpriteMask(sprite);
+		footprint.Transformed = true;
+		footprint.HFlipped = hFlipped;
+		footprint.OriginX = static_cast<float>(x);
+		footprint.OriginY = static_cast<float>(y);
+		footprint.PivotX = static_cast<float>(pivotX);
+		footprint.PivotY = static_cast<float>(pivotY);
+		footprint.InverseCos = cos / scale;
+		footprint.InverseSin = sin / scale;
+
+		// Bound the footprint by where the corners of the drawn bitmap end up, with a pixel of leeway for rounding.
+		float minX = std::numeric_limits<float>::max();
+		float minY = std::numeric_limits<float>::max();
+		float maxX = std::numeric_limits<float>::lowest();
+		float maxY = std::numeric_limits<float>::lowest();
+		for (int corner = 0; corner < 4; ++corner) {
+			float cornerX = static_cast<float>((corner & 1) ? sprite->w : 0) - footprint.PivotX;
+			float cornerY = static_cast<float>((corner & 2) ? sprite->h : 0) - footprint.PivotY;
+			float sceneX = footprint.OriginX + (cornerX * cos - cornerY * sin) * scale;
+			float sceneY = footprint.OriginY + (cornerX * sin + cornerY * cos) * scale;
+			minX = std::min(minX, sceneX);
+			minY = std::min(minY, sceneY);
+			maxX = std::max(maxX, sceneX);
+			maxY = std::max(maxY, sceneY);
+		}
+		footprint.Left = static_cast<int>(std::floor(minX)) - 1;
+		footprint.Top = static_cast<int>(std::floor(minY)) - 1;
+		footprint.Right = static_cast<int>(std::ceil(maxX)) + 1;
+		footprint.Bottom = static_cast<int>(std::ceil(maxY)) + 1;
+		AddFootprint(footprint);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDMaskLayer::AddPixel(MOID moid, int x, int y) {
+		Footprint footprint;
+		footprint.ID = moid;
+		footprint.Left = x;
+		footprint.Top = y;
+		footprint.Right = x;
+		footprint.Bottom = y;
+		footprint.Mask = nullptr;
+		footprint.Transformed = false;
+		footprint.HFlipped = false;
+		footprint.OriginX = static_cast<float>(x);
+		footprint.OriginY = static_cast<float>(y);
+		footprint.PivotX = 0;
+		footprint.PivotY = 0;
+		footprint.InverseCos = 1.0F;
+		footprint.InverseSin = 0;
+		AddFootprint(footprint);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	MOID MOIDMaskLayer::GetMOID(int x, int y) const {
+		if (m_Cells.empty() || x < 0 || y < 0 || x >= m_Width || y >= m_Height) {
+			return g_NoMOID;
+		}
+		const std::vector<int> &cell = m_Cells[static_cast<size_t>((y / c_CellSize) * m_ColumnCount + (x / c_CellSize))];
+		for (auto footprintIndex = cell.rbegin(); footprintIndex != cell.rend(); ++footprintIndex) {
+			const Footprint &footprint = m_Footprints[*footprintIndex];
+			if (x >= footprint.Left && x <= footprint.Right && y >= footprint.Top && y <= footprint.Bottom && Covers(footprint, x, y)) {
+				return footprint.ID;
+			}
+		}
+		return g_NoMOID;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	const MOIDMaskLayer::SpriteMask * MOIDMaskLayer::GetSpriteMask(BITMAP *sprite) {
+		std::unique_ptr<SpriteMask> &spriteMask = m_SpriteMasks[sprite];
+		if (spriteMask && (spriteMask->Width != sprite->w || spriteMask->Height != sprite->h || spriteMask->Pixels != sprite->line[0])) { m_StaleSpriteMasks.emplace_back(std::move(spriteMask)); }
+
+		if (!spriteMask) {
+			spriteMask = std::make_unique<SpriteMask>();
+			spriteMask->Width = sprite->w;
+			spriteMask->Height = sprite->h;
+			spriteMask->Pixels = sprite->line[0];
+			spriteMask->WordsPerRow = (sprite->w + 63) / 64;
+			spriteMask->Bits.resize(static_cast<size_t>(spriteMask->WordsPerRow * sprite->h), 0);
+
+			int maskColor = bitmap_mask_color(sprite);
+			for (int y = 0; y < sprite->h; ++y) {
+				for (int x = 0; x < sprite->w; ++x) {
+					if (getpixel(sprite, x, y) != maskColor) { spriteMask->Bits[static_cast<size_t>(y * spriteMask->WordsPerRow + (x >> 6))] |= uint64_t(1) << (x & 63); }
+				}
+			}
+		}
+		return spriteMask.get();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void MOIDMaskLayer::AddFootprint(const Footprint &footprint) {
+		int left = std::max(footprint.Left, 0);
+		int top = std::max(footprint.Top, 0);
+		int right = std::min(footprint.Right, m_Width - 1);
+		int bottom = std::min(footprint.Bottom, m_Height - 1);
+		if (m_Cells.empty() || left > right || top > bottom) {
+			return;
+		}
+		int footprintIndex = static_cast<int>(m_Footprints.size());
+		m_Footprints.emplace_back(footprint);
+		m_Footprints.back().Left = left;
+		m_Footprints.back().Top = top;
+		m_Footprints.back().Right = right;
+		m_Footprints.back().Bottom = bottom;
+
+		for (int row = top / c_CellSize; row <= bottom / c_CellSize; ++row) {
+			for (int column = left / c_CellSize; column <= right / c_CellSize; ++column) {
+				int cellIndex = row * m_ColumnCount + column;
+				std::vector<int> &cell = m_Cells[cellIndex];
+				if (cell.empty()) { m_UsedCells.emplace_back(cellIndex); }
+				cell.emplace_back(footprintIndex);
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool MOIDMaskLayer::Covers(const Footprint &footprint, int x, int y) {
+		const SpriteMask *mask = footprint.Mask;
+		if (!mask) {
+			return true;
+		}
+		int maskX;
+		int maskY;
+		if (footprint.Transformed) {
+			// Map the center of the pixel back through the rotation and scaling onto the drawn bitmap, the way Allegro samples it.
+			float offsetX = static_cast<float>(x) + 0.5F - footprint.OriginX;
+			float offsetY = static_cast<float>(y) + 0.5F - footprint.OriginY;
+			maskX = static_cast<int>(std::floor(footprint.PivotX + offsetX * footprint.InverseCos + offsetY * footprint.InverseSin));
+			maskY = static_cast<int>(std::floor(footprint.PivotY - offsetX * footprint.InverseSin + offsetY * footprint.InverseCos));
+			if (footprint.HFlipped) { maskX = mask->Width - 1 - maskX; }
+		} else {
+			maskX = x - static_cast<int>(footprint.OriginX);
+			maskY = y - static_cast<int>(footprint.OriginY);
+		}
+		return maskX >= 0 && maskY >= 0 && maskX < mask->Width && maskY < mask->Height && mask->GetBit(maskX, maskY);
+	}
+}
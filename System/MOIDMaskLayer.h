@@ -0,0 +1,190 @@
+#ifndef _RTEMOIDMASKLAYER_
+#define _RTEMOIDMASKLAYER_
+
+#include "Constants.h"
+
+struct BITMAP;
+
+namespace RTE {
+
+	/// <summary>
+	/// Answers which MOID covers a pixel of the Scene from the sprites MovableObjects would've drawn to the MOID layer, without actually drawing them.
+	/// Each draw is registered as a footprint referencing a bitmask precomputed once per sprite frame, and footprints are sorted into a uniform grid over the Scene so a query only has to test the few footprints overlapping its cell.
+	/// Footprints registered later cover earlier ones, the same as later draws overwrite earlier ones on the MOID layer, including footprints that erase to g_NoMOID.
+	/// Rotated and scaled footprints are resolved by mapping the queried pixel back into sprite space, which matches Allegro's rotated sprite rasterization except for the odd pixel along edges.
+	/// </summary>
+	class MOIDMaskLayer {
+
+	public:
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a MOIDMaskLayer object in system memory. Create() should be called before using the object.
+		/// </summary>
+		MOIDMaskLayer() { Clear(); }
+
+		/// <summary>
+		/// Makes the MOIDMaskLayer object ready for use, laid out over a Scene of the given dimensions. Any registered footprints are forgotten, but the sprite masks stay cached.
+		/// </summary>
+		/// <param name="width">The width of the Scene, in pixels.</param>
+		/// <param name="height">The height of the Scene, in pixels.</param>
+		void Create(int width, int height);
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Destructor method used to clean up a MOIDMaskLayer object before deletion from system memory.
+		/// </summary>
+		~MOIDMaskLayer() { Destroy(); }
+
+		/// <summary>
+		/// Destroys and resets (through Clear()) the MOIDMaskLayer object, including all the cached sprite masks.
+		/// </summary>
+		void Destroy();
+
+		/// <summary>
+		/// Removes all registered footprints while keeping the layout and the cached sprite masks of this MOIDMaskLayer, unless there are more cached masks than the cache is meant to hold.
+		/// </summary>
+		void Reset();
+#pragma endregion
+
+#pragma region Getters
+		/// <summary>
+		/// Gets the number of footprints currently registered.
+		/// </summary>
+		/// <returns>The number of registered footprints.</returns>
+		size_t GetFootprintCount() const { return m_Footprints.size(); }
+
+		/// <summary>
+		/// Gets the number of sprite frames a mask has been cached for.
+		/// </summary>
+		/// <returns>The number of cached sprite masks.</returns>
+		size_t GetCachedMaskCount() const { return m_SpriteMasks.size(); }
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Registers a sprite drawn unrotated and unscaled with its upper left corner at a position, like draw_character_ex() would.
+		/// </summary>
+		/// <param name="sprite">The sprite frame drawn. Its mask is made and cached if it hasn't been already.</param>
+		/// <param name="moid">The MOID drawn.</param>
+		/// <param name="left">The X position of the upper left corner of the sprite, in Scene coordinates.</param>
+		/// <param name="top">The Y position of the upper left corner of the sprite, in Scene coordinates.</param>
+		void AddSprite(BITMAP *sprite, MOID moid, int left, int top);
+
+		/// <summary>
+		/// Registers a sprite drawn rotated and scaled around a pivot, like pivot_scaled_sprite() would.
+		/// </summary>
+		/// <param name="sprite">The sprite frame drawn. Its mask is made and cached if it hasn't been already.</param>
+		/// <param name="moid">The MOID drawn.</param>
+		/// <param name="x">The X position the pivot is drawn at, in Scene coordinates.</param>
+		/// <param name="y">The Y position the pivot is drawn at, in Scene coordinates.</param>
+		/// <param name="pivotX">The X position of the pivot on the drawn bitmap.</param>
+		/// <param name="pivotY">The Y position of the pivot on the drawn bitmap.</param>
+		/// <param name="angle">The rotation angle, in Allegro's units of 256 to a full turn.</param>
+		/// <param name="scale">The scale factor.</param>
+		/// <param name="hFlipped">Whether the drawn bitmap is the sprite mirrored horizontally.</param>
+		void AddPivotedSprite(BITMAP *sprite, MOID moid, int x, int y, int pivotX, int pivotY, float angle, float scale, bool hFlipped);
+
+		/// <summary>
+		/// Registers a single drawn pixel.
+		/// </summary>
+		/// <param name="moid">The MOID drawn.</param>
+		/// <param name="x">The X position of the pixel, in Scene coordinates.</param>
+		/// <param name="y">The Y position of the pixel, in Scene coordinates.</param>
+		void AddPixel(MOID moid, int x, int y);
+
+		/// <summary>
+		/// Gets the MOID of the footprint registered last that covers a pixel. Safe to call from multiple threads as long as nothing gets registered meanwhile.
+		/// </summary>
+		/// <param name="x">The X position of the pixel, in Scene coordinates. Must be within the Scene.</param>
+		/// <param name="y">The Y position of the pixel, in Scene coordinates. Must be within the Scene.</param>
+		/// <returns>The MOID covering the pixel, or g_NoMOID if none does.</returns>
+		MOID GetMOID(int x, int y) const;
+#pragma endregion
+
+	private:
+
+		static constexpr int c_CellSize = 64; //!< The size of each grid cell, in pixels.
+		static constexpr size_t c_MaxCachedSpriteMasks = 8192; //!< The most sprite masks to keep cached between resets. More than that and the cache starts over, since only a few are used at any one time.
+
+		/// <summary>
+		/// The opaque pixels of a sprite frame, one bit per pixel, row by row.
+		/// </summary>
+		struct SpriteMask {
+			int Width; //!< The width of the sprite frame.
+			int Height; //!< The height of the sprite frame.
+			const void *Pixels; //!< The pixel memory of the sprite frame the mask was made from, to tell it apart from a different bitmap made at the same address later.
+			int WordsPerRow; //!< The number of 64 bit words each row takes up.
+			std::vector<uint64_t> Bits; //!< The bits of all the rows.
+
+			/// <summary>
+			/// Gets whether a pixel of the sprite frame is opaque. The pixel must be within the frame.
+			/// </summary>
+			bool GetBit(int x, int y) const { return (Bits[static_cast<size_t>(y * WordsPerRow + (x >> 6))] >> (x & 63)) & 1; }
+		};
+
+		/// <summary>
+		/// A registered draw.
+		/// </summary>
+		struct Footprint {
+			MOID ID; //!< The MOID drawn.
+			int Left; //!< The leftmost Scene column the footprint can cover.
+			int Top; //!< The topmost Scene row the footprint can cover.
+			int Right; //!< The rightmost Scene column the footprint can cover.
+			int Bottom; //!< The bottommost Scene row the footprint can cover.
+			const SpriteMask *Mask; //!< The mask of the drawn sprite frame, or nullptr if this is a single pixel covering its whole bounds.
+			bool Transformed; //!< Whether the sprite is rotated or scaled, so queries have to be mapped back into sprite space.
+			bool HFlipped; //!< Whether the sprite is mirrored horizontally. Only used if Transformed.
+			float OriginX; //!< The Scene X position the sprite's upper left corner (or pivot if Transformed) is drawn at.
+			float OriginY; //!< The Scene Y position the sprite's upper left corner (or pivot if Transformed) is drawn at.
+			float PivotX; //!< The X position of the pivot on the drawn bitmap. Only used if Transformed.
+			float PivotY; //!< The Y position of the pivot on the drawn bitmap. Only used if Transformed.
+			float InverseCos; //!< The cosine of the angle divided by the scale, for mapping back into sprite space. Only used if Transformed.
+			float InverseSin; //!< The sine of the angle divided by the scale, for mapping back into sprite space. Only used if Transformed.
+		};
+
+		int m_Width; //!< The width of the Scene this is laid out over.
+		int m_Height; //!< The height of the Scene this is laid out over.
+		int m_ColumnCount; //!< The number of cell columns.
+		int m_RowCount; //!< The number of cell rows.
+
+		std::vector<Footprint> m_Footprints; //!< The registered footprints, in the order they were registered.
+		std::vector<std::vector<int>> m_Cells; //!< The indices of the footprints overlapping each cell, in the order they were registered, row by row.
+		std::vector<int> m_UsedCells; //!< The indices of the cells with any footprints in them, so resetting doesn't have to go through all of them.
+		std::unordered_map<const BITMAP *, std::unique_ptr<SpriteMask>> m_SpriteMasks; //!< The cached masks of the sprite frames registered since the cache last started over, by bitmap.
+		std::vector<std::unique_ptr<SpriteMask>> m_StaleSpriteMasks; //!< Masks replaced since the last reset because their bitmap was gone, kept until then since footprints may still refer to them.
+
+		/// <summary>
+		/// Gets the cached mask of a sprite frame, making it first if there isn't one or the cached one was made from a different bitmap at the same address.
+		/// </summary>
+		/// <param name="sprite">The sprite frame to get the mask of.</param>
+		/// <returns>The mask of the sprite frame.</returns>
+		const SpriteMask * GetSpriteMask(BITMAP *sprite);
+
+		/// <summary>
+		/// Clips the bounds of a footprint to the Scene, and if anything's left adds it to the grid cells it overlaps.
+		/// </summary>
+		/// <param name="footprint">The footprint to add.</param>
+		void AddFootprint(const Footprint &footprint);
+
+		/// <summary>
+		/// Gets whether a footprint covers a pixel within its bounds.
+		/// </summary>
+		/// <param name="footprint">The footprint to check.</param>
+		/// <param name="x">The X position of the pixel, in Scene coordinates.</param>
+		/// <param name="y">The Y position of the pixel, in Scene coordinates.</param>
+		/// <returns>Whether the pixel is covered.</returns>
+		static bool Covers(const Footprint &footprint, int x, int y);
+
+		/// <summary>
+		/// Clears all the member variables of this MOIDMaskLayer, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+
+		// Disallow the use of some implicit methods.
+		MOIDMaskLayer(const MOIDMaskLayer &reference) = delete;
+		MOIDMaskLayer & operator=(const MOIDMaskLayer &rhs) = delete;
+	};
+}
+#endif
@@ -29,6 +29,7 @@ distribution.
 #endif
 
 //#include <vector>
+#include <algorithm>
 #include <memory.h>
 #include <stdio.h>
 
@@ -421,6 +422,22 @@ PathNode* PathNodePool::FetchPathNode( void* state )
 }
 
 
+void PathNodePool::ClearCachedNeighbors( void* state )
+{
+	unsigned key = Hash( state );
+
+	PathNode* root = hashTable[key];
+	while( root ) {
+		if ( root->state == state ) {
+			root->numAdjacent = -1;
+			root->cacheIndex = -1;
+			break;
+		}
+		root = ( state < root->state ) ? root->child[0] : root->child[1];
+	}
+}
+
+
 PathNode* PathNodePool::GetPathNode( unsigned frame, void* _state, float _costFromStart, float _estToGoal, PathNode* _parent )
 {
 	unsigned key = Hash( _state );
@@ -493,6 +510,23 @@ void MicroPather::Reset()
 }
 
 
+void MicroPather::StatesChanged( void* states[], int count )
+{
+	if ( pathNodePool.CacheMostlyUsed() ) {
+		Reset();
+		return;
+	}
+	for( int i=0; i<count; ++i ) {
+		pathNodePool.ClearCachedNeighbors( states[i] );
+	}
+	if ( pathCache ) {
+		MP_VECTOR< void* > sortedStates( states, states+count );
+		std::sort( sortedStates.begin(), sortedStates.end() );
+		pathCache->RemovePaths( sortedStates );
+	}
+}
+
+
 void MicroPather::GoalReached( PathNode* node, void* start, void* end, MP_VECTOR< void* > *_path )
 {
 	MP_VECTOR< void* >& path = *_path;
@@ -744,6 +778,48 @@ void PathCache::AddNoSolution( void* end, void* states[], int count )
 }
 
 
+void PathCache::RemovePaths( const MP_VECTOR< void* >& sortedStates )
+{
+	if ( !nItems ) {
+		return;
+	}
+	// Paths are chains of items leading to the same end, so a chain can't be
+	// broken up. Find all the ends with any item touching the states...
+	MP_VECTOR< void* > removedEnds;
+	for( int i=0; i<allocated; ++i ) {
+		const Item& item = mem[i];
+		if ( !item.Empty() ) {
+			if (	item.cost == FLT_MAX
+				 || std::binary_search( sortedStates.begin(), sortedStates.end(), item.start )
+				 || std::binary_search( sortedStates.begin(), sortedStates.end(), item.next )
+				 || std::binary_search( sortedStates.begin(), sortedStates.end(), item.end ) )
+			{
+				removedEnds.push_back( item.end );
+			}
+		}
+	}
+	if ( removedEnds.empty() ) {
+		return;
+	}
+	std::sort( removedEnds.begin(), removedEnds.end() );
+	removedEnds.erase( std::unique( removedEnds.begin(), removedEnds.end() ), removedEnds.end() );
+
+	// ...and rebuild the table without them, since the probing can't handle holes.
+	MP_VECTOR< Item > keptItems;
+	for( int i=0; i<allocated; ++i ) {
+		const Item& item = mem[i];
+		if ( !item.Empty() && !std::binary_search( removedEnds.begin(), removedEnds.end(), item.end ) ) {
+			keptItems.push_back( item );
+		}
+	}
+	memset( mem, 0, sizeof(*mem)*allocated );
+	nItems = 0;
+	for( unsigned i=0; i<keptItems.size(); ++i ) {
+		AddItem( keptItems[i] );
+	}
+}
+
+
 int PathCache::Solve( void* start, void* end, MP_VECTOR< void* >* path, float* totalCost )
 {
 	const Item* item = Find( start, end );
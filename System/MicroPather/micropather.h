@@ -298,6 +298,14 @@ namespace micropather
 		// Get a pathnode that is already in the pool.
 		PathNode* FetchPathNode( void* state );
 
+		// Forget the cached neighbors of a state, if it is in the pool, so they
+		// are queried from the client again the next time they are needed.
+		void ClearCachedNeighbors( void* state );
+
+		// True if most of the neighbor cache is used up. Neighbors cleared with
+		// ClearCachedNeighbors() keep taking up space until the next Clear().
+		bool CacheMostlyUsed() const	{ return cacheSize > cacheCap*3/4; }
+
 		// Store stuff in cache
 		bool PushCache( const NodeCost* nodes, int nNodes, int* start );
 
@@ -383,6 +391,9 @@ namespace micropather
 		void Reset();
 		void Add( const MP_VECTOR< void* >& path, const MP_VECTOR< float >& cost );
 		void AddNoSolution( void* end, void* states[], int count );
+		// Removes every path that starts, ends or passes through any of the
+		// (sorted) states, along with all the unsolvable paths.
+		void RemovePaths( const MP_VECTOR< void* >& sortedStates );
 		int Solve( void* startState, void* endState, MP_VECTOR< void* >* path, float* totalCost );
 
 		int AllocatedBytes() const { return allocated * sizeof(Item); }
@@ -483,6 +494,17 @@ namespace micropather
 		*/
 		void Reset();
 
+		/** Can be called instead of Reset() when only the costs to and from a few states changed.
+			Only the cached neighbors of those states and the cached paths passing through them are
+			thrown away, the rest of the cache is kept. Note that cached paths that could have become
+			cheaper by going through the changed states are kept as well. Falls back to Reset() if
+			the neighbor cache is mostly used up.
+
+			@param states	The states whose costs to adjacent states changed.
+			@param count	The number of states.
+		*/
+		void StatesChanged( void* states[], int count );
+
 		// Debugging function to return all states that were used by the last "solve" 
 		void StatesInPool( MP_VECTOR< void* >* stateVec );
 		void GetCacheData( CacheData* data );
@@ -30,7 +30,42 @@ namespace RTE {
 		ID_SRV_TERRAIN,
 		ID_SRV_POST_EFFECTS,
 		ID_SRV_SOUND_EVENTS,
-		ID_SRV_MUSIC_EVENTS
+		ID_SRV_MUSIC_EVENTS,
+		ID_CLT_KEYFRAME_REQUEST,
+		ID_SRV_ENTITY_PRESETS,
+		ID_SRV_ENTITY_SNAPSHOT
+	};
+
+	/// <summary>
+	/// Enumeration for the ways the pixels of a MsgFrameBox can be encoded.
+	/// </summary>
+	enum FrameBoxEncoding {
+		FrameBoxKeyframe = 0, //!< The box's pixels as they are, or none at all if the box is empty.
+		FrameBoxDelta, //!< The box's pixels XORed with the previous revision of the box.
+		FrameBoxUnchanged //!< No pixels, the box is the same as the previous revision.
+	};
+
+	/// <summary>
+	/// Enumeration for the flags of an EntityStateNetworkData.
+	/// </summary>
+	enum EntityStateFlags {
+		EntityHFlipped = 1, //!< The entity's sprite is drawn flipped horizontally.
+		EntityPixel = 2, //!< The entity is a single pixel with no preset, and its Frame is its palette color index instead.
+		EntityCosmetic = 4 //!< The entity only matters for looks, so its state is as it was when it first appeared and the client simulates it from there.
+	};
+
+	/// <summary>
+	/// Enumeration for which fields of an EntityStateNetworkData follow its unique ID in a MsgEntitySnapshot, in this order.
+	/// </summary>
+	enum EntityStateFields {
+		EntityFieldPreset = 1,
+		EntityFieldPos = 2,
+		EntityFieldVel = 4,
+		EntityFieldRotation = 8,
+		EntityFieldFrame = 16,
+		EntityFieldTeam = 32,
+		EntityFieldFlags = 64,
+		EntityFieldsAll = 127
 	};
 
 // Pack the structs so 1 byte members are exactly 1 byte in memory instead of being aligned by 4 bytes (padding) so the correct representation is sent over the network without empty bytes consumed by alignment.
@@ -133,6 +168,8 @@ namespace RTE {
 		unsigned short int BoxY;
 		unsigned char BoxWidth;
 		unsigned char BoxHeight;
+		unsigned char Encoding;
+		unsigned short int Revision;
 		unsigned short int DataSize;
 		unsigned short int UncompressedSize;
 	};
@@ -188,6 +225,7 @@ namespace RTE {
 		short int Width;
 		short int Height;
 		bool SceneWrapsX;
+		bool ReplicatesEntityState;
 
 		short int BackgroundLayerCount;
 		LightweightSceneLayer BackgroundLayers[c_MaxLayersStoredForNetwork];
@@ -224,18 +262,85 @@ namespace RTE {
 	/// <summary>
 	/// 
 	/// </summary>
-	struct MsgTerrainChange {
+	struct MsgKeyframeRequest {
 		unsigned char Id;
+	};
 
+	/// <summary>
+	/// One changed area of the terrain in a MsgTerrainChangeBatch.
+	/// </summary>
+	struct TerrainChangeRegion {
 		unsigned short int X;
 		unsigned short int Y;
 		unsigned short int W;
 		unsigned short int H;
 		bool Back;
-		unsigned char Color;
+	};
+
+	/// <summary>
+	/// All the terrain changes of one sim update. The data is RegionCount TerrainChangeRegions followed by the pixels of each region in turn, run-length encoded and then LZ4 compressed.
+	/// The run-length encoding is a control byte followed by either that number plus one of literal bytes if it's under 128, or by one byte to repeat the control byte minus 125 times.
+	/// </summary>
+	struct MsgTerrainChangeBatch {
+		unsigned char Id;
 		unsigned char SceneId;
-		unsigned short int DataSize;
-		unsigned short int UncompressedSize;
+
+		unsigned int Sequence;
+		unsigned int RegionCount;
+		unsigned int RawSize;
+		unsigned int RunLengthSize;
+		unsigned int DataSize;
+	};
+
+	static constexpr unsigned int c_MaxEntityPresets = 65535; //!< The most presets MsgEntitySnapshots can refer to. The server leaves the presets of entities past it out, and clients reject MsgEntityPresets that go past it.
+
+	/// <summary>
+	/// Names of the presets entities in MsgEntitySnapshots refer to by index. The data is Count pairs of null-terminated class and module and preset names, for indices starting at FirstIndex.
+	/// </summary>
+	struct MsgEntityPresets {
+		unsigned char Id;
+
+		unsigned int FirstIndex;
+		unsigned int Count;
+		unsigned int DataSize;
+	};
+
+	/// <summary>
+	/// The state of one entity in the scene, as much as the client needs to draw it.
+	/// </summary>
+	struct EntityStateNetworkData {
+		unsigned int UniqueID;
+		unsigned int PresetIndex;
+		float PosX;
+		float PosY;
+		float VelX;
+		float VelY;
+		float Rotation;
+		unsigned short int Frame;
+		signed char Team;
+		unsigned char Flags;
+	};
+
+	/// <summary>
+	/// The state of every entity in the scene, as a delta against the snapshot numbered BaseSequence, or whole if BaseSequence is 0. Entities are listed in the order they're drawn.
+	/// The data is LZ4 compressed unless DataSize equals RawSize. Uncompressed, it's RemovedCount unique IDs of entities gone since the base snapshot, then OrderCount unique IDs of every entity in the order they're drawn,
+	/// then StateCount entities that are new or changed, each as its unique ID, a byte of EntityStateFields and then the values of those fields. Entities that didn't change since the base snapshot aren't listed.
+	/// The order is only listed when it isn't the base snapshot's order with the new entities after, in the order they're listed.
+	/// </summary>
+	struct MsgEntitySnapshot {
+		unsigned char Id;
+		unsigned char SceneId;
+
+		unsigned int Sequence;
+		unsigned int BaseSequence;
+		unsigned int ServerTime;
+		float GlobalAccX;
+		float GlobalAccY;
+		unsigned int RemovedCount;
+		unsigned int OrderCount;
+		unsigned int StateCount;
+		unsigned int RawSize;
+		unsigned int DataSize;
 	};
 
 	/// <summary>
@@ -296,6 +401,8 @@ namespace RTE {
 		unsigned int InputElementPressed;
 		unsigned int InputElementReleased;
 		unsigned int InputElementHeld;
+
+		unsigned int LastEntitySnapshot;
 	};
 
 // Disables the previously set pack pragma.
@@ -0,0 +1,459 @@
+#include "ParticleStore.h"
+#include "MOPixel.h"
+#include "Atom.h"
+#include "SceneMan.h"
+#include "ActivityMan.h"
+#include "TimerMan.h"
+#include "ThreadMan.h"
+#include "ConsoleMan.h"
+#include "FloatLanes.h"
+
+namespace RTE {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ParticleStore::Clear() {
+		m_Pixels.clear();
+		m_PosX.clear();
+		m_PosY.clear();
+		m_VelX.clear();
+		m_VelY.clear();
+		m_PrevPosX.clear();
+		m_PrevPosY.clear();
+		m_GlobalAccScalars.clear();
+		m_AirResistances.clear();
+		m_AirThresholds.clear();
+		m_AgeStartTicks.clear();
+		m_Lifetimes.clear();
+		m_RestStartTicks.clear();
+		m_RestThresholds.clear();
+		m_TravelErrors.clear();
+		m_Colors.clear();
+		m_SettleMaterials.clear();
+		m_Flags.clear();
+		m_NewVelX.clear();
+		m_NewVelY.clear();
+		m_NewPosX.clear();
+		m_NewPosY.clear();
+		m_Moved.clear();
+		m_UpdateResults.clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ParticleStore::Destroy() {
+		for (const MOPixel *pixel : m_Pixels) {
+			delete pixel;
+		}
+		Clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	MOPixel * ParticleStore::GetUpToDatePixel(size_t index) const {
+		WriteBack(index);
+		return m_Pixels[index];
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool ParticleStore::Contains(const MovableObject *particle) const {
+		return std::find(m_Pixels.begin(), m_Pixels.end(), particle) != m_Pixels.end();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool ParticleStore::CanStore(const MovableObject *particle) {
+		const MOPixel *pixel = dynamic_cast<const MOPixel *>(particle);
+
+		// Anything derived from MOPixel may do more in its overrides, so only exactly MOPixels qualify.
+		if (!pixel || &pixel->GetClass() != &MOPixel::m_sClass) {
+			return false;
+		}
+		// Changes made to a stored pixel through its object would be overwritten by the stored data, so pixels anything else holds on to stay full objects.
+		return !pixel->m_ExternallyReferenced && pixel->m_AllLoadedScripts.empty() && !pixel->m_HitsMOs && !pixel->m_GetsHitByMOs && pixel->m_PinStrength == 0 && !pixel->m_MissionCritical && !pixel->m_pScreenEffect &&
+			pixel->m_Forces.empty() && pixel->m_ImpulseForces.empty() && !pixel->m_ToDelete && !pixel->m_ToSettle && !pixel->IsTooFast() &&
+			pixel->m_Atom->GetTrailLength() == 0 && pixel->m_Atom->GetOffset().IsZero();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ParticleStore::Add(MOPixel *pixel) {
+		RTEAssert(CanStore(pixel), "Trying to add a particle that can't be stored to a ParticleStore!");
+
+		m_Pixels.emplace_back(pixel);
+		m_PosX.emplace_back(pixel->m_Pos.m_X);
+		m_PosY.emplace_back(pixel->m_Pos.m_Y);
+		m_VelX.emplace_back(pixel->m_Vel.m_X);
+		m_VelY.emplace_back(pixel->m_Vel.m_Y);
+		m_PrevPosX.emplace_back(pixel->m_PrevPos.m_X);
+		m_PrevPosY.emplace_back(pixel->m_PrevPos.m_Y);
+		m_GlobalAccScalars.emplace_back(pixel->m_GlobalAccScalar);
+		m_AirResistances.emplace_back(pixel->m_AirResistance);
+		m_AirThresholds.emplace_back(pixel->m_AirThreshold);
+		// GetStartSimTimeMS() actually returns the raw tick count, which is exactly what's wanted here.
+		m_AgeStartTicks.emplace_back(pixel->m_AgeTimer.GetStartSimTimeMS());
+		m_Lifetimes.emplace_back(pixel->m_Lifetime);
+		m_RestStartTicks.emplace_back(pixel->m_RestTimer.GetStartSimTimeMS());
+		m_RestThresholds.emplace_back(pixel->m_RestThreshold);
+		m_TravelErrors.emplace_back(pixel->m_Atom->m_PrevError);
+		m_Colors.emplace_back(static_cast<unsigned char>(pixel->m_Color.GetIndex()));
+		m_SettleMaterials.emplace_back(pixel->m_Atom->GetMaterial()->GetSettleMaterial());
+
+		unsigned char flags = 0;
+		if (pixel->m_IgnoreTerrain) { flags |= IgnoresTerrain; }
+		if (pixel->m_Atom->m_ChangedDir) { flags |= ChangedDir; }
+		m_Flags.emplace_back(flags);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ParticleStore::PromoteAll(std::deque<MovableObject *> &particles) {
+		for (size_t index = 0; index < m_Pixels.size(); ++index) {
+			WriteBack(index);
+			particles.emplace_back(m_Pixels[index]);
+		}
+		// The pixels are owned by the list now, so they shouldn't be deleted.
+		Clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	MOPixel * ParticleStore::Remove(const MovableObject *particle) {
+		std::vector<MOPixel *>::const_iterator pixel = std::find(m_Pixels.begin(), m_Pixels.end(), particle);
+		return (pixel != m_Pixels.end()) ? Promote(static_cast<size_t>(pixel - m_Pixels.begin())) : nullptr;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ParticleStore::Update(std::deque<MovableObject *> &promotedParticles, bool parallel) {
+		int pixelCount = static_cast<int>(m_Pixels.size());
+		if (pixelCount == 0) {
+			return;
+		}
+		m_NewVelX.resize(pixelCount);
+		m_NewVelY.resize(pixelCount);
+		m_NewPosX.resize(pixelCount);
+		m_NewPosY.resize(pixelCount);
+		m_Moved.resize(pixelCount);
+		m_UpdateResults.resize(pixelCount);
+
+		float deltaTime = g_TimerMan.GetDeltaTimeSecs();
+		Vector globalAcc = g_SceneMan.GetGlobalAcc();
+
+		// Everything up to the wrapping only reads the Scene and each pixel's own data, so it's done for all the pixels up front where it can be spread out over the worker threads.
+		auto processBatch = [this, deltaTime, &globalAcc](int batchStart, int batchEnd) {
+			ApplyForces<SIMDFloatLanes>(batchStart, batchEnd, globalAcc, deltaTime);
+			Integrate<SIMDFloatLanes>(batchStart, batchEnd, deltaTime);
+
+			// The collision walk is the one part that has to go pixel by pixel.
+			for (int index = batchStart; index < batchEnd; ++index) {
+				if (m_UpdateResults[index] == Traveled && !Atom::IsTerrainTravelUnobstructed(Vector(m_PosX[index], m_PosY[index]), Vector(m_NewVelX[index], m_NewVelY[index]), deltaTime, m_Flags[index] & ChangedDir, m_TravelErrors[index], m_Flags[index] & IgnoresTerrain)) {
+					m_UpdateResults[index] = Obstructed;
+				}
+			}
+		};
+		if (parallel) {
+			g_ThreadMan.ParallelFor(pixelCount, 256, processBatch);
+		} else {
+			processBatch(0, pixelCount);
+		}
+
+		long long simTickCount = g_TimerMan.GetSimTickCount();
+		double ticksPerMS = static_cast<double>(g_TimerMan.GetTicksPerSecond()) * 0.001;
+
+		for (int index = 0; index < pixelCount; ++index) {
+			// Deleting a pixel only sets a flag on its object, which is the one thing read through the pointer every update.
+			if (m_Pixels[index]->m_ToDelete) {
+				m_UpdateResults[index] = Expired;
+				continue;
+			}
+			if (m_UpdateResults[index] == Obstructed) {
+				continue;
+			}
+			Vector position(m_NewPosX[index], m_NewPosY[index]);
+			bool wrapped = g_SceneMan.WrapPosition(position);
+			m_PrevPosX[index] = m_PosX[index];
+			m_PrevPosY[index] = m_PosY[index];
+			m_PosX[index] = position.m_X;
+			m_PosY[index] = position.m_Y;
+			m_VelX[index] = m_NewVelX[index];
+			m_VelY[index] = m_NewVelY[index];
+			m_Flags[index] |= HasTraveled;
+
+			// Same as MovableObject::PostTravel().
+			double age = static_cast<double>(simTickCount - m_AgeStartTicks[index]) / ticksPerMS;
+			if ((m_Lifetimes[index] && age > m_Lifetimes[index]) || !g_SceneMan.IsWithinBounds(position.m_X, position.m_Y, 100)) {
+				m_UpdateResults[index] = Expired;
+				continue;
+			}
+			// Same as MOPixel::RestDetection() and MovableMan's settle check after it. Unobstructed travel doesn't change velocity, so there are no oscillations to count.
+			// Wrapping around the Scene always moves a pixel further than a whole pixel, which the movement test before wrapping couldn't know about.
+			if (m_Moved[index] || wrapped) { m_RestStartTicks[index] = simTickCount; }
+
+			if (m_RestThresholds[index] >= 0 && static_cast<double>(simTickCount - m_RestStartTicks[index]) / ticksPerMS > m_RestThresholds[index]) {
+				if (g_SceneMan.OverAltitude(position, 2, 0)) {
+					m_RestStartTicks[index] = simTickCount;
+				} else {
+					m_UpdateResults[index] = Settled;
+				}
+			}
+		}
+
+		// Go backwards so the pixels swapped in from the end by removals have already been handled.
+		for (int index = pixelCount - 1; index >= 0; --index) {
+			switch (m_UpdateResults[index]) {
+				case Obstructed:
+					promotedParticles.emplace_back(Promote(index));
+					break;
+				case Expired:
+					delete m_Pixels[index];
+					RemoveAt(index);
+					break;
+				case Settled: {
+					MOPixel *pixel = Promote(index);
+					pixel->m_ToSettle = true;
+					pixel->m_IsUpdated = true;
+					promotedParticles.emplace_back(pixel);
+					break;
+				}
+				default:
+					break;
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ParticleStore::Draw(BITMAP *targetBitmap, const Vector &targetPos, bool drawMaterial) const {
+		const std::vector<unsigned char> &drawColors = drawMaterial ? m_SettleMaterials : m_Colors;
+
+		acquire_bitmap(targetBitmap);
+		for (size_t index = 0; index < m_Pixels.size(); ++index) {
+			putpixel(targetBitmap, static_cast<int>(std::floor(m_PosX[index]) - targetPos.m_X), static_cast<int>(std::floor(m_PosY[index]) - targetPos.m_Y), drawColors[index]);
+		}
+		release_bitmap(targetBitmap);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ParticleStore::RunKernelBenchmark(int pixelCount, int iterationCount) {
+		if (!g_SceneMan.GetScene()) {
+			g_ConsoleMan.PrintString("ERROR: The ParticleStore kernel benchmark needs a loaded Scene to run in!");
+			return;
+		} else if (g_ActivityMan.GetActivity() && !g_ActivityMan.GetActivity()->IsOver()) {
+			// The MOPixel objects run their own travel and rest detection against the Scene, which mustn't touch a game someone is playing.
+			g_ConsoleMan.PrintString("ERROR: The ParticleStore kernel benchmark changes the Scene, so it can only run once the Activity is over!");
+			return;
+		}
+		pixelCount = std::max(pixelCount, 1);
+		iterationCount = std::max(iterationCount, 1);
+
+		// The object path works on its own copies of the pixels, since unlike the kernels it writes its results back into them.
+		ParticleStore pixelStore;
+		std::vector<MOPixel *> objectPixels;
+		objectPixels.reserve(pixelCount);
+		float maxPosX = static_cast<float>(g_SceneMan.GetSceneWidth() - 1);
+		float maxPosY = static_cast<float>(g_SceneMan.GetSceneHeight() - 1);
+		for (int i = 0; i < pixelCount; ++i) {
+			MOPixel *pixel = new MOPixel(Color(g_YellowGlowColor), 0.01F, Vector(RandomNum(0.0F, maxPosX), RandomNum(0.0F, maxPosY)), Vector(RandomNum(-10.0F, 10.0F), RandomNum(-10.0F, 5.0F)), new Atom(Vector(), g_MaterialSand, nullptr), 0);
+			pixel->SetToHitMOs(false);
+			pixel->SetToGetHitByMOs(false);
+			pixel->SetRestThreshold(-1);
+			pixel->SetAirResistance(RandomNum(0.0F, 0.1F));
+			objectPixels.push_back(pixel);
+			pixelStore.Add(dynamic_cast<MOPixel *>(pixel->Clone()));
+		}
+		pixelStore.m_NewVelX.resize(pixelCount);
+		pixelStore.m_NewVelY.resize(pixelCount);
+		pixelStore.m_NewPosX.resize(pixelCount);
+		pixelStore.m_NewPosY.resize(pixelCount);
+		pixelStore.m_Moved.resize(pixelCount);
+		pixelStore.m_UpdateResults.resize(pixelCount);
+
+		float deltaTime = g_TimerMan.GetDeltaTimeSecs();
+		Vector globalAcc = g_SceneMan.GetGlobalAcc();
+		auto printResult = [pixelCount, iterationCount](const std::string &measurementName, long long elapsedTime) {
+			g_ConsoleMan.PrintString("ParticleStore kernel benchmark - " + measurementName + ": " + std::to_string(elapsedTime) + " us total, " + std::to_string(static_cast<double>(elapsedTime) * 1000.0 / (static_cast<double>(pixelCount) * static_cast<double>(iterationCount))) + " ns per pixel");
+		};
+		g_ConsoleMan.PrintString("ParticleStore kernel benchmark - Processing " + std::to_string(pixelCount) + " pixels " + std::to_string(iterationCount) + " times per measurement.");
+
+		// The stored pixels are supposed to move exactly like they would as full objects, so check the kernels against one update of the MOPixel objects themselves first.
+		pixelStore.ApplyForces<SIMDFloatLanes>(0, pixelCount, globalAcc, deltaTime);
+		pixelStore.Integrate<SIMDFloatLanes>(0, pixelCount, deltaTime);
+		int objectMismatchCount = 0;
+		for (int i = 0; i < pixelCount; ++i) {
+			MOPixel *pixel = objectPixels[i];
+			pixel->ApplyForces();
+			pixel->TravelUnobstructed();
+			Vector storedPos(pixelStore.m_NewPosX[i], pixelStore.m_NewPosY[i]);
+			g_SceneMan.WrapPosition(storedPos);
+			if (pixel->m_Vel.m_X != pixelStore.m_NewVelX[i] || pixel->m_Vel.m_Y != pixelStore.m_NewVelY[i] || pixel->m_Pos.m_X != storedPos.m_X || pixel->m_Pos.m_Y != storedPos.m_Y) { ++objectMismatchCount; }
+		}
+		if (objectMismatchCount > 0) { g_ConsoleMan.PrintString("ERROR: ParticleStore kernel benchmark found " + std::to_string(objectMismatchCount) + " differences between the " + SIMDFloatLanes::c_Name + " kernel results and the MOPixel objects!"); }
+
+		long long startTime = g_TimerMan.GetAbsoluteTime();
+		for (int iteration = 0; iteration < iterationCount; ++iteration) {
+			for (MOPixel *pixel : objectPixels) {
+				pixel->ApplyForces();
+				pixel->TravelUnobstructed();
+				pixel->RestDetection();
+			}
+		}
+		printResult("MOPixel objects", g_TimerMan.GetAbsoluteTime() - startTime);
+
+		startTime = g_TimerMan.GetAbsoluteTime();
+		for (int iteration = 0; iteration < iterationCount; ++iteration) {
+			pixelStore.ApplyForces<ScalarFloatLanes>(0, pixelCount, globalAcc, deltaTime);
+			pixelStore.Integrate<ScalarFloatLanes>(0, pixelCount, deltaTime);
+		}
+		printResult("Scalar kernels", g_TimerMan.GetAbsoluteTime() - startTime);
+
+		std::vector<float> scalarResults;
+		for (const std::vector<float> *results : { &pixelStore.m_NewVelX, &pixelStore.m_NewVelY, &pixelStore.m_NewPosX, &pixelStore.m_NewPosY }) {
+			scalarResults.insert(scalarResults.end(), results->begin(), results->end());
+		}
+		std::vector<unsigned char> scalarMoved = pixelStore.m_Moved;
+		std::vector<UpdateResult> scalarUpdateResults = pixelStore.m_UpdateResults;
+
+		startTime = g_TimerMan.GetAbsoluteTime();
+		for (int iteration = 0; iteration < iterationCount; ++iteration) {
+			pixelStore.ApplyForces<SIMDFloatLanes>(0, pixelCount, globalAcc, deltaTime);
+			pixelStore.Integrate<SIMDFloatLanes>(0, pixelCount, deltaTime);
+		}
+		printResult(std::string(SIMDFloatLanes::c_Name) + " kernels", g_TimerMan.GetAbsoluteTime() - startTime);
+
+		// The kernels are supposed to round exactly the same whichever lanes they run on, so any difference is a bug.
+		std::vector<float> simdResults;
+		for (const std::vector<float> *results : { &pixelStore.m_NewVelX, &pixelStore.m_NewVelY, &pixelStore.m_NewPosX, &pixelStore.m_NewPosY }) {
+			simdResults.insert(simdResults.end(), results->begin(), results->end());
+		}
+		int mismatchCount = 0;
+		for (size_t i = 0; i < simdResults.size(); ++i) {
+			if (simdResults[i] != scalarResults[i]) { ++mismatchCount; }
+		}
+		for (int i = 0; i < pixelCount; ++i) {
+			if (pixelStore.m_Moved[i] != scalarMoved[i] || pixelStore.m_UpdateResults[i] != scalarUpdateResults[i]) { ++mismatchCount; }
+		}
+		if (mismatchCount > 0) { g_ConsoleMan.PrintString("ERROR: ParticleStore kernel benchmark found " + std::to_string(mismatchCount) + " differences between the " + SIMDFloatLanes::c_Name + " and scalar kernel results!"); }
+
+		for (const MOPixel *pixel : objectPixels) {
+			delete pixel;
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ParticleStore::WriteBack(size_t index) const {
+		MOPixel *pixel = m_Pixels[index];
+		pixel->m_Pos.SetXY(m_PosX[index], m_PosY[index]);
+		pixel->m_Vel.SetXY(m_VelX[index], m_VelY[index]);
+		if (m_Flags[index] & HasTraveled) {
+			pixel->m_PrevPos.SetXY(m_PrevPosX[index], m_PrevPosY[index]);
+			pixel->m_PrevVel = pixel->m_Vel;
+			pixel->m_VelOscillations = 0;
+		}
+		if (pixel->m_IgnoresAGHitsWhenSlowerThan > 0) { pixel->m_IgnoresAtomGroupHits = pixel->m_Vel.GetLargest() < pixel->m_IgnoresAGHitsWhenSlowerThan; }
+		pixel->m_RestTimer.SetElapsedSimTimeMS(static_cast<double>(g_TimerMan.GetSimTickCount() - m_RestStartTicks[index]) / (static_cast<double>(g_TimerMan.GetTicksPerSecond()) * 0.001));
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	MOPixel * ParticleStore::Promote(size_t index) {
+		WriteBack(index);
+		MOPixel *pixel = m_Pixels[index];
+		RemoveAt(index);
+		return pixel;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ParticleStore::RemoveAt(size_t index) {
+		auto swapRemove = [index](auto &values) {
+			values[index] = values.back();
+			values.pop_back();
+		};
+		swapRemove(m_Pixels);
+		swapRemove(m_PosX);
+		swapRemove(m_PosY);
+		swapRemove(m_VelX);
+		swapRemove(m_VelY);
+		swapRemove(m_PrevPosX);
+		swapRemove(m_PrevPosY);
+		swapRemove(m_GlobalAccScalars);
+		swapRemove(m_AirResistances);
+		swapRemove(m_AirThresholds);
+		swapRemove(m_AgeStartTicks);
+		swapRemove(m_Lifetimes);
+		swapRemove(m_RestStartTicks);
+		swapRemove(m_RestThresholds);
+		swapRemove(m_TravelErrors);
+		swapRemove(m_Colors);
+		swapRemove(m_SettleMaterials);
+		swapRemove(m_Flags);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	template <typename Lanes>
+	void ParticleStore::ApplyForces(int batchStart, int batchEnd, const Vector &globalAcc, float deltaTime) {
+		const Lanes globalAccX = Lanes::Broadcast(globalAcc.m_X);
+		const Lanes globalAccY = Lanes::Broadcast(globalAcc.m_Y);
+		const Lanes timeStep = Lanes::Broadcast(deltaTime);
+		const Lanes zero = Lanes::Broadcast(0.0F);
+		const Lanes one = Lanes::Broadcast(1.0F);
+		const Lanes tooFastSpeed = Lanes::Broadcast(500.0F);
+
+		int index = batchStart;
+		for (; index + Lanes::c_Count <= batchEnd; index += Lanes::c_Count) {
+			// The operations are done in the same order as the Vector math in MovableObject::GetVelocityAfterForces(), so the results are exactly the same.
+			Lanes globalAccScalars = Lanes::Load(&m_GlobalAccScalars[index]);
+			Lanes velX = Lanes::Load(&m_VelX[index]) + globalAccX * globalAccScalars * timeStep;
+			Lanes velY = Lanes::Load(&m_VelY[index]) + globalAccY * globalAccScalars * timeStep;
+
+			Lanes airResistances = Lanes::Load(&m_AirResistances[index]);
+			typename Lanes::Mask airResisted = Lanes::And(airResistances > zero, Lanes::Max(Lanes::Abs(velX), Lanes::Abs(velY)) >= Lanes::Load(&m_AirThresholds[index]));
+			Lanes airFactors = one - airResistances * timeStep;
+			velX = Lanes::Select(airResisted, velX * airFactors, velX);
+			velY = Lanes::Select(airResisted, velY * airFactors, velY);
+
+			velX.Store(&m_NewVelX[index]);
+			velY.Store(&m_NewVelY[index]);
+
+			int tooFastBits = Lanes::GetMaskBits(Lanes::Max(Lanes::Abs(velX), Lanes::Abs(velY)) > tooFastSpeed);
+			for (int lane = 0; lane < Lanes::c_Count; ++lane) {
+				m_UpdateResults[index + lane] = (tooFastBits & (1 << lane)) ? Obstructed : Traveled;
+			}
+		}
+		if constexpr (Lanes::c_Count > 1) {
+			ApplyForces<ScalarFloatLanes>(index, batchEnd, globalAcc, deltaTime);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	template <typename Lanes>
+	void ParticleStore::Integrate(int batchStart, int batchEnd, float deltaTime) {
+		const Lanes timeStep = Lanes::Broadcast(deltaTime);
+		const Lanes pixelsPerMeter = Lanes::Broadcast(c_PPM);
+		const Lanes one = Lanes::Broadcast(1.0F);
+
+		int index = batchStart;
+		for (; index + Lanes::c_Count <= batchEnd; index += Lanes::c_Count) {
+			Lanes posX = Lanes::Load(&m_PosX[index]);
+			Lanes posY = Lanes::Load(&m_PosY[index]);
+			Lanes newPosX = posX + Lanes::Load(&m_NewVelX[index]) * timeStep * pixelsPerMeter;
+			Lanes newPosY = posY + Lanes::Load(&m_NewVelY[index]) * timeStep * pixelsPerMeter;
+			newPosX.Store(&m_NewPosX[index]);
+			newPosY.Store(&m_NewPosY[index]);
+
+			int movedBits = Lanes::GetMaskBits(Lanes::Or(Lanes::Abs(newPosX - posX) >= one, Lanes::Abs(newPosY - posY) >= one));
+			for (int lane = 0; lane < Lanes::c_Count; ++lane) {
+				m_Moved[index + lane] = (movedBits & (1 << lane)) ? 1 : 0;
+			}
+		}
+		if constexpr (Lanes::c_Count > 1) {
+			Integrate<ScalarFloatLanes>(index, batchEnd, deltaTime);
+		}
+	}
+}
@@ -0,0 +1,214 @@
+#ifndef _RTEPARTICLESTORE_
+#define _RTEPARTICLESTORE_
+
+#include "Vector.h"
+
+struct BITMAP;
+
+namespace RTE {
+
+	class MovableObject;
+	class MOPixel;
+
+	/// <summary>
+	/// A structure-of-arrays container for plain MOPixels, which keeps the data their travel and update touch every frame in contiguous arrays instead of behind each pixel's pointer.
+	/// Only pixels that nothing but the Scene can affect are kept here: no scripts, no MO collisions, no forces, trails or screen effects, and nothing outside of MovableMan holding on to them. Any pixel whose travel would hit something gets promoted back to a full MovableObject for the frame.
+	/// MOSParticles aren't kept here because they animate and draw rotated sprites, which would need all their sprite data anyway, and there are far fewer of them than of MOPixels.
+	/// The MOPixel objects themselves are owned and kept around for all the rest of their data, but are only brought up to date when they're promoted or asked for.
+	/// </summary>
+	class ParticleStore {
+
+	public:
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a ParticleStore object in system memory.
+		/// </summary>
+		ParticleStore() { Clear(); }
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Destructor method used to clean up a ParticleStore object before deletion from system memory.
+		/// </summary>
+		~ParticleStore() { Destroy(); }
+
+		/// <summary>
+		/// Deletes all the stored pixels and resets (through Clear()) the ParticleStore object.
+		/// </summary>
+		void Destroy();
+#pragma endregion
+
+#pragma region Getters
+		/// <summary>
+		/// Gets the number of pixels currently stored in this ParticleStore.
+		/// </summary>
+		/// <returns>The number of stored pixels.</returns>
+		size_t GetCount() const { return m_Pixels.size(); }
+
+		/// <summary>
+		/// Gets a stored pixel, brought up to date with its stored data. It stays in this ParticleStore.
+		/// </summary>
+		/// <param name="index">The index of the pixel to get.</param>
+		/// <returns>The up to date pixel. Ownership is NOT transferred!</returns>
+		MOPixel * GetUpToDatePixel(size_t index) const;
+
+		/// <summary>
+		/// Gets whether a particle is stored in this ParticleStore.
+		/// </summary>
+		/// <param name="particle">The particle to look for.</param>
+		/// <returns>Whether the particle is stored here.</returns>
+		bool Contains(const MovableObject *particle) const;
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Gets whether a particle can be kept in a ParticleStore in its current state.
+		/// </summary>
+		/// <param name="particle">The particle to check.</param>
+		/// <returns>Whether the particle is a plain MOPixel that can be stored.</returns>
+		static bool CanStore(const MovableObject *particle);
+
+		/// <summary>
+		/// Adds a pixel to this ParticleStore. CanStore() must be true for it.
+		/// </summary>
+		/// <param name="pixel">The pixel to add. Ownership IS transferred!</param>
+		void Add(MOPixel *pixel);
+
+		/// <summary>
+		/// Brings all the stored pixels up to date and takes them out of this ParticleStore.
+		/// </summary>
+		/// <param name="particles">The particle list to add the pixels to. Ownership IS transferred!</param>
+		void PromoteAll(std::deque<MovableObject *> &particles);
+
+		/// <summary>
+		/// Brings a stored pixel up to date and takes it out of this ParticleStore.
+		/// </summary>
+		/// <param name="particle">The particle to take out.</param>
+		/// <returns>The pixel taken out, or nullptr if the particle isn't stored here. Ownership IS transferred!</returns>
+		MOPixel * Remove(const MovableObject *particle);
+
+		/// <summary>
+		/// Does everything MovableMan's travel and update passes would do to each stored pixel for a sim update, in one go.
+		/// Pixels whose travel would hit anything are promoted before traveling and should go through the full travel and update of MovableMan instead.
+		/// Pixels that come to rest are promoted as travelled and set to settle, pixels that expire, leave the Scene or were set to be deleted are deleted. The Scene MUST BE LOCKED before calling this!
+		/// </summary>
+		/// <param name="promotedParticles">The particle list to add promoted pixels to. Ownership IS transferred!</param>
+		/// <param name="parallel">Whether the collision checks should be spread out over the ThreadMan's worker threads.</param>
+		void Update(std::deque<MovableObject *> &promotedParticles, bool parallel);
+
+		/// <summary>
+		/// Draws all the stored pixels to a BITMAP of choice.
+		/// </summary>
+		/// <param name="targetBitmap">A pointer to a BITMAP to draw on.</param>
+		/// <param name="targetPos">The absolute position of the target bitmap's upper left corner in the Scene.</param>
+		/// <param name="drawMaterial">Whether to draw the pixels' settle materials instead of their colors.</param>
+		void Draw(BITMAP *targetBitmap, const Vector &targetPos, bool drawMaterial) const;
+#pragma endregion
+
+#pragma region Benchmarking
+		/// <summary>
+		/// Measures how long applying forces, integrating and checking for rest takes for a number of plain MOPixels in the current Scene, through the SIMD and scalar kernels of a ParticleStore compared to through each MOPixel object, and prints the results to the console.
+		/// The MOPixel objects can change the Scene, so this refuses to run until the Activity is over.
+		/// </summary>
+		/// <param name="pixelCount">The number of pixels to process.</param>
+		/// <param name="iterationCount">The number of times to process all the pixels in each measurement.</param>
+		static void RunKernelBenchmark(int pixelCount, int iterationCount);
+#pragma endregion
+
+	private:
+
+		/// <summary>
+		/// Bit flags for the stored pixels.
+		/// </summary>
+		enum PixelFlags : unsigned char {
+			IgnoresTerrain = 1 << 0, //!< The pixel ignores terrain.
+			ChangedDir = 1 << 1, //!< The pixel's Atom changed direction during its last full travel.
+			HasTraveled = 1 << 2 //!< The pixel has traveled since it was stored, so its previous position and velocity are stored too.
+		};
+
+		/// <summary>
+		/// What happened to a stored pixel during an Update().
+		/// </summary>
+		enum UpdateResult : unsigned char {
+			Obstructed, //!< The pixel's travel would hit something, so it gets promoted before traveling.
+			Traveled, //!< The pixel traveled and stays stored.
+			Expired, //!< The pixel traveled and expired or left the Scene, so it gets deleted.
+			Settled //!< The pixel traveled and came to rest, so it gets promoted to settle.
+		};
+
+		std::vector<MOPixel *> m_Pixels; //!< The stored pixels, holding all their data that isn't stored here. Owned.
+		std::vector<float> m_PosX; //!< The X positions of the pixels.
+		std::vector<float> m_PosY; //!< The Y positions of the pixels.
+		std::vector<float> m_VelX; //!< The X velocities of the pixels.
+		std::vector<float> m_VelY; //!< The Y velocities of the pixels.
+		std::vector<float> m_PrevPosX; //!< The X positions of the pixels before their last travel.
+		std::vector<float> m_PrevPosY; //!< The Y positions of the pixels before their last travel.
+		std::vector<float> m_GlobalAccScalars; //!< How much each pixel is affected by the global acceleration.
+		std::vector<float> m_AirResistances; //!< The air resistance of each pixel.
+		std::vector<float> m_AirThresholds; //!< The speed each pixel has to go for air resistance to have an effect.
+		std::vector<long long> m_AgeStartTicks; //!< The sim tick count each pixel's age timer started at.
+		std::vector<unsigned long> m_Lifetimes; //!< The lifetime of each pixel in ms. 0 means unlimited.
+		std::vector<long long> m_RestStartTicks; //!< The sim tick count each pixel's rest timer was last reset at.
+		std::vector<int> m_RestThresholds; //!< The time each pixel has to rest to settle, in ms. Negative means never.
+		std::vector<int> m_TravelErrors; //!< The error each pixel's Atom stored at the end of its last full travel.
+		std::vector<unsigned char> m_Colors; //!< The palette index of each pixel's color.
+		std::vector<unsigned char> m_SettleMaterials; //!< The index of the material each pixel's Atom settles into.
+		std::vector<unsigned char> m_Flags; //!< The PixelFlags of each pixel.
+
+		std::vector<float> m_NewVelX; //!< The X velocities of the pixels after this update's forces. Only used during Update().
+		std::vector<float> m_NewVelY; //!< The Y velocities of the pixels after this update's forces. Only used during Update().
+		std::vector<float> m_NewPosX; //!< The X positions of the pixels after this update's travel, before wrapping. Only used during Update().
+		std::vector<float> m_NewPosY; //!< The Y positions of the pixels after this update's travel, before wrapping. Only used during Update().
+		std::vector<unsigned char> m_Moved; //!< Whether each pixel moves at least a whole pixel on either axis this update, which keeps it from resting. Only used during Update().
+		std::vector<UpdateResult> m_UpdateResults; //!< What happened to each pixel this update. Only used during Update().
+
+		/// <summary>
+		/// Applies the global acceleration and air resistance to the velocities of a range of pixels, the same as MovableObject::GetVelocityAfterForces() would, into m_NewVelX and m_NewVelY.
+		/// Sets the pixels that end up too fast to travel as Obstructed in m_UpdateResults, and all the others as Traveled.
+		/// </summary>
+		/// <param name="batchStart">The index of the first pixel to process.</param>
+		/// <param name="batchEnd">The index one past the last pixel to process.</param>
+		/// <param name="globalAcc">The global acceleration of the Scene.</param>
+		/// <param name="deltaTime">The sim update time step, in seconds.</param>
+		template <typename Lanes> void ApplyForces(int batchStart, int batchEnd, const Vector &globalAcc, float deltaTime);
+
+		/// <summary>
+		/// Integrates the positions of a range of pixels with their velocities from ApplyForces(), the same as Atom::TravelUnobstructed() would minus the wrapping, into m_NewPosX and m_NewPosY.
+		/// Also does the movement test of MovableObject::RestDetection() into m_Moved.
+		/// </summary>
+		/// <param name="batchStart">The index of the first pixel to process.</param>
+		/// <param name="batchEnd">The index one past the last pixel to process.</param>
+		/// <param name="deltaTime">The sim update time step, in seconds.</param>
+		template <typename Lanes> void Integrate(int batchStart, int batchEnd, float deltaTime);
+
+		/// <summary>
+		/// Writes the stored data of a pixel back to the pixel.
+		/// </summary>
+		/// <param name="index">The index of the pixel to bring up to date.</param>
+		void WriteBack(size_t index) const;
+
+		/// <summary>
+		/// Brings a pixel up to date and takes it out of this ParticleStore by swapping the last pixel into its place.
+		/// </summary>
+		/// <param name="index">The index of the pixel to take out.</param>
+		/// <returns>The pixel taken out. Ownership IS transferred!</returns>
+		MOPixel * Promote(size_t index);
+
+		/// <summary>
+		/// Takes a pixel out of this ParticleStore by swapping the last pixel into its place, without bringing it up to date.
+		/// </summary>
+		/// <param name="index">The index of the pixel to take out.</param>
+		void RemoveAt(size_t index);
+
+		/// <summary>
+		/// Clears all the member variables of this ParticleStore, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+
+		// Disallow the use of some implicit methods.
+		ParticleStore(const ParticleStore &reference) = delete;
+		ParticleStore & operator=(const ParticleStore &rhs) = delete;
+	};
+}
+#endif
@@ -1,16 +1,31 @@
 #include "PathFinder.h"
 #include "Scene.h"
 #include "SceneMan.h"
+#include "SettingsMan.h"
+#include "TimerMan.h"
 
 namespace RTE {
 
+	int PathFinder::s_NextPathRequestTicket = 1;
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void PathFinder::Clear() {
 		m_NodeGrid.clear();
 		m_NodeDimension = 20;
+		m_PatherAllocate = 2000;
 		m_DigStrength = 1;
+		m_PatherDigStrength = 1;
 		m_Pather = 0;
+		m_QueuedPathRequests.clear();
+		m_DispatchedPathRequestBatches.clear();
+		m_PendingPathRequestTickets.clear();
+		m_FinishedPathRequests.clear();
+		m_SnapshotPathers.clear();
+		m_ClusterXCount = 0;
+		m_ClusterYCount = 0;
+		m_HierarchyLayers.clear();
+		m_DirtyNodes.clear();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -19,12 +34,15 @@ namespace RTE {
 		RTEAssert(scene, "Scene doesn't exist or isn't loaded when creating PathFinder!");
 
 		m_NodeDimension = nodeDimension;
+		m_PatherAllocate = allocate;
 		int sceneWidth = g_SceneMan.GetSceneWidth();
 		int sceneHeight = g_SceneMan.GetSceneHeight();
 
 		// Make overlapping nodes at seams if necessary, to make sure all scene pixels are covered
 		int nodeXCount = std::ceil(static_cast<float>(sceneWidth) / static_cast<float>(m_NodeDimension));
 		int nodeYCount = std::ceil(static_cast<float>(sceneHeight) / static_cast<float>(m_NodeDimension));
+		m_ClusterXCount = (nodeXCount + c_ClusterSize - 1) / c_ClusterSize;
+		m_ClusterYCount = (nodeYCount + c_ClusterSize - 1) / c_ClusterSize;
 
 		// Create and assign scene coordinate positions for all nodes
 		PathNode *node = 0;
@@ -40,7 +58,7 @@ namespace RTE {
 				// Make sure no cell centers are off the scene (since they can overlap the far edge of the scene)
 				if (nodePos.m_Y >= sceneHeight) { nodePos.m_Y = sceneHeight - 1; }
 				// Create the new node with its in-scene position in the center of it
-				node = new PathNode(nodePos);
+				node = new PathNode(nodePos, (x * nodeYCount) + y);
 				// Move current position down for the next node in the column
 				nodePos.m_Y += nodeDimension;
 				// Add the newly created node to the column, transferring ownership to it
@@ -85,14 +103,6 @@ namespace RTE {
 		// Create and allocate the pather class which will do the work
 		m_Pather = new MicroPather(this, allocate);
 
-		// If the scene wraps we must find the cost over the seam before doing RecalculateAllCosts() the first time
-		// since the cost is equal to max(node->LeftCost, node->m_Left->RightCost)
-		if (scene->WrapsX()) {
-			for (int y = 0; y < nodeYCount; ++y) {
-				node = m_NodeGrid[0][y];
-				if (node->Left) { node->Left->RightCost = CostAlongLine(node->Pos, node->Left->Pos); }
-			}
-		}
 		// Set up all the costs between all nodes
 		RecalculateAllCosts();
 
@@ -102,6 +112,10 @@ namespace RTE {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	void PathFinder::Destroy() {
+		// The dispatched requests are solving on the nodes, so they have to be done before the nodes can go
+		for (const std::unique_ptr<PathRequestBatch> &batch : m_DispatchedPathRequestBatches) {
+			g_ThreadMan.WaitForJob(batch->Job);
+		}
 		for (unsigned int x = 0; x < m_NodeGrid.size(); ++x) {
 			for (unsigned int y = 0; y < m_NodeGrid[x].size(); ++y) {
 				delete m_NodeGrid[x][y];
@@ -132,33 +146,28 @@ namespace RTE {
 
 		// Actors capable of digging can use m_DigStrength to modify the node adjacency cost
 		m_DigStrength = digStrength;
+		// The pather caches adjacent costs and whole paths, which are only good for the dig strength they were found with
+		if (m_DigStrength != m_PatherDigStrength) {
+			m_Pather->Reset();
+			m_PatherDigStrength = m_DigStrength;
+		}
 
 		// Do the actual pathfinding, fetch out the list of states that comprise the best path
 		std::vector<void *> statePath;
-		int result = m_Pather->Solve(static_cast<void *>(m_NodeGrid[startNodeX][startNodeY]), static_cast<void *>(m_NodeGrid[endNodeX][endNodeY]), &statePath, &totalCostResult);
-
-		// We got something back
-		if (!statePath.empty()) {
-			// Replace the approximate first point from the pathfound path with the exact starting point
-			pathResult.push_back(start);
-			std::vector<void *>::iterator itr = statePath.begin();
-			itr++;
+		int result = MicroPather::NO_SOLUTION;
+		bool solvedHierarchically = false;
+		if (g_SettingsMan.HierarchicalPathfinding() && NodesAreClustersApart(m_NodeGrid[startNodeX][startNodeY], m_NodeGrid[endNodeX][endNodeY])) {
+			result = SolveHierarchical(m_NodeGrid[startNodeX][startNodeY], m_NodeGrid[endNodeX][endNodeY], statePath, totalCostResult);
+			solvedHierarchically = result != MicroPather::NO_SOLUTION;
+		}
+		// Paths between nearby points aren't worth going through the clusters for, and anything the hierarchy couldn't solve gets another go on the node grid
+		if (!solvedHierarchically) {
+			statePath.clear();
+			result = m_Pather->Solve(static_cast<void *>(m_NodeGrid[startNodeX][startNodeY]), static_cast<void *>(m_NodeGrid[endNodeX][endNodeY]), &statePath, &totalCostResult);
+		}
 
-			// Convert from a list of state void pointers to a list of scene position vectors
-			for (; itr != statePath.end(); ++itr) {
-				pathResult.push_back((static_cast<PathNode *>(*itr))->Pos);
-			}
+		ConvertStatePath(start, end, statePath, pathResult);
 
-			// Adjust the last point to be exactly where the end is supposed to be (really?)
-			if (pathResult.size() > 2) {
-				pathResult.pop_back();
-				pathResult.push_back(end);
-			}
-			// Empty path, give exact start and end
-		} else {
-			pathResult.push_back(start);
-			pathResult.push_back(end);
-		}
 		// TODO: Clean up the path, remove series of nodes in the same direction etc?
 		return result;
 	}
@@ -168,30 +177,39 @@ namespace RTE {
 	void PathFinder::RecalculateAllCosts() {
 		RTEAssert(g_SceneMan.GetScene(), "Scene doesn't exist or isn't loaded when recalculating PathFinder!");
 
-		// Update all the costs going out from each node
+		// Everything is about to be recalculated, so nothing needs to wait in the queue anymore
+		m_DirtyNodes.clear();
+
+		// Update all the edge costs owned by each node, which covers every edge exactly once
+		std::vector<PathNode *> changedNodes;
 		for (const std::vector<PathNode *> &nodeEntry : m_NodeGrid) {
 			for (PathNode *pathNode : nodeEntry) {
-				UpdateNodeCosts(pathNode);
-				// Should reset the changed flag since we're about to reset the pather
-				pathNode->IsChanged = false;
+				UpdateNodeCosts(pathNode, changedNodes);
+				pathNode->IsDirty = false;
 			}
 		}
+		// Should reset the changed flag since we're about to reset the pather
+		for (PathNode *changedNode : changedNodes) {
+			changedNode->IsChanged = false;
+		}
 		// Reset the pather when costs change, as per the docs
 		m_Pather->Reset();
+		// Everything changed, so the hierarchy layers are better off made from scratch when next needed
+		m_HierarchyLayers.clear();
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	void PathFinder::RecalculateAreaCosts(const std::deque<Box> &boxList) {
+	void PathFinder::RecalculateAreaCosts(const std::deque<Box> &boxList, float timeBudgetMS) {
+		std::vector<PathNode *> nodesInBoxes;
 		Box box;
-		// Go through all the boxes and see if any of the node centers are inside each
+		// Go through all the boxes and find the nodes owning the edges inside each
 		for (const Box &boxListEntry : boxList) {
 			// Get the current area box and make sure it's unflipped
 			box = boxListEntry;
 			box.Unflip();
 
-			// Do the updates
-			UpdateNodeCostsInBox(box);
+			GetNodesInBox(box, nodesInBoxes);
 
 			// Take care of all wrapping situations of the box
 			if (g_SceneMan.SceneWrapsX()) {
@@ -199,10 +217,10 @@ namespace RTE {
 
 				if (box.m_Corner.m_X < 0) {
 					temp = Box(Vector(box.m_Corner.m_X + g_SceneMan.GetSceneWidth(), box.m_Corner.m_Y), box.m_Width, box.m_Height);
-					UpdateNodeCostsInBox(temp);
+					GetNodesInBox(temp, nodesInBoxes);
 				} else if (box.m_Corner.m_X + box.m_Width > g_SceneMan.GetSceneWidth()) {
 					temp = Box(Vector(box.m_Corner.m_X - g_SceneMan.GetSceneWidth(), box.m_Corner.m_Y), box.m_Width, box.m_Height);
-					UpdateNodeCostsInBox(temp);
+					GetNodesInBox(temp, nodesInBoxes);
 				}
 			}
 			if (g_SceneMan.SceneWrapsY()) {
@@ -210,23 +228,45 @@ namespace RTE {
 
 				if (box.m_Corner.m_Y < 0) {
 					temp = Box(Vector(box.m_Corner.m_X, box.m_Corner.m_Y + g_SceneMan.GetSceneHeight()), box.m_Width, box.m_Height);
-					UpdateNodeCostsInBox(temp);
+					GetNodesInBox(temp, nodesInBoxes);
 				} else if (box.m_Corner.m_Y + box.m_Height > g_SceneMan.GetSceneHeight()) {
 					temp = Box(Vector(box.m_Corner.m_X, box.m_Corner.m_Y - g_SceneMan.GetSceneHeight()), box.m_Width, box.m_Height);
-					UpdateNodeCostsInBox(temp);
+					GetNodesInBox(temp, nodesInBoxes);
 				}
 			}
 		}
 
-		// Reset the pather when costs change, as per the docs
-		m_Pather->Reset();
-
-		// Reset the changed flag on all nodes
-		for (const std::vector<PathNode *> &nodeEntry : m_NodeGrid) {
-			for (PathNode *pathNode : nodeEntry) {
-				pathNode->IsChanged = false;
+		std::vector<PathNode *> changedNodes;
+		if (timeBudgetMS > 0) {
+			for (PathNode *node : nodesInBoxes) {
+				if (!node->IsDirty) {
+					node->IsDirty = true;
+					m_DirtyNodes.push_back(node);
+				}
+			}
+			// Checking the time after every node would cost more than some of the nodes themselves, so they're done a few at a time
+			const int nodesPerTimeCheck = 16;
+			long long endTime = g_TimerMan.GetAbsoluteTime() + static_cast<long long>(timeBudgetMS * 1000.0F);
+			while (!m_DirtyNodes.empty() && g_TimerMan.GetAbsoluteTime() < endTime) {
+				for (int nodeCount = 0; nodeCount < nodesPerTimeCheck && !m_DirtyNodes.empty(); ++nodeCount) {
+					PathNode *node = m_DirtyNodes.front();
+					m_DirtyNodes.pop_front();
+					if (node->IsDirty) {
+						UpdateNodeCosts(node, changedNodes);
+						node->IsDirty = false;
+					}
+				}
+			}
+		} else {
+			// Nodes that are already queued get done now as well if they're in the boxes, they'll be skipped once they come up in the queue
+			std::sort(nodesInBoxes.begin(), nodesInBoxes.end());
+			nodesInBoxes.erase(std::unique(nodesInBoxes.begin(), nodesInBoxes.end()), nodesInBoxes.end());
+			for (PathNode *node : nodesInBoxes) {
+				UpdateNodeCosts(node, changedNodes);
+				node->IsDirty = false;
 			}
 		}
+		InvalidateChangedNodes(changedNodes);
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -239,62 +279,601 @@ namespace RTE {
 
 	void PathFinder::AdjacentCost(void *state, std::vector<micropather::StateCost> *adjacentList) {
 		const PathNode *node = static_cast<PathNode *>(state);
+		float edgeCosts[c_EdgeCount];
+		GetNodeEdgeCosts(node, edgeCosts);
+		AddAdjacentCosts(node, edgeCosts, m_DigStrength, adjacentList);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int PathFinder::RequestPath(Vector start, Vector end, float digStrength, int team) {
+		// Make sure start and end are within scene bounds
+		g_SceneMan.ForceBounds(start);
+		g_SceneMan.ForceBounds(end);
+
+		PathRequest request;
+		request.Ticket = s_NextPathRequestTicket++;
+		request.Start = start;
+		request.End = end;
+		request.StartNode = m_NodeGrid[static_cast<int>(std::floor(start.m_X / static_cast<float>(m_NodeDimension)))][static_cast<int>(std::floor(start.m_Y / static_cast<float>(m_NodeDimension)))];
+		request.EndNode = m_NodeGrid[static_cast<int>(std::floor(end.m_X / static_cast<float>(m_NodeDimension)))][static_cast<int>(std::floor(end.m_Y / static_cast<float>(m_NodeDimension)))];
+		request.DigStrength = digStrength;
+		request.Team = team;
+
+		m_QueuedPathRequests.emplace_back(request);
+		m_PendingPathRequestTickets.emplace(request.Ticket);
+		return request.Ticket;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int PathFinder::TakePathRequestResult(int ticket, std::list<Vector> &pathResult, float &totalCostResult) {
+		std::unordered_map<int, PathRequestResult>::iterator resultItr = m_FinishedPathRequests.find(ticket);
+		if (resultItr == m_FinishedPathRequests.end()) {
+			return c_PathRequestNotDone;
+		}
+		pathResult = std::move(resultItr->second.Path);
+		totalCostResult = resultItr->second.TotalCost;
+		int solveResult = resultItr->second.SolveResult;
+		m_FinishedPathRequests.erase(resultItr);
+		return solveResult;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::CancelPathRequest(int ticket) {
+		// Dispatched requests can't be taken back from the jobs, but without a pending ticket their results are dropped when collected
+		if (m_PendingPathRequestTickets.erase(ticket) > 0) {
+			m_QueuedPathRequests.erase(std::remove_if(m_QueuedPathRequests.begin(), m_QueuedPathRequests.end(), [ticket](const PathRequest &request) { return request.Ticket == ticket; }), m_QueuedPathRequests.end());
+		}
+		m_FinishedPathRequests.erase(ticket);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::vector<int> PathFinder::GetQueuedPathRequestTeams() const {
+		std::vector<int> teams;
+		for (const PathRequest &request : m_QueuedPathRequests) {
+			if (std::find(teams.begin(), teams.end(), request.Team) == teams.end()) { teams.emplace_back(request.Team); }
+		}
+		std::sort(teams.begin(), teams.end());
+		return teams;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int PathFinder::DispatchPathRequests(int team, int maxSolves) {
+		std::vector<std::unique_ptr<PathRequestBatch>> newBatches;
+		int solveCount = 0;
+
+		for (std::deque<PathRequest>::iterator requestItr = m_QueuedPathRequests.begin(); requestItr != m_QueuedPathRequests.end();) {
+			if (requestItr->Team != team) {
+				++requestItr;
+				continue;
+			}
+			std::vector<std::unique_ptr<PathRequestBatch>>::iterator batchItr = std::find_if(newBatches.begin(), newBatches.end(), [&requestItr](const std::unique_ptr<PathRequestBatch> &batch) {
+				return batch->Requests.front().EndNode == requestItr->EndNode && batch->Requests.front().DigStrength == requestItr->DigStrength;
+			});
+			// Requests starting from the same node as one already in the batch get its solve for free, so they don't count against the budget
+			bool sharesSolve = batchItr != newBatches.end() && std::any_of((*batchItr)->Requests.begin(), (*batchItr)->Requests.end(), [&requestItr](const PathRequest &request) { return request.StartNode == requestItr->StartNode; });
+			if (!sharesSolve) {
+				if (maxSolves > 0 && solveCount >= maxSolves) {
+					++requestItr;
+					continue;
+				}
+				++solveCount;
+			}
+			if (batchItr == newBatches.end()) {
+				newBatches.emplace_back(std::make_unique<PathRequestBatch>());
+				batchItr = newBatches.end() - 1;
+			}
+			(*batchItr)->Requests.emplace_back(*requestItr);
+			requestItr = m_QueuedPathRequests.erase(requestItr);
+		}
+		if (newBatches.empty()) {
+			return 0;
+		}
+
+		// Copy the costs as they are right now, so they can keep changing while the jobs solve on them
+		std::shared_ptr<std::vector<float>> edgeCosts = std::make_shared<std::vector<float>>(m_NodeGrid.size() * m_NodeGrid[0].size() * c_EdgeCount);
+		for (const std::vector<PathNode *> &nodeColumn : m_NodeGrid) {
+			for (const PathNode *node : nodeColumn) {
+				GetNodeEdgeCosts(node, &(*edgeCosts)[node->Index * c_EdgeCount]);
+			}
+		}
+
+		// The pathers are made up front so the jobs never have to touch the list
+		while (m_SnapshotPathers.size() < static_cast<size_t>(g_ThreadMan.GetWorkerCount() + 1)) {
+			m_SnapshotPathers.emplace_back(std::make_unique<SnapshotPather>());
+			m_SnapshotPathers.back()->Pather = std::make_unique<MicroPather>(&m_SnapshotPathers.back()->Graph, m_PatherAllocate);
+		}
+		for (std::unique_ptr<PathRequestBatch> &batch : newBatches) {
+			batch->EdgeCosts = edgeCosts;
+			PathRequestBatch *batchToSolve = batch.get();
+			batch->Job = g_ThreadMan.AddJob([this, batchToSolve]() { SolvePathRequestBatch(*batchToSolve); });
+			m_DispatchedPathRequestBatches.emplace_back(std::move(batch));
+		}
+		return solveCount;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::CollectPathRequests() {
+		for (const std::unique_ptr<PathRequestBatch> &batch : m_DispatchedPathRequestBatches) {
+			g_ThreadMan.WaitForJob(batch->Job);
+			for (size_t requestIndex = 0; requestIndex < batch->Requests.size(); ++requestIndex) {
+				// Cancelled requests are no longer pending, so they're just dropped
+				if (m_PendingPathRequestTickets.erase(batch->Requests[requestIndex].Ticket) > 0) { m_FinishedPathRequests.emplace(batch->Requests[requestIndex].Ticket, std::move(batch->Results[requestIndex])); }
+			}
+		}
+		m_DispatchedPathRequestBatches.clear();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	float PathFinder::SnapshotGraph::LeastCostEstimate(void *startState, void *endState) {
+		return g_SceneMan.ShortestDistance((static_cast<PathNode *>(startState))->Pos, (static_cast<PathNode *>(endState))->Pos).GetMagnitude();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::SnapshotGraph::AdjacentCost(void *state, std::vector<micropather::StateCost> *adjacentList) {
+		const PathNode *node = static_cast<PathNode *>(state);
+		AddAdjacentCosts(node, &(*EdgeCosts)[node->Index * c_EdgeCount], DigStrength, adjacentList);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::GetNodeEdgeCosts(const PathNode *node, float *edgeCosts) {
+		edgeCosts[0] = node->UpCost;
+		edgeCosts[1] = node->RightCost;
+		edgeCosts[2] = node->DownCost;
+		edgeCosts[3] = node->LeftCost;
+		edgeCosts[4] = node->UpRightCost;
+		edgeCosts[5] = node->RightDownCost;
+		edgeCosts[6] = node->DownLeftCost;
+		edgeCosts[7] = node->LeftUpCost;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::AddAdjacentCosts(const PathNode *node, const float *edgeCosts, float digStrength, std::vector<micropather::StateCost> *adjacentList) {
 		micropather::StateCost adjCost;
 		float strength = 0.0F;
 
 		// Add cost for digging upwards
 		if (node->Up) {
-			strength = node->UpCost;
-			adjCost.cost = 1.0F + ((strength > m_DigStrength) ? strength * 2000.0F : strength * 4.0F); // Four times more expensive when digging
+			strength = edgeCosts[0];
+			adjCost.cost = 1.0F + ((strength > digStrength) ? strength * 2000.0F : strength * 4.0F); // Four times more expensive when digging
 			adjCost.state = static_cast<void *>(node->Up);
 			adjacentList->push_back(adjCost);
 		}
 		if (node->Right) {
-			strength = node->RightCost;
-			adjCost.cost = 1.0F + ((strength > m_DigStrength) ? strength * 1000.0F : strength);
+			strength = edgeCosts[1];
+			adjCost.cost = 1.0F + ((strength > digStrength) ? strength * 1000.0F : strength);
 			adjCost.state = static_cast<void *>(node->Right);
 			adjacentList->push_back(adjCost);
 		}
 		if (node->Down) {
-			strength = node->DownCost;
-			adjCost.cost = 1.0F + ((strength > m_DigStrength) ? strength * 1000.0F : strength);
+			strength = edgeCosts[2];
+			adjCost.cost = 1.0F + ((strength > digStrength) ? strength * 1000.0F : strength);
 			adjCost.state = static_cast<void *>(node->Down);
 			adjacentList->push_back(adjCost);
 		}
 		if (node->Left) {
-			strength = node->LeftCost;
-			adjCost.cost = 1.0F + ((strength > m_DigStrength) ? strength * 1000.0F : strength);
+			strength = edgeCosts[3];
+			adjCost.cost = 1.0F + ((strength > digStrength) ? strength * 1000.0F : strength);
 			adjCost.state = static_cast<void *>(node->Left);
 			adjacentList->push_back(adjCost);
 		}
 
 		// Add cost for digging at 45 degrees and for digging upwards
 		if (node->UpRight) {
-			strength = node->UpRightCost;
-			adjCost.cost = 1.4F + ((strength > m_DigStrength) ? strength * 2828.0F : strength * 4.2F);  // Three times more expensive when digging
+			strength = edgeCosts[4];
+			adjCost.cost = 1.4F + ((strength > digStrength) ? strength * 2828.0F : strength * 4.2F);  // Three times more expensive when digging
 			adjCost.state = static_cast<void *>(node->UpRight);
 			adjacentList->push_back(adjCost);
 		}
 		if (node->RightDown) {
-			strength = node->RightDownCost;
-			adjCost.cost = 1.4F + ((strength > m_DigStrength) ? strength * 1414.0F : strength * 1.4F);
+			strength = edgeCosts[5];
+			adjCost.cost = 1.4F + ((strength > digStrength) ? strength * 1414.0F : strength * 1.4F);
 			adjCost.state = static_cast<void *>(node->RightDown);
 			adjacentList->push_back(adjCost);
 		}
 		if (node->DownLeft) {
-			strength = node->DownLeftCost;
-			adjCost.cost = 1.4F + ((strength > m_DigStrength) ? strength * 1414.0F : strength * 1.4F);
+			strength = edgeCosts[6];
+			adjCost.cost = 1.4F + ((strength > digStrength) ? strength * 1414.0F : strength * 1.4F);
 			adjCost.state = static_cast<void *>(node->DownLeft);
 			adjacentList->push_back(adjCost);
 		}
 		if (node->LeftUp) {
-			strength = node->LeftUpCost;
-			adjCost.cost = 1.4F + ((strength > m_DigStrength) ? strength * 2828.0F : strength * 4.2F);  // Three times more expensive when digging
+			strength = edgeCosts[7];
+			adjCost.cost = 1.4F + ((strength > digStrength) ? strength * 2828.0F : strength * 4.2F);  // Three times more expensive when digging
 			adjCost.state = static_cast<void *>(node->LeftUp);
 			adjacentList->push_back(adjCost);
 		}
 	}
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::ConvertStatePath(const Vector &start, const Vector &end, const std::vector<void *> &statePath, std::list<Vector> &pathResult) {
+		pathResult.clear();
+
+		// We got something back
+		if (!statePath.empty()) {
+			// Replace the approximate first point from the pathfound path with the exact starting point
+			pathResult.push_back(start);
+			std::vector<void *>::const_iterator itr = statePath.begin();
+			itr++;
+
+			// Convert from a list of state void pointers to a list of scene position vectors
+			for (; itr != statePath.end(); ++itr) {
+				pathResult.push_back((static_cast<PathNode *>(*itr))->Pos);
+			}
+
+			// Adjust the last point to be exactly where the end is supposed to be (really?)
+			if (pathResult.size() > 2) {
+				pathResult.pop_back();
+				pathResult.push_back(end);
+			}
+			// Empty path, give exact start and end
+		} else {
+			pathResult.push_back(start);
+			pathResult.push_back(end);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::SolvePathRequestBatch(PathRequestBatch &batch) {
+		// Any thread ThreadMan doesn't own would share index 0, and with it the main thread's pather
+		RTEAssert(g_ThreadMan.CurrentThreadOwnsIndex(), "Trying to solve path requests on a thread that isn't owned by ThreadMan or the main thread!");
+		SnapshotPather &snapshotPather = *m_SnapshotPathers[g_ThreadMan.GetCurrentThreadIndex()];
+		snapshotPather.Graph.EdgeCosts = batch.EdgeCosts.get();
+		snapshotPather.Graph.DigStrength = batch.Requests.front().DigStrength;
+		// Whatever is cached is from other costs or dig strengths, but from here on the cache is shared by the whole batch
+		snapshotPather.Pather->Reset();
+
+		// The node paths solved so far, along with the index of the request they were solved for, so requests starting from the same node can share them
+		std::vector<std::pair<size_t, std::vector<void *>>> solvedStatePaths;
+		batch.Results.resize(batch.Requests.size());
+		for (size_t requestIndex = 0; requestIndex < batch.Requests.size(); ++requestIndex) {
+			const PathRequest &request = batch.Requests[requestIndex];
+			PathRequestResult &result = batch.Results[requestIndex];
+
+			std::vector<std::pair<size_t, std::vector<void *>>>::iterator solvedItr = std::find_if(solvedStatePaths.begin(), solvedStatePaths.end(), [&batch, &request](const std::pair<size_t, std::vector<void *>> &solvedStatePath) { return batch.Requests[solvedStatePath.first].StartNode == request.StartNode; });
+			if (solvedItr != solvedStatePaths.end()) {
+				result.SolveResult = batch.Results[solvedItr->first].SolveResult;
+				result.TotalCost = batch.Results[solvedItr->first].TotalCost;
+			} else {
+				solvedStatePaths.emplace_back(requestIndex, std::vector<void *>());
+				solvedItr = solvedStatePaths.end() - 1;
+				result.SolveResult = snapshotPather.Pather->Solve(static_cast<void *>(request.StartNode), static_cast<void *>(request.EndNode), &solvedItr->second, &result.TotalCost);
+			}
+			ConvertStatePath(request.Start, request.End, solvedItr->second, result.Path);
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	float PathFinder::HierarchyLayer::LeastCostEstimate(void *startState, void *endState) {
+		return g_SceneMan.ShortestDistance((static_cast<HierarchyState *>(startState))->Node->Pos, (static_cast<HierarchyState *>(endState))->Node->Pos).GetMagnitude();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::HierarchyLayer::AdjacentCost(void *state, std::vector<micropather::StateCost> *adjacentList) {
+		const std::vector<micropather::StateCost> &adjacentStates = static_cast<HierarchyState *>(state)->Adjacent;
+		adjacentList->insert(adjacentList->end(), adjacentStates.begin(), adjacentStates.end());
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int PathFinder::GetNodeCluster(const PathNode *node) const {
+		int nodeYCount = static_cast<int>(m_NodeGrid[0].size());
+		return ((node->Index / nodeYCount) / c_ClusterSize) * m_ClusterYCount + ((node->Index % nodeYCount) / c_ClusterSize);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int PathFinder::GetNodeClusterIndex(const PathNode *node) const {
+		int nodeYCount = static_cast<int>(m_NodeGrid[0].size());
+		int nodeX = node->Index / nodeYCount;
+		int nodeY = node->Index % nodeYCount;
+		int firstY = (nodeY / c_ClusterSize) * c_ClusterSize;
+		int clusterHeight = std::min(firstY + c_ClusterSize, nodeYCount) - firstY;
+		return ((nodeX % c_ClusterSize) * clusterHeight) + (nodeY - firstY);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool PathFinder::NodesAreClustersApart(const PathNode *startNode, const PathNode *endNode) const {
+		int startCluster = GetNodeCluster(startNode);
+		int endCluster = GetNodeCluster(endNode);
+		return std::abs((startCluster / m_ClusterYCount) - (endCluster / m_ClusterYCount)) > 1 || std::abs((startCluster % m_ClusterYCount) - (endCluster % m_ClusterYCount)) > 1;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int PathFinder::SolveHierarchical(PathNode *startNode, PathNode *endNode, std::vector<void *> &statePath, float &totalCostResult) {
+		HierarchyLayer &layer = GetHierarchyLayer(m_DigStrength);
+
+		// The start isn't necessarily a portal, so it gets a state of its own connected to all the portals of its cluster
+		std::unique_ptr<HierarchyState> &startState = layer.StartStates[startNode];
+		if (!startState) {
+			startState = std::make_unique<HierarchyState>();
+			startState->Node = startNode;
+			startState->Cluster = GetNodeCluster(startNode);
+			startState->Partner = nullptr;
+			std::vector<float> clusterCosts;
+			CalculateClusterCosts(startNode, layer.DigStrength, clusterCosts);
+			for (HierarchyState *portal : GetClusterPortals(layer, startState->Cluster)) {
+				float portalCost = clusterCosts[GetNodeClusterIndex(portal->Node)];
+				if (portalCost < FLT_MAX) { startState->Adjacent.push_back({ static_cast<void *>(portal), portalCost }); }
+			}
+		}
+		std::vector<void *> layerPath;
+		float layerCost = 0;
+		if (layer.Pather->Solve(static_cast<void *>(startState.get()), static_cast<void *>(&layer.ClusterSinks[GetNodeCluster(endNode)]), &layerPath, &layerCost) == MicroPather::NO_SOLUTION) {
+			return MicroPather::NO_SOLUTION;
+		}
+
+		// Refine the path on the node grid between each of the portals along it, ending at the actual end instead of the sink of its cluster
+		std::vector<PathNode *> portalNodes;
+		for (size_t stateIndex = 1; stateIndex + 1 < layerPath.size(); ++stateIndex) {
+			portalNodes.push_back(static_cast<HierarchyState *>(layerPath[stateIndex])->Node);
+		}
+		portalNodes.push_back(endNode);
+
+		statePath.clear();
+		statePath.push_back(static_cast<void *>(startNode));
+		totalCostResult = 0;
+		std::vector<void *> segmentPath;
+		float segmentCost = 0;
+		for (PathNode *portalNode : portalNodes) {
+			if (static_cast<void *>(portalNode) == statePath.back()) {
+				continue;
+			}
+			if (m_Pather->Solve(statePath.back(), static_cast<void *>(portalNode), &segmentPath, &segmentCost) == MicroPather::NO_SOLUTION) {
+				return MicroPather::NO_SOLUTION;
+			}
+			statePath.insert(statePath.end(), segmentPath.begin() + 1, segmentPath.end());
+			totalCostResult += segmentCost;
+		}
+		return MicroPather::SOLVED;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	PathFinder::HierarchyLayer & PathFinder::GetHierarchyLayer(float digStrength) {
+		std::vector<std::unique_ptr<HierarchyLayer>>::iterator layerItr = std::find_if(m_HierarchyLayers.begin(), m_HierarchyLayers.end(), [digStrength](const std::unique_ptr<HierarchyLayer> &layer) { return layer->DigStrength == digStrength; });
+		if (layerItr != m_HierarchyLayers.end()) {
+			// Keep the most recently used layer at the back, so the one evicted is the one used least recently
+			std::rotate(layerItr, layerItr + 1, m_HierarchyLayers.end());
+		} else {
+			if (m_HierarchyLayers.size() >= c_MaxHierarchyLayers) { m_HierarchyLayers.erase(m_HierarchyLayers.begin()); }
+
+			int clusterCount = m_ClusterXCount * m_ClusterYCount;
+			std::unique_ptr<HierarchyLayer> newLayer = std::make_unique<HierarchyLayer>();
+			newLayer->DigStrength = digStrength;
+			newLayer->BorderPortals.resize(clusterCount * 2);
+			newLayer->ClusterSinks.resize(clusterCount);
+			int nodeXCount = static_cast<int>(m_NodeGrid.size());
+			int nodeYCount = static_cast<int>(m_NodeGrid[0].size());
+			for (int cluster = 0; cluster < clusterCount; ++cluster) {
+				int firstX = (cluster / m_ClusterYCount) * c_ClusterSize;
+				int firstY = (cluster % m_ClusterYCount) * c_ClusterSize;
+				HierarchyState &sink = newLayer->ClusterSinks[cluster];
+				sink.Node = m_NodeGrid[(firstX + std::min(firstX + c_ClusterSize, nodeXCount)) / 2][(firstY + std::min(firstY + c_ClusterSize, nodeYCount)) / 2];
+				sink.Cluster = cluster;
+				sink.Partner = nullptr;
+			}
+			newLayer->DirtyClusters.assign(clusterCount, true);
+			newLayer->Pather = std::make_unique<MicroPather>(newLayer.get(), std::max(clusterCount * 2, 250));
+			m_HierarchyLayers.emplace_back(std::move(newLayer));
+		}
+		UpdateHierarchyLayer(*m_HierarchyLayers.back());
+		return *m_HierarchyLayers.back();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::UpdateHierarchyLayer(HierarchyLayer &layer) {
+		if (std::find(layer.DirtyClusters.begin(), layer.DirtyClusters.end(), true) == layer.DirtyClusters.end()) {
+			return;
+		}
+		int nodeXCount = static_cast<int>(m_NodeGrid.size());
+		int nodeYCount = static_cast<int>(m_NodeGrid[0].size());
+		int clusterCount = m_ClusterXCount * m_ClusterYCount;
+
+		// Portals on a border belong to the clusters on both sides, so both need their costs updated if either changed
+		std::vector<bool> clustersToUpdate = layer.DirtyClusters;
+		for (int cluster = 0; cluster < clusterCount; ++cluster) {
+			int lastX = std::min(((cluster / m_ClusterYCount) + 1) * c_ClusterSize, nodeXCount) - 1;
+			int lastY = std::min(((cluster % m_ClusterYCount) + 1) * c_ClusterSize, nodeYCount) - 1;
+			for (const PathNode *acrossNode : { m_NodeGrid[lastX][lastY]->Right, m_NodeGrid[lastX][lastY]->Down }) {
+				if (!acrossNode) {
+					continue;
+				}
+				int acrossCluster = GetNodeCluster(acrossNode);
+				if (layer.DirtyClusters[cluster] || layer.DirtyClusters[acrossCluster]) {
+					MakeBorderPortals(layer, cluster, acrossNode == m_NodeGrid[lastX][lastY]->Down);
+					clustersToUpdate[cluster] = true;
+					clustersToUpdate[acrossCluster] = true;
+				}
+			}
+		}
+		for (int cluster = 0; cluster < clusterCount; ++cluster) {
+			if (clustersToUpdate[cluster]) { UpdateClusterPortalCosts(layer, cluster); }
+		}
+		std::fill(layer.DirtyClusters.begin(), layer.DirtyClusters.end(), false);
+
+		// The start states are connected to portals that may be gone now, and the cache has paths through them, so both have to go
+		layer.StartStates.clear();
+		layer.Pather->Reset();
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::MakeBorderPortals(HierarchyLayer &layer, int cluster, bool southBorder) {
+		int nodeXCount = static_cast<int>(m_NodeGrid.size());
+		int nodeYCount = static_cast<int>(m_NodeGrid[0].size());
+		int firstX = (cluster / m_ClusterYCount) * c_ClusterSize;
+		int firstY = (cluster % m_ClusterYCount) * c_ClusterSize;
+		int lastX = std::min(firstX + c_ClusterSize, nodeXCount) - 1;
+		int lastY = std::min(firstY + c_ClusterSize, nodeYCount) - 1;
+
+		std::vector<std::unique_ptr<HierarchyState>> &borderPortals = layer.BorderPortals[(cluster * 2) + (southBorder ? 1 : 0)];
+		borderPortals.clear();
+
+		// The nodes along the border on this side, and the strength of the material between each of them and the node across
+		std::vector<PathNode *> borderNodes;
+		std::vector<float> crossingStrengths;
+		for (int borderStep = 0; borderStep <= (southBorder ? lastX - firstX : lastY - firstY); ++borderStep) {
+			PathNode *borderNode = southBorder ? m_NodeGrid[firstX + borderStep][lastY] : m_NodeGrid[lastX][firstY + borderStep];
+			borderNodes.push_back(borderNode);
+			crossingStrengths.push_back(southBorder ? borderNode->DownCost : borderNode->RightCost);
+		}
+		PathNode *firstAcrossNode = southBorder ? borderNodes.front()->Down : borderNodes.front()->Right;
+		if (!firstAcrossNode || GetNodeCluster(firstAcrossNode) == cluster) {
+			return;
+		}
+
+		std::vector<size_t> portalCrossings;
+		size_t cheapestCrossing = 0;
+		size_t stretchStart = 0;
+		bool inStretch = false;
+		for (size_t crossing = 0; crossing <= borderNodes.size(); ++crossing) {
+			bool needsDigging = crossing == borderNodes.size() || crossingStrengths[crossing] > layer.DigStrength;
+			if (crossing < borderNodes.size() && crossingStrengths[crossing] < crossingStrengths[cheapestCrossing]) { cheapestCrossing = crossing; }
+			if (!needsDigging && !inStretch) {
+				stretchStart = crossing;
+				inStretch = true;
+			} else if (needsDigging && inStretch) {
+				portalCrossings.push_back((stretchStart + crossing - 1) / 2);
+				inStretch = false;
+			}
+		}
+		// Walled off borders still get a portal so paths can dig through, otherwise the layer would have no way through where the node grid does
+		if (portalCrossings.empty()) { portalCrossings.push_back(cheapestCrossing); }
+
+		for (size_t crossing : portalCrossings) {
+			std::unique_ptr<HierarchyState> insidePortal = std::make_unique<HierarchyState>();
+			std::unique_ptr<HierarchyState> acrossPortal = std::make_unique<HierarchyState>();
+			insidePortal->Node = borderNodes[crossing];
+			insidePortal->Cluster = cluster;
+			insidePortal->Partner = acrossPortal.get();
+			acrossPortal->Node = southBorder ? borderNodes[crossing]->Down : borderNodes[crossing]->Right;
+			acrossPortal->Cluster = GetNodeCluster(acrossPortal->Node);
+			acrossPortal->Partner = insidePortal.get();
+			borderPortals.emplace_back(std::move(insidePortal));
+			borderPortals.emplace_back(std::move(acrossPortal));
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::UpdateClusterPortalCosts(HierarchyLayer &layer, int cluster) {
+		std::vector<HierarchyState *> clusterPortals = GetClusterPortals(layer, cluster);
+		HierarchyState &clusterSink = layer.ClusterSinks[cluster];
+		int sinkIndex = GetNodeClusterIndex(clusterSink.Node);
+
+		std::vector<float> clusterCosts;
+		for (HierarchyState *portal : clusterPortals) {
+			portal->Adjacent.clear();
+			CalculateClusterCosts(portal->Node, layer.DigStrength, clusterCosts);
+			for (HierarchyState *otherPortal : clusterPortals) {
+				float otherPortalCost = clusterCosts[GetNodeClusterIndex(otherPortal->Node)];
+				if (otherPortal != portal && otherPortalCost < FLT_MAX) { portal->Adjacent.push_back({ static_cast<void *>(otherPortal), otherPortalCost }); }
+			}
+			if (clusterCosts[sinkIndex] < FLT_MAX) { portal->Adjacent.push_back({ static_cast<void *>(&clusterSink), clusterCosts[sinkIndex] }); }
+
+			float crossingCost = GetStepCost(portal->Node, portal->Partner->Node, layer.DigStrength);
+			if (crossingCost < FLT_MAX) { portal->Adjacent.push_back({ static_cast<void *>(portal->Partner), crossingCost }); }
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	std::vector<PathFinder::HierarchyState *> PathFinder::GetClusterPortals(HierarchyLayer &layer, int cluster) const {
+		const PathNode *firstNode = m_NodeGrid[(cluster / m_ClusterYCount) * c_ClusterSize][(cluster % m_ClusterYCount) * c_ClusterSize];
+
+		// Portals are kept with the cluster owning the east or south side of the border, so the west and north borders are the neighbors'
+		std::vector<int> borders = { cluster * 2, (cluster * 2) + 1 };
+		if (firstNode->Left) { borders.push_back(GetNodeCluster(firstNode->Left) * 2); }
+		if (firstNode->Up) { borders.push_back((GetNodeCluster(firstNode->Up) * 2) + 1); }
+		std::sort(borders.begin(), borders.end());
+		borders.erase(std::unique(borders.begin(), borders.end()), borders.end());
+
+		std::vector<HierarchyState *> clusterPortals;
+		for (int border : borders) {
+			for (const std::unique_ptr<HierarchyState> &portal : layer.BorderPortals[border]) {
+				if (portal->Cluster == cluster) { clusterPortals.push_back(portal.get()); }
+			}
+		}
+		return clusterPortals;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::CalculateClusterCosts(const PathNode *sourceNode, float digStrength, std::vector<float> &clusterCosts) const {
+		int nodeXCount = static_cast<int>(m_NodeGrid.size());
+		int nodeYCount = static_cast<int>(m_NodeGrid[0].size());
+		int cluster = GetNodeCluster(sourceNode);
+		int firstX = (cluster / m_ClusterYCount) * c_ClusterSize;
+		int firstY = (cluster % m_ClusterYCount) * c_ClusterSize;
+		int clusterWidth = std::min(firstX + c_ClusterSize, nodeXCount) - firstX;
+		int clusterHeight = std::min(firstY + c_ClusterSize, nodeYCount) - firstY;
+
+		clusterCosts.assign(clusterWidth * clusterHeight, FLT_MAX);
+		clusterCosts[GetNodeClusterIndex(sourceNode)] = 0;
+
+		// Plain Dijkstra, the clusters are small enough that a heuristic wouldn't save much
+		using OpenEntry = std::pair<float, int>;
+		std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openNodes;
+		openNodes.emplace(0.0F, GetNodeClusterIndex(sourceNode));
+		std::vector<micropather::StateCost> adjacentCosts;
+		float edgeCosts[c_EdgeCount];
+		while (!openNodes.empty()) {
+			OpenEntry openEntry = openNodes.top();
+			openNodes.pop();
+			if (openEntry.first > clusterCosts[openEntry.second]) {
+				continue;
+			}
+			const PathNode *node = m_NodeGrid[firstX + (openEntry.second / clusterHeight)][firstY + (openEntry.second % clusterHeight)];
+			adjacentCosts.clear();
+			GetNodeEdgeCosts(node, edgeCosts);
+			AddAdjacentCosts(node, edgeCosts, digStrength, &adjacentCosts);
+			for (const micropather::StateCost &adjacentCost : adjacentCosts) {
+				const PathNode *adjacentNode = static_cast<PathNode *>(adjacentCost.state);
+				if (GetNodeCluster(adjacentNode) != cluster) {
+					continue;
+				}
+				int adjacentIndex = GetNodeClusterIndex(adjacentNode);
+				float adjacentTotalCost = openEntry.first + adjacentCost.cost;
+				if (adjacentTotalCost < clusterCosts[adjacentIndex]) {
+					clusterCosts[adjacentIndex] = adjacentTotalCost;
+					openNodes.emplace(adjacentTotalCost, adjacentIndex);
+				}
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	float PathFinder::GetStepCost(const PathNode *fromNode, const PathNode *toNode, float digStrength) {
+		float edgeCosts[c_EdgeCount];
+		GetNodeEdgeCosts(fromNode, edgeCosts);
+		std::vector<micropather::StateCost> adjacentCosts;
+		AddAdjacentCosts(fromNode, edgeCosts, digStrength, &adjacentCosts);
+		for (const micropather::StateCost &adjacentCost : adjacentCosts) {
+			if (adjacentCost.state == static_cast<const void *>(toNode)) {
+				return adjacentCost.cost;
+			}
+		}
+		return FLT_MAX;
+	}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	float PathFinder::CostAlongLine(const Vector &start, const Vector &end) {
@@ -303,50 +882,88 @@ namespace RTE {
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	void PathFinder::UpdateNodeCosts(PathNode *node) {
+	void PathFinder::UpdateNodeCosts(PathNode *node, std::vector<PathNode *> &changedNodes) {
 		if (!node) {
 			return;
 		}
-		// Look at each existing adjacent node and calculate the cost for each, offset start and end to cover more terrain
-		if (node->Up) { node->UpCost = std::max(node->Up->DownCost, CostAlongLine(node->Pos + Vector(3, 0), node->Up->Pos + Vector(3, 0))); }
-		if (node->Right) { node->RightCost = CostAlongLine(node->Pos + Vector(0, 3), node->Right->Pos + Vector(0, 3)); }
-		if (node->Down) { node->DownCost = CostAlongLine(node->Pos + Vector(-3, 0), node->Down->Pos + Vector(-3, 0)); }
-		if (node->Left) { node->LeftCost = std::max(node->Left->RightCost, CostAlongLine(node->Pos + Vector(0, -3), node->Left->Pos + Vector(0, -3))); }
+		// Look at each owned edge and calculate the cost for it, offset start and end to cover more terrain. The edges going Up, Left, LeftUp and DownLeft are owned by the nodes at their other ends.
+		if (node->Right) { UpdateEdgeCost(node, node->Right, node->RightCost, node->Right->LeftCost, Vector(0, 3), changedNodes); }
+		if (node->Down) { UpdateEdgeCost(node, node->Down, node->DownCost, node->Down->UpCost, Vector(-3, 0), changedNodes); }
+		if (node->RightDown) { UpdateEdgeCost(node, node->RightDown, node->RightDownCost, node->RightDown->LeftUpCost, Vector(2, -2), changedNodes); }
+		if (node->UpRight) { UpdateEdgeCost(node, node->UpRight, node->UpRightCost, node->UpRight->DownLeftCost, Vector(2, 2), changedNodes); }
+	}
 
-		if (node->UpRight) { node->UpRightCost = std::max(node->UpRight->DownLeftCost, CostAlongLine(node->Pos + Vector(2, 2), node->UpRight->Pos + Vector(2, 2))); }
-		if (node->RightDown) { node->RightDownCost = CostAlongLine(node->Pos + Vector(2, -2), node->RightDown->Pos + Vector(2, -2)); }
-		if (node->DownLeft) { node->DownLeftCost = CostAlongLine(node->Pos + Vector(-2, -2), node->DownLeft->Pos + Vector(-2, -2)); }
-		if (node->LeftUp) { node->LeftUpCost = std::max(node->LeftUp->RightDownCost, CostAlongLine(node->Pos + Vector(-2, 2), node->LeftUp->Pos + Vector(-2, 2))); }
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-		// Mark this as already changed so the above expensive calculation isn't done redundantly
-		node->IsChanged = true;
+	void PathFinder::UpdateEdgeCost(PathNode *node, PathNode *adjacentNode, float &cost, float &adjacentCost, const Vector &rayOffset, std::vector<PathNode *> &changedNodes) {
+		float newCost = std::max(CostAlongLine(node->Pos + rayOffset, adjacentNode->Pos + rayOffset), CostAlongLine(adjacentNode->Pos - rayOffset, node->Pos - rayOffset));
+		if (newCost != cost || newCost != adjacentCost) {
+			cost = newCost;
+			adjacentCost = newCost;
+			for (PathNode *edgeNode : { node, adjacentNode }) {
+				if (!edgeNode->IsChanged) {
+					edgeNode->IsChanged = true;
+					changedNodes.push_back(edgeNode);
+				}
+			}
+		}
 	}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	void PathFinder::UpdateNodeCostsInBox(Box &box) {
+	void PathFinder::GetNodesInBox(Box &box, std::vector<PathNode *> &nodesInBox) {
 		box.Unflip();
 
+		int nodeXCount = m_NodeGrid.size();
+		int nodeYCount = m_NodeGrid[0].size();
+
 		// Get the extents of the box' potential influence on nodes and their connecting edges
 		int firstX = std::floor((box.m_Corner.m_X / static_cast<float>(m_NodeDimension)) + 0.5F) - 1;
 		int lastX = std::floor(((box.m_Corner.m_X + box.m_Width) / static_cast<float>(m_NodeDimension)) + 0.5F) + 1;
 		int firstY = std::floor((box.m_Corner.m_Y / static_cast<float>(m_NodeDimension)) + 0.5F) - 1;
 		int lastY = std::floor(((box.m_Corner.m_Y + box.m_Height) / static_cast<float>(m_NodeDimension)) + 0.5F) + 1;
 
-		// Truncate the influence
-		if (firstX < 0) { firstX = 0; }
-		if (lastX >= m_NodeGrid.size()) { lastX = m_NodeGrid.size() - 1; }
-		if (firstY < 0) { firstY = 0; }
-		if (lastY >= m_NodeGrid[0].size()) { lastY = m_NodeGrid[0].size() - 1; }
+		// Wrap the influence around if the scene wraps, since the edges over the seam are owned by the nodes on the far side, otherwise truncate it
+		if (g_SceneMan.SceneWrapsX()) {
+			lastX = std::min(lastX, firstX + nodeXCount - 1);
+		} else {
+			firstX = std::max(firstX, 0);
+			lastX = std::min(lastX, nodeXCount - 1);
+		}
+		if (g_SceneMan.SceneWrapsY()) {
+			lastY = std::min(lastY, firstY + nodeYCount - 1);
+		} else {
+			firstY = std::max(firstY, 0);
+			lastY = std::min(lastY, nodeYCount - 1);
+		}
 
 		// Only iterate through the grid where the box overlaps any edges
-		PathNode *node = 0;
 		for (int nodeX = firstX; nodeX <= lastX; ++nodeX) {
 			for (int nodeY = firstY; nodeY <= lastY; ++nodeY) {
-				node = m_NodeGrid[nodeX][nodeY];
-				// Update all the costs going out from each node which is found to be affected by the box
-				if (!node->IsChanged) { UpdateNodeCosts(node); }
+				nodesInBox.push_back(m_NodeGrid[(nodeX + nodeXCount) % nodeXCount][(nodeY + nodeYCount) % nodeYCount]);
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void PathFinder::InvalidateChangedNodes(const std::vector<PathNode *> &changedNodes) {
+		if (changedNodes.empty()) {
+			return;
+		}
+		// Only the paths going through the changed nodes are thrown out of the pather's cache, instead of resetting all of it
+		std::vector<void *> changedStates(changedNodes.begin(), changedNodes.end());
+		m_Pather->StatesChanged(changedStates.data(), changedStates.size());
+
+		// Reset the changed flag on the nodes, marking their clusters for the hierarchy layers to update their portals in
+		for (PathNode *changedNode : changedNodes) {
+			if (!m_HierarchyLayers.empty()) {
+				int cluster = GetNodeCluster(changedNode);
+				for (const std::unique_ptr<HierarchyLayer> &layer : m_HierarchyLayers) {
+					layer->DirtyClusters[cluster] = true;
+				}
 			}
+			changedNode->IsChanged = false;
 		}
 	}
-}
\ No newline at end of file
+}
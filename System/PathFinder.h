@@ -2,6 +2,7 @@
 #define _RTEPATHFINDER_
 
 #include "Box.h"
+#include "ThreadMan.h"
 #include "System/MicroPather/micropather.h"
 
 using namespace micropather;
@@ -16,7 +17,9 @@ namespace RTE {
 	struct PathNode {
 
 		Vector Pos; //!< Absolute position of the center of this node in the scene.
-		bool IsChanged; //!< Whether this has been updated since last call to Reset the pather.
+		int Index; //!< Index of this node in the PathFinder's node grid, counted column by column.
+		bool IsChanged; //!< Whether the costs of any of this' edges changed in the current cost update.
+		bool IsDirty; //!< Whether this' edge costs are waiting to be recalculated.
 
 		/// <summary>
 		/// Pointers to all adjacent nodes. These are not owned, and may be 0 if adjacent to non-wrapping scene border.
@@ -42,8 +45,10 @@ namespace RTE {
 		float DownLeftCost;
 		float LeftUpCost;
 
-		PathNode(Vector pos) {
+		PathNode(Vector pos, int index) {
 			Pos = pos;
+			Index = index;
+			IsChanged = IsDirty = false;
 			Up = Right = Down = Left = UpRight = RightDown = DownLeft = LeftUp = 0;
 			// Costs are infinite unless recalculated as otherwise
 			UpCost = RightCost = DownCost = LeftCost = UpRightCost = RightDownCost = DownLeftCost = LeftUpCost = FLT_MAX;
@@ -96,6 +101,7 @@ namespace RTE {
 #pragma region PathFinding
 		/// <summary>
 		/// Calculates and returns the least difficult path between two points on the current scene.
+		/// With hierarchical pathfinding enabled, points more than a cluster apart are first pathed between cluster portals, then the path is refined node by node between the portals.
 		/// </summary>
 		/// <param name="start">Start positions on the scene to find the path between.</param>
 		/// <param name="end">End positions on the scene to find the path between.</param>
@@ -111,10 +117,12 @@ namespace RTE {
 		void RecalculateAllCosts();
 
 		/// <summary>
-		/// Recalculates the costs between all the nodes touching a deque of specific rectangular areas (which will be wrapped). Also resets the pather itself.
+		/// Recalculates the costs between all the nodes touching a deque of specific rectangular areas (which will be wrapped), and invalidates the pather's cached paths going through any node whose costs changed.
+		/// With a time budget, the nodes are queued up instead and only as many queued nodes as fit in the budget are recalculated, the rest are left for the next calls.
 		/// </summary>
 		/// <param name="boxList">The deque of Boxes representing the updated areas.</param>
-		void RecalculateAreaCosts(const std::deque<Box> &boxList);
+		/// <param name="timeBudgetMS">The time in milliseconds that may be spent recalculating queued nodes. 0 or less means the nodes touching the areas are recalculated right away, regardless of how long it takes.</param>
+		void RecalculateAreaCosts(const std::deque<Box> &boxList, float timeBudgetMS = 0);
 
 		/// <summary>
 		/// Implementation of the abstract interface of Graph.
@@ -137,6 +145,61 @@ namespace RTE {
 		void AdjacentCost(void *state, std::vector<micropather::StateCost> *adjacentList) override;
 #pragma endregion
 
+#pragma region Asynchronous PathFinding
+		/// <summary>
+		/// Queues up a path to be calculated in the background. The path is solved against a snapshot of the node costs taken when the request is dispatched, and can be taken with TakePathRequestResult once it's no longer pending.
+		/// </summary>
+		/// <param name="start">Start position on the scene to find the path from.</param>
+		/// <param name="end">End position on the scene to find the path to.</param>
+		/// <param name="digStrength">What material strength the search is capable of digging through.</param>
+		/// <param name="team">The team the path is for. Requests are dispatched per team, so the doors of the team can be taken out of the costs beforehand.</param>
+		/// <returns>The ticket of the request, used to pick up its result.</returns>
+		int RequestPath(Vector start, Vector end, float digStrength, int team);
+
+		/// <summary>
+		/// Gets whether a path request is still queued or being solved.
+		/// </summary>
+		/// <param name="ticket">The ticket of the request.</param>
+		/// <returns>Whether the request is still pending. False if it's done, or if no such request exists.</returns>
+		bool IsPathRequestPending(int ticket) const { return m_PendingPathRequestTickets.find(ticket) != m_PendingPathRequestTickets.end(); }
+
+		/// <summary>
+		/// Takes the result of a finished path request. The request is forgotten afterwards.
+		/// </summary>
+		/// <param name="ticket">The ticket of the request.</param>
+		/// <param name="pathResult">A list which will be filled out with waypoints between the start and end.</param>
+		/// <param name="totalCostResult">The total minimum difficulty cost calculated between the two points on the scene.</param>
+		/// <returns>Success or failure, expressed as SOLVED, NO_SOLUTION, or START_END_SAME, or c_PathRequestNotDone if the request is still pending or doesn't exist.</returns>
+		int TakePathRequestResult(int ticket, std::list<Vector> &pathResult, float &totalCostResult);
+
+		/// <summary>
+		/// Cancels a path request, whatever state it's in. Its result will never be available.
+		/// </summary>
+		/// <param name="ticket">The ticket of the request.</param>
+		void CancelPathRequest(int ticket);
+
+		/// <summary>
+		/// Gets the teams that have path requests waiting to be dispatched.
+		/// </summary>
+		/// <returns>The teams with queued path requests, in ascending order.</returns>
+		std::vector<int> GetQueuedPathRequestTeams() const;
+
+		/// <summary>
+		/// Takes a snapshot of the current node costs and hands the queued requests of a team to the ThreadMan to be solved against it.
+		/// Requests heading to the same node with the same dig strength are solved together so they can share the pather's cache, and requests with the same start and end nodes share a single solve.
+		/// Requests that don't fit in the budget stay queued for the next dispatch.
+		/// </summary>
+		/// <param name="team">The team to dispatch the requests of.</param>
+		/// <param name="maxSolves">The maximum number of distinct paths to solve. 0 or less means no limit.</param>
+		/// <returns>The number of distinct paths dispatched.</returns>
+		int DispatchPathRequests(int team, int maxSolves);
+
+		/// <summary>
+		/// Waits for all the dispatched path requests to be solved and makes their results available.
+		/// </summary>
+		void CollectPathRequests();
+#pragma endregion
+
 #pragma region Misc
 		/// <summary>
 		/// Implementation of the abstract interface of Graph. This function is only used in DEBUG mode - it dumps output to stdout.
@@ -146,16 +209,266 @@ namespace RTE {
 		void PrintStateInfo(void *state) override {}
 #pragma endregion
 
+		static constexpr int c_PathRequestNotDone = -1; //!< Returned by TakePathRequestResult when there's no result to take.
+
 	protected:
 
+		static int s_NextPathRequestTicket; //!< The ticket the next path request will get. Shared by all PathFinders so tickets from a previous scene never match new requests.
+
 		MicroPather *m_Pather; //!< The actual pathing object that does the pathfinding work. Owned.
 		std::vector<std::vector<PathNode *>> m_NodeGrid;  //!< The array of PathNodes representing the grid on the scene. The nodes are owned by this.
 		unsigned int m_NodeDimension; //!< The width and height of each node, in pixels on the scene.
+		unsigned int m_PatherAllocate; //!< The block size the node caches of the pathers are allocated from.
 
 		float m_DigStrength; //!< What material strength the search is capable of digging through.
+		float m_PatherDigStrength; //!< The dig strength the costs and paths cached in m_Pather were found with.
 
 	private:
 
+		static constexpr int c_EdgeCount = 8; //!< The number of edges going out from each node, in the order Up, Right, Down, Left, UpRight, RightDown, DownLeft, LeftUp.
+
+		/// <summary>
+		/// A path requested with RequestPath.
+		/// </summary>
+		struct PathRequest {
+			int Ticket; //!< The ticket of this request.
+			Vector Start; //!< The exact start position of the path.
+			Vector End; //!< The exact end position of the path.
+			PathNode *StartNode; //!< The node the path starts at. Not owned.
+			PathNode *EndNode; //!< The node the path ends at. Not owned.
+			float DigStrength; //!< What material strength the search is capable of digging through.
+			int Team; //!< The team the path is for.
+		};
+
+		/// <summary>
+		/// The result of a solved PathRequest.
+		/// </summary>
+		struct PathRequestResult {
+			int SolveResult; //!< SOLVED, NO_SOLUTION, or START_END_SAME.
+			std::list<Vector> Path; //!< The waypoints between the start and end.
+			float TotalCost; //!< The total minimum difficulty cost of the path.
+		};
+
+		/// <summary>
+		/// PathRequests heading to the same node with the same dig strength, solved one after the other in a single job.
+		/// </summary>
+		struct PathRequestBatch {
+			std::vector<PathRequest> Requests; //!< The requests in this batch.
+			std::vector<PathRequestResult> Results; //!< The results of the requests, in the same order. Only valid once Job is done.
+			std::shared_ptr<const std::vector<float>> EdgeCosts; //!< The node cost snapshot to solve the requests against, c_EdgeCount per node in node index order.
+			ThreadMan::JobHandle Job; //!< The job solving this batch.
+		};
+
+		/// <summary>
+		/// A Graph reading the node costs from a snapshot instead of the nodes themselves, so it can be solved on while the nodes are updated.
+		/// </summary>
+		class SnapshotGraph : public Graph {
+
+		public:
+
+			const std::vector<float> *EdgeCosts = nullptr; //!< The node cost snapshot being solved against. Not owned.
+			float DigStrength = 1; //!< What material strength the search is capable of digging through.
+
+			/// <summary>
+			/// Implementation of the abstract interface of Graph. Same as PathFinder::LeastCostEstimate.
+			/// </summary>
+			float LeastCostEstimate(void *startState, void *endState) override;
+
+			/// <summary>
+			/// Implementation of the abstract interface of Graph. Same as PathFinder::AdjacentCost, but with the costs from the snapshot.
+			/// </summary>
+			void AdjacentCost(void *state, std::vector<micropather::StateCost> *adjacentList) override;
+
+			/// <summary>
+			/// Implementation of the abstract interface of Graph. Does nothing.
+			/// </summary>
+			void PrintStateInfo(void *state) override {}
+		};
+
+		/// <summary>
+		/// A SnapshotGraph and the MicroPather solving on it. Each thread gets its own.
+		/// </summary>
+		struct SnapshotPather {
+			SnapshotGraph Graph; //!< The graph the pather solves on.
+			std::unique_ptr<MicroPather> Pather; //!< The pather.
+		};
+
+		std::deque<PathRequest> m_QueuedPathRequests; //!< The path requests waiting to be dispatched, in the order they were made.
+		std::vector<std::unique_ptr<PathRequestBatch>> m_DispatchedPathRequestBatches; //!< The path request batches handed to the ThreadMan and not yet collected.
+		std::unordered_set<int> m_PendingPathRequestTickets; //!< The tickets of all queued and dispatched path requests that haven't been cancelled.
+		std::unordered_map<int, PathRequestResult> m_FinishedPathRequests; //!< The results of collected path requests that haven't been taken yet, by ticket.
+		std::vector<std::unique_ptr<SnapshotPather>> m_SnapshotPathers; //!< The pathers solving the dispatched requests, indexed by ThreadMan thread index.
+
+		static constexpr int c_ClusterSize = 10; //!< The width and height of each cluster of the hierarchical pathfinding layers, in nodes.
+		static constexpr int c_MaxHierarchyLayers = 8; //!< The maximum number of hierarchical pathfinding layers kept around. Each dig strength needs its own.
+
+		/// <summary>
+		/// A state of a HierarchyLayer. Either a portal node on the border of a cluster, the sink of a cluster every path into it can end at, or a node a path starts from.
+		/// </summary>
+		struct HierarchyState {
+			PathNode *Node; //!< The node this state is at. Not owned.
+			int Cluster; //!< The index of the cluster this state is in.
+			HierarchyState *Partner; //!< The portal across the cluster border from this one, if this is a portal. Not owned.
+			std::vector<micropather::StateCost> Adjacent; //!< The states reachable from this one and the costs to get to each of them.
+		};
+
+		/// <summary>
+		/// An abstraction of the node grid for a specific dig strength, where clusters of nodes are connected through portals at their borders and paths only go from portal to portal.
+		/// Has its own MicroPather, so its cache is kept separately from the node grid's.
+		/// </summary>
+		class HierarchyLayer : public Graph {
+
+		public:
+
+			float DigStrength = 1; //!< What material strength the paths on this layer are capable of digging through.
+			std::vector<std::vector<std::unique_ptr<HierarchyState>>> BorderPortals; //!< The portals on each cluster border, indexed by cluster index times two, plus one for the south border instead of the east one.
+			std::vector<HierarchyState> ClusterSinks; //!< The sink of each cluster, at its center node. Paths into a cluster are solved to its sink.
+			std::unordered_map<const PathNode *, std::unique_ptr<HierarchyState>> StartStates; //!< The states paths have started from, by node. Cleared whenever any portal changes.
+			std::vector<bool> DirtyClusters; //!< Whether each cluster's node costs have changed since its portals were last updated.
+			std::unique_ptr<MicroPather> Pather; //!< The pather solving on this layer.
+
+			/// <summary>
+			/// Implementation of the abstract interface of Graph. Same as PathFinder::LeastCostEstimate, between the nodes of the states.
+			/// </summary>
+			float LeastCostEstimate(void *startState, void *endState) override;
+
+			/// <summary>
+			/// Implementation of the abstract interface of Graph. Gets the precalculated adjacent states of a state.
+			/// </summary>
+			void AdjacentCost(void *state, std::vector<micropather::StateCost> *adjacentList) override;
+
+			/// <summary>
+			/// Implementation of the abstract interface of Graph. Does nothing.
+			/// </summary>
+			void PrintStateInfo(void *state) override {}
+		};
+
+		int m_ClusterXCount; //!< The number of cluster columns the node grid is divided into.
+		int m_ClusterYCount; //!< The number of cluster rows the node grid is divided into.
+		std::vector<std::unique_ptr<HierarchyLayer>> m_HierarchyLayers; //!< The hierarchical pathfinding layers made so far, least recently used first.
+
+		std::deque<PathNode *> m_DirtyNodes; //!< The nodes queued up to have their edge costs recalculated, in the order they were queued. Nodes that were recalculated in the meantime aren't dirty anymore and are skipped.
+
+#pragma region Path Solving
+		/// <summary>
+		/// Adds the cost to go to each adjacent node of the one passed in to a list, using the passed in edge costs.
+		/// </summary>
+		/// <param name="node">The node to get the adjacent costs of. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <param name="edgeCosts">The material strength along each of the node's edges, c_EdgeCount of them.</param>
+		/// <param name="digStrength">What material strength the search is capable of digging through.</param>
+		/// <param name="adjacentList">The list to add the adjacent nodes and their costs to.</param>
+		/// <summary>
+		/// Gets the material strength along each of the edges going out from a node.
+		/// </summary>
+		/// <param name="node">The node to get the edge costs of. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <param name="edgeCosts">An array of c_EdgeCount floats which will be filled out with the edge costs.</param>
+		static void GetNodeEdgeCosts(const PathNode *node, float *edgeCosts);
+
+		static void AddAdjacentCosts(const PathNode *node, const float *edgeCosts, float digStrength, std::vector<micropather::StateCost> *adjacentList);
+
+		/// <summary>
+		/// Converts a path of PathNodes to a list of scene positions, replacing the ends with the exact start and end positions.
+		/// </summary>
+		/// <param name="start">The exact start position of the path.</param>
+		/// <param name="end">The exact end position of the path.</param>
+		/// <param name="statePath">The PathNodes making up the path, as solved by MicroPather.</param>
+		/// <param name="pathResult">A list which will be filled out with waypoints between the start and end.</param>
+		static void ConvertStatePath(const Vector &start, const Vector &end, const std::vector<void *> &statePath, std::list<Vector> &pathResult);
+
+		/// <summary>
+		/// Solves all the requests of a PathRequestBatch with the calling thread's SnapshotPather. Must be called from the main thread or a worker thread, as other threads would share the main thread's SnapshotPather.
+		/// </summary>
+		/// <param name="batch">The batch to solve.</param>
+		void SolvePathRequestBatch(PathRequestBatch &batch);
+#pragma endregion
+
+#pragma region Hierarchical PathFinding
+		/// <summary>
+		/// Gets the index of the cluster a node is in.
+		/// </summary>
+		/// <param name="node">The node to get the cluster of. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <returns>The index of the node's cluster.</returns>
+		int GetNodeCluster(const PathNode *node) const;
+
+		/// <summary>
+		/// Gets whether two nodes are far enough apart for hierarchical pathfinding to be worth it, meaning there's at least one full cluster between them.
+		/// </summary>
+		/// <param name="startNode">The node a path starts at. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <param name="endNode">The node a path ends at. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <returns>Whether the nodes' clusters are more than one cluster apart.</returns>
+		bool NodesAreClustersApart(const PathNode *startNode, const PathNode *endNode) const;
+
+		/// <summary>
+		/// Solves a path on the HierarchyLayer of the current dig strength, then refines it between each of its portals on the node grid.
+		/// </summary>
+		/// <param name="startNode">The node to start the path at. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <param name="endNode">The node to end the path at. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <param name="statePath">A vector which will be filled out with the nodes making up the path.</param>
+		/// <param name="totalCostResult">The total cost of the path.</param>
+		/// <returns>Success or failure, expressed as SOLVED or NO_SOLUTION.</returns>
+		int SolveHierarchical(PathNode *startNode, PathNode *endNode, std::vector<void *> &statePath, float &totalCostResult);
+
+		/// <summary>
+		/// Gets the HierarchyLayer for a dig strength, making it if there's none yet and updating the portals of any of its clusters that changed.
+		/// </summary>
+		/// <param name="digStrength">What material strength the layer's paths are capable of digging through.</param>
+		/// <returns>The up to date HierarchyLayer.</returns>
+		HierarchyLayer & GetHierarchyLayer(float digStrength);
+
+		/// <summary>
+		/// Remakes the portals on the borders of all dirty clusters of a HierarchyLayer, and the costs between the portals of every cluster touching those borders.
+		/// </summary>
+		/// <param name="layer">The HierarchyLayer to update.</param>
+		void UpdateHierarchyLayer(HierarchyLayer &layer);
+
+		/// <summary>
+		/// Remakes the portals on the east or south border of a cluster. A portal pair is put in the middle of every stretch of the border that can be crossed without digging, or at the cheapest crossing if there is no such stretch.
+		/// </summary>
+		/// <param name="layer">The HierarchyLayer to make the portals for.</param>
+		/// <param name="cluster">The index of the cluster whose border to make the portals on.</param>
+		/// <param name="southBorder">Whether to make the portals on the south border instead of the east one.</param>
+		void MakeBorderPortals(HierarchyLayer &layer, int cluster, bool southBorder);
+
+		/// <summary>
+		/// Recalculates the costs between all the portals of a cluster, and from each of them to its sink and across the border.
+		/// </summary>
+		/// <param name="layer">The HierarchyLayer the cluster is in.</param>
+		/// <param name="cluster">The index of the cluster to update.</param>
+		void UpdateClusterPortalCosts(HierarchyLayer &layer, int cluster);
+
+		/// <summary>
+		/// Gets all the portals inside a cluster, on any of its borders.
+		/// </summary>
+		/// <param name="layer">The HierarchyLayer the cluster is in.</param>
+		/// <param name="cluster">The index of the cluster to get the portals of.</param>
+		/// <returns>The portals inside the cluster. Not owned.</returns>
+		std::vector<HierarchyState *> GetClusterPortals(HierarchyLayer &layer, int cluster) const;
+
+		/// <summary>
+		/// Calculates the least cost from a node to every node in its cluster, without leaving the cluster.
+		/// </summary>
+		/// <param name="sourceNode">The node to calculate the costs from. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <param name="digStrength">What material strength the search is capable of digging through.</param>
+		/// <param name="clusterCosts">A vector which will be filled out with the cost to each node in the cluster, column by column. Unreachable nodes get FLT_MAX.</param>
+		void CalculateClusterCosts(const PathNode *sourceNode, float digStrength, std::vector<float> &clusterCosts) const;
+
+		/// <summary>
+		/// Gets the index of a node within its cluster, as used by CalculateClusterCosts.
+		/// </summary>
+		/// <param name="node">The node to get the index of. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <returns>The index of the node within its cluster.</returns>
+		int GetNodeClusterIndex(const PathNode *node) const;
+
+		/// <summary>
+		/// Gets the cost of stepping directly from a node to an adjacent one.
+		/// </summary>
+		/// <param name="fromNode">The node to step from. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <param name="toNode">The adjacent node to step to. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <param name="digStrength">What material strength the step is capable of digging through.</param>
+		/// <returns>The cost of the step, or FLT_MAX if the nodes aren't adjacent.</returns>
+		static float GetStepCost(const PathNode *fromNode, const PathNode *toNode, float digStrength);
+#pragma endregion
+
 #pragma region Path Cost Updates
 		/// <summary>
 		/// Helper function for calculating the real actual cost of going in a straight line between any two points on the scene.
@@ -168,18 +481,37 @@ namespace RTE {
 		float CostAlongLine(const Vector &start, const Vector &end);
 
 		/// <summary>
-		/// Helper function for updating all the values of cost edges going out from a specific node.
+		/// Helper function for updating the costs of the edges a specific node owns, which are the Right, Down, RightDown and UpRight ones. Every edge is owned by exactly one node, so updating all nodes updates every edge once.
+		/// Both directions of an edge share the same cost, which is written to the nodes at both ends.
 		/// This does NOT update the pather, which is required before solving more paths after calling this.
 		/// </summary>
-		/// <param name="node">The node to update all costs of. It's safe to pass 0 here. OWNERSHIP IS NOT TRANSFERRED!</param>
-		void UpdateNodeCosts(PathNode *node);
+		/// <param name="node">The node to update the owned edge costs of. It's safe to pass 0 here. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <param name="changedNodes">The nodes at either end of any edge whose cost changed get flagged as IsChanged and added to this, unless they already were flagged.</param>
+		void UpdateNodeCosts(PathNode *node, std::vector<PathNode *> &changedNodes);
+
+		/// <summary>
+		/// Helper function for updating the cost of a single edge, by tracing a line offset to each side of it.
+		/// </summary>
+		/// <param name="node">The node owning the edge. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <param name="adjacentNode">The node at the other end of the edge. OWNERSHIP IS NOT TRANSFERRED!</param>
+		/// <param name="cost">The cost of the edge on the owning node's side.</param>
+		/// <param name="adjacentCost">The cost of the edge on the other node's side.</param>
+		/// <param name="rayOffset">The offset of the line traced from the owning node. The line traced back from the other node is offset the opposite way.</param>
+		/// <param name="changedNodes">Both nodes get flagged as IsChanged and added to this if the cost changed, unless they already were flagged.</param>
+		void UpdateEdgeCost(PathNode *node, PathNode *adjacentNode, float &cost, float &adjacentCost, const Vector &rayOffset, std::vector<PathNode *> &changedNodes);
+
+		/// <summary>
+		/// Helper function for finding all the nodes owning edges crossed by a specific box. The node range is wrapped around if the scene wraps, but the box itself is NOT.
+		/// </summary>
+		/// <param name="box">The Box of which all edges it touches should be found.</param>
+		/// <param name="nodesInBox">The nodes owning the edges are added to this. Nodes may be added more than once.</param>
+		void GetNodesInBox(Box &box, std::vector<PathNode *> &nodesInBox);
 
 		/// <summary>
-		/// Helper function for updating all the values of cost edges crossed by a specific box.
-		/// This does NOT update the pather, which is required before solving more paths after calling this. Also it does NOT wrap the box coming in here, only truncates it!
+		/// Invalidates everything the pather and the hierarchy layers have cached about the passed in nodes, and resets their IsChanged flag.
 		/// </summary>
-		/// <param name="box">The Box of which all edges it touches should be recalculated.</param>
-		void UpdateNodeCostsInBox(Box &box);
+		/// <param name="changedNodes">The nodes whose edge costs changed.</param>
+		void InvalidateChangedNodes(const std::vector<PathNode *> &changedNodes);
 #pragma endregion
 
 		/// <summary>
@@ -0,0 +1,76 @@
+#include "ScratchArena.h"
+#include "RTEError.h"
+
+namespace RTE {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ScratchArena::Clear() {
+		m_BlockSize = c_DefaultBlockSize;
+		m_Blocks.clear();
+		m_CurrentBlock = 0;
+		m_CurrentOffset = 0;
+		m_PeakUsedBytes = 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	size_t ScratchArena::GetUsedBytes() const {
+		size_t usedBytes = m_CurrentOffset;
+		for (size_t block = 0; block < m_CurrentBlock && block < m_Blocks.size(); ++block) {
+			usedBytes += m_Blocks[block].second;
+		}
+		return usedBytes;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	size_t ScratchArena::GetReservedBytes() const {
+		size_t reservedBytes = 0;
+		for (const std::pair<std::unique_ptr<char[]>, size_t> &block : m_Blocks) {
+			reservedBytes += block.second;
+		}
+		return reservedBytes;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void * ScratchArena::Allocate(size_t size, size_t alignment) {
+		RTEAssert(alignment > 0 && (alignment & (alignment - 1)) == 0, "ScratchArena allocation alignment must be a power of two!");
+
+		auto alignedOffset = [alignment](const char *blockStart, size_t offset) {
+			uintptr_t blockAddress = reinterpret_cast<uintptr_t>(blockStart);
+			return static_cast<size_t>(((blockAddress + offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1)) - blockAddress);
+		};
+
+		size_t allocationOffset = 0;
+		bool fitsInCurrentBlock = false;
+		if (m_CurrentBlock < m_Blocks.size()) {
+			allocationOffset = alignedOffset(m_Blocks[m_CurrentBlock].first.get(), m_CurrentOffset);
+			fitsInCurrentBlock = allocationOffset + size <= m_Blocks[m_CurrentBlock].second;
+			if (!fitsInCurrentBlock) { ++m_CurrentBlock; }
+		}
+		if (!fitsInCurrentBlock) {
+			// Continue in the next block, making sure it's large enough. Blocks past the current one aren't in use so they can be swapped out freely.
+			size_t requiredSize = std::max(m_BlockSize, size + alignment);
+			if (m_CurrentBlock == m_Blocks.size()) {
+				m_Blocks.emplace_back(std::unique_ptr<char[]>(new char[requiredSize]), requiredSize);
+			} else if (m_Blocks[m_CurrentBlock].second < size + alignment) {
+				m_Blocks[m_CurrentBlock] = { std::unique_ptr<char[]>(new char[requiredSize]), requiredSize };
+			}
+			allocationOffset = alignedOffset(m_Blocks[m_CurrentBlock].first.get(), 0);
+		}
+		m_CurrentOffset = allocationOffset + size;
+		m_PeakUsedBytes = std::max(m_PeakUsedBytes, GetUsedBytes());
+
+		return m_Blocks[m_CurrentBlock].first.get() + allocationOffset;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void ScratchArena::ReleaseToMarker(const Marker &marker) {
+		RTEAssert(marker.BlockIndex < m_CurrentBlock || (marker.BlockIndex == m_CurrentBlock && marker.Offset <= m_CurrentOffset), "Trying to release a ScratchArena to a Marker past its current position!");
+		m_CurrentBlock = marker.BlockIndex;
+		m_CurrentOffset = marker.Offset;
+	}
+}
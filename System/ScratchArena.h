@@ -0,0 +1,147 @@
+#ifndef _RTESCRATCHARENA_
+#define _RTESCRATCHARENA_
+
+namespace RTE {
+
+	/// <summary>
+	/// A bump allocator for short lived temporary memory. Allocating is just moving an offset forward, and everything allocated after a marker is freed at once by releasing back to it.
+	/// Not thread-safe, each thread is supposed to have its own. Nothing allocated from it has its destructor called.
+	/// </summary>
+	class ScratchArena {
+
+	public:
+
+		/// <summary>
+		/// A position in a ScratchArena that it can be released back to.
+		/// </summary>
+		struct Marker {
+			size_t BlockIndex; //!< The index of the block the position is in.
+			size_t Offset; //!< The offset of the position in the block.
+		};
+
+		/// <summary>
+		/// Releases everything allocated from a ScratchArena during its lifetime when it goes out of scope.
+		/// </summary>
+		class Scope {
+
+		public:
+
+			/// <summary>
+			/// Constructor method used to instantiate a Scope object, marking the passed in ScratchArena's current position.
+			/// </summary>
+			/// <param name="arena">The ScratchArena to release back to the current position when this goes out of scope.</param>
+			explicit Scope(ScratchArena &arena) : m_Arena(arena), m_Marker(arena.GetMarker()) {}
+
+			/// <summary>
+			/// Destructor method used to release the ScratchArena back to the position it was at when this was constructed.
+			/// </summary>
+			~Scope() { m_Arena.ReleaseToMarker(m_Marker); }
+
+		private:
+
+			ScratchArena &m_Arena; //!< The ScratchArena to release.
+			Marker m_Marker; //!< The position to release the ScratchArena back to.
+
+			// Disallow the use of some implicit methods.
+			Scope(const Scope &reference) = delete;
+			Scope & operator=(const Scope &rhs) = delete;
+		};
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a ScratchArena object in system memory. No memory is reserved until the first allocation.
+		/// </summary>
+		/// <param name="blockSize">The size in bytes of each block of memory this reserves at a time. Larger allocations get a block of their own size.</param>
+		explicit ScratchArena(size_t blockSize = c_DefaultBlockSize) { Clear(); m_BlockSize = blockSize; }
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Destructor method used to free all the memory reserved by this ScratchArena.
+		/// </summary>
+		~ScratchArena() { Destroy(); }
+
+		/// <summary>
+		/// Frees all the memory reserved by this ScratchArena. Everything allocated from it becomes invalid.
+		/// </summary>
+		void Destroy() { size_t blockSize = m_BlockSize; Clear(); m_BlockSize = blockSize; }
+
+		/// <summary>
+		/// Releases everything allocated from this ScratchArena, but keeps the reserved memory around for reuse.
+		/// </summary>
+		void Reset() { ReleaseToMarker({ 0, 0 }); }
+#pragma endregion
+
+#pragma region Getters
+		/// <summary>
+		/// Gets the number of bytes currently allocated from this ScratchArena, including alignment padding.
+		/// </summary>
+		/// <returns>The number of bytes currently in use.</returns>
+		size_t GetUsedBytes() const;
+
+		/// <summary>
+		/// Gets the highest number of bytes that were ever in use at once in this ScratchArena.
+		/// </summary>
+		/// <returns>The peak number of bytes in use.</returns>
+		size_t GetPeakUsedBytes() const { return m_PeakUsedBytes; }
+
+		/// <summary>
+		/// Gets the number of bytes of memory this ScratchArena has reserved from the system.
+		/// </summary>
+		/// <returns>The number of bytes reserved.</returns>
+		size_t GetReservedBytes() const;
+
+		/// <summary>
+		/// Gets the current position of this ScratchArena, which it can be released back to with ReleaseToMarker().
+		/// </summary>
+		/// <returns>A Marker for the current position.</returns>
+		Marker GetMarker() const { return { m_CurrentBlock, m_CurrentOffset }; }
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Allocates uninitialized memory from this ScratchArena.
+		/// </summary>
+		/// <param name="size">The number of bytes to allocate.</param>
+		/// <param name="alignment">The alignment of the allocated memory. Must be a power of two.</param>
+		/// <returns>A pointer to the allocated memory. Ownership is NOT transferred!</returns>
+		void * Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		/// <summary>
+		/// Allocates uninitialized memory for an array of a trivially destructible type from this ScratchArena.
+		/// </summary>
+		/// <param name="count">The number of elements to allocate.</param>
+		/// <returns>A pointer to the first element of the array. Ownership is NOT transferred!</returns>
+		template <typename Type> Type * AllocateArray(size_t count) {
+			static_assert(std::is_trivially_destructible<Type>::value, "ScratchArena never calls destructors, so it can only hold trivially destructible types!");
+			return static_cast<Type *>(Allocate(sizeof(Type) * count, alignof(Type)));
+		}
+
+		/// <summary>
+		/// Releases everything allocated from this ScratchArena after the passed in Marker was taken.
+		/// </summary>
+		/// <param name="marker">The Marker to release back to.</param>
+		void ReleaseToMarker(const Marker &marker);
+#pragma endregion
+
+	private:
+
+		static constexpr size_t c_DefaultBlockSize = 256 * 1024; //!< The default size of the memory blocks reserved by a ScratchArena.
+
+		size_t m_BlockSize; //!< The size in bytes of each block of memory this reserves at a time.
+		std::vector<std::pair<std::unique_ptr<char[]>, size_t>> m_Blocks; //!< The memory blocks reserved by this and their sizes.
+		size_t m_CurrentBlock; //!< The index of the block allocations are currently made from.
+		size_t m_CurrentOffset; //!< The offset in the current block of the next allocation.
+		size_t m_PeakUsedBytes; //!< The highest number of bytes that were ever in use at once.
+
+		/// <summary>
+		/// Clears all the member variables of this ScratchArena, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+
+		// Disallow the use of some implicit methods.
+		ScratchArena(const ScratchArena &reference) = delete;
+		ScratchArena & operator=(const ScratchArena &rhs) = delete;
+	};
+}
+#endif
@@ -0,0 +1,159 @@
+#include "SlabAllocator.h"
+#include "RTEError.h"
+
+namespace RTE {
+
+	/// <summary>
+	/// Gets the next free SlabAllocator id. A function local counter, so SlabAllocators can be statically constructed in any order.
+	/// </summary>
+	/// <returns>The next free id.</returns>
+	static int NextSlabAllocatorId() { static std::atomic<int> nextId(0); return nextId.fetch_add(1, std::memory_order_relaxed); }
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	SlabAllocator::SlabAllocator(size_t slotSize, int slotsPerSlab) :
+		m_SlotSize(((std::max(slotSize, sizeof(void *)) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t)) * alignof(std::max_align_t)),
+		m_SlotsPerSlab((slotsPerSlab > 0) ? slotsPerSlab : 10),
+		m_Id(NextSlabAllocatorId()),
+		m_ReservedSlots(0),
+		m_SlotsInUse(0),
+		m_PeakSlotsInUse(0) {}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	SlabAllocator::ThreadCaches::~ThreadCaches() {
+		for (ThreadCache &threadCache : Caches) {
+			if (threadCache.Owner) { threadCache.Owner->FlushThreadCache(threadCache, 0); }
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	SlabAllocator::Statistics SlabAllocator::GetStatistics() const {
+		Statistics statistics;
+		statistics.SlotsInUse = m_SlotsInUse.load(std::memory_order_relaxed);
+		statistics.PeakSlotsInUse = m_PeakSlotsInUse.load(std::memory_order_relaxed);
+		statistics.EmptySlabs = 0;
+		statistics.PartialSlabs = 0;
+
+		std::lock_guard<std::mutex> slabLock(m_Mutex);
+		statistics.SlabCount = static_cast<int>(m_Slabs.size());
+		statistics.ReservedSlots = m_ReservedSlots;
+		statistics.CachedSlots = std::max(m_ReservedSlots - statistics.SlotsInUse - static_cast<int>(m_FreeSlots.size()), 0);
+
+		// Count the free slots of each slab by looking up which slab each one on the shared free list falls in.
+		std::vector<const Slab *> slabsByAddress;
+		slabsByAddress.reserve(m_Slabs.size());
+		for (const Slab &slab : m_Slabs) {
+			slabsByAddress.push_back(&slab);
+		}
+		std::sort(slabsByAddress.begin(), slabsByAddress.end(), [](const Slab *slabA, const Slab *slabB) { return std::less<const char *>()(slabA->Memory, slabB->Memory); });
+		std::vector<int> freeSlotsPerSlab(slabsByAddress.size(), 0);
+		for (const void *freeSlot : m_FreeSlots) {
+			const char *slotAddress = static_cast<const char *>(freeSlot);
+			auto slabItr = std::upper_bound(slabsByAddress.begin(), slabsByAddress.end(), slotAddress, [](const char *address, const Slab *slab) { return std::less<const char *>()(address, slab->Memory); });
+			if (slabItr != slabsByAddress.begin()) { freeSlotsPerSlab[std::distance(slabsByAddress.begin(), slabItr) - 1]++; }
+		}
+
+		int strandedSlots = 0;
+		for (size_t slabIndex = 0; slabIndex < slabsByAddress.size(); ++slabIndex) {
+			if (freeSlotsPerSlab[slabIndex] == slabsByAddress[slabIndex]->SlotCount) {
+				statistics.EmptySlabs++;
+			} else if (freeSlotsPerSlab[slabIndex] > 0) {
+				statistics.PartialSlabs++;
+				strandedSlots += freeSlotsPerSlab[slabIndex];
+			}
+		}
+		statistics.Fragmentation = (m_ReservedSlots > 0) ? static_cast<float>(strandedSlots) / static_cast<float>(m_ReservedSlots) : 0.0F;
+		return statistics;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void * SlabAllocator::Allocate() {
+		ThreadCache &threadCache = GetThreadCache();
+		if (threadCache.FreeSlots.empty()) { RefillThreadCache(threadCache); }
+
+		void *slot = threadCache.FreeSlots.back();
+		threadCache.FreeSlots.pop_back();
+		RTEAssert(slot, "Could not find an available slot in the pool, even after increasing its size!");
+
+		int slotsInUse = m_SlotsInUse.fetch_add(1, std::memory_order_relaxed) + 1;
+		int peakSlotsInUse = m_PeakSlotsInUse.load(std::memory_order_relaxed);
+		while (slotsInUse > peakSlotsInUse && !m_PeakSlotsInUse.compare_exchange_weak(peakSlotsInUse, slotsInUse, std::memory_order_relaxed)) {}
+
+		return slot;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	int SlabAllocator::Deallocate(void *slot) {
+		if (!slot) {
+			return GetSlotsInUse();
+		}
+		ThreadCache &threadCache = GetThreadCache();
+		threadCache.FreeSlots.push_back(slot);
+		// Keep a batch around so a thread that frees and allocates in turns doesn't trade with the shared free list every time.
+		if (threadCache.FreeSlots.size() > static_cast<size_t>(m_SlotsPerSlab) * 2) { FlushThreadCache(threadCache, static_cast<size_t>(m_SlotsPerSlab)); }
+
+		return m_SlotsInUse.fetch_sub(1, std::memory_order_relaxed) - 1;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SlabAllocator::Reserve(int slotCount) {
+		std::lock_guard<std::mutex> slabLock(m_Mutex);
+		AddSlab((slotCount > 0) ? slotCount : m_SlotsPerSlab);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	SlabAllocator::ThreadCache & SlabAllocator::GetThreadCache() {
+		thread_local ThreadCaches threadCaches;
+		if (static_cast<size_t>(m_Id) >= threadCaches.Caches.size()) { threadCaches.Caches.resize(m_Id + 1); }
+
+		ThreadCache &threadCache = threadCaches.Caches[m_Id];
+		if (!threadCache.Owner) {
+			threadCache.Owner = this;
+			threadCache.FreeSlots.reserve(m_SlotsPerSlab * 2 + 1);
+		}
+		return threadCache;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SlabAllocator::RefillThreadCache(ThreadCache &threadCache) {
+		std::lock_guard<std::mutex> slabLock(m_Mutex);
+		if (m_FreeSlots.empty()) { AddSlab(m_SlotsPerSlab); }
+
+		size_t batchSize = std::min(m_FreeSlots.size(), static_cast<size_t>(m_SlotsPerSlab));
+		threadCache.FreeSlots.insert(threadCache.FreeSlots.end(), m_FreeSlots.end() - batchSize, m_FreeSlots.end());
+		m_FreeSlots.resize(m_FreeSlots.size() - batchSize);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SlabAllocator::FlushThreadCache(ThreadCache &threadCache, size_t slotsToKeep) {
+		if (threadCache.FreeSlots.size() <= slotsToKeep) {
+			return;
+		}
+		std::lock_guard<std::mutex> slabLock(m_Mutex);
+		m_FreeSlots.insert(m_FreeSlots.end(), threadCache.FreeSlots.begin() + slotsToKeep, threadCache.FreeSlots.end());
+		threadCache.FreeSlots.resize(slotsToKeep);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SlabAllocator::AddSlab(int slotCount) {
+		char *slabMemory = static_cast<char *>(malloc(m_SlotSize * static_cast<size_t>(slotCount)));
+		RTEAssert(slabMemory, "Failed to reserve a slab of " + std::to_string(slotCount) + " slots for the pool!");
+
+		m_Slabs.push_back({ slabMemory, slotCount });
+		m_ReservedSlots += slotCount;
+		m_FreeSlots.reserve(m_FreeSlots.size() + slotCount);
+		// Add the slots back to front, so they're handed out front to back.
+		for (int slotIndex = slotCount - 1; slotIndex >= 0; --slotIndex) {
+			m_FreeSlots.push_back(slabMemory + m_SlotSize * static_cast<size_t>(slotIndex));
+		}
+	}
+}
@@ -0,0 +1,151 @@
+#ifndef _RTESLABALLOCATOR_
+#define _RTESLABALLOCATOR_
+
+namespace RTE {
+
+	/// <summary>
+	/// A thread-safe pool of fixed size memory slots, carved out of contiguous slabs instead of allocated one at a time.
+	/// Each thread takes and returns slots through a cache of its own, and only locks to trade a batch of them with the shared free list when its cache runs dry or overflows.
+	/// Slabs are never given back to the system, same as the pools they replace.
+	/// </summary>
+	class SlabAllocator {
+
+	public:
+
+		/// <summary>
+		/// A snapshot of how much of a SlabAllocator's memory is used, and how scattered the use is.
+		/// </summary>
+		struct Statistics {
+			int SlotsInUse; //!< The number of slots currently handed out.
+			int PeakSlotsInUse; //!< The highest number of slots that were ever handed out at once.
+			int SlabCount; //!< The number of slabs reserved from the system.
+			int ReservedSlots; //!< The number of slots in all the slabs.
+			int CachedSlots; //!< The number of free slots held in the caches of threads, which count as in use for the slab occupancy below.
+			int EmptySlabs; //!< The number of slabs with none of their slots in use.
+			int PartialSlabs; //!< The number of slabs with some, but not all, of their slots in use.
+			float Fragmentation; //!< The fraction of all reserved slots that are free but stuck in partially used slabs.
+		};
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a SlabAllocator object in system memory. No memory is reserved until the first allocation.
+		/// </summary>
+		/// <param name="slotSize">The size in bytes of each slot. Gets rounded up to keep every slot maximally aligned.</param>
+		/// <param name="slotsPerSlab">The number of slots in each slab reserved when the pool runs dry, which is also how many slots threads trade with the shared free list at a time.</param>
+		SlabAllocator(size_t slotSize, int slotsPerSlab);
+#pragma endregion
+
+#pragma region Getters
+		/// <summary>
+		/// Gets the size in bytes of each slot of this SlabAllocator, after rounding for alignment.
+		/// </summary>
+		/// <returns>The size of each slot.</returns>
+		size_t GetSlotSize() const { return m_SlotSize; }
+
+		/// <summary>
+		/// Gets the number of slots currently handed out by this SlabAllocator.
+		/// </summary>
+		/// <returns>The number of slots in use.</returns>
+		int GetSlotsInUse() const { return m_SlotsInUse.load(std::memory_order_relaxed); }
+
+		/// <summary>
+		/// Gets a snapshot of how much of this SlabAllocator's memory is used and how scattered it is. Meant for debug output, as it walks over the whole free list.
+		/// </summary>
+		/// <returns>The Statistics of this SlabAllocator.</returns>
+		Statistics GetStatistics() const;
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Takes a free slot from this SlabAllocator, reserving another slab if there are none left.
+		/// </summary>
+		/// <returns>A pointer to the uninitialized slot. OWNERSHIP IS TRANSFERRED!</returns>
+		void * Allocate();
+
+		/// <summary>
+		/// Returns a slot to this SlabAllocator. It can be returned from any thread, not just the one that took it.
+		/// </summary>
+		/// <param name="slot">The slot to return. Must have been taken from this SlabAllocator. OWNERSHIP IS TRANSFERRED!</param>
+		/// <returns>The number of slots still in use after this was returned.</returns>
+		int Deallocate(void *slot);
+
+		/// <summary>
+		/// Reserves a new slab with a certain number of free slots in it.
+		/// </summary>
+		/// <param name="slotCount">The number of slots to reserve. If 0 is specified, the set number of slots per slab will be used.</param>
+		void Reserve(int slotCount = 0);
+#pragma endregion
+
+	private:
+
+		/// <summary>
+		/// A contiguous block of slots reserved from the system at once.
+		/// </summary>
+		struct Slab {
+			char *Memory; //!< The start of the block.
+			int SlotCount; //!< The number of slots in the block.
+		};
+
+		/// <summary>
+		/// The free slots of one SlabAllocator held by one thread.
+		/// </summary>
+		struct ThreadCache {
+			SlabAllocator *Owner = nullptr; //!< The SlabAllocator the slots belong to, so they can be returned to it when the thread ends.
+			std::vector<void *> FreeSlots; //!< The free slots.
+		};
+
+		/// <summary>
+		/// All the caches of one thread, indexed by the ids of the SlabAllocators they belong to. Returns everything in them when the thread ends.
+		/// </summary>
+		struct ThreadCaches {
+			std::vector<ThreadCache> Caches; //!< The caches of the thread.
+
+			/// <summary>
+			/// Destructor method used to return all the cached slots of the ending thread to their SlabAllocators.
+			/// </summary>
+			~ThreadCaches();
+		};
+
+		const size_t m_SlotSize; //!< The size in bytes of each slot, rounded up for alignment.
+		const int m_SlotsPerSlab; //!< The number of slots reserved at a time when the pool runs dry, and traded between thread caches and the shared free list at a time.
+		const int m_Id; //!< The index of this SlabAllocator's cache in each thread's ThreadCaches.
+
+		mutable std::mutex m_Mutex; //!< Mutex guarding the slabs and the shared free list.
+		std::vector<Slab> m_Slabs; //!< All the slabs reserved so far.
+		std::vector<void *> m_FreeSlots; //!< The shared free list that thread caches refill from and flush to.
+		int m_ReservedSlots; //!< The number of slots in all the slabs.
+
+		std::atomic<int> m_SlotsInUse; //!< The number of slots currently handed out.
+		std::atomic<int> m_PeakSlotsInUse; //!< The highest number of slots that were ever handed out at once.
+
+		/// <summary>
+		/// Gets the calling thread's cache for this SlabAllocator, making it if it doesn't exist yet.
+		/// </summary>
+		/// <returns>The calling thread's cache.</returns>
+		ThreadCache & GetThreadCache();
+
+		/// <summary>
+		/// Moves a batch of free slots from the shared free list into a thread's cache, reserving another slab if there aren't enough.
+		/// </summary>
+		/// <param name="threadCache">The thread cache to refill.</param>
+		void RefillThreadCache(ThreadCache &threadCache);
+
+		/// <summary>
+		/// Moves free slots from a thread's cache back to the shared free list.
+		/// </summary>
+		/// <param name="threadCache">The thread cache to flush.</param>
+		/// <param name="slotsToKeep">The number of slots to leave in the thread cache.</param>
+		void FlushThreadCache(ThreadCache &threadCache, size_t slotsToKeep);
+
+		/// <summary>
+		/// Reserves a new slab and adds its slots to the shared free list. The mutex must be held when calling this.
+		/// </summary>
+		/// <param name="slotCount">The number of slots in the new slab.</param>
+		void AddSlab(int slotCount);
+
+		// Disallow the use of some implicit methods.
+		SlabAllocator(const SlabAllocator &reference) = delete;
+		SlabAllocator & operator=(const SlabAllocator &rhs) = delete;
+	};
+}
+#endif
@@ -0,0 +1,246 @@
+#include "SpatialHash.h"
+#include "MovableObject.h"
+#include "SceneMan.h"
+#include "Box.h"
+
+namespace RTE {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialHash::Clear() {
+		m_Width = 0;
+		m_Height = 0;
+		m_WrapsX = false;
+		m_WrapsY = false;
+		m_ColumnCount = 0;
+		m_RowCount = 0;
+		m_CellWidth = 1.0F;
+		m_CellHeight = 1.0F;
+		m_Cells.clear();
+		m_ObjectCells.clear();
+		m_MaxObjectRadius = 0;
+		m_NextInsertionOrder = 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialHash::Create(int width, int height, bool wrapsX, bool wrapsY, int cellSize) {
+		Clear();
+		m_Width = std::max(width, 1);
+		m_Height = std::max(height, 1);
+		m_WrapsX = wrapsX;
+		m_WrapsY = wrapsY;
+
+		// Rounding the cell count and stretching the cells to fit means a wrapped coordinate and its unwrapped counterpart always land in the same cell.
+		cellSize = std::max(cellSize, 1);
+		m_ColumnCount = std::max(static_cast<int>(std::round(static_cast<float>(m_Width) / static_cast<float>(cellSize))), 1);
+		m_RowCount = std::max(static_cast<int>(std::round(static_cast<float>(m_Height) / static_cast<float>(cellSize))), 1);
+		m_CellWidth = static_cast<float>(m_Width) / static_cast<float>(m_ColumnCount);
+		m_CellHeight = static_cast<float>(m_Height) / static_cast<float>(m_RowCount);
+		m_Cells.resize(static_cast<size_t>(m_ColumnCount * m_RowCount));
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialHash::Reset() {
+		for (std::vector<Entry> &cell : m_Cells) {
+			cell.clear();
+		}
+		m_ObjectCells.clear();
+		m_MaxObjectRadius = 0;
+		m_NextInsertionOrder = 0;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialHash::Insert(MovableObject *object) {
+		if (!object || m_Cells.empty() || m_ObjectCells.find(object) != m_ObjectCells.end()) {
+			return;
+		}
+		const Vector &pos = object->GetPos();
+		int column = BoundCellIndex(GetUnboundedCellIndex(pos.GetX(), m_CellWidth), m_ColumnCount, m_WrapsX);
+		int row = BoundCellIndex(GetUnboundedCellIndex(pos.GetY(), m_CellHeight), m_RowCount, m_WrapsY);
+		int cellIndex = row * m_ColumnCount + column;
+
+		m_Cells[cellIndex].push_back({ object, m_NextInsertionOrder++ });
+		m_ObjectCells.try_emplace(object, cellIndex);
+		m_MaxObjectRadius = std::max(m_MaxObjectRadius, object->GetRadius());
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialHash::Remove(const MovableObject *object) {
+		auto objectCell = m_ObjectCells.find(object);
+		if (objectCell == m_ObjectCells.end()) {
+			return;
+		}
+		std::vector<Entry> &cell = m_Cells[objectCell->second];
+		for (Entry &entry : cell) {
+			if (entry.Object == object) {
+				// Order within cells doesn't matter since results are sorted by insertion order, so swap the last entry in instead of shifting everything down.
+				entry = cell.back();
+				cell.pop_back();
+				break;
+			}
+		}
+		m_ObjectCells.erase(objectCell);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialHash::GetObjectsInRadius(const Vector &center, float radius, std::vector<MovableObject *> &foundObjects) const {
+		if (m_ObjectCells.empty() || radius < 0) {
+			return;
+		}
+		float reach = radius + m_MaxObjectRadius;
+		std::vector<Entry> foundEntries;
+		ForEachEntryInRange(center - Vector(reach, reach), center + Vector(reach, reach), [&foundEntries, &center, radius](const Entry &entry) {
+			if (OverlapsCircle(entry.Object, center, radius)) { foundEntries.emplace_back(entry); }
+		});
+		AddSortedEntries(foundEntries, foundObjects);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialHash::GetObjectsInBox(const Box &box, std::vector<MovableObject *> &foundObjects) const {
+		if (m_ObjectCells.empty()) {
+			return;
+		}
+		Box unflippedBox(box);
+		unflippedBox.Unflip();
+		Vector reach(m_MaxObjectRadius, m_MaxObjectRadius);
+		std::vector<Entry> foundEntries;
+		ForEachEntryInRange(unflippedBox.GetCorner() - reach, unflippedBox.GetCorner() + Vector(unflippedBox.GetWidth(), unflippedBox.GetHeight()) + reach, [&foundEntries, &unflippedBox](const Entry &entry) {
+			if (OverlapsBox(entry.Object, unflippedBox)) { foundEntries.emplace_back(entry); }
+		});
+		AddSortedEntries(foundEntries, foundObjects);
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	MovableObject * SpatialHash::GetClosestObject(const Vector &point, float sqrMaxDistance, const std::function<bool(const MovableObject *)> &filter, Vector &distance) const {
+		if (m_ObjectCells.empty() || !(sqrMaxDistance > 0)) {
+			return nullptr;
+		}
+		MovableObject *closestObject = nullptr;
+		int closestInsertionOrder = 0;
+		float closestSqrDistance = sqrMaxDistance;
+		Vector closestDistance;
+
+		auto checkCell = [&](int column, int row) {
+			for (const Entry &entry : m_Cells[row * m_ColumnCount + column]) {
+				Vector entryDistance = g_SceneMan.ShortestDistance(entry.Object->GetPos(), point);
+				float entrySqrDistance = entryDistance.GetSqrMagnitude();
+				if ((entrySqrDistance < closestSqrDistance || (closestObject && entrySqrDistance == closestSqrDistance && entry.InsertionOrder < closestInsertionOrder)) && filter(entry.Object)) {
+					closestObject = entry.Object;
+					closestInsertionOrder = entry.InsertionOrder;
+					closestSqrDistance = entrySqrDistance;
+					closestDistance = entryDistance;
+				}
+			}
+		};
+
+		// Search outward in square rings of cells around the point. Everything outside ring n is at least n cells' worth of distance away, so the search can stop once the best candidate is closer than that.
+		int centerColumn = BoundCellIndex(GetUnboundedCellIndex(point.GetX(), m_CellWidth), m_ColumnCount, m_WrapsX);
+		int centerRow = BoundCellIndex(GetUnboundedCellIndex(point.GetY(), m_CellHeight), m_RowCount, m_WrapsY);
+		float minCellSize = std::min(m_CellWidth, m_CellHeight);
+		int ringLimit = std::max(m_ColumnCount, m_RowCount);
+
+		for (int ring = 0; ring <= ringLimit; ++ring) {
+			if ((m_WrapsX && ring * 2 + 1 > m_ColumnCount) || (m_WrapsY && ring * 2 + 1 > m_RowCount)) {
+				// The ring would wrap around onto itself, so just finish off with everything. Rechecking cells from earlier rings can't change the result.
+				for (int row = 0; row < m_RowCount; ++row) {
+					for (int column = 0; column < m_ColumnCount; ++column) {
+						checkCell(column, row);
+					}
+				}
+				break;
+			}
+			for (int rowOffset = -ring; rowOffset <= ring; ++rowOffset) {
+				int row = centerRow + rowOffset;
+				if (!m_WrapsY && (row < 0 || row >= m_RowCount)) {
+					continue;
+				}
+				row = BoundCellIndex(row, m_RowCount, m_WrapsY);
+				// Rows at the top and bottom of the ring are visited whole, the ones in between only at their two ends.
+				int columnStep = (rowOffset == -ring || rowOffset == ring) ? 1 : std::max(ring * 2, 1);
+				for (int columnOffset = -ring; columnOffset <= ring; columnOffset += columnStep) {
+					int column = centerColumn + columnOffset;
+					if (!m_WrapsX && (column < 0 || column >= m_ColumnCount)) {
+						continue;
+					}
+					checkCell(BoundCellIndex(column, m_ColumnCount, m_WrapsX), row);
+				}
+			}
+			float coveredDistance = static_cast<float>(ring) * minCellSize;
+			if (closestSqrDistance <= coveredDistance * coveredDistance) {
+				break;
+			}
+		}
+		if (closestObject) { distance = closestDistance; }
+		return closestObject;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool SpatialHash::OverlapsCircle(const MovableObject *object, const Vector &center, float radius) {
+		float reach = radius + object->GetRadius();
+		return g_SceneMan.ShortestDistance(center, object->GetPos()).GetSqrMagnitude() <= reach * reach;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	bool SpatialHash::OverlapsBox(const MovableObject *object, const Box &box) {
+		Box unflippedBox(box);
+		unflippedBox.Unflip();
+		Vector centerDistance = g_SceneMan.ShortestDistance(unflippedBox.GetCenter(), object->GetPos());
+		float outsideX = std::max(std::abs(centerDistance.GetX()) - unflippedBox.GetWidth() / 2.0F, 0.0F);
+		float outsideY = std::max(std::abs(centerDistance.GetY()) - unflippedBox.GetHeight() / 2.0F, 0.0F);
+		float radius = object->GetRadius();
+		return outsideX * outsideX + outsideY * outsideY <= radius * radius;
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialHash::ForEachEntryInRange(const Vector &minCorner, const Vector &maxCorner, const std::function<void(const Entry &)> &entryFunction) const {
+		int firstColumn = GetUnboundedCellIndex(minCorner.GetX(), m_CellWidth);
+		int lastColumn = GetUnboundedCellIndex(maxCorner.GetX(), m_CellWidth);
+		int firstRow = GetUnboundedCellIndex(minCorner.GetY(), m_CellHeight);
+		int lastRow = GetUnboundedCellIndex(maxCorner.GetY(), m_CellHeight);
+
+		// Ranges covering a whole wrapping axis are cut down to one lap so no cell gets visited twice, and ranges on non-wrapping axes are clamped since everything outside is filed in the edge cells.
+		if (m_WrapsX && lastColumn - firstColumn + 1 >= m_ColumnCount) {
+			firstColumn = 0;
+			lastColumn = m_ColumnCount - 1;
+		} else if (!m_WrapsX) {
+			firstColumn = BoundCellIndex(firstColumn, m_ColumnCount, false);
+			lastColumn = BoundCellIndex(lastColumn, m_ColumnCount, false);
+		}
+		if (m_WrapsY && lastRow - firstRow + 1 >= m_RowCount) {
+			firstRow = 0;
+			lastRow = m_RowCount - 1;
+		} else if (!m_WrapsY) {
+			firstRow = BoundCellIndex(firstRow, m_RowCount, false);
+			lastRow = BoundCellIndex(lastRow, m_RowCount, false);
+		}
+
+		for (int row = firstRow; row <= lastRow; ++row) {
+			int cellRowStart = BoundCellIndex(row, m_RowCount, m_WrapsY) * m_ColumnCount;
+			for (int column = firstColumn; column <= lastColumn; ++column) {
+				for (const Entry &entry : m_Cells[cellRowStart + BoundCellIndex(column, m_ColumnCount, m_WrapsX)]) {
+					entryFunction(entry);
+				}
+			}
+		}
+	}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void SpatialHash::AddSortedEntries(std::vector<Entry> &foundEntries, std::vector<MovableObject *> &foundObjects) {
+		std::sort(foundEntries.begin(), foundEntries.end(), [](const Entry &lhs, const Entry &rhs) { return lhs.InsertionOrder < rhs.InsertionOrder; });
+		foundObjects.reserve(foundObjects.size() + foundEntries.size());
+		for (const Entry &entry : foundEntries) {
+			foundObjects.emplace_back(entry.Object);
+		}
+	}
+}
@@ -0,0 +1,184 @@
+#ifndef _RTESPATIALHASH_
+#define _RTESPATIALHASH_
+
+#include "Vector.h"
+
+namespace RTE {
+
+	class MovableObject;
+	class Box;
+
+	/// <summary>
+	/// A uniform grid over the Scene that sorts MovableObjects into cells by position, so proximity queries only need to look at the objects in nearby cells instead of all of them.
+	/// The grid wraps around along the same axes the Scene does, and the cells are sized so that a whole number of them exactly spans the Scene.
+	/// Objects are filed by their position at the time they're inserted, and stay in that cell until removed. Queries are exact against the filed positions and bounding radii.
+	/// </summary>
+	class SpatialHash {
+
+	public:
+
+#pragma region Creation
+		/// <summary>
+		/// Constructor method used to instantiate a SpatialHash object in system memory. Create() should be called before using the object.
+		/// </summary>
+		SpatialHash() { Clear(); }
+
+		/// <summary>
+		/// Makes the SpatialHash object ready for use, laid out over a Scene of the given dimensions. Any previously inserted objects are forgotten.
+		/// </summary>
+		/// <param name="width">The width of the Scene, in pixels.</param>
+		/// <param name="height">The height of the Scene, in pixels.</param>
+		/// <param name="wrapsX">Whether the Scene wraps around horizontally.</param>
+		/// <param name="wrapsY">Whether the Scene wraps around vertically.</param>
+		/// <param name="cellSize">The desired size of each cell, in pixels. The actual size is adjusted so the cells exactly span the Scene.</param>
+		void Create(int width, int height, bool wrapsX, bool wrapsY, int cellSize);
+#pragma endregion
+
+#pragma region Destruction
+		/// <summary>
+		/// Removes all inserted objects while keeping the layout of this SpatialHash.
+		/// </summary>
+		void Reset();
+#pragma endregion
+
+#pragma region Getters
+		/// <summary>
+		/// Gets whether this SpatialHash has been created with a layout matching the given Scene dimensions.
+		/// </summary>
+		/// <param name="width">The width of the Scene, in pixels.</param>
+		/// <param name="height">The height of the Scene, in pixels.</param>
+		/// <param name="wrapsX">Whether the Scene wraps around horizontally.</param>
+		/// <param name="wrapsY">Whether the Scene wraps around vertically.</param>
+		/// <returns>Whether the layout matches.</returns>
+		bool HasLayout(int width, int height, bool wrapsX, bool wrapsY) const { return !m_Cells.empty() && m_Width == width && m_Height == height && m_WrapsX == wrapsX && m_WrapsY == wrapsY; }
+
+		/// <summary>
+		/// Gets the number of objects currently inserted in this SpatialHash.
+		/// </summary>
+		/// <returns>The number of inserted objects.</returns>
+		size_t GetObjectCount() const { return m_ObjectCells.size(); }
+#pragma endregion
+
+#pragma region Concrete Methods
+		/// <summary>
+		/// Files an object into the cell its current position falls in. Objects already inserted are ignored.
+		/// </summary>
+		/// <param name="object">The object to insert. Ownership is NOT transferred!</param>
+		void Insert(MovableObject *object);
+
+		/// <summary>
+		/// Removes an object from this SpatialHash. Objects that aren't inserted are ignored.
+		/// </summary>
+		/// <param name="object">The object to remove.</param>
+		void Remove(const MovableObject *object);
+
+		/// <summary>
+		/// Finds all inserted objects whose bounding circles overlap a circle, in the order they were inserted.
+		/// </summary>
+		/// <param name="center">The center of the circle, in Scene coordinates.</param>
+		/// <param name="radius">The radius of the circle.</param>
+		/// <param name="foundObjects">The list to add the found objects to.</param>
+		void GetObjectsInRadius(const Vector &center, float radius, std::vector<MovableObject *> &foundObjects) const;
+
+		/// <summary>
+		/// Finds all inserted objects whose bounding circles overlap a box, in the order they were inserted.
+		/// </summary>
+		/// <param name="box">The box to check, in Scene coordinates.</param>
+		/// <param name="foundObjects">The list to add the found objects to.</param>
+		void GetObjectsInBox(const Box &box, std::vector<MovableObject *> &foundObjects) const;
+
+		/// <summary>
+		/// Finds the inserted object whose position is closest to a point, out of those that pass a filter. Ties go to the object inserted first.
+		/// </summary>
+		/// <param name="point">The point to measure from, in Scene coordinates.</param>
+		/// <param name="sqrMaxDistance">The squared distance objects have to be strictly closer than to be found.</param>
+		/// <param name="filter">The function that decides whether an object may be found.</param>
+		/// <param name="distance">Set to the shortest distance vector from the found object to the point. Left alone if nothing is found.</param>
+		/// <returns>The closest object that passed the filter, or nullptr if none did within range.</returns>
+		MovableObject * GetClosestObject(const Vector &point, float sqrMaxDistance, const std::function<bool(const MovableObject *)> &filter, Vector &distance) const;
+
+		/// <summary>
+		/// Gets whether the bounding circle of an object overlaps a circle, taking Scene wrapping into account.
+		/// </summary>
+		/// <param name="object">The object to check.</param>
+		/// <param name="center">The center of the circle, in Scene coordinates.</param>
+		/// <param name="radius">The radius of the circle.</param>
+		/// <returns>Whether they overlap.</returns>
+		static bool OverlapsCircle(const MovableObject *object, const Vector &center, float radius);
+
+		/// <summary>
+		/// Gets whether the bounding circle of an object overlaps a box, taking Scene wrapping into account.
+		/// </summary>
+		/// <param name="object">The object to check.</param>
+		/// <param name="box">The box to check, in Scene coordinates.</param>
+		/// <returns>Whether they overlap.</returns>
+		static bool OverlapsBox(const MovableObject *object, const Box &box);
+#pragma endregion
+
+	private:
+
+		/// <summary>
+		/// An object filed in a cell.
+		/// </summary>
+		struct Entry {
+			MovableObject *Object; //!< The filed object. Not owned.
+			int InsertionOrder; //!< When the object was inserted relative to the others, so results don't depend on the order within cells.
+		};
+
+		int m_Width; //!< The width of the Scene this is laid out over.
+		int m_Height; //!< The height of the Scene this is laid out over.
+		bool m_WrapsX; //!< Whether the Scene wraps around horizontally.
+		bool m_WrapsY; //!< Whether the Scene wraps around vertically.
+		int m_ColumnCount; //!< The number of cell columns.
+		int m_RowCount; //!< The number of cell rows.
+		float m_CellWidth; //!< The width of each cell.
+		float m_CellHeight; //!< The height of each cell.
+
+		std::vector<std::vector<Entry>> m_Cells; //!< The objects filed in each cell, row by row.
+		std::unordered_map<const MovableObject *, int> m_ObjectCells; //!< The index of the cell each inserted object is filed in.
+		float m_MaxObjectRadius; //!< The largest bounding radius of any object inserted since the last reset, which is how far outside its cell an object can reach.
+		int m_NextInsertionOrder; //!< The insertion order the next inserted object gets.
+
+		/// <summary>
+		/// Gets the index of the column or row a coordinate falls in, without wrapping or clamping it into the grid.
+		/// </summary>
+		/// <param name="coordinate">The coordinate to convert.</param>
+		/// <param name="cellSize">The size of the cells along the coordinate's axis.</param>
+		/// <returns>The unbounded column or row index.</returns>
+		static int GetUnboundedCellIndex(float coordinate, float cellSize) { return static_cast<int>(std::floor(coordinate / cellSize)); }
+
+		/// <summary>
+		/// Brings an unbounded column or row index into the grid, by wrapping it on wrapping axes or clamping it otherwise.
+		/// </summary>
+		/// <param name="index">The unbounded index.</param>
+		/// <param name="count">The number of columns or rows.</param>
+		/// <param name="wraps">Whether the axis wraps around.</param>
+		/// <returns>The index in the grid.</returns>
+		static int BoundCellIndex(int index, int count, bool wraps) { return wraps ? ((index % count) + count) % count : std::clamp(index, 0, count - 1); }
+
+		/// <summary>
+		/// Calls a function for every entry in the cells overlapping a range of Scene coordinates, visiting each cell only once even if the range wraps around onto itself.
+		/// </summary>
+		/// <param name="minCorner">The upper left corner of the range.</param>
+		/// <param name="maxCorner">The lower right corner of the range.</param>
+		/// <param name="entryFunction">The function to call for each entry.</param>
+		void ForEachEntryInRange(const Vector &minCorner, const Vector &maxCorner, const std::function<void(const Entry &)> &entryFunction) const;
+
+		/// <summary>
+		/// Sorts found entries by insertion order and adds their objects to a result list.
+		/// </summary>
+		/// <param name="foundEntries">The entries to sort and add.</param>
+		/// <param name="foundObjects">The list to add the objects to.</param>
+		static void AddSortedEntries(std::vector<Entry> &foundEntries, std::vector<MovableObject *> &foundObjects);
+
+		/// <summary>
+		/// Clears all the member variables of this SpatialHash, effectively resetting the members of this abstraction level only.
+		/// </summary>
+		void Clear();
+
+		// Disallow the use of some implicit methods.
+		SpatialHash(const SpatialHash &reference) = delete;
+		SpatialHash & operator=(const SpatialHash &rhs) = delete;
+	};
+}
+#endif
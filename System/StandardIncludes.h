@@ -51,6 +51,8 @@
 #include <functional>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <cctype>
 #include <string>
 #include <cstring>
@@ -76,6 +78,7 @@
 #include <limits>
 #include <random>
 #include <array>
+#include <bitset>
 #include <filesystem>
 
 // TODO: Get rid of these once alias qualifiers are added.
@@ -8,8 +8,9 @@
 
 namespace RTE {
 
-	bool System::s_Quit = false;
+	std::atomic<bool> System::s_Quit = { false };
 	bool System::s_LogToCLI = false;
+	bool System::s_Headless = false;
 	std::string System::s_WorkingDirectory = ".";
 	std::vector<size_t> System::s_WorkingTree;
 	std::filesystem::file_time_type System::s_ProgramStartTime = std::filesystem::file_time_type::clock::now();
@@ -36,6 +36,19 @@ namespace RTE {
 		static void WindowCloseButtonHandler() { SetQuit(); }
 #pragma endregion
 
+#pragma region Headless Mode
+		/// <summary>
+		/// Gets whether the program runs as a dedicated server without a display, audio output, input devices or menus.
+		/// </summary>
+		/// <returns>Whether the program runs headless or not.</returns>
+		static bool IsHeadless() { return s_Headless; }
+
+		/// <summary>
+		/// Makes the program run as a dedicated server without a display, audio output, input devices or menus. Has to be done before Allegro and the managers are initialized.
+		/// </summary>
+		static void EnableHeadlessMode() { s_Headless = true; }
+#pragma endregion
+
 #pragma region Directories
 		/// <summary>
 		/// Gets the current working directory.
@@ -147,8 +160,9 @@ namespace RTE {
 
 	private:
 
-		static bool s_Quit; //!< Whether the user requested program termination through GUI or the window close button.
+		static std::atomic<bool> s_Quit; //!< Whether the user requested program termination through GUI, the window close button or a termination signal. Atomic so it can be set from signal handlers.
 		static bool s_LogToCLI; //!< Bool to tell whether to print the loading log and anything specified with PrintToCLI to command-line or not.
+		static bool s_Headless; //!< Whether the program runs as a dedicated server without a display, audio output, input devices or menus.
 		static std::string s_WorkingDirectory; //!< String containing the absolute path to current working directory.
 		static std::vector<size_t> s_WorkingTree; //!< Vector of the hashes of all file paths in the working directory.
 		static std::filesystem::file_time_type s_ProgramStartTime; //!< Low precision time point of program start for checking if a file was created after starting.